@@ -0,0 +1,23 @@
+/**
+ *
+ * This file contains the declaration of the BatteryMonitor interface.
+ * A BatteryMonitor reports how much charge is left and controls charging at the base.
+ * The ExecutionController uses it to decide when to return to base (see ExecutionController::setReturnToBase()).
+ * SimBattery is the simulated implementation, a real one would read a fuel gauge over I2C.
+ *
+ */
+
+#ifndef BATTERYMONITOR_H
+#define BATTERYMONITOR_H
+
+class BatteryMonitor {
+	public:
+		virtual ~BatteryMonitor() {}
+		virtual double getRemainingWh() = 0;
+		virtual double getCapacityWh() = 0;
+		virtual double getVoltage() = 0;
+		virtual int startCharging() = 0;
+		virtual int stopCharging() = 0;
+};
+
+#endif // BATTERYMONITOR_H
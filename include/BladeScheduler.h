@@ -0,0 +1,41 @@
+/**
+ *
+ * This file contains the declaration of the BladeScheduler class and all associated member functions and attributes.
+ * The BladeScheduler class decides when the blade spins, from the cutting annotations of the instructions (see Path::annotateCutting()).
+ * Stretches of blade-off instructions that are too short to be worth stopping the blade for are switched back on,
+ * and before every longer stretch ends the blade is started early (pre-spin) so it is at speed when cutting resumes.
+ *
+ * Instruction durations are estimated from the standard drive speed and 90 degree turn time, so pre-spin is approximate.
+ *
+ */
+
+#ifndef BLADESCHEDULER_H
+#define BLADESCHEDULER_H
+
+#include <deque>
+#include "Instruction.h"
+
+class BladeScheduler {
+	public:
+		BladeScheduler();
+		BladeScheduler(int spinUpMs, int minOffMs);
+		~BladeScheduler();
+		int schedule(Plan& instructions);
+		int setEnabled(bool enabled);
+		bool isEnabled();
+		int getSpinUpMs();
+		int getMinOffMs();
+		int getOffCount();
+
+	protected:
+
+	private:
+		int m_spinUpMs; // time the blade needs to get up to cutting speed
+		int m_minOffMs; // shortest blade-off stretch worth stopping the blade for
+		bool m_enabled;
+		int m_offCount;
+
+		int estimateDuration(const Instruction& instruction);
+};
+
+#endif // BLADESCHEDULER_H
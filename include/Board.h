@@ -0,0 +1,55 @@
+/**
+ *
+ * This file contains the declaration of the Board interface.
+ * A Board is what the motor and execution classes talk to instead of calling wiringPi directly:
+ * WiringPiBoard drives the real GPIO pins on the RPi, SimBoard keeps the pins in memory and runs on a virtual clock,
+ * so the same controller classes can run on the mower or headless in a simulator.
+ *
+ * Input pins can also be waited on: getEdgeFd() returns a file descriptor that becomes readable when the pin changes
+ * (for epoll, see Reactor), and readEdges() consumes the pending changes.
+ * delay() with a CancellationToken returns early when the token is cancelled, so shutdown does not wait for a whole move.
+ *
+ * For the emergency stop, output pins can be resolved once into a PinBatch and then all written LOW with writeLow(),
+ * which takes no locks and allocates nothing. attachInterrupt() calls a handler when an input pin goes LOW,
+ * without going through the button polling or the reactor.
+ *
+ */
+
+#ifndef BOARD_H
+#define BOARD_H
+
+class CancellationToken;
+
+const int PIN_BATCH_SIZE = 8;
+
+/**
+ * Output pins resolved by Board::resolvePins(), the contents are board specific
+ */
+struct PinBatch {
+	unsigned long long mask; // one bit per pin, what the bit means depends on the board
+	int handle; // e.g. a GPIO line request, -1 if the board does not need one
+	int count;
+	int pins[PIN_BATCH_SIZE];
+};
+
+typedef void (*InterruptHandler)(void* context);
+
+class Board {
+	public:
+		virtual ~Board() {}
+		virtual int setup() = 0;
+		virtual int pinMode(int pin, int mode) = 0;
+		virtual int pullUpDnControl(int pin, int pud) = 0;
+		virtual int digitalWrite(int pin, int value) = 0;
+		virtual int digitalRead(int pin) = 0;
+		virtual void delay(unsigned int milliseconds) = 0;
+		virtual unsigned int delay(unsigned int milliseconds, CancellationToken& token) = 0;
+		virtual unsigned int millis() = 0;
+		virtual int getEdgeFd(int pin) = 0;
+		virtual int readEdges(int pin, long long& firstEdgeNs) = 0;
+		virtual int resolvePins(const int* pins, int count, PinBatch& batch) = 0;
+		virtual int writeLow(const PinBatch& batch) = 0;
+		virtual int attachInterrupt(int pin, InterruptHandler handler, void* context) = 0;
+};
+
+#endif // BOARD_H
@@ -0,0 +1,57 @@
+/**
+ *
+ * This file contains the declaration of the BoardTrace class and all associated member functions and attributes.
+ * A BoardTrace is a list of what happened on a Board's pins and timers, in order, with the board time of each event
+ * (ms since the recording started): input reads, output writes, delays and interrupts. RecordingBoard records one,
+ * TraceReplayer plays the inputs of one back on a SimBoard, and getTimeline() takes out the output pin edges so
+ * two runs can be compared.
+ *
+ * Traces are saved as text, one event per line ("time type pin value"), so a corpus of them can be kept with the code
+ * and a changed timeline shows up in a diff. The first line is the format version, a second "#" line is free text
+ * (e.g. how the mower was set up).
+ *
+ */
+
+#ifndef BOARDTRACE_H
+#define BOARDTRACE_H
+
+#include <string>
+#include <vector>
+
+enum TraceEventType {
+	TRACE_READ = 'R', // value: level read (only reads that returned a different level than the last read of the pin)
+	TRACE_WRITE = 'W', // value: level written (writeLow() is recorded as a write of 0 to every pin of the batch)
+	TRACE_DELAY = 'D', // pin: -1, value: ms actually waited
+	TRACE_INTERRUPT = 'I' // an attached interrupt handler was called, value: 0 (handlers run when the pin goes LOW)
+};
+
+struct TraceEvent {
+	unsigned int timeMs;
+	char type; // TraceEventType
+	int pin;
+	int value;
+};
+
+class BoardTrace {
+	public:
+		BoardTrace();
+		~BoardTrace();
+		int add(unsigned int timeMs, char type, int pin, int value);
+		int save(const std::string& path) const;
+		int load(const std::string& path);
+		int clear();
+		BoardTrace getTimeline() const;
+		int compare(const BoardTrace& other, unsigned int toleranceMs, unsigned int& maxDeviationMs, std::string& difference) const;
+		const std::vector<TraceEvent>& getEvents() const;
+		const std::string& getHeader() const;
+		void setHeader(const std::string& header);
+		unsigned int getEndMs() const;
+
+	protected:
+
+	private:
+		std::vector<TraceEvent> m_events;
+		std::string m_header;
+};
+
+#endif // BOARDTRACE_H
@@ -3,24 +3,53 @@
  * This file contains the declaration of the ButtonController class and all associated member functions and attributes.
  * The ButtonController class is used to receive button input and then depending on the button pressed + current state will do a specific action
  * This is where we used the idea of an FSM to better understand how we should react to button presses depending on the current state
+ * The display is not touched until initDisplay() has run (it can run on another thread while the buttons are already live),
+ * and a start press waits for the plan if one is still being generated (see setPlanReady())
  *
  */
 
 #ifndef BUTTONCONTROLLER_H
 #define	BUTTONCONTROLLER_H
 
+#include <vector>
+#include <atomic>
+#include <future>
 #include "State.h"
 #include "Path.h"
 #include "ExecutionController.h"
+#include "Board.h"
+#include "CancellationToken.h"
+#include "EmergencyStop.h"
+#include "MissionLog.h"
+#include "LatencyHistogram.h"
+
+const int BUTTON_COUNT = 4;
+const unsigned int BUTTON_LOCKOUT_MS = 500; // presses of the same button closer together than this are ignored
 
 class ButtonController {
 	public:
 		ButtonController(int pinStart, int pinSetDimensions, int pinUpArrow, int pinDownArrow, State& currentState, Path& path, ExecutionController& exeControl);
+		ButtonController(int pinStart, int pinSetDimensions, int pinUpArrow, int pinDownArrow, State& currentState, Path& path, ExecutionController& exeControl, Board& board);
 		~ButtonController();
 		int sendButtonPress(int pinButtonPressed);
 		int startInputListener();
+		int setupInputs();
+		int initDisplay();
+		int setPlanReady(std::shared_future<int> planReady);
+		int pollButtons();
+		int refreshDisplay();
+		void showGoodbye();
+		bool isShutDown();
+		int setCancellationToken(CancellationToken& token);
+		int setEmergencyStop(EmergencyStop& emergencyStop);
+		int setMissionLog(MissionLog& missionLog);
+		int setEdgeTime(long long edgeNs);
+		int setUploadedPlan(const Plan* plan, const Pose& start);
+		std::vector<int> getButtonPins();
 		State getCurrentState();
 		int getErrorNum();
+		const LatencyHistogram& getPressHistogram();
+		const LatencyHistogram& getFrameHistogram();
 
 	protected:
 
@@ -28,6 +57,7 @@ class ButtonController {
 		State* m_currentState;
 		Path* m_path;
 		ExecutionController* m_exeControl;
+		Board* m_board;
 		int m_pinStart;
 		int m_pinSetDimensions;
 		int m_pinUpArrow;
@@ -36,6 +66,23 @@ class ButtonController {
 		int m_inputWidth;
 		int m_errorNum;
 		bool m_shutDownFlag;
+		CancellationToken* m_cancelToken; // nullptr: only the down button shuts the listener down
+		EmergencyStop* m_emergencyStop; // nullptr: no e-stop fitted
+		MissionLog* m_missionLog; // nullptr: presses are not recorded
+		std::atomic<bool> m_displayReady; // set by initDisplay(), nothing is drawn before
+		bool m_screenShown; // the state screen has replaced the welcome screen
+		std::shared_future<int> m_planReady; // invalid: the plan is generated before the buttons are live
+		const Plan* m_uploadedPlan; // nullptr: START mows the lawn entered on the buttons
+		Pose m_uploadedStart;
+		long long m_edgeNs; // when the pin edge behind the next pollButtons() happened, 0 if not known
+		LatencyHistogram m_pressHistogram; // press (edge, or seen by pollButtons()) to its handler returning
+		LatencyHistogram m_frameHistogram; // ssd1306_display() calls
+
+		int m_buttonPins[BUTTON_COUNT]; // start, set dimensions, up, down: read on every poll without building a vector
+
+		// used to prevent multiple presses when the user holds a button down
+		bool m_buttonReleased[BUTTON_COUNT];
+		unsigned int m_lastPressMs[BUTTON_COUNT];
 
 		// button press callbacks
 		int	onStart();
@@ -51,9 +98,13 @@ class ButtonController {
 		void pausedScreen();
 		void lwInputMode(char* val, int decider, State state);
 		void displayTemp();
-		void staticDisplays(char* state);
+		void staticDisplays(const char* state);
 		int calcX(char* str);
-		void drawText(int x, int y, char* s, int size, char* state);
+		void drawText(int x, int y, char* s, int size, const char* state);
+		void writeText(int x, int y, char* s, int size, const char* state);
+		void waitForPlan();
+		void setState(State state);
+		void drawPose(const char* state);
 };
 
 #endif // BUTTONCONTROLLER_H
@@ -0,0 +1,41 @@
+/**
+ *
+ * This file contains the declaration of the CancellationToken class and all associated member functions and attributes.
+ * A CancellationToken is shared by everything that has to stop on shutdown (ExecutionController, WheelController, Motor,
+ * ButtonController). cancel() can be called from any thread: every sleepFor() on the token returns straight away,
+ * and the callbacks registered with onCancel() run on the cancelling thread before cancel() returns.
+ * The controllers register a callback that writes their motor pins LOW, so the motors are stopped as soon as
+ * cancel() returns, whatever the thread that drives them is doing.
+ *
+ * A token can only be cancelled once, and must not be cancelled after the objects that registered callbacks are gone.
+ *
+ */
+
+#ifndef CANCELLATIONTOKEN_H
+#define CANCELLATIONTOKEN_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+class CancellationToken {
+	public:
+		CancellationToken();
+		~CancellationToken();
+		int cancel();
+		bool isCancelled() const;
+		unsigned int sleepFor(unsigned int milliseconds);
+		int onCancel(std::function<void()> callback);
+
+	protected:
+
+	private:
+		std::atomic<bool> m_cancelled;
+		std::mutex m_mutex;
+		std::condition_variable m_wakeUp;
+		std::vector<std::function<void()>> m_callbacks;
+};
+
+#endif // CANCELLATIONTOKEN_H
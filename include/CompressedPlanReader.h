@@ -0,0 +1,64 @@
+/**
+ *
+ * This file contains the declaration of the CompressedPlanReader class and all associated member functions and attributes.
+ * The CompressedPlanReader decodes the plans CompressedPlanWriter stores (see CompressedPlanWriter.h for the format)
+ * one instruction at a time, straight out of the memory mapped file: the only state is the position in the ops, the
+ * run being repeated and a stack of the loops being repeated, so decoding never touches the heap.
+ *
+ * open() checks the whole file (symbol indices, loop bodies, nesting and the instruction count) without expanding it,
+ * so next() can trust what it reads. rewind() starts again from the first instruction.
+ *
+ */
+
+#ifndef COMPRESSEDPLANREADER_H
+#define COMPRESSEDPLANREADER_H
+
+#include <cstdint>
+#include <string>
+#include "CompressedPlanWriter.h"
+#include "Instruction.h"
+
+class CompressedPlanReader {
+	public:
+		CompressedPlanReader();
+		~CompressedPlanReader();
+		int open(const std::string& path);
+		int open(const unsigned char* data, size_t size);
+		int close();
+		int next(Instruction& instruction);
+		int rewind();
+		bool isOpen();
+		size_t getInstructionCount();
+		size_t getRemainingCount();
+		size_t getFileSize();
+
+	protected:
+
+	private:
+		struct Loop {
+			const unsigned char* body;
+			const unsigned char* end;
+			uint64_t repeats; // left after the one being decoded
+		};
+
+		void* m_mapping; // nullptr when reading a buffer the caller owns
+		size_t m_size;
+		const unsigned char* m_symbols;
+		uint32_t m_symbolCount;
+		uint32_t m_symbolSize;
+		const unsigned char* m_ops;
+		const unsigned char* m_opsEnd;
+		size_t m_instructionCount;
+		size_t m_decodedCount;
+		const unsigned char* m_position; // next op
+		uint32_t m_runSymbol;
+		uint64_t m_runLeft; // instructions of the current run still to come
+		Loop m_loops[COMPRESSED_PLAN_MAX_DEPTH];
+		int m_depth; // loops being repeated
+
+		int check(const unsigned char* data, size_t size);
+		int countOps(const unsigned char* begin, const unsigned char* end, int depth, uint64_t& count);
+		static const unsigned char* readVarint(const unsigned char* position, const unsigned char* end, uint64_t& value);
+};
+
+#endif // COMPRESSEDPLANREADER_H
@@ -0,0 +1,93 @@
+/**
+ *
+ * This file contains the declaration of the CompressedPlanWriter class and all associated member functions and attributes.
+ * A CompressedPlanWriter stores a plan in a compact binary file for large properties, whose plans are long but made of
+ * the same few instructions over and over (the serpentine of generatePath() repeats TR/MB/TR/MF TL/MB/TL/MF once per
+ * pair of strips). CompressedPlanReader decodes the file one instruction at a time, so the executor can mow a plan of
+ * any length without it ever being expanded in memory (see ExecutionController::assignInstructions()).
+ *
+ * The file is a CompressedPlanHeader, then the symbols (every different instruction once, as CompressedPlanSymbols),
+ * then the ops, each a LEB128 varint with the op type in its low two bits:
+ *  - SYMBOL: index << 2 | PLAN_OP_SYMBOL, one instruction
+ *  - RUN: index << 2 | PLAN_OP_RUN, then the count: the same instruction count times
+ *  - LOOP: repeats << 2 | PLAN_OP_LOOP, then the body's length in bytes, then the body: its ops repeats times
+ * Loops may hold runs and other loops, up to COMPRESSED_PLAN_MAX_DEPTH deep. The writer looks for groups of up to
+ * COMPRESSED_PLAN_MAX_PERIOD instructions that repeat straight after each other.
+ *
+ * Instructions are stored as they are given, blade schedule included: run BladeScheduler::schedule() on the plan before
+ * writing it, the executor does not schedule a plan it decodes as it goes (that would need the whole plan).
+ *
+ * Format version 2, little endian (the symbols of version 1 end before durationMs, it reads as 0).
+ *
+ */
+
+#ifndef COMPRESSEDPLANWRITER_H
+#define COMPRESSEDPLANWRITER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Instruction.h"
+
+const uint32_t COMPRESSED_PLAN_MAGIC = 0x5a4c504e; // "NPLZ"
+const uint16_t COMPRESSED_PLAN_VERSION = 2;
+const uint32_t COMPRESSED_PLAN_SYMBOL_V1_SIZE = 16; // the smallest symbol a reader accepts
+const uint32_t COMPRESSED_PLAN_MAX_SYMBOLS = 1 << 20;
+const int COMPRESSED_PLAN_MAX_PERIOD = 16; // instructions in the longest repeated group looked for
+const int COMPRESSED_PLAN_MAX_DEPTH = 8; // loops inside loops
+
+enum CompressedPlanOp {
+	PLAN_OP_SYMBOL = 0,
+	PLAN_OP_RUN = 1,
+	PLAN_OP_LOOP = 2
+};
+
+struct CompressedPlanHeader {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t headerSize;
+	uint64_t instructionCount; // once the loops and runs are expanded
+	uint32_t symbolCount;
+	uint32_t symbolSize;
+	uint64_t opBytes; // after the symbols
+	uint8_t reserved[32];
+};
+
+struct CompressedPlanSymbol {
+	char action[2]; // MF, MB, TL, TR or CH
+	uint8_t cutting;
+	uint8_t reserved;
+	int32_t preSpinMs;
+	double value;
+	int32_t durationMs; // since version 2
+	uint8_t reserved2[4];
+};
+
+static_assert(sizeof(CompressedPlanHeader) == 64, "the header is part of the file format");
+static_assert(sizeof(CompressedPlanSymbol) == 24, "the symbol is part of the file format");
+
+class CompressedPlanWriter {
+	public:
+		CompressedPlanWriter();
+		~CompressedPlanWriter();
+		int compress(const Plan& plan);
+		int write(const std::string& path);
+		const std::vector<unsigned char>& getData();
+		size_t getInstructionCount();
+		size_t getSymbolCount();
+		long getOpCount();
+
+	protected:
+
+	private:
+		std::vector<unsigned char> m_data; // the whole file
+		std::vector<CompressedPlanSymbol> m_symbols;
+		std::vector<uint32_t> m_sequence; // symbol index of every instruction
+		size_t m_instructionCount;
+		long m_opCount;
+
+		int encode(size_t begin, size_t end, int depth, std::vector<unsigned char>& ops);
+		static void appendVarint(uint64_t value, std::vector<unsigned char>& ops);
+};
+
+#endif // COMPRESSEDPLANWRITER_H
@@ -0,0 +1,36 @@
+/**
+ *
+ * This file contains the declaration of the ControlClient class and all associated member functions and attributes.
+ * The ControlClient is the client side of the ControlServer's socket, for a control daemon or a command line tool:
+ * one request at a time, each call waits for its reply. uploadPlan() writes the plan into a memfd, seals it and passes
+ * the fd, so a plan of any size costs one message.
+ *
+ */
+
+#ifndef CONTROLCLIENT_H
+#define CONTROLCLIENT_H
+
+#include <string>
+#include "ControlServer.h"
+#include "Instruction.h"
+#include "Pose.h"
+
+class ControlClient {
+	public:
+		ControlClient();
+		~ControlClient();
+		int open(const std::string& path);
+		int close();
+		int sendCommand(ControlCommand command, ControlReply& reply);
+		int uploadPlan(const Plan& plan, const Pose& start, ControlReply& reply);
+
+	protected:
+
+	private:
+		int m_fd;
+		unsigned int m_nextId;
+
+		int request(ControlCommand command, int planFd, ControlReply& reply);
+};
+
+#endif // CONTROLCLIENT_H
@@ -0,0 +1,134 @@
+/**
+ *
+ * This file contains the declaration of the ControlServer class and all associated member functions and attributes.
+ * The ControlServer lets local programs (e.g. a control daemon or the site app's agent) drive the mower over a Unix
+ * domain socket instead of the four buttons. It runs on the ReactorRuntime's loop (see ReactorRuntime::setControlServer()),
+ * so commands go through the same ButtonController state machine as the presses, on the same thread, without locks.
+ *
+ * The socket is SOCK_SEQPACKET: every request and every reply is one fixed-size message (ControlRequest, ControlReply).
+ *  - UPLOAD: a plan is passed as a memfd (SCM_RIGHTS) holding a ControlPlanHeader and ControlPlanInstructions, sealed with
+ *    F_SEAL_SHRINK and F_SEAL_WRITE (or F_SEAL_FUTURE_WRITE) so the client cannot change it while the server reads it.
+ *    The plan never goes through the socket, the server maps the memfd and reads it in place. The next START mows it
+ *    instead of the lawn entered on the buttons (entering a new lawn on the buttons goes back to that).
+ *  - START, PAUSE, RESUME, STOP: the press that makes that change in the current state, refused in any other state.
+ *  - STATUS: only the reply (every reply carries the state and the executor's remaining instruction count).
+ * ControlClient (ControlClient.h) implements the client side.
+ *
+ */
+
+#ifndef CONTROLSERVER_H
+#define CONTROLSERVER_H
+
+#include <fcntl.h>
+#include <functional>
+#include <string>
+#include <vector>
+#include "ButtonController.h"
+#include "ExecutionController.h"
+#include "Instruction.h"
+#include "PlanArena.h"
+#include "Pose.h"
+#include "Reactor.h"
+
+const unsigned int CONTROL_MAGIC = 0x4C52544E; // "NTRL"
+const unsigned int CONTROL_PLAN_MAGIC = 0x4E4C504E; // "NPLN"
+const int CONTROL_MAX_CLIENTS = 8;
+const int CONTROL_BATCH = 32; // requests handled per wake up, so a busy client cannot hold up the buttons and motors
+const unsigned int CONTROL_MAX_PLAN = 1 << 20; // instructions in an uploaded plan
+
+#ifdef F_SEAL_FUTURE_WRITE
+const int CONTROL_SEAL_FUTURE_WRITE = F_SEAL_FUTURE_WRITE; // also accepted in place of F_SEAL_WRITE (Linux 5.1)
+#else
+const int CONTROL_SEAL_FUTURE_WRITE = 0;
+#endif
+
+enum ControlCommand {
+	CONTROL_STATUS = 0,
+	CONTROL_UPLOAD = 1,
+	CONTROL_START = 2,
+	CONTROL_PAUSE = 3,
+	CONTROL_RESUME = 4,
+	CONTROL_STOP = 5
+};
+
+enum ControlResult {
+	CONTROL_OK = 0,
+	CONTROL_BAD_REQUEST = -1, // wrong size, magic or command
+	CONTROL_REFUSED = -2, // not possible in the current state
+	CONTROL_BAD_PLAN = -3 // missing, unsealed or malformed memfd
+};
+
+struct ControlRequest {
+	unsigned int magic; // CONTROL_MAGIC
+	unsigned int id; // returned in the reply
+	unsigned int command; // ControlCommand
+	unsigned int reserved;
+};
+
+struct ControlReply {
+	unsigned int magic;
+	unsigned int id;
+	unsigned int command;
+	int result; // ControlResult
+	int state; // State after the command
+	unsigned int remainingCount; // instructions the executor has left
+	unsigned int planSize; // instructions in the last plan uploaded, 0 if none
+	unsigned int reserved;
+};
+
+/**
+ * Start of an uploaded plan, followed by count ControlPlanInstructions
+ */
+struct ControlPlanHeader {
+	unsigned int magic; // CONTROL_PLAN_MAGIC
+	unsigned int count;
+	double startX; // pose the mower starts the plan from
+	double startY;
+	double startTheta;
+};
+
+struct ControlPlanInstruction {
+	char action[2]; // MF, MB, TL or TR
+	unsigned char cutting; // 0 for a transit leg
+	unsigned char reserved;
+	int durationMs; // motor-on time measured for a turn, 0 looks the angle up (was reserved, so older clients send 0)
+	double value; // metres or degrees
+};
+
+class ControlServer {
+	public:
+		ControlServer(ButtonController& buttonControl, ExecutionController& exeControl);
+		~ControlServer();
+		int open(const std::string& path);
+		int close();
+		int attach(Reactor& reactor, std::function<void()> onCommand);
+		const Plan& getUploadedPlan();
+		long getCommandCount();
+		int getClientCount();
+
+	protected:
+
+	private:
+		ButtonController* m_buttonControl;
+		ExecutionController* m_exeControl;
+		Reactor* m_reactor; // nullptr until attach()
+		std::function<void()> m_onCommand; // kicks the executor after a command changed the state
+		std::string m_path;
+		int m_listenFd;
+		std::vector<int> m_clients;
+		PlanArena m_planArena; // must be declared before m_plan, which lives in it
+		Plan m_plan; // last plan uploaded
+		Plan m_staging; // plan being uploaded, swapped with m_plan once every record is checked
+		Pose m_planStart;
+		bool m_hasPlan;
+		long m_commandCount;
+
+		int onAccept();
+		int onClient(int fd);
+		int dropClient(int fd);
+		int handleRequest(const ControlRequest& request, int planFd);
+		int pressFor(State from, int button, State to);
+		int loadPlan(int planFd);
+};
+
+#endif // CONTROLSERVER_H
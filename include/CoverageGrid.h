@@ -0,0 +1,213 @@
+/**
+ *
+ * This file contains the declaration of the CoverageGrid class and all associated member functions and attributes.
+ * The CoverageGrid class checks how well a plan (or a recorded pose trace) covers the lawn.
+ * The lawn is rasterized into cells, one bit per cell packed into 64 bit words, and the blade footprint is swept along every leg.
+ * Coverage and overlap are then counted a word at a time with popcount.
+ *
+ * Overlap only counts cells cut again by a later pass: the cells a leg shares with the instruction right before it
+ * (the blade sitting still over the pivot point of a turn) are not counted as overlap.
+ *
+ */
+
+#ifndef COVERAGEGRID_H
+#define COVERAGEGRID_H
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <vector>
+#include "Instruction.h"
+#include "Pose.h"
+#include "DriveModel.h"
+
+constexpr double ARC_STEP = 30.0; // degrees between chords when sweeping a pivot turn (under 2 cm from the true arc)
+
+/**
+ * Helper which rounds up, for values that fit in an int (std::ceil is a long sequence without SSE4.1, this is per row)
+ */
+constexpr int ceilToInt(double x) {
+	int i = (int) x;
+
+	return i < x ? i + 1 : i;
+}
+
+/**
+ * Helper which rounds down, for values that fit in an int
+ */
+constexpr int floorToInt(double x) {
+	int i = (int) x;
+
+	return i > x ? i - 1 : i;
+}
+
+/**
+ * Helper which sets the bits for columns colStart..colEnd (inclusive) of a row
+ * A row is only a few words, so they are or'ed in one loop (a plain store loop becomes a memset call per row)
+ */
+constexpr void fillRow(uint64_t* words, int colStart, int colEnd) {
+	int firstWord = colStart / 64;
+	int lastWord = colEnd / 64;
+	uint64_t firstMask = ~0ULL << (colStart % 64);
+	uint64_t lastMask = ~0ULL >> (63 - colEnd % 64);
+
+	for (int w = firstWord; w <= lastWord; w++) {
+		uint64_t mask = ~0ULL;
+
+		if (w == firstWord) {
+			mask &= firstMask;
+		}
+
+		if (w == lastWord) {
+			mask &= lastMask;
+		}
+
+		words[w] |= mask;
+	}
+}
+
+/**
+ * Function which finds the cells whose centre is within radius of the segment, the disc around (x0, y0) only if startCap is set
+ * (a segment that continues the one before leaves it out, it is that segment's end cap)
+ * Each row of the swept shape (a stadium) is a single interval, which is passed to fill(row, colStart, colEnd) in row order
+ * The body's edges are straight lines, so their slopes are worked out once and each row only evaluates them
+ * CoverageGrid sweeps with std::sqrt, the compiler annotates preset plans with presetSqrt (PresetPlan.h), std::sqrt is not constexpr
+ *
+ * @param rows: rows of the grid, @param cols: columns of the grid, cells outside it are left out
+ * @param resolution: size of a cell in metres
+ */
+template <class Sqrt, class Fill>
+constexpr void sweepStadiumRows(double x0, double y0, double x1, double y1, double radius, bool startCap, int rows, int cols, double resolution, Sqrt sqrt, Fill&& fill) {
+	const double huge = std::numeric_limits<double>::infinity();
+	double yMin = std::min(y0, y1) - radius;
+	double yMax = std::max(y0, y1) + radius;
+	int rowStart = std::max(0, ceilToInt(yMin / resolution - 0.5));
+	int rowEnd = std::min(rows - 1, floorToInt(yMax / resolution - 0.5));
+
+	if (rowStart > rowEnd) {
+		return;
+	}
+
+	double length = sqrt((x1 - x0) * (x1 - x0) + (y1 - y0) * (y1 - y0)); // std::hypot is a slow library call
+	bool hasBody = length > 1e-12;
+	double dirX = hasBody ? (x1 - x0) / length : 0;
+	double dirY = hasBody ? (y1 - y0) / length : 0;
+	double radiusSquared = radius * radius;
+	double cellsPerMetre = 1 / resolution; // each row multiplies, a division takes several times as long
+
+	// body: 0 <= along <= length bounds x between two lines (or rows, if the segment runs along y),
+	// |across| <= radius bounds x between two more lines (or rows, if the segment runs along x)
+	bool alongBoundsX = (dirX < 0 ? -dirX : dirX) >= 1e-12;
+	bool acrossBoundsX = (dirY < 0 ? -dirY : dirY) >= 1e-12;
+	double alongSlope = alongBoundsX ? -dirY / dirX : 0;
+	double alongLo = alongBoundsX ? (dirX > 0 ? 0 : length) / dirX : 0;
+	double alongHi = alongBoundsX ? (dirX > 0 ? length : 0) / dirX : 0;
+	double acrossSlope = acrossBoundsX ? dirX / dirY : 0;
+	double acrossLo = acrossBoundsX ? (dirY > 0 ? radius : -radius) / -dirY : 0;
+	double acrossHi = acrossBoundsX ? (dirY > 0 ? -radius : radius) / -dirY : 0;
+
+	for (int row = rowStart; row <= rowEnd; row++) {
+		double y = (row + 0.5) * resolution;
+		double lo = huge;
+		double hi = -huge;
+
+		// end caps
+		double dy = y - y0;
+
+		if (startCap && dy * dy <= radiusSquared) {
+			double half = sqrt(radiusSquared - dy * dy);
+			lo = x0 - half;
+			hi = x0 + half;
+		}
+
+		double dy1 = y - y1;
+
+		if (dy1 * dy1 <= radiusSquared) {
+			double half = sqrt(radiusSquared - dy1 * dy1);
+			lo = std::min(lo, x1 - half);
+			hi = std::max(hi, x1 + half);
+		}
+
+		if (hasBody) {
+			double bodyLo = -huge;
+			double bodyHi = huge;
+
+			if (alongBoundsX) {
+				bodyLo = x0 + alongLo + dy * alongSlope;
+				bodyHi = x0 + alongHi + dy * alongSlope;
+			} else if (dy * dirY < 0 || dy * dirY > length) {
+				bodyHi = -huge;
+			}
+
+			if (acrossBoundsX) {
+				bodyLo = std::max(bodyLo, x0 + acrossLo + dy * acrossSlope);
+				bodyHi = std::min(bodyHi, x0 + acrossHi + dy * acrossSlope);
+			} else if (dy * dirX < -radius || dy * dirX > radius) {
+				bodyHi = -huge;
+			}
+
+			if (bodyLo <= bodyHi) {
+				lo = std::min(lo, bodyLo);
+				hi = std::max(hi, bodyHi);
+			}
+		}
+
+		if (!(lo <= hi)) {
+			continue;
+		}
+
+		int colStart = std::max(0, ceilToInt(std::max(lo * cellsPerMetre - 0.5, -1.0)));
+		int colEnd = std::min(cols - 1, floorToInt(std::min(hi * cellsPerMetre - 0.5, (double) cols)));
+
+		if (colStart <= colEnd) {
+			fill(row, colStart, colEnd);
+		}
+	}
+}
+
+class CoverageGrid {
+	public:
+		CoverageGrid(double sizeX, double sizeY, double resolution);
+		~CoverageGrid();
+		int reset();
+		int sweepPlan(const Plan& plan, const Pose& start, double bladeDiameter, const DriveModel& model);
+		Pose sweepInstruction(const Pose& pose, const Instruction& instruction, double bladeDiameter, const DriveModel& model);
+		int sweepTrace(const std::vector<Pose>& trace, double bladeDiameter);
+		int sweepSegment(double x0, double y0, double x1, double y1, double radius);
+		int endPass();
+		long getNewCellCount();
+		double getCoveragePercent();
+		double getOverlapPercent();
+		double getMissedArea();
+		long getCellCount();
+		double getResolution();
+		bool isCovered(double x, double y);
+
+	protected:
+
+	private:
+		double m_sizeX;
+		double m_sizeY;
+		double m_resolution;
+		int m_cols;
+		int m_rows;
+		int m_wordsPerRow;
+		std::vector<uint64_t> m_covered; // cut by any pass except the previous one
+		std::vector<uint64_t> m_previous; // cut by the previous pass
+		std::vector<uint64_t> m_pass; // cut by the pass being swept
+		std::vector<uint64_t> m_overlap; // cut by two passes that are not back to back
+		int m_passRowMin;
+		int m_passRowMax;
+		int m_passWordMin; // words of a row the pass being swept touches
+		int m_passWordMax;
+		int m_previousRowMin;
+		int m_previousRowMax;
+		int m_previousWordMin;
+		int m_previousWordMax;
+
+		int sweepStadium(double x0, double y0, double x1, double y1, double radius, bool startCap);
+		long countBits(const std::vector<uint64_t>& bits);
+};
+
+#endif // COVERAGEGRID_H
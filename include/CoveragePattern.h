@@ -0,0 +1,287 @@
+/**
+ *
+ * This file contains the coverage patterns used to plan a rectangular lawn, and the PlanTurtle helper they are written with.
+ * Every pattern works in its own frame: the lawn is [0, sizeX] x [0, sizeY], strips run along x,
+ * and the mower starts in the corner at the origin facing +x (see getPatternStartPose()).
+ * PlanSearch maps that frame onto the real lawn for every start corner and strip direction.
+ *
+ * Patterns are policies: a struct with a static generate(lawn, turtle) member, selected at compile time with
+ * generateCoverage<Pattern>(lawn, sink). Both the pattern and the sink are template parameters, so every combination
+ * is inlined with no virtual calls. A sink is anything with push_back(Instruction), e.g. Plan,
+ * or MissionTimeSink to only estimate how long the plan takes.
+ *
+ */
+
+#ifndef COVERAGEPATTERN_H
+#define COVERAGEPATTERN_H
+
+#include <cmath>
+#include <algorithm>
+#include <cassert>
+#include "Instruction.h"
+#include "Pose.h"
+#include "DriveModel.h"
+
+const double MIN_TURN_ANGLE = 0.1; // degrees, smaller heading errors are not worth a pivot
+
+struct LawnSpec {
+	double sizeX; // along the strips
+	double sizeY; // across the strips
+	double carDiameter; // also used as the wheel base
+	double bladeDiameter;
+	double overlap; // fraction of the blade diameter that neighbouring strips share
+};
+
+/**
+ * Function which returns where every pattern starts: one car radius in from both edges, facing along the strips
+ */
+inline Pose getPatternStartPose(const LawnSpec& lawn) {
+	return Pose{lawn.carDiameter / 2, lawn.carDiameter / 2, 0};
+}
+
+/**
+ * PlanTurtle emits instructions while tracking the mower pose through the DriveModel
+ * Pivot turns move the mower half a wheel base back along the old heading and forward along the new one,
+ * corner() takes that into account so consecutive legs stay on the intended lines
+ */
+template <class Sink>
+class PlanTurtle {
+	public:
+		PlanTurtle(Sink& sink, const DriveModel& model, const Pose& start) : m_sink(sink), m_model(model) {
+			m_pose = start;
+		}
+
+		/**
+		 * Function which moves forward (or backward, for negative distances) along the current heading
+		 */
+		void forward(double distance) {
+			if (std::fabs(distance) < 1e-6) {
+				return;
+			}
+
+			emit(Instruction{distance > 0 ? "MF" : "MB", std::fabs(distance)});
+		}
+
+		/**
+		 * Function which pivots left or right by angle degrees
+		 */
+		void turn(bool left, double angle) {
+			emit(Instruction{left ? "TL" : "TR", angle});
+		}
+
+		/**
+		 * Function which drives along the current heading up to the corner (x, y) and pivots 90 degrees onto the next leg
+		 */
+		void corner(double x, double y, bool left) {
+			forward(along(x, y) - m_model.getWheelBase() / 2);
+			turn(left, 90);
+		}
+
+		/**
+		 * Function which drives along the current heading until level with (x, y)
+		 */
+		void lineTo(double x, double y) {
+			forward(along(x, y));
+		}
+
+		/**
+		 * Function which drives to (x, y) from anywhere and ends up facing heading (radians): turn, straight, turn
+		 * Pivots move the mower, so it stops short of (x, y) where the last pivot brings it onto the target,
+		 * and the bearing is corrected once after the first pivot
+		 */
+		void driveTo(double x, double y, double heading) {
+			Pose target = Pose{x, y, heading};
+			Pose approach = target;
+
+			for (int i = 0; i < 2; i++) {
+				for (int k = 0; k < 3; k++) {
+					approach = approachFor(target, std::atan2(approach.y - m_pose.y, approach.x - m_pose.x));
+				}
+
+				if (std::hypot(approach.x - m_pose.x, approach.y - m_pose.y) > 1e-3) {
+					turnTowards(std::atan2(approach.y - m_pose.y, approach.x - m_pose.x));
+				}
+			}
+
+			forward(along(approach.x, approach.y));
+			turnTowards(heading);
+		}
+
+		Pose getPose() {
+			return m_pose;
+		}
+
+	private:
+		Sink& m_sink;
+		const DriveModel& m_model;
+		Pose m_pose;
+
+		double along(double x, double y) {
+			return (x - m_pose.x) * std::cos(m_pose.theta) + (y - m_pose.y) * std::sin(m_pose.theta);
+		}
+
+		void turnTowards(double heading) {
+			double angle = std::remainder(heading - m_pose.theta, 2 * M_PI) * 180 / M_PI;
+
+			if (std::fabs(angle) >= MIN_TURN_ANGLE) {
+				turn(angle > 0, std::fabs(angle));
+			}
+		}
+
+		// where to stop, driving along bearing, so that pivoting onto the target heading ends on the target
+		Pose approachFor(const Pose& target, double bearing) {
+			double angle = std::remainder(target.theta - bearing, 2 * M_PI) * 180 / M_PI;
+
+			if (std::fabs(angle) < MIN_TURN_ANGLE) {
+				return target;
+			}
+
+			// pivoting back by the same angle about the same wheel undoes the turn
+			return m_model.applyInstruction(target, Instruction{angle > 0 ? "TL" : "TR", -std::fabs(angle)});
+		}
+
+		void emit(const Instruction& instruction) {
+			m_sink.push_back(instruction);
+			m_pose = m_model.applyInstruction(m_pose, instruction);
+		}
+};
+
+/**
+ * Sink which only adds up how long the instructions take to drive, in seconds (nothing is stored)
+ */
+struct MissionTimeSink {
+	double seconds = 0;
+	int count = 0;
+
+	void push_back(const Instruction& instruction) {
+		if (instruction.action == "MF" || instruction.action == "MB") {
+			seconds += instruction.value * DRIVE_MS_PER_METRE / 1000;
+		} else {
+			seconds += instruction.value * 0.9 / 90; // standard 90 degree pivot takes 900 ms
+		}
+
+		count++;
+	}
+};
+
+/**
+ * Function which cuts back and forth strips between xMin and xMax, from row yStart up to row yEnd
+ * The turtle must be on row yStart facing +x
+ */
+template <class Sink>
+void fillStrips(PlanTurtle<Sink>& turtle, double xMin, double xMax, double yStart, double yEnd, double spacing) {
+	assert(spacing > 0); // Path::usePattern refuses overlaps that would never reach yEnd
+	bool facingPositive = true;
+	double y = yStart;
+
+	while (y < yEnd - 1e-6) {
+		double nextY = std::min(y + spacing, yEnd);
+		double x = facingPositive ? xMax : xMin;
+
+		// both corners of a U-turn turn towards +y: left when facing +x, right when facing -x
+		turtle.corner(x, y, facingPositive);
+		turtle.corner(x, nextY, facingPositive);
+
+		y = nextY;
+		facingPositive = !facingPositive;
+	}
+
+	turtle.lineTo(facingPositive ? xMax : xMin, y);
+}
+
+/**
+ * Boustrophedon (serpentine): strips along x, one blade width apart (less the overlap)
+ */
+struct Boustrophedon {
+	static const char* getName() {
+		return "boustrophedon";
+	}
+
+	template <class Sink>
+	static void generate(const LawnSpec& lawn, PlanTurtle<Sink>& turtle) {
+		double inset = lawn.carDiameter / 2;
+		double spacing = lawn.bladeDiameter * (1 - lawn.overlap);
+
+		fillStrips(turtle, inset, lawn.sizeX - inset, inset, lawn.sizeY - inset, spacing);
+	}
+};
+
+/**
+ * Inward spiral: counter-clockwise loops, each one strip further in, until the loops meet in the middle
+ */
+struct InwardSpiral {
+	static const char* getName() {
+		return "inward spiral";
+	}
+
+	template <class Sink>
+	static void generate(const LawnSpec& lawn, PlanTurtle<Sink>& turtle) {
+		double spacing = lawn.bladeDiameter * (1 - lawn.overlap);
+		double inset = lawn.carDiameter / 2;
+
+		assert(spacing > 0); // Path::usePattern refuses overlaps that would never meet in the middle
+
+		while (true) {
+			double right = lawn.sizeX - inset;
+			double top = lawn.sizeY - inset;
+			double nextInset = inset + spacing;
+
+			turtle.corner(right, inset, true);
+			turtle.corner(right, top, true);
+			turtle.corner(inset, top, true);
+
+			if (lawn.sizeX - 2 * nextInset < 0 || lawn.sizeY - 2 * nextInset < 0) {
+				turtle.lineTo(inset, nextInset);
+				break;
+			}
+
+			turtle.corner(inset, nextInset, true);
+			inset = nextInset;
+		}
+	}
+};
+
+/**
+ * Perimeter first: one loop around the edge, then back and forth strips over what is left inside
+ */
+struct PerimeterFirst {
+	static const char* getName() {
+		return "perimeter first";
+	}
+
+	template <class Sink>
+	static void generate(const LawnSpec& lawn, PlanTurtle<Sink>& turtle) {
+		double inset = lawn.carDiameter / 2;
+		double spacing = lawn.bladeDiameter * (1 - lawn.overlap);
+		double right = lawn.sizeX - inset;
+		double top = lawn.sizeY - inset;
+
+		turtle.corner(right, inset, true);
+		turtle.corner(right, top, true);
+		turtle.corner(inset, top, true);
+
+		if (top - spacing < inset + spacing || right - spacing < inset + spacing) { // nothing left inside the loop
+			turtle.lineTo(inset, inset);
+			return;
+		}
+
+		turtle.corner(inset, inset + spacing, true);
+		fillStrips(turtle, inset + spacing, right - spacing, inset + spacing, top - spacing, spacing);
+	}
+};
+
+/**
+ * Function which generates the plan for a pattern policy into a sink, starting from getPatternStartPose()
+ *
+ * @param lawn: lawn and mower dimensions
+ * @param sink: receives the instructions
+ */
+template <class Pattern, class Sink>
+void generateCoverage(const LawnSpec& lawn, Sink& sink) {
+	DriveModel model(lawn.carDiameter);
+	PlanTurtle<Sink> turtle(sink, model, getPatternStartPose(lawn));
+
+	Pattern::generate(lawn, turtle);
+}
+
+#endif // COVERAGEPATTERN_H
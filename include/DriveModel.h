@@ -0,0 +1,33 @@
+/**
+ *
+ * This file contains the declaration of the DriveModel class and all associated member functions and attributes.
+ * The DriveModel class describes how the differential drive moves the mower for given wheel speeds or instructions.
+ * Turns are pivots: turnLeft only powers the right wheel (and vice versa), so the mower rotates about the stopped wheel.
+ *
+ */
+
+#ifndef DRIVEMODEL_H
+#define DRIVEMODEL_H
+
+#include "Pose.h"
+#include "Instruction.h"
+
+const double DRIVE_MS_PER_METRE = 925; // time the wheels are powered to move 1 m forward/backward
+const double DRIVE_SPEED = 1000.0 / DRIVE_MS_PER_METRE; // wheel speed in m/s
+
+class DriveModel {
+	public:
+		DriveModel(double wheelBase);
+		~DriveModel();
+		Pose integrate(const Pose& pose, double vLeft, double vRight, double dt) const;
+		Pose applyInstruction(const Pose& pose, const Instruction& instruction) const;
+		double getTurnWheelSpeed(double angle, int durationMs) const;
+		double getWheelBase() const;
+
+	protected:
+
+	private:
+		double m_wheelBase;
+};
+
+#endif // DRIVEMODEL_H
@@ -0,0 +1,48 @@
+/**
+ *
+ * This file contains the declaration of the EmergencyStop class and all associated member functions and attributes.
+ * The EmergencyStop class is the fast path that stops the mower from a dedicated e-stop input, without going through
+ * the buttons, the state machine or the instruction queue (which only stop the motors once the current delay is over).
+ * The motor pins are resolved into a PinBatch when the object is constructed; when the input goes LOW the board's
+ * interrupt calls trigger(), which writes the whole batch LOW and latches the fault. trigger() takes no locks
+ * and allocates nothing, so it is safe to call from an interrupt thread (or a signal handler).
+ *
+ * While the fault is latched the ExecutionController will not switch any motor on (see setEmergencyStop()).
+ * The fault stays latched until reset() is called with the e-stop input released.
+ *
+ */
+
+#ifndef EMERGENCYSTOP_H
+#define EMERGENCYSTOP_H
+
+#include <atomic>
+#include <vector>
+#include "Board.h"
+
+class EmergencyStop {
+	public:
+		EmergencyStop(int pinStop, const std::vector<int>& motorPins, Board& board);
+		~EmergencyStop();
+		int arm();
+		int trigger();
+		int reset();
+		bool isLatched() const;
+		long getTriggerCount();
+		long long getLastTriggerNs();
+		int getErrorNum();
+
+	protected:
+
+	private:
+		Board* m_board;
+		int m_pinStop;
+		PinBatch m_motorPins;
+		std::atomic<bool> m_latched;
+		std::atomic<long> m_triggerCount;
+		std::atomic<long long> m_lastTriggerNs; // CLOCK_MONOTONIC, 0 if never triggered
+		int m_errorNum;
+
+		static void onInterrupt(void* context);
+};
+
+#endif // EMERGENCYSTOP_H
@@ -0,0 +1,46 @@
+/**
+ *
+ * This file contains the declaration of the EnergyModel class and all associated member functions and attributes.
+ * The EnergyModel class predicts how much battery energy instructions use, from how the controllers drive the motors:
+ * MF/MB power both wheel motors (WheelController::moveForward/moveBackward), TL/TR power one wheel motor for the turn,
+ * and the blade motor runs for every cutting instruction, with an extra cost each time it has to start (BladeController::startMotor).
+ * Durations are the standard drive speed and 90 degree turn time, or the time a plan measured for a turn (Instruction::durationMs).
+ *
+ */
+
+#ifndef ENERGYMODEL_H
+#define ENERGYMODEL_H
+
+#include <deque>
+#include <vector>
+#include "Instruction.h"
+#include "Pose.h"
+
+const double WHEEL_MOTOR_WATTS = 25; // per powered wheel motor
+const double BLADE_MOTOR_WATTS = 120;
+const double BLADE_START_JOULES = 150; // extra energy to get the blade up to speed each time it starts
+
+class EnergyModel {
+	public:
+		EnergyModel(double wheelBase);
+		EnergyModel(double wheelBase, double wheelMotorWatts, double bladeMotorWatts, double bladeStartJoules);
+		~EnergyModel();
+		double getInstructionWh(const Instruction& instruction, bool bladeWasOn) const;
+		double getPlanWh(const Plan& plan) const;
+		int getRemainingWh(const Plan& plan, std::vector<double>& remainingWh) const;
+		double getTransitWh(const Pose& from, const Pose& to) const;
+		int getTransit(const Pose& from, const Pose& to, Plan& leg) const;
+		double getWheelBase() const;
+
+	protected:
+
+	private:
+		double m_wheelBase;
+		double m_wheelMotorWatts;
+		double m_bladeMotorWatts;
+		double m_bladeStartJoules;
+
+		double getDurationSeconds(const Instruction& instruction) const;
+};
+
+#endif // ENERGYMODEL_H
@@ -11,21 +11,66 @@
 
 #include <string>
 #include <deque>
+#include <vector>
+#include <atomic>
+#include <mutex>
 #include "State.h"
 #include "Instruction.h"
 #include "Path.h"
 #include "WheelController.h"
 #include "BladeController.h"
+#include "PoseEstimator.h"
+#include "Board.h"
+#include "BladeScheduler.h"
+#include "BatteryMonitor.h"
+#include "EnergyModel.h"
+#include "CancellationToken.h"
+#include "EmergencyStop.h"
+#include "PlanArena.h"
+#include "MissionLog.h"
+#include "LatencyHistogram.h"
+#include "TelemetryWriter.h"
+#include "CompressedPlanReader.h"
+
+enum InstructionPhase {
+	NO_INSTRUCTION, // nothing started
+	DRIVING, // motors run until the wait is over
+	PRE_SPIN, // blade-off leg, the blade starts when the wait is over
+	CHARGING // on the base, the battery is checked every time the wait is over
+};
 
 class ExecutionController {
 	public:
 		ExecutionController(State& currentState, Path& path, WheelController& wheelControl, BladeController& bladeControl);
+		ExecutionController(State& currentState, Path& path, WheelController& wheelControl, BladeController& bladeControl, Board& board);
 		~ExecutionController();
 		int startExecutionListener();
+		int executeNext();
+		int startNext(unsigned int& waitMs);
+		int continueCurrent(unsigned int& waitMs);
+		bool isInstructionActive();
+		int cancelCurrent();
 		int assignInstructions();
+		int assignInstructions(const Plan& instructions, const Pose& start);
+		int assignInstructions(CompressedPlanReader& plan, const Pose& start);
 		int clearInstructions();
+		int reservePlan(size_t maxInstructions);
 		State getCurrentState();
 		void sendShutDownSignal();
+		int setCancellationToken(CancellationToken& token);
+		void setEmergencyStop(EmergencyStop& emergencyStop);
+		void setPoseEstimator(PoseEstimator& poseEstimator);
+		void setMissionLog(MissionLog& missionLog);
+		int setTelemetry(TelemetryWriter& telemetry);
+		int getPose(Pose& pose);
+		void setVerbose(bool verbose);
+		void setBladeScheduler(const BladeScheduler& bladeScheduler);
+		int setReturnToBase(BatteryMonitor& batteryMonitor, const EnergyModel& energyModel, const Pose& base, double reserveWh);
+		int getReturnCount();
+		int getRemainingCount();
+		int markStateChange();
+		const LatencyHistogram& getStateChangeHistogram();
+		const LatencyHistogram& getOverrunHistogram();
         
 	protected:
 		
@@ -34,11 +79,61 @@ class ExecutionController {
 		Path* m_path;
 		WheelController* m_wheelControl;
 		BladeController* m_bladeControl;
-		std::deque<Instruction> m_remainingInstructions;
-		bool m_shutDownFlag;
+		PoseEstimator* m_poseEstimator;
+		Board* m_board;
+		BladeScheduler m_bladeScheduler;
+		BatteryMonitor* m_batteryMonitor;
+		const EnergyModel* m_energyModel;
+		Pose m_basePose;
+		double m_reserveWh;
+		Pose m_plannedPose; // where the plan has taken the mower so far
+		std::vector<double> m_remainingWh; // energy from each plan instruction to the end
+		double m_endToBaseWh; // energy to drive home from the end of the plan
+		size_t m_planIndex; // plan instructions executed so far (return and resume legs not counted)
+		size_t m_planSize; // instructions in the plan assigned (return and resume legs not counted)
+		std::atomic<unsigned int> m_startedCount; // instructions started since the plan was assigned, charge legs included
+		size_t m_resumeIndex; // m_planIndex when the mower last came back from the base
+		int m_chargeLegCount; // return, charge and resume instructions still at the front of the queue
+		int m_returnCount;
+		std::mutex m_planMutex; // the buttons and control API clear and assign plans while the executor walks them, see clearInstructions()
+		PlanArena m_planArena; // must be declared before m_remainingInstructions, which lives in it
+		Plan m_remainingInstructions; // for a streamed plan, only the instructions decoded ahead
+		std::atomic<int> m_remainingCount; // plan instructions left, set with m_planMutex held and read without it
+		CompressedPlanReader* m_planStream; // nullptr: the whole plan is in m_remainingInstructions
+		double m_streamRemainingWh; // energy of a streamed plan from m_planIndex to the end (m_remainingWh would expand it)
+		bool m_streamBladeWasOn; // whether the plan instruction before m_planIndex cuts
+		Instruction m_currentInstruction; // started by startNext(), not finished yet
+		InstructionPhase m_phase;
+		int m_currentDurationMs;
+		int m_preSpinLeadMs;
+		int m_poseMs; // ms of the current instruction already stepped into the pose estimator
+		unsigned int m_startedMs; // board time the current instruction was started at
+		CancellationToken m_ownToken; // used until setCancellationToken() is called
+		CancellationToken* m_cancelToken; // cancelled on shutdown
+		EmergencyStop* m_emergencyStop; // nullptr: no e-stop fitted
+		MissionLog* m_missionLog; // nullptr: missions are not recorded
+		TelemetryWriter* m_telemetry; // nullptr: no live telemetry
 		bool m_isBladeSpinning;
+		bool m_verbose;
+		std::atomic<long long> m_stateChangedNs; // set by markStateChange(), 0 once the motors have followed it
+		LatencyHistogram m_stateChangeHistogram; // state change to the motors being switched for it
+		LatencyHistogram m_overrunHistogram; // how much longer than commanded each motion ran
 
-		int executeInstruction(Instruction instruction);
+		int startInstruction(const Instruction& instruction, unsigned int& waitMs);
+		int finishInstruction(int elapsedMs);
+		int updatePose(int elapsedMs);
+		int recordStateChange();
+		int publishTelemetry();
+		int stopMotors();
+		bool isFaulted();
+		int abortOnFault();
+		void setState(State state);
+		int preparePlan(const Pose& start);
+		int refillPlan();
+		void updateRemainingCount();
+		double getRemainingPlanWh();
+		int checkBattery(const Instruction& next);
+		bool isCharged();
 };
 
 #endif // EXECUTIONCONTROLLER_H
@@ -0,0 +1,87 @@
+/**
+ *
+ * This file contains the declaration of the FleetSimulator class and all associated member functions and attributes.
+ * The FleetSimulator class runs many virtual mowers headless to get statistics on planner and executor changes.
+ * Every mower has the full stack used on the real mower (Path, ExecutionController, WheelController, BladeController, Motors)
+ * wired to its own SimBoard, so missions run on a virtual clock instead of in real time.
+ * Mowers are sharded over a ThreadPool. After a mission the pin intervals recorded by the board are replayed through
+ * the DriveModel to get where the mower actually went, which gives the coverage and the motor on-times give the energy.
+ *
+ * The simulated ground matches the default turn calibration tables (including the extra slip right after reversing)
+ * and the turn times a plan measured (Instruction::durationMs), so a mower that executes its plan correctly ends up
+ * where the plan expects.
+ *
+ */
+
+#ifndef FLEETSIMULATOR_H
+#define FLEETSIMULATOR_H
+
+#include <vector>
+#include "ThreadPool.h"
+#include "SimBoard.h"
+#include "DriveModel.h"
+#include "BladeScheduler.h"
+#include "EnergyModel.h"
+
+struct MowerResult {
+	double length;
+	double width;
+	double missionSeconds; // virtual time from start to the last instruction
+	double coveragePercent;
+	double energyWh;
+	double bladeSeconds; // time the blade was spinning
+	int bladeStarts;
+	int instructionCount;
+};
+
+// a turn the plan measured the time of: while it runs the ground lets the pivoting wheel turn the mower at this speed
+struct MeasuredTurn {
+	unsigned int startMs;
+	unsigned int endMs;
+	double wheelSpeed;
+};
+
+struct FleetSummary {
+	int mowerCount;
+	double simulatedHours; // mower-hours of missions simulated
+	double wallSeconds;
+	double mowerHoursPerSecond;
+	double meanMissionMinutes;
+	double p95MissionMinutes;
+	double maxMissionMinutes;
+	double meanCoveragePercent;
+	double minCoveragePercent;
+	double meanEnergyWh;
+	double totalEnergyWh;
+	double meanBladeMinutes;
+};
+
+class FleetSimulator {
+	public:
+		FleetSimulator(double carDiameter, double bladeDiameter, ThreadPool& pool);
+		~FleetSimulator();
+		int addMower(double length, double width);
+		int setResolution(double resolution);
+		int setBladeScheduler(const BladeScheduler& bladeScheduler);
+		int run();
+		FleetSummary getSummary();
+		std::vector<MowerResult>& getResults();
+		int getErrorNum();
+
+	protected:
+
+	private:
+		double m_carDiameter;
+		double m_bladeDiameter;
+		double m_resolution;
+		ThreadPool* m_pool;
+		BladeScheduler m_bladeScheduler;
+		std::vector<MowerResult> m_results; // one per mower, filled in by run()
+		FleetSummary m_summary;
+		int m_errorNum;
+
+		int simulateMower(MowerResult& result);
+		int replay(SimBoard& board, const Pose& start, double length, double width, const std::vector<MeasuredTurn>& measuredTurns, MowerResult& result);
+};
+
+#endif // FLEETSIMULATOR_H
@@ -1,17 +1,64 @@
 /**
  *
  * This file contains the declaration of the intructions class and all associated member functions and attributes.
+ * An instruction is plain data (the action is stored inline, not in a std::string), so copying one never touches the heap.
+ * A Plan is a queue of instructions with polymorphic allocation: it uses the heap like a std::deque by default,
+ * or a PlanArena when it is constructed with one.
  *
  */
 
 #ifndef INSTRUCTION_H
 #define	INSTRUCTION_H
 
-#include <string>
+#include <cstring>
+#include <deque>
+#include <memory_resource>
+#include <ostream>
+
+/**
+ * Two letter action of an instruction: MF/MB (move forward/backward), TL/TR (turn left/right), CH (charge)
+ */
+struct ActionCode {
+	char code[3];
+
+	ActionCode(const char* action = "") {
+		strncpy(code, action, 2);
+		code[2] = '\0';
+	}
+
+	bool operator==(const char* action) const {
+		return strcmp(code, action) == 0;
+	}
+
+	bool operator!=(const char* action) const {
+		return strcmp(code, action) != 0;
+	}
+
+	bool operator==(const ActionCode& other) const {
+		return strcmp(code, other.code) == 0;
+	}
+
+	bool operator!=(const ActionCode& other) const {
+		return strcmp(code, other.code) != 0;
+	}
+
+	const char* c_str() const {
+		return code;
+	}
+};
+
+inline std::ostream& operator<<(std::ostream& out, const ActionCode& action) {
+	return out << action.code;
+}
 
 struct Instruction {
-	std::string action;
+	ActionCode action;
     double value;
+	bool cutting = true; // blade on; false for transit legs and legs over grass that is already cut
+	int preSpinMs = 0; // for a blade-off leg: start the blade this long before the leg ends (set by BladeScheduler)
+	int durationMs = 0; // for a turn: motor-on time measured for it where it is planned, instead of the calibration table (0: look the angle up)
 };
 
+typedef std::pmr::deque<Instruction> Plan;
+
 #endif // INSTRUCTION_H
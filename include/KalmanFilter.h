@@ -0,0 +1,84 @@
+/**
+ *
+ * This file contains the declaration and implementation of the KalmanFilter class template.
+ * The KalmanFilter class holds an N-dimensional state and its covariance and applies (extended) Kalman predict/update steps.
+ * The model itself is supplied by the caller (new state + Jacobian), so the same filter can be reused for any fixed-size problem.
+ * All sizes are compile-time constants and nothing is allocated on the heap.
+ *
+ */
+
+#ifndef KALMANFILTER_H
+#define KALMANFILTER_H
+
+#include "Matrix.h"
+
+template <int N>
+class KalmanFilter {
+	public:
+		KalmanFilter() {
+			m_covariance = Matrix<N, N>::identity();
+		}
+
+		/**
+		 * Function which resets the state and covariance
+		 */
+		void reset(const Matrix<N, 1>& state, const Matrix<N, N>& covariance) {
+			m_state = state;
+			m_covariance = covariance;
+		}
+
+		/**
+		 * Predict step, P = F P F^T + Q
+		 *
+		 * @param predictedState: state after applying the (possibly non-linear) motion model
+		 * @param jacobian: F, the motion model linearised around the previous state
+		 * @param processNoise: Q
+		 */
+		void predict(const Matrix<N, 1>& predictedState, const Matrix<N, N>& jacobian, const Matrix<N, N>& processNoise) {
+			m_state = predictedState;
+			m_covariance = jacobian * m_covariance * jacobian.transpose() + processNoise;
+		}
+
+		/**
+		 * Update step with an M-dimensional measurement
+		 *
+		 * @param innovation: z - h(x), already wrapped for angles by the caller
+		 * @param observation: H
+		 * @param measurementNoise: R
+		 * @return 0: success
+		 * @return -1: innovation covariance is singular, the measurement is ignored
+		 */
+		template <int M>
+		int update(const Matrix<M, 1>& innovation, const Matrix<M, N>& observation, const Matrix<M, M>& measurementNoise) {
+			Matrix<N, M> ht = observation.transpose();
+			Matrix<M, M> s = observation * m_covariance * ht + measurementNoise;
+			Matrix<M, M> sInverse;
+
+			if (s.inverse(sInverse) != 0) {
+				return -1;
+			}
+
+			Matrix<N, M> gain = m_covariance * ht * sInverse;
+
+			m_state = m_state + gain * innovation;
+			m_covariance = (Matrix<N, N>::identity() - gain * observation) * m_covariance;
+
+			return 0;
+		}
+
+		Matrix<N, 1>& getState() {
+			return m_state;
+		}
+
+		const Matrix<N, N>& getCovariance() const {
+			return m_covariance;
+		}
+
+	protected:
+
+	private:
+		Matrix<N, 1> m_state;
+		Matrix<N, N> m_covariance;
+};
+
+#endif // KALMANFILTER_H
@@ -0,0 +1,52 @@
+/**
+ *
+ * This file contains the declaration of the LatencyHistogram class and all associated member functions and attributes.
+ * A LatencyHistogram counts durations in microseconds in HDR-style log-linear buckets: exact below 32 us, then 32 buckets
+ * per power of two, so every bucket is within about 3% of the values in it from 1 us up to about 71 minutes.
+ * record() is a few relaxed atomic adds: it never locks or allocates, so the motion and button code can call it on
+ * their own threads while a publisher (see MetricsPublisher) takes snapshots from another one.
+ *
+ */
+
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <atomic>
+#include <vector>
+
+const int HISTOGRAM_SUB_BUCKET_BITS = 5; // 32 buckets per power of two
+const int HISTOGRAM_SUB_BUCKETS = 1 << HISTOGRAM_SUB_BUCKET_BITS;
+const int HISTOGRAM_BUCKETS = (32 - HISTOGRAM_SUB_BUCKET_BITS + 1) * HISTOGRAM_SUB_BUCKETS; // every unsigned int value
+
+struct HistogramSnapshot {
+	std::vector<unsigned int> counts; // per bucket, HISTOGRAM_BUCKETS of them
+	unsigned long count;
+	unsigned long long sumUs;
+	unsigned int maxUs;
+};
+
+class LatencyHistogram {
+	public:
+		LatencyHistogram();
+		~LatencyHistogram();
+		void record(unsigned int valueUs);
+		void recordSince(long long startNs);
+		int getSnapshot(HistogramSnapshot& snapshot) const;
+		int reset();
+		static unsigned int getPercentileUs(const HistogramSnapshot& snapshot, double percentile);
+		static int getBucketIndex(unsigned int valueUs);
+		static unsigned int getBucketStartUs(int index);
+		static long long now();
+
+	protected:
+
+	private:
+		std::atomic<unsigned int> m_counts[HISTOGRAM_BUCKETS];
+		std::atomic<unsigned long long> m_sumUs;
+		std::atomic<unsigned int> m_maxUs;
+
+		LatencyHistogram(const LatencyHistogram&) = delete;
+		LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+};
+
+#endif // LATENCYHISTOGRAM_H
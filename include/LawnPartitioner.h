@@ -0,0 +1,76 @@
+/**
+ *
+ * This file contains the declaration of the LawnPartitioner class and all associated member functions and attributes.
+ * The LawnPartitioner class splits one lawn (a rectangle or a polygon) between several mowers.
+ * The lawn is cut into horizontal bands, one per mower, whose heights are chosen so every mower finishes at about the same time:
+ * each band's estimate includes the mowing itself, the U-turns between its strips and the drive from that mower's start pose.
+ * Every mower then gets its own instruction stream (drive to its band, then boustrophedon strips over it).
+ *
+ * Bands are planned over their bounding rectangle, so for strongly concave polygons the strips can run outside the lawn.
+ *
+ */
+
+#ifndef LAWNPARTITIONER_H
+#define LAWNPARTITIONER_H
+
+#include <deque>
+#include <vector>
+#include "Instruction.h"
+#include "Pose.h"
+
+const int MAX_MOWERS = 32;
+
+struct LawnPoint {
+	double x;
+	double y;
+};
+
+struct MowerAssignment {
+	int mowerId;
+	double xMin; // bounding rectangle of the band
+	double xMax;
+	double yMin;
+	double yMax;
+	double area; // grass inside the band (m^2)
+	double transitSeconds;
+	double mowingSeconds;
+	Plan instructions; // starting from the mower's start pose
+};
+
+class LawnPartitioner {
+	public:
+		LawnPartitioner(double length, double width, double carDiameter, double bladeDiameter);
+		LawnPartitioner(const std::vector<LawnPoint>& polygon, double carDiameter, double bladeDiameter);
+		~LawnPartitioner();
+		int addMower(int mowerId, const Pose& start);
+		int removeMower(int mowerId);
+		int partition();
+		std::vector<MowerAssignment>& getAssignments();
+		double getMakespan();
+		int getMowerCount();
+		int getErrorNum();
+
+	protected:
+
+	private:
+		struct Mower {
+			int id;
+			Pose start;
+		};
+
+		std::vector<LawnPoint> m_polygon;
+		std::vector<Mower> m_mowers;
+		std::vector<MowerAssignment> m_assignments;
+		double m_carDiameter;
+		double m_bladeDiameter;
+		double m_yMin;
+		double m_yMax;
+		int m_errorNum;
+
+		double bandSeconds(const Mower& mower, double y0, double y1, MowerAssignment* assignment);
+		double bandEnd(const Mower& mower, double y0, double target);
+		void clipBand(double y0, double y1, std::vector<LawnPoint>& clipped);
+		int generateInstructions(const Mower& mower, MowerAssignment& assignment);
+};
+
+#endif // LAWNPARTITIONER_H
@@ -0,0 +1,123 @@
+/**
+ *
+ * This file contains the declaration of the Logger class and all associated member functions and attributes.
+ * The Logger is an asynchronous structured logger: every line has a time, a level, the thread it came from and an event name.
+ * LOG_INFO("exec", "instruction %s%g", ...) formats the message into a ring buffer owned by the calling thread and returns,
+ * without a lock or a system call. A background writer collects the lines of every thread every LOG_WRITE_INTERVAL_MS
+ * and writes them in batches, to stdout or to a log file that is rotated when it gets too big (see open()).
+ * When nothing is logged the writer sleeps until the next line: the first line after a quiet spell wakes it up.
+ *
+ * Levels below LOG_LEVEL (compile with e.g. -DLOG_LEVEL=LOG_LEVEL_DEBUG) compile to nothing, arguments included.
+ * When a thread logs faster than the writer empties its buffer, the newest lines are dropped (getDroppedCount()).
+ * The event name must be a string literal: only the pointer is stored.
+ *
+ */
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_OFF 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(event, ...) Logger::getInstance().log(LOG_LEVEL_DEBUG, event, __VA_ARGS__)
+#else
+#define LOG_DEBUG(event, ...) ((void) 0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(event, ...) Logger::getInstance().log(LOG_LEVEL_INFO, event, __VA_ARGS__)
+#else
+#define LOG_INFO(event, ...) ((void) 0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(event, ...) Logger::getInstance().log(LOG_LEVEL_WARN, event, __VA_ARGS__)
+#else
+#define LOG_WARN(event, ...) ((void) 0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(event, ...) Logger::getInstance().log(LOG_LEVEL_ERROR, event, __VA_ARGS__)
+#else
+#define LOG_ERROR(event, ...) ((void) 0)
+#endif
+
+const unsigned int LOG_RING_SIZE = 1024; // lines buffered per thread, a power of two
+const int LOG_TEXT_SIZE = 200; // longer messages are cut
+const int LOG_WRITE_INTERVAL_MS = 10;
+const size_t LOG_BATCH_BYTES = 64 * 1024;
+
+struct LogRecord {
+	long long timeNs; // CLOCK_REALTIME
+	const char* event;
+	int level;
+	char text[LOG_TEXT_SIZE];
+};
+
+class Logger {
+	public:
+		static Logger& getInstance();
+		~Logger();
+		int open(const std::string& path, size_t maxFileBytes, int maxFiles);
+		void log(int level, const char* event, const char* format, ...) __attribute__((format(printf, 4, 5)));
+		int flush();
+		long getLineCount();
+		long getDroppedCount();
+		long getWriteCount();
+
+	protected:
+
+	private:
+		struct ThreadBuffer {
+			std::atomic<unsigned int> head; // next record the thread fills
+			std::atomic<unsigned int> tail; // next record the writer takes
+			int threadIndex;
+			LogRecord records[LOG_RING_SIZE];
+		};
+
+		std::mutex m_buffersMutex; // threads register their buffer once
+		std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+		std::mutex m_writeMutex; // only one of the writer thread and flush() empties the buffers at a time
+		std::thread m_writer;
+		std::mutex m_wakeMutex;
+		std::condition_variable m_wakeUp;
+		std::atomic<bool> m_writerIdle; // the writer found nothing to write and waits for m_wakeUp
+		std::atomic<bool> m_shutDownFlag;
+		std::atomic<long> m_droppedCount;
+		long m_lineCount;
+		long m_writeCount; // write() calls
+		int m_fd; // stdout until open()
+		std::string m_path;
+		size_t m_maxFileBytes;
+		int m_maxFiles;
+		size_t m_fileBytes;
+		char m_batch[LOG_BATCH_BYTES];
+		size_t m_batchBytes;
+
+		Logger();
+		ThreadBuffer* getThreadBuffer();
+		void writerLoop();
+		int drain();
+		bool hasPending();
+		int appendRecord(const LogRecord& record, int threadIndex);
+		int writeBatch();
+		int rotate();
+};
+
+#endif // LOGGER_H
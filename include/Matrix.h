@@ -0,0 +1,157 @@
+/**
+ *
+ * This file contains the declaration and implementation of the Matrix class template.
+ * The Matrix class is a small fixed-size matrix whose dimensions are known at compile time.
+ * Storage lives inside the object (no heap allocation), so it is safe to use in the 1 kHz estimator loop.
+ *
+ */
+
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include <array>
+#include <cmath>
+
+template <int ROWS, int COLS>
+class Matrix {
+	public:
+		Matrix() {
+			m_data.fill(0.0);
+		}
+
+		static Matrix identity() {
+			Matrix result;
+
+			for (int i = 0; i < ROWS && i < COLS; i++) {
+				result(i, i) = 1.0;
+			}
+
+			return result;
+		}
+
+		double& operator()(int row, int col) {
+			return m_data[row * COLS + col];
+		}
+
+		double operator()(int row, int col) const {
+			return m_data[row * COLS + col];
+		}
+
+		Matrix operator+(const Matrix& other) const {
+			Matrix result;
+
+			for (int i = 0; i < ROWS * COLS; i++) {
+				result.m_data[i] = m_data[i] + other.m_data[i];
+			}
+
+			return result;
+		}
+
+		Matrix operator-(const Matrix& other) const {
+			Matrix result;
+
+			for (int i = 0; i < ROWS * COLS; i++) {
+				result.m_data[i] = m_data[i] - other.m_data[i];
+			}
+
+			return result;
+		}
+
+		template <int OTHER_COLS>
+		Matrix<ROWS, OTHER_COLS> operator*(const Matrix<COLS, OTHER_COLS>& other) const {
+			Matrix<ROWS, OTHER_COLS> result;
+
+			for (int i = 0; i < ROWS; i++) {
+				for (int k = 0; k < COLS; k++) {
+					double a = (*this)(i, k);
+
+					for (int j = 0; j < OTHER_COLS; j++) {
+						result(i, j) += a * other(k, j);
+					}
+				}
+			}
+
+			return result;
+		}
+
+		Matrix<COLS, ROWS> transpose() const {
+			Matrix<COLS, ROWS> result;
+
+			for (int i = 0; i < ROWS; i++) {
+				for (int j = 0; j < COLS; j++) {
+					result(j, i) = (*this)(i, j);
+				}
+			}
+
+			return result;
+		}
+
+		/**
+		 * Function which inverts a square matrix with Gauss-Jordan elimination (partial pivoting)
+		 *
+		 * @param result: receives the inverse
+		 * @return 0: success
+		 * @return -1: matrix is singular
+		 */
+		int inverse(Matrix& result) const {
+			static_assert(ROWS == COLS, "only square matrices can be inverted");
+
+			Matrix a = *this;
+			result = identity();
+
+			for (int col = 0; col < ROWS; col++) {
+				int pivot = col;
+
+				for (int row = col + 1; row < ROWS; row++) {
+					if (std::fabs(a(row, col)) > std::fabs(a(pivot, col))) {
+						pivot = row;
+					}
+				}
+
+				if (std::fabs(a(pivot, col)) < 1e-12) {
+					return -1;
+				}
+
+				if (pivot != col) {
+					for (int j = 0; j < COLS; j++) {
+						double tmp = a(col, j);
+						a(col, j) = a(pivot, j);
+						a(pivot, j) = tmp;
+
+						tmp = result(col, j);
+						result(col, j) = result(pivot, j);
+						result(pivot, j) = tmp;
+					}
+				}
+
+				double scale = 1.0 / a(col, col);
+
+				for (int j = 0; j < COLS; j++) {
+					a(col, j) *= scale;
+					result(col, j) *= scale;
+				}
+
+				for (int row = 0; row < ROWS; row++) {
+					if (row == col) {
+						continue;
+					}
+
+					double factor = a(row, col);
+
+					for (int j = 0; j < COLS; j++) {
+						a(row, j) -= factor * a(col, j);
+						result(row, j) -= factor * result(col, j);
+					}
+				}
+			}
+
+			return 0;
+		}
+
+	protected:
+
+	private:
+		std::array<double, ROWS * COLS> m_data;
+};
+
+#endif // MATRIX_H
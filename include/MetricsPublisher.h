@@ -0,0 +1,57 @@
+/**
+ *
+ * This file contains the declaration of the MetricsPublisher class and all associated member functions and attributes.
+ * The MetricsPublisher writes snapshots of LatencyHistograms to a file in the Prometheus text format, e.g. for the
+ * node_exporter textfile collector or the site monitoring agent to pick up. Each write goes to path.tmp and is renamed
+ * over the file, so a reader never sees half a snapshot.
+ *
+ * After start() a background thread at low priority publishes every periodMs: the controllers only ever touch their
+ * histograms' atomic counters, so publishing does not take a lock they use or delay the motion timing.
+ *
+ */
+
+#ifndef METRICSPUBLISHER_H
+#define METRICSPUBLISHER_H
+
+#include "LatencyHistogram.h"
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class MetricsPublisher {
+	public:
+		MetricsPublisher();
+		~MetricsPublisher();
+		int addHistogram(const std::string& name, const std::string& help, const LatencyHistogram& histogram);
+		int start(const std::string& path, unsigned int periodMs);
+		int stop();
+		int publish();
+		int publish(const std::string& path);
+		long getPublishCount();
+
+	protected:
+
+	private:
+		struct Metric {
+			std::string name; // e.g. mower_button_press_to_handler_seconds
+			std::string help;
+			const LatencyHistogram* histogram;
+		};
+
+		std::vector<Metric> m_metrics; // added before start()
+		std::string m_path;
+		unsigned int m_periodMs;
+		std::thread m_thread;
+		std::mutex m_mutex; // guards m_stopFlag
+		std::condition_variable m_wakeUp;
+		bool m_stopFlag;
+		std::mutex m_publishMutex; // one publish() at a time
+		long m_publishCount;
+		HistogramSnapshot m_snapshot; // reused by every publish()
+
+		void publisherLoop();
+};
+
+#endif // METRICSPUBLISHER_H
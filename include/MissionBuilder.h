@@ -0,0 +1,111 @@
+/**
+ *
+ * This file contains the declaration of the MissionBuilder class and all associated member functions and attributes.
+ * The MissionBuilder class stitches several lawns of one property (front, back, side...) into a single mission.
+ * Every area gets its own coverage plan, the areas are ordered to keep the drive between them short
+ * (nearest neighbour, then 2-opt), and blade-off transit legs join the end of one area to the start of the next.
+ * The result is one continuous instruction stream for ExecutionController::assignInstructions().
+ *
+ * All areas are axis aligned rectangles in the same frame as the mower's start pose.
+ * Transit legs are straight lines, so they can cross other areas (with the blade off) but not obstacles.
+ *
+ */
+
+#ifndef MISSIONBUILDER_H
+#define MISSIONBUILDER_H
+
+#include <deque>
+#include <vector>
+#include "Instruction.h"
+#include "Pose.h"
+#include "CoveragePattern.h"
+
+struct MowingArea {
+	double x; // corner with the smallest x and y
+	double y;
+	double length; // along x
+	double width; // along y
+};
+
+class MissionBuilder {
+	public:
+		MissionBuilder(double carDiameter, double bladeDiameter);
+		~MissionBuilder();
+		int addArea(const MowingArea& area);
+		int setStartPose(const Pose& pose);
+		int setReturnToStart(bool returnToStart);
+		int build();
+		Plan& getInstructions();
+		std::vector<int>& getOrder();
+		double getTransitDistance();
+		double getNearestNeighbourDistance();
+		int getAreaCount();
+		int getErrorNum();
+
+		/**
+		 * Function that selects the coverage pattern policy used inside every area (Boustrophedon by default)
+		 * @param overlap: fraction of the blade diameter that neighbouring strips share
+		 * @return 0: success
+		 * @return -1: the overlap is not in [0, 1) or there is no blade, the pattern is not used
+		 */
+		template <class Pattern>
+		int usePattern(double overlap = 0) {
+			if (overlap < 0 || overlap >= 1 || m_bladeDiameter <= 0) {
+				m_errorNum = -1;
+				return -1;
+			}
+
+			m_overlap = overlap;
+			m_generator = &MissionBuilder::generateArea<Pattern>;
+
+			return 0;
+		}
+
+	protected:
+
+	private:
+		struct AreaPlan {
+			Plan instructions;
+			Pose entry; // where the plan starts, in the property frame
+			Pose exit; // where the plan ends
+		};
+
+		double m_carDiameter;
+		double m_bladeDiameter;
+		double m_overlap;
+		Pose m_startPose;
+		bool m_returnToStart;
+		std::vector<MowingArea> m_areas;
+		std::vector<AreaPlan> m_plans;
+		std::vector<int> m_order;
+		Plan m_instructions;
+		double m_transitDistance;
+		double m_nearestNeighbourDistance;
+		int m_errorNum;
+		int (MissionBuilder::*m_generator)(const MowingArea&, AreaPlan&);
+
+		template <class Pattern>
+		int generateArea(const MowingArea& area, AreaPlan& plan) {
+			LawnSpec lawn = LawnSpec{area.length, area.width, m_carDiameter, m_bladeDiameter, m_overlap};
+			Pose start = getPatternStartPose(lawn);
+			DriveModel model(m_carDiameter);
+			PlanTurtle<Plan> turtle(plan.instructions, model, start);
+
+			Pattern::generate(lawn, turtle);
+
+			// the pattern frame only differs from the property frame by the area's corner
+			Pose end = turtle.getPose();
+			plan.entry = Pose{area.x + start.x, area.y + start.y, start.theta};
+			plan.exit = Pose{area.x + end.x, area.y + end.y, end.theta};
+
+			return 0;
+		}
+
+		double transit(const Pose& from, const Pose& to);
+		double tourLength(const std::vector<int>& order);
+		int nearestNeighbour();
+		int twoOpt();
+		int appendTransit(Pose& pose, const Pose& target);
+};
+
+#endif // MISSIONBUILDER_H
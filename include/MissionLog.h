@@ -0,0 +1,110 @@
+/**
+ *
+ * This file contains the declaration of the MissionLog class and all associated member functions and attributes.
+ * A MissionLog records a run of the mower in a compact binary file: a MissionLogHeader, then fixed-size MissionRecords
+ * (a new mission and its plan, instruction start/end, state changes, motor pin edges, button presses, mission end).
+ * Times are the board clock (millis()); the header has the wall clock time the board clock was read at, to convert.
+ *
+ * Records are buffered and written MISSION_LOG_BATCH_RECORDS at a time (one SD card page), and the file is only synced
+ * at the end of a mission and on close(), to keep the card from wearing out. It can be called from several threads.
+ * MissionLogReader reads the files back.
+ *
+ * Format version 1, little endian. A reader steps through the records by the header's recordSize, so later versions
+ * can add fields at the end of a record, and must skip record types it does not know.
+ *
+ */
+
+#ifndef MISSIONLOG_H
+#define MISSIONLOG_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include "Board.h"
+#include "Instruction.h"
+#include "State.h"
+
+const uint32_t MISSION_LOG_MAGIC = 0x474c4d4d; // "MMLG"
+const uint16_t MISSION_LOG_VERSION = 1;
+const int MISSION_LOG_BATCH_RECORDS = 128; // 4 KiB
+
+enum MissionRecordType {
+	MISSION_START = 1, // index: instructions in the plan
+	INSTRUCTION_START = 2, // index: instruction number in the mission, arg: planned ms, value: instruction value
+	INSTRUCTION_END = 3, // index: instruction number, arg: elapsed ms (board clock), value: planned ms
+	STATE_CHANGE = 4, // index: new State, arg: old State
+	PIN_EDGE = 5, // index: pin, arg: new level
+	BUTTON_PRESS = 6, // index: pin
+	MISSION_END = 7 // index: instructions started, arg: mission ms
+};
+
+// flags
+const uint16_t MISSION_FLAG_CUTTING = 1; // instruction records: blade on
+const uint16_t MISSION_FLAG_CANCELLED = 2; // INSTRUCTION_END: stopped early, MISSION_END: the plan was not finished
+
+struct MissionLogHeader {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t recordSize;
+	uint32_t headerSize;
+	uint32_t boardStartMs; // board clock when the log was opened
+	int64_t wallStartNs; // CLOCK_REALTIME at the same moment
+	uint8_t reserved[40];
+};
+
+struct MissionRecord {
+	uint32_t timeMs; // board clock
+	uint16_t type; // MissionRecordType
+	uint16_t flags;
+	uint32_t index;
+	uint32_t arg;
+	double value;
+	char action[2]; // instruction records: MF, MB, TL, TR or CH
+	uint16_t reserved;
+	uint32_t mission; // missions started in this log before this record
+};
+
+static_assert(sizeof(MissionLogHeader) == 64, "the header is part of the file format");
+static_assert(sizeof(MissionRecord) == 32, "the record is part of the file format");
+
+class MissionLog {
+	public:
+		MissionLog(Board& board);
+		~MissionLog();
+		int open(const std::string& path);
+		int close();
+		int logMissionStart(size_t instructionCount);
+		int logInstructionStart(const Instruction& instruction, int plannedMs);
+		int logInstructionEnd(const Instruction& instruction, int plannedMs, int elapsedMs, bool cancelled);
+		int logState(State from, State to);
+		int logPinEdge(int pin, int level);
+		int logButton(int pin);
+		int logMissionEnd(bool completed);
+		int flush();
+		long getRecordCount();
+		long getWriteCount();
+		long getSyncCount();
+
+	protected:
+
+	private:
+		Board* m_board;
+		int m_fd;
+		std::mutex m_mutex; // guards everything below but the file
+		std::mutex m_fileMutex; // a full batch is written with only this one held
+		MissionRecord m_batches[2][MISSION_LOG_BATCH_RECORDS]; // one filling while the other is written
+		int m_active; // batch being filled
+		int m_batchCount; // records in the active batch
+		uint32_t m_mission;
+		bool m_inMission;
+		uint32_t m_missionStartMs;
+		uint32_t m_instructionIndex; // instructions started this mission
+		long m_recordCount;
+		long m_writeCount;
+		long m_syncCount;
+
+		int append(uint16_t type, uint16_t flags, uint32_t index, uint32_t arg, double value, const char* action);
+		int writeRecords(const MissionRecord* records, int count);
+};
+
+#endif // MISSIONLOG_H
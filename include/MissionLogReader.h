@@ -0,0 +1,68 @@
+/**
+ *
+ * This file contains the declaration of the MissionLogReader class and all associated member functions and attributes.
+ * The MissionLogReader reads the binary logs written by MissionLog and adds them up: missions, how long they took, how often
+ * the mower was paused, and per instruction type how long the instructions took (with percentiles) against their plan.
+ * Files are memory mapped and read front to back in one pass without copying, so a season of logs reads in seconds.
+ * Several files (or several readers, one per thread, merged with merge()) add to the same summary.
+ *
+ */
+
+#ifndef MISSIONLOGREADER_H
+#define MISSIONLOGREADER_H
+
+#include <string>
+#include <vector>
+#include "MissionLog.h"
+
+const int MISSION_LOG_ACTIONS = 5; // MF, MB, TL, TR, CH
+const int MISSION_LOG_HISTOGRAM_MS = 65536; // 1 ms buckets, longer instructions go in the last one
+
+struct ActionSummary {
+	char action[3];
+	long count; // instructions finished
+	long cancelled; // stopped early
+	double elapsedMsSum;
+	double lateMsSum; // elapsed - planned
+	unsigned int maxMs;
+	std::vector<unsigned int> histogram; // instructions per elapsed ms
+};
+
+struct MissionLogSummary {
+	long files;
+	long bytes;
+	long records;
+	long unknownRecords; // types added after this reader, skipped
+	long missions; // started
+	long completedMissions;
+	long endedMissions; // completed or dropped
+	double missionMsSum; // of the ended missions
+	unsigned int minMissionMs;
+	unsigned int maxMissionMs;
+	long pauses;
+	long stateChanges;
+	long buttonPresses;
+	long pinEdges;
+	ActionSummary actions[MISSION_LOG_ACTIONS];
+};
+
+class MissionLogReader {
+	public:
+		MissionLogReader();
+		~MissionLogReader();
+		int read(const std::string& path);
+		int merge(const MissionLogReader& other);
+		int reset();
+		const MissionLogSummary& getSummary();
+		unsigned int getPercentileMs(int action, double percentile);
+		static int getActionIndex(const char* action);
+
+	protected:
+
+	private:
+		MissionLogSummary m_summary;
+
+		void addRecord(const MissionRecord& record);
+};
+
+#endif // MISSIONLOGREADER_H
@@ -10,6 +10,10 @@
 #ifndef MOTOR_H
 #define MOTOR_H
 
+#include "Board.h"
+#include "CancellationToken.h"
+#include "MissionLog.h"
+
 enum Direction { 
 	CW, // Clockwise
 	CCW // Counter-Clockwise
@@ -18,12 +22,17 @@ enum Direction {
 class Motor {
 	public:
 		Motor(int pinCW, int pinCCW);
+		Motor(int pinCW, int pinCCW, Board& board);
 		~Motor();
 		int stop();
 		int start(Direction direction);
 		int start(Direction direction, int duration);
+		int start(Direction direction, int duration, CancellationToken& token);
 		int getPinCW();
 		int getPinCCW();
+		int getLevels();
+		Board* getBoard();
+		void setMissionLog(MissionLog& missionLog);
 		int getErrorNum();
 		
 	protected:
@@ -31,9 +40,14 @@ class Motor {
 	private:
 		int m_pinCW;
 		int m_pinCCW;
+		Board* m_board;
 		int m_errorNum;
+		MissionLog* m_missionLog; // nullptr: pin changes are not recorded
+		int m_levelCW; // last level written to each pin
+		int m_levelCCW;
 		
 		int spinClockwise();
+		int writePin(int pin, int level, int& lastLevel);
 		int spinCounterClockwise();
 		
 };
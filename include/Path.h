@@ -3,6 +3,9 @@
  * This file contains the declaration of the Path class and all associated member functions and attributes.
  * The Path class is used to hold dimensions of the mower and lawn, and to generate a set of instructions based on these values.
  * The resulting double ended queue is iterated through and provides the logic for the lawn mower
+ * By default the original serpentine is generated, usePattern<Pattern>() switches to one of the policies in CoveragePattern.h
+ * and usePreset<Lawn>() loads the serpentine the compiler has already planned for a fixed lawn (see PresetPlan.h)
+ * Every generated instruction is annotated with whether it cuts grass that is still uncut (see annotateCutting())
  *
  */
 
@@ -12,17 +15,77 @@
 #include <string>
 #include <deque>
 #include "Instruction.h"
+#include "Pose.h"
+#include "CoveragePattern.h"
+#include "EnergyModel.h"
+#include "LatencyHistogram.h"
+#include "PresetPlan.h"
 
 class Path {
     public:
-        Path(double length, double width, double carDiameter, double bladeDiameter);
+        Path(double length, double width, double carDiameter, double bladeDiameter, bool verbose = true, bool generateNow = true);
         ~Path();
         double getLength();
         double getWidth();
         double getCarDiameter();
         double getBladeDiameter();
-        std::deque<Instruction> getInstructions();
+        const Plan& getInstructions();
+        Pose getStartPose();
         int setDimensions(double length, double width);
+        int generate();
+        int annotateCutting();
+        double getEnergyEstimate(const EnergyModel& energyModel);
+        const LatencyHistogram& getGenerationHistogram();
+
+        /**
+         * Function that regenerates the path with a coverage pattern policy (Boustrophedon, InwardSpiral, PerimeterFirst)
+         * The pattern is kept when the dimensions change
+         * @param overlap: fraction of the blade diameter that neighbouring strips share
+         * @return 0: success
+         * @return -1: the overlap is not in [0, 1) or there is no blade (the pattern is not used),
+         *             or the lawn is smaller than the mower (the path is left empty)
+         */
+        template <class Pattern>
+        int usePattern(double overlap = 0) {
+            // strips would be no distance apart and the pattern would never reach the far side
+            if (overlap < 0 || overlap >= 1 || m_bladeDiameter <= 0) {
+                return -1;
+            }
+
+            m_overlap = overlap;
+            m_generator = &Path::generatePatternPath<Pattern>;
+
+            return runGenerator();
+        }
+
+        /**
+         * Function that loads the preset plan of a lawn (see PresetPlan.h) instead of generating it, nothing is planned at runtime
+         * The lawn's dimensions become the path's, and a later setDimensions() generates the serpentine as usual
+         * @return 0: success
+         * @return -1: the preset was planned for a different mower or blade diameter
+         */
+        template <class Lawn>
+        int usePreset() {
+            if (Lawn::carDiameter != m_carDiameter || Lawn::bladeDiameter != m_bladeDiameter) {
+                return -1;
+            }
+
+            long long startNs = LatencyHistogram::now();
+
+            m_length = Lawn::length;
+            m_width = Lawn::width;
+            m_generator = &Path::generatePath;
+            m_instructions.clear();
+
+            for (const PresetInstruction& preset : PresetPlanTable<Lawn>::instructions) {
+                m_instructions.push_back(Instruction{preset.action, preset.value, preset.cutting, 0, preset.durationMs});
+            }
+
+            m_startPose = PresetPlanTable<Lawn>::startPose;
+            m_generationHistogram.recordSince(startNs);
+
+            return 0;
+        }
 		
     protected:
 		
@@ -31,12 +94,38 @@ class Path {
         double m_width;
         double m_carDiameter;
         double m_bladeDiameter;
-        std::deque<Instruction> m_instructions;
+        Plan m_instructions;
+        Pose m_startPose;
+        double m_overlap;
+        bool m_verbose;
+        int (Path::*m_generator)(); // generatePath or generatePatternPath<Pattern>, picked once per plan
+        LatencyHistogram m_generationHistogram; // how long each plan took to generate
 
+        int runGenerator();
         int generatePath();
-        double calculateRemainder(double numer, double denom);
-        void addAFew(std::string firstMove, double firstDis,std:: string secMove="", double secDis=0, std::string thirdMove="", double thirdDis=0, std::string fourthMove = "", double fourthDis=0);
-        void addConditionally(double condition, std::string move, double firstDis, double secDis);
+
+        template <class Pattern>
+        int generatePatternPath() {
+            m_instructions.clear();
+
+            if (std::min(m_length, m_width) < m_carDiameter) {
+                return -1;
+            }
+
+            // same frame as generatePath: long side along x
+            LawnSpec lawn = LawnSpec{std::max(m_length, m_width), std::min(m_length, m_width), m_carDiameter, m_bladeDiameter, m_overlap};
+            generateCoverage<Pattern>(lawn, m_instructions);
+            m_startPose = getPatternStartPose(lawn);
+
+            return annotateCutting();
+        }
+
+        // sink generatePresetSerpentine() plans the serpentine into at runtime, see generatePath()
+        struct InstructionSink {
+            Path* path;
+
+            void add(const char* action, double value, int durationMs = 0);
+        };
 };
 
 #endif // PATH_H
@@ -0,0 +1,51 @@
+/**
+ *
+ * This file contains the declaration of the PlanArena class and all associated member functions and attributes.
+ * A PlanArena is a memory resource for Plans (see Instruction.h): memory comes from large blocks that are only given back
+ * when the arena is destroyed, and a pool on top hands the deque blocks a Plan frees to the next Plan that needs them.
+ * Once an arena has held its largest plan, building, copying, extending and emptying plans of that size never touch the heap.
+ *
+ * A Plan is constructed on the arena with Plan plan(arena.getResource()). reset() gives all the memory back at once,
+ * so it may only be called when no Plan is using the arena any more. An arena is not thread safe: one per thread.
+ *
+ */
+
+#ifndef PLANARENA_H
+#define PLANARENA_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+class PlanArena : public std::pmr::memory_resource {
+	public:
+		PlanArena(size_t blockBytes = 64 * 1024);
+		~PlanArena();
+		std::pmr::memory_resource* getResource();
+		int reset();
+		size_t getUsedBytes();
+		size_t getReservedBytes();
+		long getHeapAllocations();
+
+	protected:
+
+	private:
+		struct Block {
+			unsigned char* data;
+			size_t size;
+		};
+
+		size_t m_blockBytes;
+		std::vector<Block> m_blocks; // allocated in order, reused from the first one after reset()
+		size_t m_current; // block allocations are made from, a new one is taken from the heap when it is past the last
+		size_t m_offset; // bytes used in the current block
+		size_t m_usedBytes; // bytes handed out since the last reset()
+		long m_heapAllocations; // blocks taken from the heap
+		std::pmr::unsynchronized_pool_resource m_pool; // must be declared last: it allocates from this arena
+
+		void* do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+};
+
+#endif // PLANARENA_H
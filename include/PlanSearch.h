@@ -0,0 +1,85 @@
+/**
+ *
+ * This file contains the declaration of the PlanSearch class and all associated member functions and attributes.
+ * The PlanSearch class is the "search" planner mode: instead of the single plan Path generates, it builds many candidate plans
+ * (pattern, strip direction, start corner, blade overlap), scores each one on a time/coverage cost model,
+ * and keeps the cheapest. Candidates are scored in parallel on a ThreadPool and the search gives up at a deadline.
+ *
+ * The lawn is [0, length] x [0, width], with the mower's current pose in the same frame.
+ *
+ */
+
+#ifndef PLANSEARCH_H
+#define PLANSEARCH_H
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Instruction.h"
+#include "Pose.h"
+#include "CoverageGrid.h"
+#include "ThreadPool.h"
+#include "PlanArena.h"
+
+enum CoveragePatternType {
+	BOUSTROPHEDON,
+	INWARD_SPIRAL,
+	PERIMETER_FIRST
+};
+
+struct PlanCandidate {
+	CoveragePatternType pattern;
+	int stripAxis; // 0: strips along x (length), 1: strips along y (width)
+	int startCorner; // bit 0: start at x = length, bit 1: start at y = width
+	double overlap; // fraction of the blade diameter shared by neighbouring strips
+};
+
+struct PlanScore {
+	double cost; // seconds, including the missed area penalty
+	double seconds; // estimated time to drive to the start and mow
+	double coveragePercent;
+	double overlapPercent;
+};
+
+class PlanSearch {
+	public:
+		PlanSearch(double length, double width, double carDiameter, double bladeDiameter, ThreadPool& pool);
+		~PlanSearch();
+		int setStartPose(const Pose& pose);
+		int setMissedAreaPenalty(double secondsPerSquareMetre);
+		int setResolution(double resolution);
+		int search(int deadlineMs);
+		int generate(const PlanCandidate& candidate, Plan& instructions, Pose& start);
+		PlanScore score(const PlanCandidate& candidate, CoverageGrid& grid, PlanArena& arena);
+		std::vector<PlanCandidate> getCandidates();
+		PlanCandidate getBestCandidate();
+		PlanScore getBestScore();
+		int getBestInstructions(Plan& instructions, Pose& start);
+		int getScoredCount();
+
+	protected:
+
+	private:
+		double m_length;
+		double m_width;
+		double m_carDiameter;
+		double m_bladeDiameter;
+		double m_resolution;
+		double m_missedAreaPenalty;
+		Pose m_startPose;
+		ThreadPool* m_pool;
+		std::vector<std::unique_ptr<CoverageGrid>> m_grids; // one scratch grid per worker
+		std::vector<std::unique_ptr<PlanArena>> m_arenas; // one per worker, the candidates are built in it
+		std::mutex m_bestMutex;
+		PlanCandidate m_bestCandidate;
+		PlanScore m_bestScore;
+		int m_scoredCount;
+
+		int generateCanonical(const PlanCandidate& candidate, Plan& instructions);
+		Pose toLawnFrame(const PlanCandidate& candidate, const Pose& pose);
+		bool isMirrored(const PlanCandidate& candidate);
+		double estimateSeconds(const Plan& instructions);
+};
+
+#endif // PLANSEARCH_H
@@ -0,0 +1,37 @@
+/**
+ *
+ * This file contains the declaration of the PlanTextReader class and all associated member functions and attributes.
+ * The PlanTextReader imports the plans PlanTextWriter exports (see PlanTextWriter.h for the format).
+ * Files are memory mapped and parsed front to back in one pass, in place: values of up to 15 digits are made straight
+ * from their digits, longer ones go through std::from_chars, and no line is copied, so the only memory used is the Plan's
+ * own. Read into a Plan on a PlanArena that has already held a plan that size and importing never touches the heap.
+ *
+ * A malformed line stops the import: the Plan is left as it was and getErrorLine() says which line it was.
+ *
+ */
+
+#ifndef PLANTEXTREADER_H
+#define PLANTEXTREADER_H
+
+#include <string>
+#include "Instruction.h"
+
+class PlanTextReader {
+	public:
+		PlanTextReader();
+		~PlanTextReader();
+		int read(const std::string& path, Plan& plan);
+		int parse(const char* data, size_t size, Plan& plan);
+		long getLineCount();
+		long getErrorLine();
+		long getByteCount();
+
+	protected:
+
+	private:
+		long m_lineCount; // of the last read() or parse()
+		long m_errorLine; // 0 if the last read() or parse() succeeded
+		long m_byteCount; // parsed since the reader was made
+};
+
+#endif // PLANTEXTREADER_H
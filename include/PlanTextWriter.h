@@ -0,0 +1,55 @@
+/**
+ *
+ * This file contains the declaration of the PlanTextWriter class and all associated member functions and attributes.
+ * A PlanTextWriter exports plans as text, one instruction per line in the notation generatePath() logs ("MF2.13", "TR90"),
+ * so a plan can be looked at, edited by hand or made by another program and read back with PlanTextReader.
+ *
+ * Format:
+ *  - a line is an action (MF, MB, TL, TR or CH) followed straight away by its value (metres or degrees, not negative)
+ *  - a time in ms after the value ("TL90 1450ms") is the motor-on time measured for a turn (Instruction::durationMs)
+ *  - " off" after that marks a leg with the blade off (Instruction::cutting false)
+ *  - blank lines and lines starting with '#' are skipped, spaces before and after an instruction and "\r\n" are allowed
+ * Values are written with the fewest digits that read back to the same double, so a plan survives export and import
+ * unchanged. preSpinMs is not written: BladeScheduler sets it again for the plan that is read back.
+ *
+ * Lines are formatted with std::to_chars into a fixed buffer that is written PLAN_TEXT_BUFFER bytes at a time,
+ * so exporting never touches the heap.
+ *
+ */
+
+#ifndef PLANTEXTWRITER_H
+#define PLANTEXTWRITER_H
+
+#include <string>
+#include "Instruction.h"
+
+const int PLAN_TEXT_BUFFER = 64 * 1024;
+const int PLAN_TEXT_MAX_LINE = 56; // "MF" + the longest double + " " + the longest int + "ms off\n"
+
+class PlanTextWriter {
+	public:
+		PlanTextWriter();
+		~PlanTextWriter();
+		int open(const std::string& path);
+		int close();
+		int write(const Instruction& instruction);
+		int writePlan(const Plan& plan);
+		int writeComment(const char* comment);
+		int flush();
+		long getInstructionCount();
+		long getByteCount();
+		static int format(const Instruction& instruction, char* line);
+
+	protected:
+
+	private:
+		int m_fd;
+		char m_buffer[PLAN_TEXT_BUFFER];
+		int m_used; // bytes in m_buffer
+		long m_instructionCount;
+		long m_byteCount; // written to the file, or waiting in m_buffer
+
+		int reserve(int bytes);
+};
+
+#endif // PLANTEXTWRITER_H
@@ -0,0 +1,17 @@
+/**
+ *
+ * This file contains the declaration of the Pose struct, the position and heading of the mower on the lawn.
+ * x/y are in metres from the starting corner, theta is the heading in radians (0 = facing +x, counter-clockwise positive).
+ *
+ */
+
+#ifndef POSE_H
+#define	POSE_H
+
+struct Pose {
+	double x;
+	double y;
+	double theta;
+};
+
+#endif // POSE_H
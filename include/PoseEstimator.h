@@ -0,0 +1,51 @@
+/**
+ *
+ * This file contains the declaration of the PoseEstimator class and all associated member functions and attributes.
+ * The PoseEstimator class keeps track of where the mower is by dead reckoning the wheel commands through the DriveModel.
+ * An extended Kalman filter over [x, y, theta, v, omega] lets wheel encoder and IMU samples correct the estimate when available.
+ * The filter is stepped at 1 kHz (one step per ms of motion) and never allocates.
+ *
+ */
+
+#ifndef POSEESTIMATOR_H
+#define POSEESTIMATOR_H
+
+#include <mutex>
+#include "Pose.h"
+#include "DriveModel.h"
+#include "KalmanFilter.h"
+
+const int POSE_STEP_MS = 1; // filter step, 1 kHz
+
+class PoseEstimator {
+	public:
+		PoseEstimator(double wheelBase);
+		PoseEstimator(double wheelBase, const Pose& start);
+		~PoseEstimator();
+		int reset(const Pose& pose);
+		int predict(double vLeft, double vRight, double dt);
+		int advance(double vLeft, double vRight, int durationMs);
+		int coast();
+		int integrate(double vLeft, double vRight, int durationMs);
+		int updateEncoders(double vLeft, double vRight);
+		int updateGyro(double yawRate);
+		int updateHeading(double heading);
+		Pose getPose();
+		double getPositionVariance();
+		DriveModel& getDriveModel();
+
+	protected:
+
+	private:
+		DriveModel m_model;
+		KalmanFilter<5> m_filter; // state: x, y, theta, v, omega
+		std::mutex m_mutex;
+		double m_motorTimeConstant; // seconds for the wheels to reach commanded speed
+		double m_encoderNoise;
+		double m_gyroNoise;
+		double m_headingNoise;
+
+		int predictLocked(double vLeft, double vRight, double dt);
+};
+
+#endif // POSEESTIMATOR_H
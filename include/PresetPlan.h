@@ -0,0 +1,434 @@
+/**
+ *
+ * This file contains the preset plans: the original serpentine of Path::generatePath() planned at compile time
+ * for a lawn whose dimensions are fixed, so a mower that only ever mows the same plot starts with no planning to do.
+ *
+ * A preset lawn is a policy, a struct with static constexpr length, width, carDiameter and bladeDiameter members:
+ *
+ *     struct BackLawn {
+ *         static constexpr double length = 3.0;
+ *         static constexpr double width = 3.0;
+ *         static constexpr double carDiameter = 0.87;
+ *         static constexpr double bladeDiameter = 0.435;
+ *     };
+ *
+ * PresetPlanTable<BackLawn>::instructions is then a std::array of the plan's instructions, cutting flags included,
+ * built by the compiler and stored read only in the binary; Path::usePreset<BackLawn>() copies it into the path.
+ * The plan is checked when the table is instantiated: a lawn too small for the mower, an instruction that is not
+ * finite and positive, or a leg that drives the mower off the lawn is a compile error.
+ *
+ * The serpentine is planned by generatePresetSerpentine(), which Path::generatePath() also runs at runtime, so there is
+ * a single planner. Annotating the plan sweeps the blade with CoverageGrid's own sweepStadiumRows(), and the rest of it
+ * mirrors the runtime code it stands in for (Path::annotateCutting(), CoverageGrid::sweepInstruction() and
+ * DriveModel::applyInstruction()) with the same arithmetic in the same order, so the table matches the plan Path
+ * generates for the same lawn (preset_plan_test checks that it does).
+ * Only sin, cos and sqrt are not the library's: the constexpr versions here can be an ulp away from it.
+ *
+ * Large lawns take more steps to evaluate than some compilers allow by default, raise the limit
+ * (-fconstexpr-ops-limit with g++) for presets of more than a few hundred square metres.
+ *
+ */
+
+#ifndef PRESETPLAN_H
+#define PRESETPLAN_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include "Pose.h"
+#include "CoverageGrid.h"
+#include "WheelController.h"
+
+constexpr double ANNOTATION_RESOLUTION = 0.05; // grid cell size (m) used to find the instructions that cut new grass
+constexpr double MIN_NEW_CUT_AREA = 0.02; // m^2 of new grass an instruction has to cut to need the blade
+constexpr double PRESET_LAWN_MARGIN = 0.01; // m the mower centre may end up outside the lawn before a preset is rejected
+
+/**
+ * An instruction of a preset plan, Instruction with an action that can be built at compile time
+ */
+struct PresetInstruction {
+	char action[3];
+	double value;
+	bool cutting;
+	int durationMs;
+};
+
+/**
+ * Results of checkPresetPlan()
+ */
+enum PresetPlanCheck {
+	PRESET_PLAN_OK = 0,
+	PRESET_LAWN_TOO_SMALL = 1,
+	PRESET_BAD_INSTRUCTION = 2,
+	PRESET_OFF_LAWN = 3
+};
+
+/**
+ * Function which returns the square root, Newton's method from above until it stops getting smaller
+ */
+constexpr double presetSqrt(double x) {
+	if (!(x > 0)) {
+		return 0;
+	}
+
+	double root = x > 1 ? x : 1;
+	double next = (root + x / root) / 2;
+
+	while (next < root) {
+		root = next;
+		next = (root + x / root) / 2;
+	}
+
+	return root;
+}
+
+/**
+ * Function which returns sin(x) (quadrant == 0) or cos(x) (quadrant == 1)
+ * x is brought down to [-pi/4, pi/4] around the nearest multiple of pi/2, then the Taylor series is summed
+ */
+constexpr double presetSinCos(double x, int quadrant) {
+	double turns = x / (M_PI / 2);
+	long long nearest = (long long) (turns < 0 ? turns - 0.5 : turns + 0.5);
+	double reduced = x - nearest * (M_PI / 2);
+	double squared = reduced * reduced;
+	double sin = reduced;
+	double cos = 1;
+	double sinTerm = reduced;
+	double cosTerm = 1;
+
+	for (int n = 1; n <= 12; n++) {
+		sinTerm *= -squared / ((2 * n) * (2 * n + 1));
+		cosTerm *= -squared / ((2 * n - 1) * (2 * n));
+		sin += sinTerm;
+		cos += cosTerm;
+	}
+
+	switch (((nearest + quadrant) % 4 + 4) % 4) {
+		case 0:
+			return sin;
+		case 1:
+			return cos;
+		case 2:
+			return -sin;
+		default:
+			return -cos;
+	}
+}
+
+constexpr double presetSin(double x) {
+	return presetSinCos(x, 0);
+}
+
+constexpr double presetCos(double x) {
+	return presetSinCos(x, 1);
+}
+
+/**
+ * Function which compares two action codes
+ */
+constexpr bool isPresetAction(const char* action, const char* expected) {
+	return action[0] == expected[0] && action[1] == expected[1];
+}
+
+/**
+ * Function which returns the pose after an instruction, as DriveModel::applyInstruction() does (the wheel base is the car diameter)
+ */
+constexpr Pose applyPresetInstruction(const Pose& pose, const char* action, double value, double wheelBase) {
+	double c = presetCos(pose.theta);
+	double s = presetSin(pose.theta);
+
+	if (isPresetAction(action, "MF")) {
+		return Pose{pose.x + value * c, pose.y + value * s, pose.theta};
+	} else if (isPresetAction(action, "MB")) {
+		return Pose{pose.x - value * c, pose.y - value * s, pose.theta};
+	} else if (isPresetAction(action, "TL") || isPresetAction(action, "TR")) {
+		double sign = isPresetAction(action, "TL") ? 1.0 : -1.0;
+		double angle = sign * value * M_PI / 180.0;
+
+		// the stopped wheel is on the inside of the turn
+		double pivotX = pose.x - sign * s * wheelBase / 2;
+		double pivotY = pose.y + sign * c * wheelBase / 2;
+		double dx = pose.x - pivotX;
+		double dy = pose.y - pivotY;
+
+		return Pose{pivotX + dx * presetCos(angle) - dy * presetSin(angle), pivotY + dx * presetSin(angle) + dy * presetCos(angle), pose.theta + angle};
+	}
+
+	return pose;
+}
+
+/**
+ * Sink which only counts the instructions of a preset plan
+ */
+struct PresetCountSink {
+	size_t count = 0;
+
+	constexpr void add(const char*, double, int = 0) {
+		count++;
+	}
+};
+
+/**
+ * Sink which writes the instructions of a preset plan into an array, all cutting until they are annotated
+ */
+struct PresetArraySink {
+	PresetInstruction* instructions;
+	size_t count = 0;
+
+	constexpr void add(const char* action, double value, int durationMs = 0) {
+		instructions[count] = PresetInstruction{{action[0], action[1], '\0'}, value, true, durationMs};
+		count++;
+	}
+};
+
+/**
+ * Function which generates the original serpentine into a sink: the preset tables at compile time,
+ * Path::generatePath() at runtime (a sink only needs an add(const char* action, double value, int durationMs = 0) member)
+ * The turns between strips and on the final strip keep the motor-on times TurnDuration measured for them on grass
+ * (the TR100, TL110 and TL120 of the original plan, TL120 ran as two standard turns), whatever move came before them
+ */
+template <class Sink>
+constexpr void generatePresetSerpentine(double length, double width, double carDiameter, double bladeDiameter, Sink& sink) {
+	double firstMoveDistance = 0;
+	double secondMoveDistance = 0;
+	double shortSide = 0;
+
+	// mower will always start with short side on left
+	if (length > width) {
+		firstMoveDistance = width - carDiameter;
+		secondMoveDistance = length - carDiameter * 2;
+		shortSide = width;
+	} else {
+		firstMoveDistance = length - carDiameter;
+		secondMoveDistance = width - carDiameter * 2;
+		shortSide = length;
+	}
+
+	sink.add("MF", firstMoveDistance);
+	sink.add("TR", 90);
+	sink.add("MF", secondMoveDistance);
+
+	int loopCount = ceilToInt((shortSide - carDiameter) / bladeDiameter);
+	double remainder = shortSide - carDiameter;
+
+	while (bladeDiameter > 0 && remainder >= bladeDiameter) {
+		remainder -= bladeDiameter;
+	}
+
+	double stripWidth = bladeDiameter;
+	double stripLength = secondMoveDistance - bladeDiameter;
+
+	for (int i = 0; i < loopCount - 1; i++) {
+		const char* turn = i % 2 == 0 ? "TR" : "TL";
+
+		sink.add(turn, 90);
+		sink.add("MB", carDiameter - stripWidth);
+		sink.add(turn, 90, i % 2 == 0 ? TurnDuration::positionTwo : 2 * TurnDuration::positionOne);
+		sink.add("MF", stripLength);
+	}
+
+	if (loopCount % 2 == 0) {
+		sink.add("TR", 90);
+		sink.add("MB", remainder == 0 ? stripWidth : remainder);
+		sink.add("TR", 90, TurnDuration::positionTwo);
+		sink.add("MF", stripLength);
+		sink.add("TL", 180);
+		sink.add("MF", secondMoveDistance);
+		sink.add("TR", 90);
+		sink.add("MB", carDiameter * 2);
+	} else {
+		sink.add("TL", 90, TurnDuration::positionFour);
+		sink.add("MB", remainder == 0 ? stripWidth : remainder);
+		sink.add("TL", 90, 2 * TurnDuration::positionOne);
+		sink.add("MF", secondMoveDistance);
+		sink.add("TR", 90, TurnDuration::positionTwo);
+		sink.add("MB", carDiameter);
+	}
+}
+
+/**
+ * Getter function which returns how many instructions the preset plan of a lawn has
+ */
+template <class Lawn>
+constexpr size_t getPresetPlanSize() {
+	PresetCountSink sink;
+
+	generatePresetSerpentine(Lawn::length, Lawn::width, Lawn::carDiameter, Lawn::bladeDiameter, sink);
+
+	return sink.count;
+}
+
+/**
+ * Getter function which returns where the serpentine starts, for the preset plans and Path::generatePath()
+ */
+constexpr Pose getPresetStartPose(double carDiameter) {
+	return Pose{carDiameter / 2, carDiameter / 2, M_PI / 2};
+}
+
+/**
+ * PresetCoverage is CoverageGrid cut down to what annotating a preset plan needs, in fixed size arrays so it runs at compile time:
+ * one bit per cell, the cells cut by earlier instructions and the cells cut by the one being swept
+ */
+template <int Rows, int WordsPerRow>
+class PresetCoverage {
+	public:
+		constexpr PresetCoverage(int cols, double resolution)
+			: m_cols(cols), m_resolution(resolution), m_cut(), m_pass(), m_passRowMin(Rows), m_passRowMax(-1) {
+
+		}
+
+		/**
+		 * Function which sweeps the blade along an instruction, as CoverageGrid::sweepInstruction()
+		 * @return the pose after the instruction
+		 */
+		constexpr Pose sweepInstruction(const Pose& pose, const PresetInstruction& instruction, double bladeDiameter, double wheelBase) {
+			double radius = bladeDiameter / 2;
+			Pose next = applyPresetInstruction(pose, instruction.action, instruction.value, wheelBase);
+
+			if (isPresetAction(instruction.action, "TL") || isPresetAction(instruction.action, "TR")) {
+				int steps = std::max(1, ceilToInt((instruction.value < 0 ? -instruction.value : instruction.value) / ARC_STEP));
+				Pose from = pose;
+
+				for (int i = 1; i <= steps; i++) {
+					Pose to = applyPresetInstruction(pose, instruction.action, instruction.value * i / steps, wheelBase);
+					sweepStadium(from.x, from.y, to.x, to.y, radius, i == 1);
+					from = to;
+				}
+			} else {
+				sweepStadium(pose.x, pose.y, next.x, next.y, radius, true);
+			}
+
+			return next;
+		}
+
+		/**
+		 * Function which finishes the instruction being swept
+		 * @return how many of its cells no earlier instruction has cut
+		 */
+		constexpr long endPass() {
+			long count = 0;
+
+			for (int i = m_passRowMin * WordsPerRow; i < (m_passRowMax + 1) * WordsPerRow; i++) {
+				count += __builtin_popcountll(m_pass[i] & ~m_cut[i]);
+				m_cut[i] |= m_pass[i];
+				m_pass[i] = 0;
+			}
+
+			m_passRowMin = Rows;
+			m_passRowMax = -1;
+
+			return count;
+		}
+
+	private:
+		int m_cols;
+		double m_resolution;
+		uint64_t m_cut[Rows * WordsPerRow];
+		uint64_t m_pass[Rows * WordsPerRow];
+		int m_passRowMin;
+		int m_passRowMax;
+
+		// marks every cell whose centre is within radius of the segment (the start cap only if startCap is set),
+		// with the same sweepStadiumRows() as CoverageGrid::sweepStadium()
+		constexpr void sweepStadium(double x0, double y0, double x1, double y1, double radius, bool startCap) {
+			sweepStadiumRows(x0, y0, x1, y1, radius, startCap, Rows, m_cols, m_resolution, presetSqrt,
+				[this](int row, int colStart, int colEnd) {
+					fillRow(&m_pass[row * WordsPerRow], colStart, colEnd);
+					m_passRowMin = std::min(m_passRowMin, row);
+					m_passRowMax = std::max(m_passRowMax, row);
+				});
+		}
+};
+
+/**
+ * Getter functions which return the size of the grid a lawn is annotated on, as in Path::annotateCutting()
+ */
+template <class Lawn>
+constexpr int getPresetColumns() {
+	return std::max(1, ceilToInt(std::max(Lawn::length, Lawn::width) / ANNOTATION_RESOLUTION));
+}
+
+template <class Lawn>
+constexpr int getPresetRows() {
+	return std::max(1, ceilToInt(std::min(Lawn::length, Lawn::width) / ANNOTATION_RESOLUTION));
+}
+
+/**
+ * Function which plans a preset lawn: the serpentine, then every instruction marked with whether it cuts new grass
+ */
+template <class Lawn>
+constexpr std::array<PresetInstruction, getPresetPlanSize<Lawn>()> makePresetPlan() {
+	std::array<PresetInstruction, getPresetPlanSize<Lawn>()> plan{};
+	PresetArraySink sink{plan.data()};
+
+	generatePresetSerpentine(Lawn::length, Lawn::width, Lawn::carDiameter, Lawn::bladeDiameter, sink);
+
+	PresetCoverage<getPresetRows<Lawn>(), (getPresetColumns<Lawn>() + 63) / 64> grid(getPresetColumns<Lawn>(), ANNOTATION_RESOLUTION);
+	Pose pose = getPresetStartPose(Lawn::carDiameter);
+
+	for (size_t i = 0; i < plan.size(); i++) {
+		pose = grid.sweepInstruction(pose, plan[i], Lawn::bladeDiameter, Lawn::carDiameter);
+		plan[i].cutting = grid.endPass() * ANNOTATION_RESOLUTION * ANNOTATION_RESOLUTION >= MIN_NEW_CUT_AREA;
+	}
+
+	return plan;
+}
+
+/**
+ * Function which checks that a lawn gets a plan the mower can drive
+ * @return PRESET_PLAN_OK: success
+ * @return PRESET_LAWN_TOO_SMALL: the short side is not longer than the mower, or the blade is wider than the mower
+ * @return PRESET_BAD_INSTRUCTION: an instruction is not finite and positive, or turns by more than 180 degrees
+ * @return PRESET_OFF_LAWN: an instruction leaves the mower centre off the lawn
+ */
+template <class Lawn>
+constexpr int checkPresetPlan() {
+	if (!(Lawn::carDiameter > 0 && Lawn::bladeDiameter > 0 && Lawn::bladeDiameter <= Lawn::carDiameter
+		&& std::min(Lawn::length, Lawn::width) > Lawn::carDiameter)) {
+		return PRESET_LAWN_TOO_SMALL;
+	}
+
+	std::array<PresetInstruction, getPresetPlanSize<Lawn>()> plan{};
+	PresetArraySink sink{plan.data()};
+	Pose pose = getPresetStartPose(Lawn::carDiameter);
+
+	generatePresetSerpentine(Lawn::length, Lawn::width, Lawn::carDiameter, Lawn::bladeDiameter, sink);
+
+	for (const PresetInstruction& instruction : plan) {
+		bool turn = isPresetAction(instruction.action, "TL") || isPresetAction(instruction.action, "TR");
+
+		if (!(instruction.value > 0 && instruction.value < std::numeric_limits<double>::infinity()) || (turn && instruction.value > 180)) {
+			return PRESET_BAD_INSTRUCTION;
+		}
+
+		pose = applyPresetInstruction(pose, instruction.action, instruction.value, Lawn::carDiameter);
+
+		// the plan is laid out like the annotation grid: the short side along y, the long side along x
+		if (pose.x < -PRESET_LAWN_MARGIN || pose.y < -PRESET_LAWN_MARGIN || pose.x > std::max(Lawn::length, Lawn::width) + PRESET_LAWN_MARGIN
+			|| pose.y > std::min(Lawn::length, Lawn::width) + PRESET_LAWN_MARGIN) {
+			return PRESET_OFF_LAWN;
+		}
+	}
+
+	return PRESET_PLAN_OK;
+}
+
+/**
+ * The preset plan of a lawn, built once by the compiler and only instantiated if it passes checkPresetPlan()
+ */
+template <class Lawn>
+struct PresetPlanTable {
+	static constexpr int check = checkPresetPlan<Lawn>();
+
+	static_assert(check != PRESET_LAWN_TOO_SMALL, "preset lawn: the short side must be longer than the mower and the blade no wider than it");
+	static_assert(check != PRESET_BAD_INSTRUCTION, "preset lawn: the plan has an instruction that is not finite and positive");
+	static_assert(check != PRESET_OFF_LAWN, "preset lawn: the plan drives the mower off the lawn");
+
+	static constexpr std::array<PresetInstruction, getPresetPlanSize<Lawn>()> instructions = makePresetPlan<Lawn>();
+	static constexpr Pose startPose = getPresetStartPose(Lawn::carDiameter);
+};
+
+#endif // PRESETPLAN_H
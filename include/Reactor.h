@@ -0,0 +1,72 @@
+/**
+ *
+ * This file contains the declaration of the Reactor class and all associated member functions and attributes.
+ * The Reactor class is a single threaded event loop on epoll: every source is a file descriptor
+ * (input pin edges from Board::getEdgeFd(), timerfd timers, eventfd events) and its handler runs on the loop thread,
+ * so handlers never need locks and the thread sleeps in the kernel while nothing happens.
+ *
+ * The loop also measures how late it handles events: timers against the time they were due,
+ * file descriptors against the time the caller reports with recordLatency() (e.g. the kernel's edge timestamp).
+ *
+ */
+
+#ifndef REACTOR_H
+#define REACTOR_H
+
+#include <functional>
+#include <vector>
+
+struct LatencyStats {
+	long count;
+	double meanUs;
+	double maxUs;
+};
+
+class Reactor {
+	public:
+		Reactor();
+		~Reactor();
+		int addFd(int fd, std::function<void()> handler);
+		int removeFd(int fd);
+		int addTimer(std::function<void()> handler);
+		int armTimer(int timer, unsigned int delayMs, unsigned int periodMs);
+		int disarmTimer(int timer);
+		int addEvent(std::function<void()> handler);
+		int notify(int event);
+		int run();
+		int stop();
+		int recordLatency(long long eventNs);
+		LatencyStats getLatency();
+		static long long getMonotonicNs();
+		int getErrorNum();
+
+	protected:
+
+	private:
+		enum SourceType {
+			FD_SOURCE, // owned by the caller, the handler consumes it (fd -1 once removed, the slot is reused)
+			TIMER_SOURCE,
+			EVENT_SOURCE
+		};
+
+		struct Source {
+			int fd;
+			SourceType type;
+			std::function<void()> handler;
+			long long dueNs; // when an armed timer should fire next, 0 if disarmed
+			unsigned int periodMs;
+		};
+
+		int m_epollFd;
+		std::vector<Source> m_sources; // the epoll data of every fd is its index in here
+		bool m_running;
+		long m_latencyCount;
+		double m_latencyTotalUs;
+		double m_latencyMaxUs;
+		int m_errorNum;
+
+		int addSource(int fd, SourceType type, std::function<void()> handler);
+		int dispatch(int index);
+};
+
+#endif // REACTOR_H
@@ -0,0 +1,58 @@
+/**
+ *
+ * This file contains the declaration of the ReactorRuntime class and all associated member functions and attributes.
+ * The ReactorRuntime class is the single threaded alternative to running ButtonController::startInputListener()
+ * and ExecutionController::startExecutionListener() on two spinning threads (see thread_test.cpp).
+ * Everything runs on one Reactor:
+ *  - button edges come from the board's edge fds (polled every BUTTON_POLL_MS if the board has none)
+ *  - motion deadlines are a one shot timer armed with the time ExecutionController::startNext() asks for
+ *  - the display refresh is a one second timer
+ *  - shutdown is an event, so requestShutdown() can be called from any thread
+ *  - control clients, if a ControlServer is set, are served like the buttons
+ * The thread sleeps in epoll between events, so an idle mower uses no CPU.
+ *
+ */
+
+#ifndef REACTORRUNTIME_H
+#define REACTORRUNTIME_H
+
+#include "Reactor.h"
+#include "ButtonController.h"
+#include "ExecutionController.h"
+#include "Board.h"
+#include "ControlServer.h"
+
+const unsigned int BUTTON_POLL_MS = 10;
+const unsigned int DISPLAY_REFRESH_MS = 1000;
+
+class ReactorRuntime {
+	public:
+		ReactorRuntime(ButtonController& buttonControl, ExecutionController& exeControl, Board& board);
+		~ReactorRuntime();
+		int run();
+		int requestShutdown();
+		int setControlServer(ControlServer& controlServer);
+		LatencyStats getLatency();
+		int getErrorNum();
+
+	protected:
+
+	private:
+		Reactor m_reactor;
+		ButtonController* m_buttonControl;
+		ExecutionController* m_exeControl;
+		Board* m_board;
+		int m_motionTimer;
+		int m_displayTimer;
+		int m_pollTimer; // only used when the board has no edge fds
+		int m_shutdownEvent;
+		bool m_shuttingDown;
+		int m_errorNum;
+
+		int onButtons();
+		int onMotionDeadline();
+		int onShutdown();
+		int startNextInstruction();
+};
+
+#endif // REACTORRUNTIME_H
@@ -0,0 +1,65 @@
+/**
+ *
+ * This file contains the declaration of the RecordingBoard class and all associated member functions and attributes.
+ * The RecordingBoard class is a Board that passes every call on to another board (WiringPiBoard on the mower, or a SimBoard)
+ * and records what happened into a BoardTrace: reads that returned a new level, every write, every delay and every
+ * interrupt, timed with the other board's clock from when the RecordingBoard was made. The controllers are given the
+ * RecordingBoard instead of the board itself. The trace can be saved and replayed with TraceReplayer.
+ *
+ * Polling loops read the buttons thousands of times a second, so a read is only recorded when its level differs from
+ * the last read of the same pin: those are the reads that can change what the controllers do.
+ * Recording takes a lock, so an interrupt handler is no longer lock free while it is recorded.
+ *
+ */
+
+#ifndef RECORDINGBOARD_H
+#define RECORDINGBOARD_H
+
+#include <mutex>
+#include "Board.h"
+#include "BoardTrace.h"
+
+const int RECORDING_PIN_COUNT = 64;
+
+class RecordingBoard : public Board {
+	public:
+		RecordingBoard(Board& board);
+		~RecordingBoard();
+		int setup();
+		int pinMode(int pin, int mode);
+		int pullUpDnControl(int pin, int pud);
+		int digitalWrite(int pin, int value);
+		int digitalRead(int pin);
+		void delay(unsigned int milliseconds);
+		unsigned int delay(unsigned int milliseconds, CancellationToken& token);
+		unsigned int millis();
+		int getEdgeFd(int pin);
+		int readEdges(int pin, long long& firstEdgeNs);
+		int resolvePins(const int* pins, int count, PinBatch& batch);
+		int writeLow(const PinBatch& batch);
+		int attachInterrupt(int pin, InterruptHandler handler, void* context);
+		BoardTrace getTrace();
+		int save(const std::string& path, const std::string& header);
+
+	protected:
+
+	private:
+		struct RecordedInterrupt {
+			RecordingBoard* board;
+			int pin;
+			InterruptHandler handler;
+			void* context;
+		};
+
+		Board* m_board;
+		unsigned int m_startMs; // the other board's clock when recording started
+		std::mutex m_mutex;
+		BoardTrace m_trace;
+		int m_lastRead[RECORDING_PIN_COUNT]; // -1 before the first read
+		RecordedInterrupt m_interrupts[RECORDING_PIN_COUNT];
+
+		void record(unsigned int timeMs, char type, int pin, int value);
+		static void onInterrupt(void* context);
+};
+
+#endif // RECORDINGBOARD_H
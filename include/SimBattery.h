@@ -0,0 +1,53 @@
+/**
+ *
+ * This file contains the declaration of the SimBattery class and all associated member functions and attributes.
+ * The SimBattery class is a BatteryMonitor for a SimBoard: it drains by the power of every load pin while that pin is HIGH
+ * and charges at a fixed power while charging, both on the board's virtual clock.
+ *
+ */
+
+#ifndef SIMBATTERY_H
+#define SIMBATTERY_H
+
+#include <vector>
+#include "BatteryMonitor.h"
+#include "SimBoard.h"
+
+const double SIM_BATTERY_FULL_VOLTS = 25.2; // 6 cell lithium ion pack
+const double SIM_BATTERY_EMPTY_VOLTS = 19.8;
+
+class SimBattery : public BatteryMonitor {
+	public:
+		SimBattery(SimBoard& board, double capacityWh, double chargeWatts);
+		~SimBattery();
+		int addLoad(int pin, double watts);
+		double getRemainingWh();
+		double getCapacityWh();
+		double getVoltage();
+		int startCharging();
+		int stopCharging();
+		int setRemainingWh(double remainingWh);
+		int getChargeCount();
+
+	protected:
+
+	private:
+		struct Load {
+			int pin;
+			double watts;
+			unsigned int highTimeAtSync; // pin HIGH time when m_levelWh was last updated
+		};
+
+		SimBoard* m_board;
+		double m_capacityWh;
+		double m_chargeWatts;
+		double m_levelWh;
+		std::vector<Load> m_loads;
+		bool m_charging;
+		unsigned int m_chargeStartMs;
+		int m_chargeCount;
+
+		int sync();
+};
+
+#endif // SIMBATTERY_H
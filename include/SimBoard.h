@@ -0,0 +1,73 @@
+/**
+ *
+ * This file contains the declaration of the SimBoard class and all associated member functions and attributes.
+ * The SimBoard class is a Board with no hardware behind it: pin levels live in the object and time is a virtual clock
+ * that only moves when delay() is called, so a mission that takes an hour on the lawn runs in microseconds.
+ * Every delay is recorded together with the output pin levels during it, which is enough to replay what the motors did.
+ * Each instance has its own pins and clock, so many boards can run on different threads at the same time.
+ *
+ * In real time mode delay() really sleeps and millis() is wall-clock time, so a runtime that waits on timers
+ * (or several threads sharing the board) can be measured without hardware. Nothing is recorded in that mode.
+ * Input pins changed with setInput() signal their edge file descriptors (eventfds), like GPIO line events.
+ * An interrupt handler attached to a pin runs inside setInput() on the thread that pulls the pin LOW, like a hardware interrupt.
+ *
+ */
+
+#ifndef SIMBOARD_H
+#define SIMBOARD_H
+
+#include <cstdint>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include "Board.h"
+
+const int SIM_PIN_COUNT = 64; // enough for every wiringPi pin number
+
+struct PinInterval {
+	unsigned int startMs;
+	unsigned int durationMs;
+	uint64_t levels; // bit n set: pin n was HIGH
+};
+
+class SimBoard : public Board {
+	public:
+		SimBoard();
+		~SimBoard();
+		int setup();
+		int pinMode(int pin, int mode);
+		int pullUpDnControl(int pin, int pud);
+		int digitalWrite(int pin, int value);
+		int digitalRead(int pin);
+		void delay(unsigned int milliseconds);
+		unsigned int delay(unsigned int milliseconds, CancellationToken& token);
+		unsigned int millis();
+		int getEdgeFd(int pin);
+		int readEdges(int pin, long long& firstEdgeNs);
+		int resolvePins(const int* pins, int count, PinBatch& batch);
+		int writeLow(const PinBatch& batch);
+		int attachInterrupt(int pin, InterruptHandler handler, void* context);
+		int setInput(int pin, int value);
+		int setRealTime(bool realTime);
+		int reset();
+		const std::vector<PinInterval>& getIntervals();
+		unsigned int getPinHighTime(int pin);
+		int getErrorNum();
+
+	protected:
+
+	private:
+		std::atomic<uint64_t> m_levels; // bit n set: pin n is HIGH (atomic so threads can share the board in real time mode)
+		unsigned int m_now;
+		bool m_realTime;
+		std::chrono::steady_clock::time_point m_realTimeStart;
+		int m_edgeFds[SIM_PIN_COUNT]; // eventfd per input pin, -1 until requested
+		std::atomic<long long> m_firstEdgeNs[SIM_PIN_COUNT]; // time of the oldest edge not read yet, 0 if none
+		InterruptHandler m_interruptHandlers[SIM_PIN_COUNT]; // nullptr if none attached
+		void* m_interruptContexts[SIM_PIN_COUNT];
+		unsigned int m_highTime[SIM_PIN_COUNT];
+		std::vector<PinInterval> m_intervals;
+		int m_errorNum;
+};
+
+#endif // SIMBOARD_H
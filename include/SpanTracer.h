@@ -0,0 +1,116 @@
+/**
+ *
+ * This file contains the declaration of the SpanTracer class and all associated member functions and attributes.
+ * The SpanTracer records timed spans of what each thread is doing (an instruction, a motor command, a button handler,
+ * a display update, a delay) so the threads can be seen side by side in chrome://tracing or Perfetto.
+ *
+ * TRACE_SPAN("exec", "executeNext") at the top of a block records the time from there to the end of the block.
+ * While tracing is stopped (the default) a span costs one relaxed atomic load. While it runs, a span reads the clock
+ * twice and fills a slot of a ring buffer owned by the calling thread: no lock and no system call. Each ring keeps the
+ * last spans of its thread, so the tracer can be left running on the mower like a flight recorder and saved with
+ * writeChromeTrace() when something looks wrong. Compile with -DTRACE_SPANS=0 to remove the spans entirely.
+ *
+ * Category and name must be string literals: only the pointers are stored.
+ *
+ */
+
+#ifndef SPANTRACER_H
+#define SPANTRACER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifndef TRACE_SPANS
+#define TRACE_SPANS 1
+#endif
+
+#define TRACE_SPAN_JOIN(a, b) a##b
+#define TRACE_SPAN_NAME(line) TRACE_SPAN_JOIN(traceSpan, line)
+
+#if TRACE_SPANS
+#define TRACE_SPAN(category, name) ScopedSpan TRACE_SPAN_NAME(__LINE__)(category, name)
+#else
+#define TRACE_SPAN(category, name) ((void) 0)
+#endif
+
+const unsigned int SPAN_RING_SIZE = 4096; // spans kept per thread, a power of two
+
+struct SpanRecord {
+	long long startNs; // CLOCK_MONOTONIC
+	long long durationNs;
+	const char* category;
+	const char* name;
+};
+
+class SpanTracer {
+	public:
+		static SpanTracer& getInstance();
+		~SpanTracer();
+		int start();
+		int stop();
+		int clear();
+		void record(const char* category, const char* name, long long startNs, long long endNs);
+		void setThreadName(const char* name);
+		int writeChromeTrace(const std::string& path);
+		long getSpanCount();
+		long getOverwrittenCount();
+
+		/**
+		 * Getter function which returns whether spans are being recorded, inline so a span costs one load while stopped
+		 */
+		static bool isRunning() {
+			return s_running.load(std::memory_order_relaxed);
+		}
+
+		static long long now();
+
+	protected:
+
+	private:
+		struct ThreadBuffer {
+			std::atomic<unsigned int> head; // spans recorded by the thread, the next one goes to head % SPAN_RING_SIZE
+			int threadIndex;
+			const char* name;
+			SpanRecord records[SPAN_RING_SIZE];
+		};
+
+		static std::atomic<bool> s_running;
+		std::mutex m_buffersMutex; // threads register their buffer once
+		std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+
+		SpanTracer();
+		ThreadBuffer* getThreadBuffer();
+};
+
+/**
+ * A span from its construction to its destruction, recorded only if tracing was running when it started (see TRACE_SPAN)
+ */
+class ScopedSpan {
+	public:
+		ScopedSpan(const char* category, const char* name) {
+			m_startNs = SpanTracer::isRunning() ? SpanTracer::now() : 0;
+			m_category = category;
+			m_name = name;
+		}
+
+		~ScopedSpan() {
+			if (m_startNs != 0) {
+				SpanTracer::getInstance().record(m_category, m_name, m_startNs, SpanTracer::now());
+			}
+		}
+
+		ScopedSpan(const ScopedSpan&) = delete;
+		ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+	protected:
+
+	private:
+		long long m_startNs; // 0 when not recorded
+		const char* m_category;
+		const char* m_name;
+};
+
+#endif // SPANTRACER_H
@@ -0,0 +1,61 @@
+/**
+ *
+ * This file contains the declaration of the StartupOrchestrator class and all associated member functions and attributes.
+ * The StartupOrchestrator class runs the start up of the mower and times every step of it:
+ *  - GPIO is set up once, before anything else (later Board::setup() calls return straight away)
+ *  - slow steps that nothing waits for (the OLED, the default plan) run on threads of their own with startStep()
+ *  - markReady() is called as soon as the buttons can be polled, the parallel steps may still be running
+ * printReport() shows when each step started and how long it took, from the start of the process.
+ *
+ */
+
+#ifndef STARTUPORCHESTRATOR_H
+#define STARTUPORCHESTRATOR_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <chrono>
+#include <ostream>
+#include "Board.h"
+
+struct StartupStep {
+	std::string name;
+	bool parallel; // ran on its own thread
+	double startMs; // since the orchestrator was created
+	double durationMs;
+	int result;
+};
+
+class StartupOrchestrator {
+	public:
+		StartupOrchestrator(Board& board);
+		~StartupOrchestrator();
+		int setupGpio();
+		int runStep(const std::string& name, std::function<int()> step);
+		std::shared_future<int> startStep(const std::string& name, std::function<int()> step);
+		int markReady();
+		int waitAll();
+		double getReadyMs();
+		double getProcessAgeMs();
+		std::vector<StartupStep> getSteps();
+		int printReport(std::ostream& out);
+
+	protected:
+
+	private:
+		Board* m_board;
+		std::chrono::steady_clock::time_point m_start;
+		double m_processAgeMs; // how long the process had been running when the orchestrator was created, -1 if unknown
+		double m_readyMs; // -1 until markReady()
+		std::mutex m_mutex; // the parallel steps add themselves to m_steps
+		std::vector<StartupStep> m_steps;
+		std::vector<std::shared_future<int>> m_pending;
+
+		double getElapsedMs();
+		int timeStep(const std::string& name, bool parallel, std::function<int()>& step);
+};
+
+#endif // STARTUPORCHESTRATOR_H
@@ -0,0 +1,36 @@
+/**
+ *
+ * This file contains the declaration of the TelemetryReader class and all associated member functions and attributes.
+ * The TelemetryReader maps the segment a TelemetryWriter publishes to (read only) and copies out whole frames: read()
+ * retries while the writer is in the middle of a frame, it never blocks the writer or the other readers. A read is a
+ * few dozen loads, so a dashboard can sample at kHz rates. Link it into the reading process with TelemetryWriter.h.
+ *
+ */
+
+#ifndef TELEMETRYREADER_H
+#define TELEMETRYREADER_H
+
+#include <string>
+#include "TelemetryWriter.h"
+
+const int TELEMETRY_READ_RETRIES = 10000; // a frame takes well under a microsecond to write
+
+class TelemetryReader {
+	public:
+		TelemetryReader();
+		~TelemetryReader();
+		int open(const std::string& name);
+		int close();
+		int read(TelemetryFrame& frame);
+		int read(TelemetryFrame& frame, unsigned int& sequence);
+		bool isOpen();
+		unsigned long getRetryCount();
+
+	protected:
+
+	private:
+		const TelemetrySegment* m_segment; // nullptr: not open
+		unsigned long m_retryCount; // reads that overlapped a write and were repeated
+};
+
+#endif // TELEMETRYREADER_H
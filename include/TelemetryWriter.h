@@ -0,0 +1,89 @@
+/**
+ *
+ * This file contains the declaration of the TelemetryWriter class and all associated member functions and attributes.
+ * The TelemetryWriter publishes the executor's live state (see TelemetryFrame) into a POSIX shared-memory segment, so
+ * a dashboard or any other local process can sample it with a TelemetryReader without going through the logs.
+ *
+ * The segment is guarded by a seqlock: the writer makes the sequence odd, copies the frame in and makes it even again,
+ * and a reader retries if the sequence was odd or changed while it copied. The writer never waits for the readers and
+ * there can be any number of them. Publishing is a memory compare and a copy into the mapping: no lock, no allocation
+ * and no system call, so the executor can publish from its loop. Frames equal to the last one published are skipped.
+ *
+ * The frame is copied as 32-bit relaxed atomics, which are plain loads and stores on every platform the mower runs on
+ * and are safe to read from a read-only mapping (64-bit atomics are not, on 32-bit ARM).
+ *
+ */
+
+#ifndef TELEMETRYWRITER_H
+#define TELEMETRYWRITER_H
+
+#include <atomic>
+#include <string>
+
+const unsigned int TELEMETRY_MAGIC = 0x4D4C4554; // "TELM" in a little-endian file
+const unsigned int TELEMETRY_VERSION = 1;
+const char TELEMETRY_DEFAULT_NAME[] = "/nomo_telemetry";
+
+/**
+ * What the executor publishes, fixed layout without padding (readers built separately must agree on it)
+ */
+struct TelemetryFrame {
+	double x; // pose estimate in metres, 0 if no PoseEstimator is attached
+	double y;
+	double theta;
+	double value; // of the current instruction
+	int state; // State
+	int phase; // InstructionPhase
+	unsigned int instructionIndex; // instructions started since the plan was assigned, the current one included
+	unsigned int remainingCount; // instructions left, the current one not included
+	unsigned int motorLevels; // last level written to each motor pin, see TELEMETRY_* bits
+	char action[4]; // of the current instruction ("MF", "TL"...), empty between instructions
+	int poseValid; // 1 if x, y and theta come from a PoseEstimator
+	int bladeSpinning;
+};
+
+// bits of TelemetryFrame::motorLevels
+const unsigned int TELEMETRY_LEFT_CW = 1 << 0;
+const unsigned int TELEMETRY_LEFT_CCW = 1 << 1;
+const unsigned int TELEMETRY_RIGHT_CW = 1 << 2;
+const unsigned int TELEMETRY_RIGHT_CCW = 1 << 3;
+const unsigned int TELEMETRY_BLADE_CW = 1 << 4;
+const unsigned int TELEMETRY_BLADE_CCW = 1 << 5;
+
+const int TELEMETRY_WORDS = sizeof(TelemetryFrame) / sizeof(unsigned int);
+
+static_assert(sizeof(TelemetryFrame) == 64, "TelemetryFrame must not have padding");
+static_assert(sizeof(std::atomic<unsigned int>) == sizeof(unsigned int), "the segment layout needs plain 32-bit atomics");
+
+/**
+ * The shared-memory segment, magic is set last by the writer so a reader never sees a half initialised segment
+ */
+struct TelemetrySegment {
+	std::atomic<unsigned int> magic;
+	unsigned int version;
+	unsigned int frameSize;
+	std::atomic<unsigned int> sequence; // odd while the writer is copying a frame in
+	std::atomic<unsigned int> words[TELEMETRY_WORDS]; // the frame
+};
+
+class TelemetryWriter {
+	public:
+		TelemetryWriter();
+		~TelemetryWriter();
+		int open(const std::string& name);
+		int close();
+		int unlink();
+		int publish(const TelemetryFrame& frame);
+		bool isOpen();
+		unsigned long getPublishCount();
+
+	protected:
+
+	private:
+		std::string m_name;
+		TelemetrySegment* m_segment; // nullptr: not open, publish() does nothing
+		TelemetryFrame m_lastFrame; // last frame published, to skip unchanged ones
+		unsigned long m_publishCount;
+};
+
+#endif // TELEMETRYWRITER_H
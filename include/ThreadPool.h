@@ -0,0 +1,54 @@
+/**
+ *
+ * This file contains the declaration of the ThreadPool class and all associated member functions and attributes.
+ * The ThreadPool class runs tasks on a fixed number of worker threads using work stealing:
+ * every worker owns a queue and takes its newest task first, idle workers steal the oldest task from another worker's queue.
+ *
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+	public:
+		ThreadPool(int threadCount);
+		~ThreadPool();
+		int submit(std::function<void()> task);
+		int wait();
+		int getThreadCount();
+		long getStealCount();
+		static int getWorkerIndex();
+
+	protected:
+
+	private:
+		struct WorkerQueue {
+			std::mutex mutex;
+			std::deque<std::function<void()>> tasks;
+		};
+
+		std::vector<std::thread> m_threads;
+		std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+		std::atomic<long> m_pending; // submitted but not yet finished
+		std::atomic<long> m_queued; // submitted but not yet started
+		std::atomic<long> m_steals;
+		std::atomic<unsigned int> m_nextQueue;
+		std::atomic<bool> m_shutDownFlag;
+		std::mutex m_sleepMutex;
+		std::condition_variable m_workAvailable;
+		std::condition_variable m_allDone;
+
+		void workerLoop(int index);
+		bool takeTask(int index, std::function<void()>& task);
+};
+
+#endif // THREADPOOL_H
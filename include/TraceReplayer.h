@@ -0,0 +1,48 @@
+/**
+ *
+ * This file contains the declaration of the TraceReplayer class and all associated member functions and attributes.
+ * The TraceReplayer class plays the inputs of a recorded BoardTrace back into a SimBoard on its virtual clock and runs
+ * the buttons and the executor the way ReactorRuntime does (button changes handled as soon as they happen, the executor
+ * driven with startNext()/continueCurrent() at its deadlines), all on the calling thread. Time only moves from one event
+ * to the next, so an hour of mowing replays in milliseconds, and the same trace always gives the same output timeline.
+ * Give the controllers a RecordingBoard on the SimBoard to get that timeline.
+ *
+ * Inputs are the pins the trace reads or has interrupts on but never writes. Each input starts at the level of its
+ * first recorded read (HIGH if its first event is an interrupt, which happens on a falling edge) and changes at the
+ * recorded times. The replay ends at the last event of the trace, or earlier if the buttons shut the mower down.
+ *
+ */
+
+#ifndef TRACEREPLAYER_H
+#define TRACEREPLAYER_H
+
+#include "BoardTrace.h"
+#include "ButtonController.h"
+#include "ExecutionController.h"
+#include "SimBoard.h"
+
+class TraceReplayer {
+	public:
+		TraceReplayer(ButtonController& buttonControl, ExecutionController& exeControl, SimBoard& board);
+		~TraceReplayer();
+		int run(const BoardTrace& trace);
+		long getInputCount();
+
+	protected:
+
+	private:
+		ButtonController* m_buttonControl;
+		ExecutionController* m_exeControl;
+		SimBoard* m_board;
+		unsigned long long m_deadlineMs; // motion deadline, when m_motionArmed (64 bits: a wait can be as long as the clock)
+		bool m_motionArmed;
+		bool m_shuttingDown;
+		long m_inputCount; // input changes played back by the last run()
+
+		int onButtons();
+		int onMotionDeadline();
+		int onShutdown();
+		int startNextInstruction();
+};
+
+#endif // TRACEREPLAYER_H
@@ -0,0 +1,45 @@
+/**
+ *
+ * This file contains the declaration of the TurnCalibration class and all associated member functions and attributes.
+ * The TurnCalibration class converts a requested turn angle into the time a wheel motor has to be powered for.
+ * Durations are measured on the mower at a handful of angles and linearly interpolated in between,
+ * optionally with one table per battery voltage (the mower turns slower as the battery drains).
+ *
+ */
+
+#ifndef TURNCALIBRATION_H
+#define TURNCALIBRATION_H
+
+#include <vector>
+
+struct CalibrationPoint {
+	double angle; // degrees
+	double duration; // milliseconds
+};
+
+class TurnCalibration {
+	public:
+		TurnCalibration();
+		TurnCalibration(const std::vector<CalibrationPoint>& points);
+		~TurnCalibration();
+		int addTable(double voltage, const std::vector<CalibrationPoint>& points);
+		int getDuration(double angle) const;
+		int getDuration(double angle, double voltage) const;
+		int getTableCount() const;
+		int getErrorNum() const;
+
+	protected:
+
+	private:
+		struct Table {
+			double voltage;
+			std::vector<CalibrationPoint> points; // sorted by angle, always starts at (0, 0)
+		};
+
+		std::vector<Table> m_tables; // sorted by voltage
+		int m_errorNum;
+
+		double interpolate(const Table& table, double angle) const;
+};
+
+#endif // TURNCALIBRATION_H
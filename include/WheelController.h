@@ -11,6 +11,8 @@
 
 #include "MotorController.h"
 #include "Motor.h"
+#include "TurnCalibration.h"
+#include "CancellationToken.h"
 
 enum TurnDuration { 
 	positionOne = 900, // standard TR or TL
@@ -20,6 +22,11 @@ enum TurnDuration {
 	positionFive = 900 // placeholder value for additional turn duration (may need to be added, depending on terrain)
 };
 
+// a pivot started straight after moving backward slips before the mower turns, so it needs this much more motor time
+// (measured at 90 degrees: TL after MB and TR after MB against a standard turn)
+const int LEFT_TURN_AFTER_REVERSE_MS = TurnDuration::positionFour - TurnDuration::positionOne;
+const int RIGHT_TURN_AFTER_REVERSE_MS = TurnDuration::positionTwo - TurnDuration::positionOne;
+
 class WheelController : public MotorController {
 	public:
 		WheelController(Motor& leftWheelMotor, Motor& rightWheelMotor);
@@ -29,6 +36,16 @@ class WheelController : public MotorController {
 		int moveBackward();
 		int turnLeft(TurnDuration turnDuration);
 		int turnRight(TurnDuration turnDuration);
+		int turnLeft(double angle);
+		int turnRight(double angle);
+		int startTurnLeft(double angle, int durationMs = 0);
+		int startTurnRight(double angle, int durationMs = 0);
+		int setTurnCalibration(const TurnCalibration& leftTurns, const TurnCalibration& rightTurns);
+		int setTurnAfterReverseCorrection(int leftMs, int rightMs);
+		int setBatteryVoltage(double voltage);
+		int setCancellationToken(CancellationToken& token);
+		int getTurnLeftDuration(double angle);
+		int getTurnRightDuration(double angle);
 		Motor* getLeftWheelMotor();
 		Motor* getRightWheelMotor();
 		
@@ -37,6 +54,15 @@ class WheelController : public MotorController {
 	private:
 		Motor* m_leftWheelMotor;
 		Motor* m_rightWheelMotor;
+		TurnCalibration m_leftTurns;
+		TurnCalibration m_rightTurns;
+		int m_leftTurnAfterReverseMs; // added to a turn made straight after moving backward
+		int m_rightTurnAfterReverseMs;
+		bool m_lastMoveBackward; // the wheels last moved backward, the next turn gets the after reverse correction
+		double m_batteryVoltage;
+		CancellationToken* m_cancelToken; // nullptr: turns cannot be interrupted
+
+		int runMotor(Motor* motor, Direction direction, int duration);
 };
 
 #endif // WHEELCONTROLLER_H
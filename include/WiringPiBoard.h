@@ -0,0 +1,58 @@
+/**
+ *
+ * This file contains the declaration of the WiringPiBoard class and all associated member functions and attributes.
+ * The WiringPiBoard class is the Board used on the mower: every call goes straight to wiringPi.
+ * Classes constructed without a Board use the shared instance from getInstance().
+ * wiringPi is only set up by the first call to setup(), later calls (every Motor, the buttons) return straight away.
+ * Edge file descriptors are line event requests on the GPIO character device (/dev/gpiochip0).
+ * A PinBatch is one output line request for all its pins, so writeLow() is a single ioctl.
+ * Each attached interrupt has its own thread (real time priority if allowed) that sleeps until the pin's falling edge.
+ *
+ *
+ */
+
+#ifndef WIRINGPIBOARD_H
+#define WIRINGPIBOARD_H
+
+#include "Board.h"
+#include <thread>
+#include <vector>
+#include <mutex>
+
+const int WIRINGPI_PIN_COUNT = 64;
+
+class WiringPiBoard : public Board {
+	public:
+		WiringPiBoard();
+		~WiringPiBoard();
+		int setup();
+		int pinMode(int pin, int mode);
+		int pullUpDnControl(int pin, int pud);
+		int digitalWrite(int pin, int value);
+		int digitalRead(int pin);
+		void delay(unsigned int milliseconds);
+		unsigned int delay(unsigned int milliseconds, CancellationToken& token);
+		unsigned int millis();
+		int getEdgeFd(int pin);
+		int readEdges(int pin, long long& firstEdgeNs);
+		int resolvePins(const int* pins, int count, PinBatch& batch);
+		int writeLow(const PinBatch& batch);
+		int attachInterrupt(int pin, InterruptHandler handler, void* context);
+		static WiringPiBoard& getInstance();
+
+	protected:
+
+	private:
+		std::once_flag m_setupOnce;
+		int m_setupResult;
+		int m_chipFd;
+		int m_edgeFds[WIRINGPI_PIN_COUNT]; // -1 until the pin's edges are requested
+		int m_interruptStopFd; // eventfd that wakes the interrupt threads on destruction
+		std::vector<std::thread> m_interruptThreads;
+		std::vector<int> m_batchFds;
+
+		int openChip();
+		static int runInterrupt(int lineFd, int stopFd, InterruptHandler handler, void* context);
+};
+
+#endif // WIRINGPIBOARD_H
@@ -0,0 +1,157 @@
+/**
+ * This file contains the implementation of the BladeScheduler class and all associated member functions that are included in the BladeScheduler.h file.
+ * The BladeScheduler class decides when the blade spins and when it is started ahead of the next cutting leg.
+ *
+ */
+
+#include "BladeScheduler.h"
+#include "DriveModel.h"
+
+const int DEFAULT_SPIN_UP_MS = 1000;
+const int DEFAULT_MIN_OFF_MS = 3000;
+
+/**
+ * Constructor with the default spin up time and shortest blade-off stretch
+ */
+BladeScheduler::BladeScheduler() : BladeScheduler(DEFAULT_SPIN_UP_MS, DEFAULT_MIN_OFF_MS) {
+
+}
+
+/**
+ * Constructor
+ *
+ * @param spinUpMs: time the blade needs to get up to cutting speed
+ * @param minOffMs: shortest blade-off stretch worth stopping the blade for (restarting costs energy and wears the motor)
+ *
+ */
+BladeScheduler::BladeScheduler(int spinUpMs, int minOffMs) {
+	m_spinUpMs = spinUpMs;
+	m_minOffMs = minOffMs;
+	m_enabled = true;
+	m_offCount = 0;
+}
+
+/**
+ * Member function destructor which deletes an object: no return
+ */
+BladeScheduler::~BladeScheduler() {
+
+}
+
+/**
+ * Function which rewrites the blade annotations of a plan (cutting and preSpinMs) into the blade schedule the executor follows
+ * When disabled, the blade spins for the whole plan (the behaviour before blade scheduling)
+ *
+ * @param instructions: plan with cutting annotations, updated in place
+ * @return the number of stretches the blade is stopped for
+ */
+int BladeScheduler::schedule(Plan& instructions) {
+	m_offCount = 0;
+
+	for (Instruction& instruction : instructions) {
+		instruction.preSpinMs = 0;
+
+		if (!m_enabled) {
+			instruction.cutting = true;
+		}
+	}
+
+	if (!m_enabled) {
+		return 0;
+	}
+
+	size_t i = 0;
+
+	while (i < instructions.size()) {
+		if (instructions[i].cutting) {
+			i++;
+			continue;
+		}
+
+		// blade-off stretch [i, end)
+		size_t end = i;
+		int stretchMs = 0;
+
+		while (end < instructions.size() && !instructions[end].cutting) {
+			stretchMs += estimateDuration(instructions[end]);
+			end++;
+		}
+
+		bool between = i > 0 && end < instructions.size();
+
+		if (between && stretchMs < m_spinUpMs + m_minOffMs) { // too short, keep the blade spinning
+			for (size_t k = i; k < end; k++) {
+				instructions[k].cutting = true;
+			}
+		} else {
+			m_offCount++;
+
+			// start the blade early enough to be at speed when the next cutting leg begins
+			int remaining = end < instructions.size() ? m_spinUpMs : 0;
+
+			for (size_t k = end; k > i && remaining > 0; k--) {
+				int duration = estimateDuration(instructions[k - 1]);
+
+				if (duration >= remaining) {
+					instructions[k - 1].preSpinMs = remaining;
+					remaining = 0;
+				} else {
+					instructions[k - 1].cutting = true;
+					remaining -= duration;
+				}
+			}
+		}
+
+		i = end;
+	}
+
+	return m_offCount;
+}
+
+/**
+ * Setter function which turns scheduling on or off (off: the blade spins for the whole plan)
+ */
+int BladeScheduler::setEnabled(bool enabled) {
+	m_enabled = enabled;
+
+	return 0;
+}
+
+/**
+ * Getter function which returns whether scheduling is on
+ */
+bool BladeScheduler::isEnabled() {
+	return m_enabled;
+}
+
+/**
+ * Getter function which returns the spin up time in milliseconds
+ */
+int BladeScheduler::getSpinUpMs() {
+	return m_spinUpMs;
+}
+
+/**
+ * Getter function which returns the shortest blade-off stretch in milliseconds
+ */
+int BladeScheduler::getMinOffMs() {
+	return m_minOffMs;
+}
+
+/**
+ * Getter function which returns how many stretches the last schedule stopped the blade for
+ */
+int BladeScheduler::getOffCount() {
+	return m_offCount;
+}
+
+/**
+ * Function which estimates how long an instruction takes, in milliseconds
+ */
+int BladeScheduler::estimateDuration(const Instruction& instruction) {
+	if (instruction.action == "MF" || instruction.action == "MB") {
+		return instruction.value * DRIVE_MS_PER_METRE;
+	}
+
+	return instruction.value * 900 / 90; // standard 90 degree pivot takes 900 ms
+}
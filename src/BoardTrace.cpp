@@ -0,0 +1,213 @@
+/**
+ * This file contains the implementation of the BoardTrace class and all associated member functions that are included in the BoardTrace.h file.
+ * The BoardTrace class holds the recorded events of a board and reads and writes them as text.
+ *
+ */
+
+#include "BoardTrace.h"
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <map>
+#include <algorithm>
+
+const char* BOARD_TRACE_VERSION_LINE = "# board trace 1";
+
+/**
+ * Constructor, starts with no events
+ */
+BoardTrace::BoardTrace() {
+
+}
+
+/**
+ * Member function destructor which deletes an object: no return
+ */
+BoardTrace::~BoardTrace() {
+
+}
+
+/**
+ * Function which adds an event at the end of the trace
+ * @param type: TraceEventType
+ * Return value is 0 for success
+ */
+int BoardTrace::add(unsigned int timeMs, char type, int pin, int value) {
+	m_events.push_back(TraceEvent{timeMs, type, pin, value});
+
+	return 0;
+}
+
+/**
+ * Function which writes the trace to a text file (an existing file is replaced)
+ * @return 0: success
+ * @return -1: the file could not be written
+ */
+int BoardTrace::save(const std::string& path) const {
+	std::ofstream file(path);
+
+	if (!file) {
+		return -1;
+	}
+
+	file << BOARD_TRACE_VERSION_LINE << "\n";
+
+	if (!m_header.empty()) {
+		file << "# " << m_header << "\n";
+	}
+
+	for (const TraceEvent& event : m_events) {
+		file << event.timeMs << " " << event.type << " " << event.pin << " " << event.value << "\n";
+	}
+
+	file.close();
+
+	return file ? 0 : -1;
+}
+
+/**
+ * Function which replaces the trace with the one in a text file written by save()
+ * @return 0: success
+ * @return -1: the file could not be read
+ * @return -2: the file is not a board trace, or a line could not be read (the trace is left empty)
+ */
+int BoardTrace::load(const std::string& path) {
+	std::ifstream file(path);
+	std::string line;
+
+	clear();
+
+	if (!file) {
+		return -1;
+	}
+
+	if (!std::getline(file, line) || line != BOARD_TRACE_VERSION_LINE) {
+		return -2;
+	}
+
+	while (std::getline(file, line)) {
+		if (line.empty()) {
+			continue;
+		}
+
+		if (line[0] == '#') {
+			m_header = line.size() > 2 ? line.substr(2) : "";
+			continue;
+		}
+
+		std::istringstream fields(line);
+		TraceEvent event;
+
+		if (!(fields >> event.timeMs >> event.type >> event.pin >> event.value)) {
+			clear();
+			return -2;
+		}
+
+		m_events.push_back(event);
+	}
+
+	return 0;
+}
+
+/**
+ * Function which removes every event and the header
+ * Return value is 0 for success
+ */
+int BoardTrace::clear() {
+	m_events.clear();
+	m_header.clear();
+
+	return 0;
+}
+
+/**
+ * Function which returns the output pin edges of the trace: the writes that changed a pin's level (pins start LOW)
+ */
+BoardTrace BoardTrace::getTimeline() const {
+	BoardTrace timeline;
+	std::map<int, int> levels;
+
+	timeline.m_header = m_header;
+
+	for (const TraceEvent& event : m_events) {
+		if (event.type != TRACE_WRITE) {
+			continue;
+		}
+
+		int level = event.value ? 1 : 0;
+
+		if (levels[event.pin] != level) {
+			levels[event.pin] = level;
+			timeline.m_events.push_back(TraceEvent{event.timeMs, TRACE_WRITE, event.pin, level});
+		}
+	}
+
+	return timeline;
+}
+
+/**
+ * Function which compares the events of two traces (usually two timelines): same events in the same order,
+ * each at most toleranceMs apart (0 for a bit-exact match)
+ * @param maxDeviationMs: set to the largest time difference between matching events
+ * @param difference: set to a description of the first event that does not match
+ * @return 0: the traces match
+ * @return 1: they do not
+ */
+int BoardTrace::compare(const BoardTrace& other, unsigned int toleranceMs, unsigned int& maxDeviationMs, std::string& difference) const {
+	size_t count = std::min(m_events.size(), other.m_events.size());
+
+	maxDeviationMs = 0;
+	difference.clear();
+
+	for (size_t i = 0; i < count; i++) {
+		const TraceEvent& expected = m_events[i];
+		const TraceEvent& actual = other.m_events[i];
+		unsigned int deviationMs = std::abs((long) expected.timeMs - (long) actual.timeMs);
+
+		if (expected.type != actual.type || expected.pin != actual.pin || expected.value != actual.value || deviationMs > toleranceMs) {
+			std::ostringstream message;
+
+			message << "event " << i << ": expected " << expected.timeMs << " " << expected.type << " " << expected.pin << " " << expected.value;
+			message << ", got " << actual.timeMs << " " << actual.type << " " << actual.pin << " " << actual.value;
+			difference = message.str();
+			return 1;
+		}
+
+		maxDeviationMs = std::max(maxDeviationMs, deviationMs);
+	}
+
+	if (m_events.size() != other.m_events.size()) {
+		difference = "expected " + std::to_string(m_events.size()) + " events, got " + std::to_string(other.m_events.size());
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * Getter function which returns the events in the order they happened
+ */
+const std::vector<TraceEvent>& BoardTrace::getEvents() const {
+	return m_events;
+}
+
+/**
+ * Getter function which returns the free text saved with the trace
+ */
+const std::string& BoardTrace::getHeader() const {
+	return m_header;
+}
+
+/**
+ * Setter function for the free text saved with the trace (one line)
+ */
+void BoardTrace::setHeader(const std::string& header) {
+	m_header = header;
+}
+
+/**
+ * Getter function which returns the time of the last event (0 for an empty trace)
+ */
+unsigned int BoardTrace::getEndMs() const {
+	return m_events.empty() ? 0 : m_events.back().timeMs;
+}
@@ -5,11 +5,15 @@
  */
 
 #include "ButtonController.h"
+#include "WiringPiBoard.h"
+#include "Logger.h"
+#include "SpanTracer.h"
 #include <wiringPi.h>
-#include <iostream>
 #include "ssd1306_i2c.h"
 #include <stdio.h>
 #include <string.h>
+#include <cmath>
+#include <iterator>
 
 /**
  * Constructor
@@ -23,7 +27,18 @@
  * @param exeControl: reference to execution controller object
  *
  */
-ButtonController::ButtonController(int pinStart, int pinSetDimensions, int pinUpArrow, int pinDownArrow, State& currentState, Path& path, ExecutionController& exeControl) {
+ButtonController::ButtonController(int pinStart, int pinSetDimensions, int pinUpArrow, int pinDownArrow, State& currentState, Path& path, ExecutionController& exeControl)
+	: ButtonController(pinStart, pinSetDimensions, pinUpArrow, pinDownArrow, currentState, path, exeControl, WiringPiBoard::getInstance()) {
+
+}
+
+/**
+ * Constructor like the one above, for buttons wired to another board (e.g. a SimBoard)
+ *
+ * @param board: board the buttons are on
+ *
+ */
+ButtonController::ButtonController(int pinStart, int pinSetDimensions, int pinUpArrow, int pinDownArrow, State& currentState, Path& path, ExecutionController& exeControl, Board& board) {
 	m_pinStart = pinStart; // init variables
 	m_pinSetDimensions = pinSetDimensions;
 	m_pinUpArrow = pinUpArrow;
@@ -31,14 +46,28 @@ ButtonController::ButtonController(int pinStart, int pinSetDimensions, int pinUp
 	m_currentState = &currentState;
 	m_path = &path;
 	m_exeControl = &exeControl;
+	m_board = &board;
 	m_inputLength = 0;
 	m_inputWidth = 0;
 	m_errorNum = 0;
 	m_shutDownFlag = false;
-
-	ssd1306_begin(SSD1306_SWITCHCAPVCC, SSD1306_I2C_ADDRESS); // initialize screen for displaying states, info, etc.
-	welcomeScreen();
-	delay(3000);
+	m_cancelToken = nullptr;
+	m_emergencyStop = nullptr;
+	m_missionLog = nullptr;
+	m_displayReady = false;
+	m_screenShown = false;
+	m_edgeNs = 0;
+	m_uploadedPlan = nullptr;
+	m_uploadedStart = Pose{0, 0, 0};
+	m_buttonPins[0] = pinStart;
+	m_buttonPins[1] = pinSetDimensions;
+	m_buttonPins[2] = pinUpArrow;
+	m_buttonPins[3] = pinDownArrow;
+
+	for (int i = 0; i < BUTTON_COUNT; i++) {
+		m_buttonReleased[i] = false;
+		m_lastPressMs[i] = 0;
+	}
 }
 
 /**
@@ -70,80 +99,225 @@ int ButtonController::sendButtonPress(int pinButtonPressed) {
 	return 0;
 }
 
+/**
+ * Function that runs the button thread: polls the buttons and refreshes the display until shutdown.
+ * The inputs must have been set up with setupInputs() first (StartupOrchestrator does it once at start up)
+ * Return value is 0 for success
+ */
 int ButtonController::startInputListener() {
-    wiringPiSetup();
+	SpanTracer::getInstance().setThreadName("buttons");
+
+	unsigned int lastPoseRefresh = m_board->millis(); // the pose line on the mowing screen is redrawn once a second
+
+	while (!isShutDown()) {
+		if (m_board->millis() - lastPoseRefresh >= 1000) {
+			refreshDisplay();
+			lastPoseRefresh = m_board->millis();
+		}
+
+		pollButtons();
+	}
+
+	goodbyeScreen();
 
-	pinMode(m_pinStart, INPUT); // red
-    pullUpDnControl(m_pinStart, PUD_UP);
+	return 0;
+}
+
+/**
+ * Function that sets the button pins up as inputs with pull ups and shows the idle screen
+ * Return value is 0 for success
+ */
+int ButtonController::setupInputs() {
+	m_board->setup();
 
-    pinMode(m_pinSetDimensions, INPUT); // blue
-    pullUpDnControl(m_pinSetDimensions, PUD_UP);
+	m_board->pinMode(m_pinStart, INPUT); // red
+	m_board->pullUpDnControl(m_pinStart, PUD_UP);
 
-    pinMode(m_pinUpArrow, INPUT); // up yellow
-    pullUpDnControl(m_pinUpArrow, PUD_UP);
+	m_board->pinMode(m_pinSetDimensions, INPUT); // blue
+	m_board->pullUpDnControl(m_pinSetDimensions, PUD_UP);
 
-    pinMode(m_pinDownArrow, INPUT); // down yellow
-    pullUpDnControl(m_pinDownArrow, PUD_UP);
+	m_board->pinMode(m_pinUpArrow, INPUT); // up yellow
+	m_board->pullUpDnControl(m_pinUpArrow, PUD_UP);
 
-	// these flags are used to prevent multiple presses when the user holds a button down
-    bool buttonPressed = false;
-    bool buttonPressed2 = false;
-    bool buttonPressed3 = false;
-    bool buttonPressed4 = false;
+	m_board->pinMode(m_pinDownArrow, INPUT); // down yellow
+	m_board->pullUpDnControl(m_pinDownArrow, PUD_UP);
+
+	// a button held down at start up does not count as a press
+	for (int i = 0; i < BUTTON_COUNT; i++) {
+		m_buttonReleased[i] = m_board->digitalRead(m_buttonPins[i]) != LOW;
+	}
 
 	idleScreen();
 
-    while (!m_shutDownFlag) {
-        if (digitalRead(m_pinStart) == LOW) {
-            if (buttonPressed) {
-                std::cout << "Start button pressed" << std::endl;
-                buttonPressed = false;
-				onStart();
-                delay(500);
-            }
-        } else {
-            buttonPressed = true;
-        }
-        
-        if (digitalRead(m_pinSetDimensions) == LOW) {
-            if (buttonPressed2) {
-                std::cout << "Input button pressed" << std::endl;
-                buttonPressed2 = false;
-				onSetDimensions();
-                delay(500);
-            }
-        } else {
-            buttonPressed2 = true;
-        }
-
-        if (digitalRead(m_pinUpArrow) == LOW) {
-            if (buttonPressed3) {
-                std::cout << "Up button pressed" << std::endl;
-                buttonPressed3 = false;
-				onUpArrow();
-                delay(500);
-            }
-        } else {
-            buttonPressed3 = true;
-        }
-
-        if (digitalRead(m_pinDownArrow) == LOW) {
-            if (buttonPressed4) {
-                std::cout << "Down button pressed" << std::endl;
-                buttonPressed4 = false;
-				onDownArrow();
-                delay(500);
-            }
-        } else {
-            buttonPressed4 = true;
-        }  
-    }
+	return 0;
+}
+
+/**
+ * Function that initializes the screen and shows the welcome screen, which stays up until the next display refresh
+ * Can run on a start up thread while the buttons are already polled: the other screens are only drawn once this is done
+ * Return value is 0 for success
+ */
+int ButtonController::initDisplay() {
+	TRACE_SPAN("display", "initDisplay");
+
+	ssd1306_begin(SSD1306_SWITCHCAPVCC, SSD1306_I2C_ADDRESS); // initialize screen for displaying states, info, etc.
+	welcomeScreen();
+	m_displayReady = true;
+
+	return 0;
+}
+
+/**
+ * Setter function for a plan being generated on another thread: a start press waits for it (set before the buttons are live)
+ */
+int ButtonController::setPlanReady(std::shared_future<int> planReady) {
+	m_planReady = planReady;
+
+	return 0;
+}
+
+/**
+ * Function that reads every button once and calls the callback of each new press (buttons pull the pin LOW)
+ * Never blocks, so it can run in a loop (button thread) or whenever a pin changes (reactor runtime)
+ * @return the number of presses handled
+ */
+int ButtonController::pollButtons() {
+	const char* names[BUTTON_COUNT] = {"Start", "Input", "Up", "Down"};
+	int presses = 0;
+
+	for (int i = 0; i < BUTTON_COUNT; i++) {
+		if (m_board->digitalRead(m_buttonPins[i]) != LOW) {
+			m_buttonReleased[i] = true;
+			continue;
+		}
+
+		if (!m_buttonReleased[i]) {
+			continue;
+		}
+
+		m_buttonReleased[i] = false;
+
+		unsigned int now = m_board->millis();
+
+		if (now - m_lastPressMs[i] < BUTTON_LOCKOUT_MS && m_lastPressMs[i] != 0) {
+			continue;
+		}
+
+		m_lastPressMs[i] = now;
+		long long pressNs = m_edgeNs != 0 ? m_edgeNs : LatencyHistogram::now();
+		LOG_INFO("button", "%s button pressed", names[i]);
+
+		if (m_missionLog != nullptr) {
+			m_missionLog->logButton(m_buttonPins[i]);
+		}
+
+		sendButtonPress(m_buttonPins[i]);
+		m_pressHistogram.recordSince(pressNs);
+		presses++;
+	}
+
+	m_edgeNs = 0;
+
+	return presses;
+}
+
+/**
+ * Function that redraws the mowing screen (the pose line changes while mowing), called about once a second
+ * Return value is 0 for success
+ */
+int ButtonController::refreshDisplay() {
+	if (!m_displayReady) {
+		return 0;
+	}
+
+	if (!m_screenShown) { // first refresh since initDisplay(), replace the welcome screen
+		m_screenShown = true;
+
+		if (*m_currentState == IDLE) {
+			idleScreen();
+		} else if (*m_currentState == PAUSED) {
+			pausedScreen();
+		}
+	}
 
+	if (*m_currentState == MOWING) {
+		mowingScreen();
+	}
+
+	return 0;
+}
+
+/**
+ * Function that shows the goodbye screen, used by runtimes that do not run startInputListener()
+ */
+void ButtonController::showGoodbye() {
 	goodbyeScreen();
+}
+
+/**
+ * Getter function, returns whether the shutdown button has been pressed (or the cancellation token cancelled)
+ */
+bool ButtonController::isShutDown() {
+	return m_shutDownFlag || (m_cancelToken != nullptr && m_cancelToken->isCancelled());
+}
+
+/**
+ * Setter function for the (optional) e-stop, a start press is needed to clear its fault
+ */
+int ButtonController::setEmergencyStop(EmergencyStop& emergencyStop) {
+	m_emergencyStop = &emergencyStop;
+
+	return 0;
+}
+
+/**
+ * Setter function for the (optional) mission log, which records the button presses and the state changes they make
+ */
+int ButtonController::setMissionLog(MissionLog& missionLog) {
+	m_missionLog = &missionLog;
+
+	return 0;
+}
+
+/**
+ * Setter function for the time (CLOCK_MONOTONIC ns) of the pin edge that triggers the next pollButtons(), e.g. the
+ * kernel's edge timestamp, so the press latency counts from the edge rather than from the poll
+ */
+int ButtonController::setEdgeTime(long long edgeNs) {
+	m_edgeNs = edgeNs;
+
+	return 0;
+}
+
+/**
+ * Setter function for a plan uploaded through the ControlServer, which the next start mows instead of the lawn entered
+ * on the buttons (until new dimensions are entered)
+ * @param plan: must outlive its use, nullptr to go back to the lawn entered
+ * @param start: pose the plan starts from
+ */
+int ButtonController::setUploadedPlan(const Plan* plan, const Pose& start) {
+	m_uploadedPlan = plan;
+	m_uploadedStart = start;
 
 	return 0;
 }
 
+/**
+ * Setter function for the token shared with the executor, so a shutdown from anywhere also ends the button listener
+ */
+int ButtonController::setCancellationToken(CancellationToken& token) {
+	m_cancelToken = &token;
+
+	return 0;
+}
+
+/**
+ * Getter function, returns the button pins (start, set dimensions, up, down)
+ */
+std::vector<int> ButtonController::getButtonPins() {
+	return std::vector<int>(std::begin(m_buttonPins), std::end(m_buttonPins));
+}
+
 /**
  * Getter function, returns the current state
  */
@@ -158,39 +332,70 @@ int ButtonController::getErrorNum() {
 	return m_errorNum;
 }
 
+/**
+ * Getter function, returns how long presses took from the edge (or from being seen) to their handler returning
+ */
+const LatencyHistogram& ButtonController::getPressHistogram() {
+	return m_pressHistogram;
+}
+
+/**
+ * Getter function, returns how long each frame took to send to the OLED display
+ */
+const LatencyHistogram& ButtonController::getFrameHistogram() {
+	return m_frameHistogram;
+}
+
 /**
  * Function to determine what state we should move to when red button is pressed
  * @return 0: success
  * @return -2: failure, -2 is more specific so we set that to see where code is developing errors
  */
 int ButtonController::onStart() {
+	TRACE_SPAN("buttons", "onStart");
+
+	waitForPlan();
+
+	// after an e-stop the start button only acknowledges the fault: the mission is dropped and the fault cleared once the e-stop is released
+	if (m_emergencyStop != nullptr && m_emergencyStop->isLatched()) {
+		m_exeControl->clearInstructions();
+		setState(IDLE);
+		m_emergencyStop->reset();
+		idleScreen();
+		return 0;
+	}
+
 	switch (*m_currentState) {
 		case IDLE: // if curr state is idle and red button pressed... etc.
-			// tell executionController to start executing instructions
-			m_exeControl->assignInstructions();
-			*m_currentState = MOWING;
+			// tell executionController to start executing instructions (an uploaded plan, or the one for the lawn entered)
+			if (m_uploadedPlan != nullptr) {
+				m_exeControl->assignInstructions(*m_uploadedPlan, m_uploadedStart);
+			} else {
+				m_exeControl->assignInstructions();
+			}
+			setState(MOWING);
 			mowingScreen();
 			break;
 		case MOWING:
 			// tell executionController to stop executing instructions, end current mowing job
 			m_exeControl->clearInstructions();
-			*m_currentState = IDLE;
+			setState(IDLE);
 			idleScreen();
 			break;
 		case INPUT_LENGTH:
 			// don't set new inputs
-			*m_currentState = IDLE;
+			setState(IDLE);
 			idleScreen();
 			break;
 		case INPUT_WIDTH:
 			// don't set new inputs
-			*m_currentState = IDLE;
+			setState(IDLE);
 			idleScreen();
 			break;
 		case PAUSED:
 			// tell executionController to stop executing instructions, end current mowing job
 			m_exeControl->clearInstructions();
-			*m_currentState = IDLE;
+			setState(IDLE);
 			idleScreen();
 			break;
 		default:
@@ -207,32 +412,37 @@ int ButtonController::onStart() {
  * @return -2: failure, -2 is more specific so we set that to see where code is developing errors
  */
 int ButtonController::onSetDimensions() {
+	TRACE_SPAN("buttons", "onSetDimensions");
+
+	waitForPlan();
+
 	switch (*m_currentState) {
 		case IDLE: // if blue button pressed and currently on idle state
 			m_inputLength = 0;
 			m_inputWidth = 0;
-			*m_currentState = INPUT_LENGTH;
+			setState(INPUT_LENGTH);
 			lwInputMode((char*) m_inputLength, 1, INPUT_LENGTH);
 			break;
 		case MOWING:
 			// tell executionController to pause executing instructions
-			*m_currentState = PAUSED;
+			setState(PAUSED);
 			pausedScreen();
 			break;
 		case INPUT_LENGTH:
 			// accept length input, listen for width input
-			*m_currentState = INPUT_WIDTH;
+			setState(INPUT_WIDTH);
 			lwInputMode((char*) m_inputWidth, 1, INPUT_WIDTH);
 			break;
 		case INPUT_WIDTH:
-			// send new dimensions to path object
+			// send new dimensions to path object, the next start mows them instead of an uploaded plan
 			m_path->setDimensions(m_inputLength, m_inputWidth);
-			*m_currentState = IDLE;
+			m_uploadedPlan = nullptr;
+			setState(IDLE);
 			idleScreen();
 			break;
 		case PAUSED:
 			// tell executionController to resume executing instructions
-			*m_currentState = MOWING;
+			setState(MOWING);
 			mowingScreen();
 			break;
 		default:
@@ -249,6 +459,8 @@ int ButtonController::onSetDimensions() {
  * @return -2: failure, -2 is more specific so we set that to see where code is developing errors
  */
 int ButtonController::onUpArrow() {
+	TRACE_SPAN("buttons", "onUpArrow");
+
 	switch (*m_currentState) {
 		case IDLE: // up arrow has no functionality on idle/paused/mowing state
 			break;
@@ -278,6 +490,8 @@ int ButtonController::onUpArrow() {
  * @return -2: failure, -2 is more specific so we set that to see where code is developing errors
  */
 int ButtonController::onDownArrow() {
+	TRACE_SPAN("buttons", "onDownArrow");
+
 	switch (*m_currentState) {
 		case IDLE: // down arrow is used to send immediate shutdown signal (end all threads) when not in input mode
 			m_shutDownFlag = true;
@@ -311,8 +525,13 @@ void ButtonController::goodbyeScreen() {
 }
 
 void ButtonController::welcomeScreen() {
-	drawText(calcX("NoMo Lawn: WELCOME :)"), 32, "NoMo Lawn: WELCOME :)", 1, "IDLE");
-	displayTemp();
+	// drawn by initDisplay() before the display is marked ready, so it skips the checks in drawText() and displayTemp()
+	writeText(calcX("NoMo Lawn: WELCOME :)"), 32, "NoMo Lawn: WELCOME :)", 1, "IDLE");
+	TRACE_SPAN("display", "ssd1306_display");
+	long long startNs = LatencyHistogram::now();
+	ssd1306_display();
+	m_frameHistogram.recordSince(startNs);
+	ssd1306_clearDisplay();
 }
 
 void ButtonController::idleScreen() {
@@ -323,11 +542,13 @@ void ButtonController::idleScreen() {
 
 void ButtonController::mowingScreen() {
 	drawText(calcX("CURRENTLY MOWING!"), 32, "CURRENTLY MOWING!", 1, "MOWING");
+	drawPose("MOWING");
 	displayTemp();
 }
 
 void ButtonController::pausedScreen() {
 	drawText(calcX("CURRENTLY PAUSED!"), 32, "CURRENTLY PAUSED!", 1, "PAUSED");
+	drawPose("PAUSED");
 	displayTemp();
 }
 
@@ -361,11 +582,18 @@ void ButtonController::lwInputMode(char* val, int decider, State state) {
 }
 
 void ButtonController::displayTemp() {
+	if (!m_displayReady) {
+		return;
+	}
+
+	TRACE_SPAN("display", "ssd1306_display");
+	long long startNs = LatencyHistogram::now();
 	ssd1306_display();												// actually display
+	m_frameHistogram.recordSince(startNs);
 	ssd1306_clearDisplay();											// clear display
 }
 
-void ButtonController::staticDisplays(char* state) {
+void ButtonController::staticDisplays(const char* state) {
 	char final[50];
 	strcpy(final, "STATE:");
 	strcat(final, state);
@@ -390,7 +618,15 @@ int ButtonController::calcX(char* str) {
 	return (64 - ((count / 2) * 6));
 }
 
-void ButtonController::drawText(int x, int y, char* s, int size, char* state) {
+void ButtonController::drawText(int x, int y, char* s, int size, const char* state) {
+	if (!m_displayReady) { // initDisplay() has not finished yet
+		return;
+	}
+
+	writeText(x, y, s, size, state);
+}
+
+void ButtonController::writeText(int x, int y, char* s, int size, const char* state) {
 	staticDisplays(state);
 
 	char* c = s;
@@ -400,3 +636,42 @@ void ButtonController::drawText(int x, int y, char* s, int size, char* state) {
 		x += 6;
 	}
 }
+
+void ButtonController::drawPose(const char* state) {
+	Pose pose;
+
+	if (m_exeControl->getPose(pose) != 0) { // no pose estimator attached
+		return;
+	}
+
+	int heading = ((int) std::lround(pose.theta * 180.0 / M_PI) % 360 + 360) % 360;
+	char s[24];
+
+	snprintf(s, sizeof(s), "X:%.1f Y:%.1f H:%d", pose.x, pose.y, heading);
+	drawText(calcX(s), 32 + 16, s, 1, state);
+}
+
+/**
+ * Function that blocks until the plan generated at start up is ready (returns straight away after that)
+ */
+void ButtonController::waitForPlan() {
+	if (m_planReady.valid()) {
+		m_planReady.wait();
+	}
+}
+
+/**
+ * Function that changes the mower's state, and records the change in the mission log
+ */
+void ButtonController::setState(State state) {
+	if (m_missionLog != nullptr) {
+		m_missionLog->logState(*m_currentState, state);
+	}
+
+	// the executor times how long the motors take to follow (marked first, the executor may act on the state at once)
+	if (state == MOWING || state == PAUSED) {
+		m_exeControl->markStateChange();
+	}
+
+	*m_currentState = state;
+}
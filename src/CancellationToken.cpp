@@ -0,0 +1,92 @@
+/**
+ * This file contains the implementation of the CancellationToken class and all associated member functions that are included in the CancellationToken.h file.
+ * The CancellationToken class makes blocking waits interruptible and stops the motors on shutdown.
+ *
+ */
+
+#include "CancellationToken.h"
+#include <algorithm>
+#include <chrono>
+
+/**
+ * Constructor, the token starts not cancelled
+ */
+CancellationToken::CancellationToken() : m_cancelled(false) {
+
+}
+
+/**
+ * Member function destructor which deletes an object: no return
+ */
+CancellationToken::~CancellationToken() {
+
+}
+
+/**
+ * Function which cancels the token: wakes every sleepFor() and runs the registered callbacks on this thread
+ * @return 0: success
+ * @return -1: the token was already cancelled
+ */
+int CancellationToken::cancel() {
+	std::vector<std::function<void()>> callbacks;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (m_cancelled) {
+			return -1;
+		}
+
+		m_cancelled = true;
+		callbacks = m_callbacks;
+	}
+
+	m_wakeUp.notify_all();
+
+	for (const std::function<void()>& callback : callbacks) {
+		callback();
+	}
+
+	return 0;
+}
+
+/**
+ * Getter function which returns whether the token has been cancelled
+ */
+bool CancellationToken::isCancelled() const {
+	return m_cancelled;
+}
+
+/**
+ * Function which blocks for the given number of milliseconds, or until the token is cancelled
+ * @return the milliseconds actually slept (less than asked if the token was cancelled)
+ */
+unsigned int CancellationToken::sleepFor(unsigned int milliseconds) {
+	auto start = std::chrono::steady_clock::now();
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	m_wakeUp.wait_for(lock, std::chrono::milliseconds(milliseconds), [this]() { return m_cancelled.load(); });
+
+	auto slept = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+	return m_cancelled ? std::min((unsigned int) slept, milliseconds) : milliseconds;
+}
+
+/**
+ * Function which registers a callback to run when the token is cancelled (straight away if it already is)
+ * Callbacks run on the cancelling thread, so they must be quick and thread safe (e.g. writing pins LOW)
+ */
+int CancellationToken::onCancel(std::function<void()> callback) {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (!m_cancelled) {
+			m_callbacks.push_back(callback);
+			return 0;
+		}
+	}
+
+	callback();
+
+	return 0;
+}
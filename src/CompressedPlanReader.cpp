@@ -0,0 +1,358 @@
+/**
+ * This file contains the implementation of the CompressedPlanReader class and all associated member functions that are included in the CompressedPlanReader.h file.
+ * The CompressedPlanReader class checks a compressed plan and expands its runs and loops one instruction at a time.
+ *
+ */
+
+#include "CompressedPlanReader.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const uint64_t COMPRESSED_PLAN_MAX_INSTRUCTIONS = 1ULL << 48; // larger counts are taken for a corrupt file
+
+/**
+ * Constructor, nothing to read until open()
+ */
+CompressedPlanReader::CompressedPlanReader() {
+	m_mapping = nullptr;
+	m_size = 0;
+	close();
+}
+
+/**
+ * Member function destructor which unmaps the file: no return
+ */
+CompressedPlanReader::~CompressedPlanReader() {
+	close();
+}
+
+/**
+ * Function which maps a compressed plan file and checks it
+ * @return 0: success
+ * @return -1: the file could not be opened or mapped
+ * @return -2: the file is not a compressed plan, or is corrupt
+ */
+int CompressedPlanReader::open(const std::string& path) {
+	close();
+
+	int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	struct stat status;
+
+	if (fd < 0) {
+		return -1;
+	}
+
+	if (fstat(fd, &status) != 0) {
+		::close(fd);
+		return -1;
+	}
+
+	size_t size = status.st_size;
+
+	if (size < sizeof(CompressedPlanHeader)) {
+		::close(fd);
+		return -2;
+	}
+
+	void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+
+	if (mapping == MAP_FAILED) {
+		return -1;
+	}
+
+	if (check(static_cast<const unsigned char*>(mapping), size) != 0) {
+		munmap(mapping, size);
+		close();
+		return -2;
+	}
+
+	m_mapping = mapping;
+	m_size = size;
+
+	return 0;
+}
+
+/**
+ * Function which reads a compressed plan from memory (e.g. CompressedPlanWriter::getData()) and checks it
+ * @param data: must stay valid until close()
+ * @return 0: success
+ * @return -2: the data is not a compressed plan, or is corrupt
+ */
+int CompressedPlanReader::open(const unsigned char* data, size_t size) {
+	close();
+
+	if (check(data, size) != 0) {
+		close();
+		return -2;
+	}
+
+	m_size = size;
+
+	return 0;
+}
+
+/**
+ * Function which unmaps the file, next() then has nothing to read
+ * Return value is 0 for success
+ */
+int CompressedPlanReader::close() {
+	if (m_mapping != nullptr) {
+		munmap(m_mapping, m_size);
+		m_mapping = nullptr;
+	}
+
+	m_size = 0;
+	m_symbols = nullptr;
+	m_symbolCount = 0;
+	m_symbolSize = 0;
+	m_ops = nullptr;
+	m_opsEnd = nullptr;
+	m_instructionCount = 0;
+
+	return rewind();
+}
+
+/**
+ * Function which decodes the next instruction of the plan
+ * @param instruction: receives the instruction, blade schedule included
+ * @return 1: an instruction was decoded
+ * @return 0: the plan is over (or nothing is open)
+ */
+int CompressedPlanReader::next(Instruction& instruction) {
+	while (m_runLeft == 0) {
+		if (m_depth > 0 && m_position == m_loops[m_depth - 1].end) {
+			Loop& loop = m_loops[m_depth - 1];
+
+			if (loop.repeats > 0) {
+				loop.repeats--;
+				m_position = loop.body;
+			} else {
+				m_depth--;
+			}
+
+			continue;
+		}
+
+		if (m_position >= m_opsEnd) {
+			return 0;
+		}
+
+		// open() has checked every op, so they are read without checking again
+		uint64_t op;
+		uint64_t argument;
+
+		m_position = readVarint(m_position, m_opsEnd, op);
+
+		switch (op & 3) {
+			case PLAN_OP_SYMBOL:
+				m_runSymbol = op >> 2;
+				m_runLeft = 1;
+				break;
+			case PLAN_OP_RUN:
+				m_runSymbol = op >> 2;
+				m_position = readVarint(m_position, m_opsEnd, m_runLeft);
+				break;
+			default: // PLAN_OP_LOOP
+				m_position = readVarint(m_position, m_opsEnd, argument);
+				m_loops[m_depth] = Loop{m_position, m_position + argument, (op >> 2) - 1};
+				m_depth++;
+				break;
+		}
+	}
+
+	CompressedPlanSymbol symbol;
+
+	memset(&symbol, 0, sizeof(symbol));
+	memcpy(&symbol, m_symbols + (size_t) m_runSymbol * m_symbolSize, std::min((size_t) m_symbolSize, sizeof(symbol)));
+	instruction.action.code[0] = symbol.action[0];
+	instruction.action.code[1] = symbol.action[1];
+	instruction.action.code[2] = '\0';
+	instruction.value = symbol.value;
+	instruction.cutting = symbol.cutting != 0;
+	instruction.preSpinMs = symbol.preSpinMs;
+	instruction.durationMs = symbol.durationMs;
+	m_runLeft--;
+	m_decodedCount++;
+
+	return 1;
+}
+
+/**
+ * Function which goes back to the first instruction of the plan
+ * Return value is 0 for success
+ */
+int CompressedPlanReader::rewind() {
+	m_position = m_ops;
+	m_runSymbol = 0;
+	m_runLeft = 0;
+	m_depth = 0;
+	m_decodedCount = 0;
+
+	return 0;
+}
+
+/**
+ * Getter function which returns whether a plan is open
+ */
+bool CompressedPlanReader::isOpen() {
+	return m_ops != nullptr;
+}
+
+/**
+ * Getter function which returns how many instructions the plan has
+ */
+size_t CompressedPlanReader::getInstructionCount() {
+	return m_instructionCount;
+}
+
+/**
+ * Getter function which returns how many instructions next() has still to decode
+ */
+size_t CompressedPlanReader::getRemainingCount() {
+	return m_instructionCount - m_decodedCount;
+}
+
+/**
+ * Getter function which returns the size of the compressed plan in bytes
+ */
+size_t CompressedPlanReader::getFileSize() {
+	return m_size;
+}
+
+/**
+ * Function which checks a compressed plan and points the reader at it
+ * @return 0: success, -1: not a compressed plan, or corrupt
+ */
+int CompressedPlanReader::check(const unsigned char* data, size_t size) {
+	CompressedPlanHeader header;
+
+	if (size < sizeof(header)) {
+		return -1;
+	}
+
+	memcpy(&header, data, sizeof(header));
+
+	// later versions only add fields at the end of the header and of the symbols
+	if (header.magic != COMPRESSED_PLAN_MAGIC || header.version < 1 || header.headerSize < sizeof(CompressedPlanHeader)
+		|| header.symbolSize < COMPRESSED_PLAN_SYMBOL_V1_SIZE || header.symbolCount > COMPRESSED_PLAN_MAX_SYMBOLS
+		|| header.instructionCount > COMPRESSED_PLAN_MAX_INSTRUCTIONS) {
+		return -1;
+	}
+
+	uint64_t symbolsEnd = (uint64_t) header.headerSize + (uint64_t) header.symbolCount * header.symbolSize;
+
+	if (symbolsEnd > size || header.opBytes > size - symbolsEnd) {
+		return -1;
+	}
+
+	for (uint32_t i = 0; i < header.symbolCount; i++) {
+		CompressedPlanSymbol symbol;
+		ActionCode action;
+
+		memset(&symbol, 0, sizeof(symbol));
+		memcpy(&symbol, data + header.headerSize + (size_t) i * header.symbolSize, std::min((size_t) header.symbolSize, sizeof(symbol)));
+		action.code[0] = symbol.action[0];
+		action.code[1] = symbol.action[1];
+
+		if ((action != "MF" && action != "MB" && action != "TL" && action != "TR" && action != "CH") || !std::isfinite(symbol.value)) {
+			return -1;
+		}
+	}
+
+	uint64_t count;
+
+	m_symbols = data + header.headerSize;
+	m_symbolCount = header.symbolCount;
+	m_symbolSize = header.symbolSize;
+
+	if (countOps(data + symbolsEnd, data + symbolsEnd + header.opBytes, 0, count) != 0 || count != header.instructionCount) {
+		return -1;
+	}
+
+	m_ops = data + symbolsEnd;
+	m_opsEnd = m_ops + header.opBytes;
+	m_instructionCount = header.instructionCount;
+
+	return rewind();
+}
+
+/**
+ * Function which checks the ops [begin, end) and adds up the instructions they expand to, every loop body is read once
+ * @param depth: loops the ops are inside of
+ * @return 0: success, -1: an op is cut off, refers to a symbol that does not exist, or has an empty or oversized loop or run
+ */
+int CompressedPlanReader::countOps(const unsigned char* begin, const unsigned char* end, int depth, uint64_t& count) {
+	const unsigned char* position = begin;
+
+	count = 0;
+
+	while (position < end) {
+		uint64_t op;
+		uint64_t argument;
+		uint64_t bodyCount;
+
+		position = readVarint(position, end, op);
+
+		if (position == nullptr) {
+			return -1;
+		}
+
+		switch (op & 3) {
+			case PLAN_OP_SYMBOL:
+				argument = 1;
+				break;
+			case PLAN_OP_RUN:
+				position = readVarint(position, end, argument);
+				break;
+			case PLAN_OP_LOOP:
+				position = readVarint(position, end, argument);
+
+				if (position == nullptr || depth >= COMPRESSED_PLAN_MAX_DEPTH || argument == 0 || argument > (uint64_t) (end - position)
+					|| countOps(position, position + argument, depth + 1, bodyCount) != 0
+					|| bodyCount == 0 || (op >> 2) == 0 || bodyCount > COMPRESSED_PLAN_MAX_INSTRUCTIONS / (op >> 2)) {
+					return -1;
+				}
+
+				position += argument;
+				argument = bodyCount * (op >> 2);
+				break;
+			default:
+				return -1;
+		}
+
+		if (position == nullptr || argument == 0 || argument > COMPRESSED_PLAN_MAX_INSTRUCTIONS - count
+			|| ((op & 3) != PLAN_OP_LOOP && (op >> 2) >= m_symbolCount)) {
+			return -1;
+		}
+
+		count += argument;
+	}
+
+	return 0;
+}
+
+/**
+ * Function which reads a LEB128 varint (see CompressedPlanWriter::appendVarint())
+ * @return the position after the varint, nullptr if it is cut off or longer than 64 bits
+ */
+const unsigned char* CompressedPlanReader::readVarint(const unsigned char* position, const unsigned char* end, uint64_t& value) {
+	value = 0;
+
+	for (int shift = 0; position < end && shift < 64; shift += 7) {
+		unsigned char byte = *position++;
+
+		value |= (uint64_t) (byte & 0x7f) << shift;
+
+		if ((byte & 0x80) == 0) {
+			return position;
+		}
+	}
+
+	return nullptr;
+}
@@ -0,0 +1,220 @@
+/**
+ * This file contains the implementation of the CompressedPlanWriter class and all associated member functions that are included in the CompressedPlanWriter.h file.
+ * The CompressedPlanWriter class finds the different instructions of a plan and the runs and loops they repeat in.
+ *
+ */
+
+#include "CompressedPlanWriter.h"
+#include <cstring>
+#include <map>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * Constructor, empty until compress()
+ */
+CompressedPlanWriter::CompressedPlanWriter() {
+	m_instructionCount = 0;
+	m_opCount = 0;
+}
+
+/**
+ * Member function destructor which deletes an object: no return
+ */
+CompressedPlanWriter::~CompressedPlanWriter() {
+
+}
+
+/**
+ * Function which compresses a plan into the file format, ready for write() or getData()
+ * @return 0: success
+ * @return -1: the plan has more than COMPRESSED_PLAN_MAX_SYMBOLS different instructions
+ */
+int CompressedPlanWriter::compress(const Plan& plan) {
+	std::map<std::string, uint32_t> indices; // symbol bytes to index
+	std::vector<unsigned char> ops;
+
+	m_symbols.clear();
+	m_sequence.clear();
+	m_sequence.reserve(plan.size());
+	m_data.clear();
+	m_instructionCount = 0;
+	m_opCount = 0;
+
+	for (const Instruction& instruction : plan) {
+		CompressedPlanSymbol symbol;
+
+		memset(&symbol, 0, sizeof(symbol));
+		memcpy(symbol.action, instruction.action.c_str(), sizeof(symbol.action));
+		symbol.cutting = instruction.cutting ? 1 : 0;
+		symbol.preSpinMs = instruction.preSpinMs;
+		symbol.value = instruction.value;
+		symbol.durationMs = instruction.durationMs;
+
+		auto found = indices.emplace(std::string(reinterpret_cast<const char*>(&symbol), sizeof(symbol)), m_symbols.size());
+
+		if (found.second) {
+			if (m_symbols.size() >= COMPRESSED_PLAN_MAX_SYMBOLS) {
+				m_symbols.clear();
+				m_sequence.clear();
+				return -1;
+			}
+
+			m_symbols.push_back(symbol);
+		}
+
+		m_sequence.push_back(found.first->second);
+	}
+
+	encode(0, m_sequence.size(), 0, ops);
+
+	CompressedPlanHeader header;
+
+	memset(&header, 0, sizeof(header));
+	header.magic = COMPRESSED_PLAN_MAGIC;
+	header.version = COMPRESSED_PLAN_VERSION;
+	header.headerSize = sizeof(CompressedPlanHeader);
+	header.instructionCount = plan.size();
+	header.symbolCount = m_symbols.size();
+	header.symbolSize = sizeof(CompressedPlanSymbol);
+	header.opBytes = ops.size();
+
+	const unsigned char* headerBytes = reinterpret_cast<const unsigned char*>(&header);
+	const unsigned char* symbolBytes = reinterpret_cast<const unsigned char*>(m_symbols.data());
+
+	m_data.reserve(sizeof(header) + m_symbols.size() * sizeof(CompressedPlanSymbol) + ops.size());
+	m_data.insert(m_data.end(), headerBytes, headerBytes + sizeof(header));
+	m_data.insert(m_data.end(), symbolBytes, symbolBytes + m_symbols.size() * sizeof(CompressedPlanSymbol));
+	m_data.insert(m_data.end(), ops.begin(), ops.end());
+	m_instructionCount = plan.size();
+	m_sequence.clear();
+
+	return 0;
+}
+
+/**
+ * Function which writes the last plan compressed to a file (an existing file is replaced)
+ * @return 0: success
+ * @return -1: nothing compressed yet, or the file could not be written
+ */
+int CompressedPlanWriter::write(const std::string& path) {
+	if (m_data.empty()) {
+		return -1;
+	}
+
+	int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	size_t done = 0;
+
+	if (fd < 0) {
+		return -1;
+	}
+
+	while (done < m_data.size()) {
+		ssize_t written = ::write(fd, m_data.data() + done, m_data.size() - done);
+
+		if (written <= 0) {
+			close(fd);
+			return -1;
+		}
+
+		done += written;
+	}
+
+	return close(fd) == 0 ? 0 : -1;
+}
+
+/**
+ * Getter function which returns the last plan compressed, as it is written to a file
+ */
+const std::vector<unsigned char>& CompressedPlanWriter::getData() {
+	return m_data;
+}
+
+/**
+ * Getter function which returns how many instructions the last plan compressed has
+ */
+size_t CompressedPlanWriter::getInstructionCount() {
+	return m_instructionCount;
+}
+
+/**
+ * Getter function which returns how many different instructions the last plan compressed has
+ */
+size_t CompressedPlanWriter::getSymbolCount() {
+	return m_symbols.size();
+}
+
+/**
+ * Getter function which returns how many ops the last plan compressed took (a loop body counted once)
+ */
+long CompressedPlanWriter::getOpCount() {
+	return m_opCount;
+}
+
+/**
+ * Function which encodes the instructions [begin, end) of m_sequence as ops
+ * At every instruction the group of up to COMPRESSED_PLAN_MAX_PERIOD instructions that repeats for longest from there
+ * is taken: a run if it is one instruction, a loop (whose body is encoded the same way) otherwise.
+ * A repeat too short to save anything is left as single instructions.
+ *
+ * @param depth: loops the ops are inside of
+ * @param ops: the ops are appended to it
+ * Return value is 0 for success
+ */
+int CompressedPlanWriter::encode(size_t begin, size_t end, int depth, std::vector<unsigned char>& ops) {
+	size_t i = begin;
+
+	while (i < end) {
+		size_t bestPeriod = 0;
+		size_t bestRepeats = 0;
+
+		for (size_t period = 1; period <= (size_t) COMPRESSED_PLAN_MAX_PERIOD && i + 2 * period <= end; period++) {
+			size_t repeated = i + period;
+
+			while (repeated < end && m_sequence[repeated] == m_sequence[repeated - period]) {
+				repeated++;
+			}
+
+			size_t repeats = (repeated - i) / period;
+
+			// ties go to the shorter group, e.g. a serpentine is 8 instructions repeated, not 16 repeated half as often
+			if (repeats >= 2 && repeats * period > bestRepeats * bestPeriod) {
+				bestPeriod = period;
+				bestRepeats = repeats;
+			}
+		}
+
+		if (bestPeriod == 1 && bestRepeats >= 3) {
+			appendVarint((uint64_t) m_sequence[i] << 2 | PLAN_OP_RUN, ops);
+			appendVarint(bestRepeats, ops);
+			i += bestRepeats;
+		} else if (bestPeriod > 1 && (bestRepeats - 1) * bestPeriod >= 3 && depth < COMPRESSED_PLAN_MAX_DEPTH) {
+			std::vector<unsigned char> body;
+
+			encode(i, i + bestPeriod, depth + 1, body);
+			appendVarint((uint64_t) bestRepeats << 2 | PLAN_OP_LOOP, ops);
+			appendVarint(body.size(), ops);
+			ops.insert(ops.end(), body.begin(), body.end());
+			i += bestPeriod * bestRepeats;
+		} else {
+			appendVarint((uint64_t) m_sequence[i] << 2 | PLAN_OP_SYMBOL, ops);
+			i++;
+		}
+
+		m_opCount++;
+	}
+
+	return 0;
+}
+
+/**
+ * Function which appends a LEB128 varint: 7 bits per byte, low bits first, the top bit set on every byte but the last
+ */
+void CompressedPlanWriter::appendVarint(uint64_t value, std::vector<unsigned char>& ops) {
+	while (value >= 0x80) {
+		ops.push_back((value & 0x7f) | 0x80);
+		value >>= 7;
+	}
+
+	ops.push_back(value);
+}
@@ -0,0 +1,180 @@
+/**
+ * This file contains the implementation of the ControlClient class and all associated member functions that are included in the ControlClient.h file.
+ * The ControlClient class sends requests to a ControlServer and waits for the replies.
+ *
+ */
+
+#include "ControlClient.h"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+ * Constructor, not connected until open()
+ */
+ControlClient::ControlClient() {
+	m_fd = -1;
+	m_nextId = 1;
+}
+
+/**
+ * Member function destructor which closes the connection: no return
+ */
+ControlClient::~ControlClient() {
+	close();
+}
+
+/**
+ * Function which connects to a ControlServer
+ * @return 0: success
+ * @return -1: nothing is listening on the path
+ */
+int ControlClient::open(const std::string& path) {
+	sockaddr_un address = {};
+
+	if (path.size() >= sizeof(address.sun_path)) {
+		return -1;
+	}
+
+	close();
+
+	int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, path.c_str());
+
+	if (fd < 0 || connect(fd, (sockaddr*) &address, sizeof(address)) != 0) {
+		if (fd >= 0) {
+			::close(fd);
+		}
+
+		return -1;
+	}
+
+	m_fd = fd;
+
+	return 0;
+}
+
+/**
+ * Function which closes the connection
+ * Return value is 0 for success
+ */
+int ControlClient::close() {
+	if (m_fd >= 0) {
+		::close(m_fd);
+		m_fd = -1;
+	}
+
+	return 0;
+}
+
+/**
+ * Function which sends a command (anything but CONTROL_UPLOAD) and waits for the reply
+ * @return 0: the reply arrived, reply.result says whether the command was carried out
+ * @return -1: not connected, or the connection was lost
+ */
+int ControlClient::sendCommand(ControlCommand command, ControlReply& reply) {
+	return request(command, -1, reply);
+}
+
+/**
+ * Function which uploads a plan for the next start and waits for the reply
+ * The plan is written to a sealed memfd which is passed to the server, only the request goes through the socket
+ *
+ * @param plan: MF, MB, TL and TR instructions
+ * @param start: pose the mower starts the plan from
+ * @return 0: the reply arrived, reply.result says whether the plan was accepted
+ * @return -1: not connected, the connection was lost or the memfd could not be made
+ */
+int ControlClient::uploadPlan(const Plan& plan, const Pose& start, ControlReply& reply) {
+	size_t size = sizeof(ControlPlanHeader) + plan.size() * sizeof(ControlPlanInstruction);
+	int planFd = memfd_create("nomo_plan", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+
+	if (planFd < 0) {
+		return -1;
+	}
+
+	void* mapping = ftruncate(planFd, size) == 0 ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, planFd, 0) : MAP_FAILED;
+
+	if (mapping == MAP_FAILED) {
+		::close(planFd);
+		return -1;
+	}
+
+	ControlPlanHeader* header = static_cast<ControlPlanHeader*>(mapping);
+	ControlPlanInstruction* instructions = reinterpret_cast<ControlPlanInstruction*>(header + 1);
+
+	header->magic = CONTROL_PLAN_MAGIC;
+	header->count = plan.size();
+	header->startX = start.x;
+	header->startY = start.y;
+	header->startTheta = start.theta;
+
+	for (size_t i = 0; i < plan.size(); i++) {
+		memcpy(instructions[i].action, plan[i].action.c_str(), sizeof(instructions[i].action));
+		instructions[i].cutting = plan[i].cutting;
+		instructions[i].durationMs = plan[i].durationMs;
+		instructions[i].value = plan[i].value;
+	}
+
+	munmap(mapping, size);
+
+	// the server maps the memfd, so it must not shrink (or change) once passed
+	if (fcntl(planFd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) != 0) {
+		::close(planFd);
+		return -1;
+	}
+
+	int result = request(CONTROL_UPLOAD, planFd, reply);
+
+	::close(planFd);
+
+	return result;
+}
+
+/**
+ * Function which sends a request, with an fd if planFd is not -1, and waits for its reply
+ * @return 0: the reply arrived
+ * @return -1: not connected, or the connection was lost
+ */
+int ControlClient::request(ControlCommand command, int planFd, ControlReply& reply) {
+	ControlRequest request = {CONTROL_MAGIC, m_nextId++, (unsigned int) command, 0};
+	alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+	iovec data = {&request, sizeof(request)};
+	msghdr message = {};
+
+	if (m_fd < 0) {
+		return -1;
+	}
+
+	message.msg_iov = &data;
+	message.msg_iovlen = 1;
+
+	if (planFd >= 0) {
+		message.msg_control = control;
+		message.msg_controllen = sizeof(control);
+
+		cmsghdr* header = CMSG_FIRSTHDR(&message);
+		header->cmsg_level = SOL_SOCKET;
+		header->cmsg_type = SCM_RIGHTS;
+		header->cmsg_len = CMSG_LEN(sizeof(int));
+		memcpy(CMSG_DATA(header), &planFd, sizeof(planFd));
+	}
+
+	if (sendmsg(m_fd, &message, MSG_NOSIGNAL) != sizeof(request)) {
+		close();
+		return -1;
+	}
+
+	// replies come in order, one per request
+	if (recv(m_fd, &reply, sizeof(reply), 0) != sizeof(reply) || reply.magic != CONTROL_MAGIC || reply.id != request.id) {
+		close();
+		return -1;
+	}
+
+	return 0;
+}
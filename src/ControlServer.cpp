@@ -0,0 +1,372 @@
+/**
+ * This file contains the implementation of the ControlServer class and all associated member functions that are included in the ControlServer.h file.
+ * The ControlServer class accepts control clients on a Unix socket and turns their requests into presses and plan uploads.
+ *
+ */
+
+#include "ControlServer.h"
+#include "Logger.h"
+#include <cmath>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+ * Constructor, nothing is accepted until open() and attach()
+ *
+ * @param buttonControl: the state machine commands go through
+ * @param exeControl: executor, for the remaining instruction count in the replies
+ *
+ */
+ControlServer::ControlServer(ButtonController& buttonControl, ExecutionController& exeControl) : m_plan(m_planArena.getResource()), m_staging(m_planArena.getResource()) {
+	m_buttonControl = &buttonControl;
+	m_exeControl = &exeControl;
+	m_reactor = nullptr;
+	m_listenFd = -1;
+	m_planStart = Pose{0, 0, 0};
+	m_hasPlan = false;
+	m_commandCount = 0;
+}
+
+/**
+ * Member function destructor which closes the socket and every client: no return
+ */
+ControlServer::~ControlServer() {
+	close();
+}
+
+/**
+ * Function which creates the listening socket, replacing a socket file left by an earlier run
+ *
+ * @param path: socket file, e.g. /run/nomo/control.sock (only the owner and group may connect)
+ * @return 0: success
+ * @return -1: the socket could not be created or bound
+ * @return -2: already open
+ */
+int ControlServer::open(const std::string& path) {
+	sockaddr_un address = {};
+
+	if (m_listenFd >= 0) {
+		return -2;
+	}
+
+	if (path.size() >= sizeof(address.sun_path)) {
+		return -1;
+	}
+
+	int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+	if (fd < 0) {
+		return -1;
+	}
+
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, path.c_str());
+	unlink(path.c_str());
+
+	if (bind(fd, (sockaddr*) &address, sizeof(address)) != 0 || chmod(path.c_str(), 0660) != 0 || listen(fd, CONTROL_MAX_CLIENTS) != 0) {
+		::close(fd);
+		return -1;
+	}
+
+	m_path = path;
+	m_listenFd = fd;
+
+	return 0;
+}
+
+/**
+ * Function which closes the clients and the listening socket and removes the socket file
+ * Return value is 0 for success
+ */
+int ControlServer::close() {
+	while (!m_clients.empty()) {
+		dropClient(m_clients.back());
+	}
+
+	if (m_listenFd >= 0) {
+		if (m_reactor != nullptr) {
+			m_reactor->removeFd(m_listenFd);
+		}
+
+		::close(m_listenFd);
+		unlink(m_path.c_str());
+		m_listenFd = -1;
+	}
+
+	return 0;
+}
+
+/**
+ * Function which has a reactor accept and serve the clients, every handler then runs on the reactor's thread
+ *
+ * @param reactor: the loop the buttons run on
+ * @param onCommand: called after each command that may have changed the state (e.g. to start the next instruction)
+ * @return 0: success
+ * @return -1: not open, or the reactor refused the socket
+ */
+int ControlServer::attach(Reactor& reactor, std::function<void()> onCommand) {
+	if (m_listenFd < 0) {
+		return -1;
+	}
+
+	m_reactor = &reactor;
+	m_onCommand = onCommand;
+
+	return m_reactor->addFd(m_listenFd, [this]() { onAccept(); });
+}
+
+/**
+ * Getter function which returns the last plan uploaded (empty if none)
+ */
+const Plan& ControlServer::getUploadedPlan() {
+	return m_plan;
+}
+
+/**
+ * Getter function which returns how many requests have been answered
+ */
+long ControlServer::getCommandCount() {
+	return m_commandCount;
+}
+
+/**
+ * Getter function which returns how many clients are connected
+ */
+int ControlServer::getClientCount() {
+	return m_clients.size();
+}
+
+/**
+ * Function which accepts the clients waiting to connect, past CONTROL_MAX_CLIENTS they are hung up on
+ * Return value is the number of clients accepted
+ */
+int ControlServer::onAccept() {
+	int accepted = 0;
+	int fd;
+
+	while ((fd = accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+		if ((int) m_clients.size() >= CONTROL_MAX_CLIENTS || m_reactor->addFd(fd, [this, fd]() { onClient(fd); }) != 0) {
+			::close(fd);
+			continue;
+		}
+
+		m_clients.push_back(fd);
+		accepted++;
+	}
+
+	return accepted;
+}
+
+/**
+ * Function which answers up to CONTROL_BATCH requests of a client (the reactor calls it again if more are waiting)
+ * A client that hung up, or does not read its replies, is dropped
+ * Return value is the number of requests answered
+ */
+int ControlServer::onClient(int fd) {
+	int answered = 0;
+
+	for (; answered < CONTROL_BATCH; answered++) {
+		ControlRequest request;
+		alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+		iovec data = {&request, sizeof(request)};
+		msghdr message = {};
+		int planFd = -1;
+
+		message.msg_iov = &data;
+		message.msg_iovlen = 1;
+		message.msg_control = control;
+		message.msg_controllen = sizeof(control);
+
+		ssize_t received = recvmsg(fd, &message, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+
+		if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			break;
+		}
+
+		if (received <= 0) {
+			dropClient(fd);
+			break;
+		}
+
+		for (cmsghdr* header = CMSG_FIRSTHDR(&message); header != nullptr; header = CMSG_NXTHDR(&message, header)) {
+			if (header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS && planFd < 0) {
+				memcpy(&planFd, CMSG_DATA(header), sizeof(planFd));
+			}
+		}
+
+		ControlReply reply = {};
+
+		if (received != sizeof(request) || (message.msg_flags & MSG_TRUNC) != 0 || request.magic != CONTROL_MAGIC) {
+			reply.result = CONTROL_BAD_REQUEST;
+		} else {
+			reply.id = request.id;
+			reply.command = request.command;
+			reply.result = handleRequest(request, planFd);
+		}
+
+		if (planFd >= 0) {
+			::close(planFd);
+		}
+
+		reply.magic = CONTROL_MAGIC;
+		reply.state = m_buttonControl->getCurrentState();
+		reply.remainingCount = m_exeControl->getRemainingCount();
+		reply.planSize = m_hasPlan ? m_plan.size() : 0;
+		m_commandCount++;
+
+		if (send(fd, &reply, sizeof(reply), MSG_DONTWAIT | MSG_NOSIGNAL) != sizeof(reply)) {
+			dropClient(fd);
+			break;
+		}
+	}
+
+	return answered;
+}
+
+/**
+ * Function which stops serving a client and closes its socket
+ * Return value is 0 for success
+ */
+int ControlServer::dropClient(int fd) {
+	for (size_t i = 0; i < m_clients.size(); i++) {
+		if (m_clients[i] == fd) {
+			m_clients.erase(m_clients.begin() + i);
+
+			if (m_reactor != nullptr) {
+				m_reactor->removeFd(fd);
+			}
+
+			::close(fd);
+			break;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Function which carries out a request
+ * @param planFd: fd passed with the request, -1 if none
+ * @return a ControlResult
+ */
+int ControlServer::handleRequest(const ControlRequest& request, int planFd) {
+	State state = m_buttonControl->getCurrentState();
+	int result;
+
+	switch (request.command) {
+		case CONTROL_STATUS:
+			return CONTROL_OK;
+		case CONTROL_UPLOAD:
+			return loadPlan(planFd);
+		case CONTROL_START:
+			result = pressFor(IDLE, 0, MOWING);
+			break;
+		case CONTROL_PAUSE:
+			result = pressFor(MOWING, 1, PAUSED);
+			break;
+		case CONTROL_RESUME:
+			result = pressFor(PAUSED, 1, MOWING);
+			break;
+		case CONTROL_STOP:
+			result = pressFor(state == PAUSED ? PAUSED : MOWING, 0, IDLE);
+			break;
+		default:
+			return CONTROL_BAD_REQUEST;
+	}
+
+	if (result == CONTROL_OK && m_onCommand) {
+		m_onCommand();
+	}
+
+	return result;
+}
+
+/**
+ * Function which presses a button if the mower is in the state the command is meant for
+ * @param button: index in ButtonController::getButtonPins() (0 start, 1 set dimensions)
+ * @return CONTROL_OK if the press took the mower to the state wanted, CONTROL_REFUSED otherwise (e.g. e-stop latched)
+ */
+int ControlServer::pressFor(State from, int button, State to) {
+	if (m_buttonControl->getCurrentState() != from) {
+		return CONTROL_REFUSED;
+	}
+
+	m_buttonControl->sendButtonPress(m_buttonControl->getButtonPins()[button]);
+
+	return m_buttonControl->getCurrentState() == to ? CONTROL_OK : CONTROL_REFUSED;
+}
+
+/**
+ * Function which reads an uploaded plan straight out of the client's memfd and has the next START mow it
+ * The memfd must be sealed against shrinking (it could otherwise be cut short while mapped) and against writing (the
+ * client could otherwise change a record after it was checked). Every record is copied once into m_staging and checked
+ * there, the last plan is only replaced when all of them pass
+ * @return a ControlResult
+ */
+int ControlServer::loadPlan(int planFd) {
+	struct stat status;
+
+	if (planFd < 0 || fstat(planFd, &status) != 0 || (size_t) status.st_size < sizeof(ControlPlanHeader)) {
+		return CONTROL_BAD_PLAN;
+	}
+
+	int seals = fcntl(planFd, F_GET_SEALS);
+
+	if (seals < 0 || (seals & F_SEAL_SHRINK) == 0 || (seals & (F_SEAL_WRITE | CONTROL_SEAL_FUTURE_WRITE)) == 0) {
+		return CONTROL_BAD_PLAN;
+	}
+
+	size_t size = status.st_size;
+	void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, planFd, 0);
+
+	if (mapping == MAP_FAILED) {
+		return CONTROL_BAD_PLAN;
+	}
+
+	const unsigned char* bytes = static_cast<const unsigned char*>(mapping);
+	ControlPlanHeader header;
+
+	memcpy(&header, bytes, sizeof(header));
+
+	bool valid = header.magic == CONTROL_PLAN_MAGIC && header.count > 0 && header.count <= CONTROL_MAX_PLAN
+		&& size >= sizeof(ControlPlanHeader) + header.count * sizeof(ControlPlanInstruction);
+
+	m_staging.clear();
+
+	for (unsigned int i = 0; valid && i < header.count; i++) {
+		ControlPlanInstruction record;
+		Instruction instruction;
+
+		memcpy(&record, bytes + sizeof(ControlPlanHeader) + i * sizeof(ControlPlanInstruction), sizeof(record));
+		instruction.action = ActionCode(record.action); // copies at most two characters
+		instruction.value = record.value;
+		instruction.cutting = record.cutting != 0;
+		instruction.durationMs = record.durationMs;
+
+		valid = (instruction.action == "MF" || instruction.action == "MB" || instruction.action == "TL" || instruction.action == "TR")
+			&& std::isfinite(instruction.value) && instruction.value >= 0 && instruction.durationMs >= 0;
+		m_staging.push_back(instruction);
+	}
+
+	munmap(mapping, size);
+
+	if (!valid) {
+		m_staging.clear();
+		return CONTROL_BAD_PLAN;
+	}
+
+	m_plan.swap(m_staging);
+	m_staging.clear();
+	m_planStart = Pose{header.startX, header.startY, header.startTheta};
+	m_hasPlan = true;
+	m_buttonControl->setUploadedPlan(&m_plan, m_planStart);
+	LOG_INFO("control", "plan of %u instructions uploaded", header.count);
+
+	return CONTROL_OK;
+}
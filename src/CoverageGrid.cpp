@@ -0,0 +1,322 @@
+/**
+ * This file contains the implementation of the CoverageGrid class and all associated member functions that are included in the CoverageGrid.h file.
+ * The CoverageGrid class checks how well a plan (or a recorded pose trace) covers the lawn.
+ *
+ */
+
+#include "CoverageGrid.h"
+#include <algorithm>
+#include <cmath>
+
+const double TRACE_PASS_ANGLE = M_PI / 4; // heading change that starts a new pass when sweeping a trace
+
+/**
+ * Constructor
+ *
+ * @param sizeX: size of the lawn along x in metres (the long side for plans from Path)
+ * @param sizeY: size of the lawn along y in metres
+ * @param resolution: cell size in metres
+ *
+ */
+CoverageGrid::CoverageGrid(double sizeX, double sizeY, double resolution) {
+	m_sizeX = sizeX;
+	m_sizeY = sizeY;
+	m_resolution = resolution;
+	m_cols = std::max(1, (int) std::ceil(sizeX / resolution));
+	m_rows = std::max(1, (int) std::ceil(sizeY / resolution));
+	m_wordsPerRow = (m_cols + 63) / 64;
+
+	m_covered.assign(m_rows * m_wordsPerRow, 0);
+	m_previous.assign(m_rows * m_wordsPerRow, 0);
+	m_pass.assign(m_rows * m_wordsPerRow, 0);
+	m_overlap.assign(m_rows * m_wordsPerRow, 0);
+
+	reset();
+}
+
+/**
+ * Member function destructor which deletes an object: no return
+ */
+CoverageGrid::~CoverageGrid() {
+
+}
+
+/**
+ * Function which clears the grid so another plan can be scored without reallocating
+ */
+int CoverageGrid::reset() {
+	std::fill(m_covered.begin(), m_covered.end(), 0);
+	std::fill(m_previous.begin(), m_previous.end(), 0);
+	std::fill(m_pass.begin(), m_pass.end(), 0);
+	std::fill(m_overlap.begin(), m_overlap.end(), 0);
+
+	m_passRowMin = m_rows;
+	m_passRowMax = -1;
+	m_passWordMin = m_wordsPerRow;
+	m_passWordMax = -1;
+	m_previousRowMin = m_rows;
+	m_previousRowMax = -1;
+	m_previousWordMin = m_wordsPerRow;
+	m_previousWordMax = -1;
+
+	return 0;
+}
+
+/**
+ * Function which sweeps the blade along every instruction of a plan, each instruction is one pass
+ * Instructions that are not cutting (transit legs) move the mower without sweeping
+ *
+ * @param plan: instructions, as generated by Path
+ * @param start: pose of the mower before the first instruction
+ * @param bladeDiameter: diameter of the cut, centred on the mower
+ * @param model: drive model used to turn instructions into motion
+ * @return 0: success
+ */
+int CoverageGrid::sweepPlan(const Plan& plan, const Pose& start, double bladeDiameter, const DriveModel& model) {
+	Pose pose = start;
+
+	for (const Instruction& instruction : plan) {
+		if (!instruction.cutting) { // blade off, only moves the mower
+			pose = model.applyInstruction(pose, instruction);
+			continue;
+		}
+
+		pose = sweepInstruction(pose, instruction, bladeDiameter, model);
+		endPass();
+	}
+
+	return 0;
+}
+
+/**
+ * Function which sweeps the blade along a single instruction into the current pass (endPass() is left to the caller)
+ *
+ * @param pose: pose of the mower before the instruction
+ * @param instruction: instruction to sweep, whether it is cutting or not
+ * @return the pose after the instruction
+ */
+Pose CoverageGrid::sweepInstruction(const Pose& pose, const Instruction& instruction, double bladeDiameter, const DriveModel& model) {
+	double radius = bladeDiameter / 2;
+	Pose next = model.applyInstruction(pose, instruction);
+
+	if (instruction.action == "TL" || instruction.action == "TR") {
+		// pivots move the blade along an arc, sweep it as a few chords
+		int steps = std::max(1, (int) std::ceil(std::fabs(instruction.value) / ARC_STEP));
+		Pose from = pose;
+
+		for (int i = 1; i <= steps; i++) {
+			Pose to = model.applyInstruction(pose, Instruction{instruction.action, instruction.value * i / steps});
+			sweepStadium(from.x, from.y, to.x, to.y, radius, i == 1); // the joint was swept as the end of the last chord
+			from = to;
+		}
+	} else {
+		sweepSegment(pose.x, pose.y, next.x, next.y, radius);
+	}
+
+	return next;
+}
+
+/**
+ * Function which sweeps the blade along a recorded pose trace (e.g. sampled from the PoseEstimator)
+ * A new pass starts whenever the heading has changed by more than 45 degrees or the mower reverses
+ *
+ * @param trace: poses in the order they were visited
+ * @param bladeDiameter: diameter of the cut, centred on the mower
+ * @return 0: success
+ */
+int CoverageGrid::sweepTrace(const std::vector<Pose>& trace, double bladeDiameter) {
+	double radius = bladeDiameter / 2;
+	double passTheta = 0;
+	bool passReversed = false;
+	bool passStarted = false;
+
+	for (size_t i = 1; i < trace.size(); i++) {
+		const Pose& from = trace[i - 1];
+		const Pose& to = trace[i];
+		double dx = to.x - from.x;
+		double dy = to.y - from.y;
+		bool reversed = dx * std::cos(from.theta) + dy * std::sin(from.theta) < 0;
+
+		if (passStarted && (std::fabs(std::remainder(to.theta - passTheta, 2 * M_PI)) > TRACE_PASS_ANGLE || reversed != passReversed)) {
+			endPass();
+			passStarted = false;
+		}
+
+		bool continued = passStarted;
+
+		if (!passStarted) {
+			passTheta = to.theta;
+			passReversed = reversed;
+			passStarted = true;
+		}
+
+		sweepStadium(from.x, from.y, to.x, to.y, radius, !continued); // within a pass, from was swept as the end of the last segment
+	}
+
+	endPass();
+
+	return 0;
+}
+
+/**
+ * Function which marks every cell whose centre is within radius of the segment as cut by the current pass
+ *
+ * @return 0: success
+ */
+int CoverageGrid::sweepSegment(double x0, double y0, double x1, double y1, double radius) {
+	return sweepStadium(x0, y0, x1, y1, radius, true);
+}
+
+/**
+ * Function which marks the cells within radius of the segment as cut by the current pass,
+ * the disc around (x0, y0) only if startCap is set (see sweepStadiumRows())
+ *
+ * @return 0: success
+ */
+int CoverageGrid::sweepStadium(double x0, double y0, double x1, double y1, double radius, bool startCap) {
+	int rowMin = m_rows;
+	int rowMax = -1;
+	int colMin = m_cols;
+	int colMax = -1;
+
+	sweepStadiumRows(x0, y0, x1, y1, radius, startCap, m_rows, m_cols, m_resolution, [](double x) { return std::sqrt(x); },
+		[&](int row, int colStart, int colEnd) {
+			fillRow(&m_pass[row * m_wordsPerRow], colStart, colEnd); // cut by the current pass
+			rowMin = std::min(rowMin, row);
+			rowMax = row;
+			colMin = std::min(colMin, colStart);
+			colMax = std::max(colMax, colEnd);
+		});
+
+	if (rowMax >= 0) {
+		m_passRowMin = std::min(m_passRowMin, rowMin);
+		m_passRowMax = std::max(m_passRowMax, rowMax);
+		m_passWordMin = std::min(m_passWordMin, colMin / 64);
+		m_passWordMax = std::max(m_passWordMax, colMax / 64);
+	}
+
+	return 0;
+}
+
+/**
+ * Function which finishes the current pass: cells it shares with anything but the previous pass become overlap
+ * Only the words touched by the last two passes are visited (a turn only touches a word or two of each row),
+ * and the pass becomes the previous one by swapping the bit planes rather than copying them
+ *
+ * @return 0: success
+ */
+int CoverageGrid::endPass() {
+	// the pass against everything cut before the previous pass
+	for (int row = m_passRowMin; row <= m_passRowMax; row++) {
+		for (int i = row * m_wordsPerRow + m_passWordMin; i <= row * m_wordsPerRow + m_passWordMax; i++) {
+			m_overlap[i] |= m_covered[i] & m_pass[i];
+		}
+	}
+
+	// the previous pass is done with, its plane is cleared to take the next pass
+	for (int row = m_previousRowMin; row <= m_previousRowMax; row++) {
+		for (int i = row * m_wordsPerRow + m_previousWordMin; i <= row * m_wordsPerRow + m_previousWordMax; i++) {
+			m_covered[i] |= m_previous[i];
+			m_previous[i] = 0;
+		}
+	}
+
+	m_previous.swap(m_pass);
+	m_previousRowMin = m_passRowMin;
+	m_previousRowMax = m_passRowMax;
+	m_previousWordMin = m_passWordMin;
+	m_previousWordMax = m_passWordMax;
+	m_passRowMin = m_rows;
+	m_passRowMax = -1;
+	m_passWordMin = m_wordsPerRow;
+	m_passWordMax = -1;
+
+	return 0;
+}
+
+/**
+ * Getter function which returns how many cells the current pass cuts that no earlier pass has cut
+ * Call it before endPass()
+ */
+long CoverageGrid::getNewCellCount() {
+	long count = 0;
+
+	for (int row = m_passRowMin; row <= m_passRowMax; row++) {
+		for (int i = row * m_wordsPerRow + m_passWordMin; i <= row * m_wordsPerRow + m_passWordMax; i++) {
+			count += __builtin_popcountll(m_pass[i] & ~(m_covered[i] | m_previous[i]));
+		}
+	}
+
+	return count;
+}
+
+/**
+ * Getter function which returns the percentage of the lawn that has been cut
+ */
+double CoverageGrid::getCoveragePercent() {
+	long covered = 0;
+
+	for (size_t i = 0; i < m_covered.size(); i++) {
+		covered += __builtin_popcountll(m_covered[i] | m_previous[i] | m_pass[i]);
+	}
+
+	return 100.0 * covered / getCellCount();
+}
+
+/**
+ * Getter function which returns the percentage of the lawn that has been cut more than once
+ */
+double CoverageGrid::getOverlapPercent() {
+	return 100.0 * countBits(m_overlap) / getCellCount();
+}
+
+/**
+ * Getter function which returns the area (m^2) that has not been cut
+ */
+double CoverageGrid::getMissedArea() {
+	return (100.0 - getCoveragePercent()) / 100.0 * getCellCount() * m_resolution * m_resolution;
+}
+
+/**
+ * Getter function which returns the number of cells covering the lawn
+ */
+long CoverageGrid::getCellCount() {
+	return (long) m_rows * m_cols;
+}
+
+/**
+ * Getter function which returns the cell size in metres
+ */
+double CoverageGrid::getResolution() {
+	return m_resolution;
+}
+
+/**
+ * Function which returns whether the cell containing (x, y) has been cut
+ */
+bool CoverageGrid::isCovered(double x, double y) {
+	int col = (int) std::floor(x / m_resolution);
+	int row = (int) std::floor(y / m_resolution);
+
+	if (col < 0 || col >= m_cols || row < 0 || row >= m_rows) {
+		return false;
+	}
+
+	int i = row * m_wordsPerRow + col / 64;
+	uint64_t bit = 1ULL << (col % 64);
+
+	return ((m_covered[i] | m_previous[i] | m_pass[i]) & bit) != 0;
+}
+
+/**
+ * Function which counts the set bits of a bit plane, one 64 bit word at a time
+ */
+long CoverageGrid::countBits(const std::vector<uint64_t>& bits) {
+	long count = 0;
+
+	for (uint64_t word : bits) {
+		count += __builtin_popcountll(word);
+	}
+
+	return count;
+}
@@ -0,0 +1,102 @@
+/**
+ * This file contains the implementation of the DriveModel class and all associated member functions that are included in the DriveModel.h file.
+ * The DriveModel class describes how the differential drive moves the mower for given wheel speeds or instructions.
+ *
+ */
+
+#include "DriveModel.h"
+#include <cmath>
+
+/**
+ * Constructor
+ *
+ * @param wheelBase: distance between the left and right wheels in metres
+ *
+ */
+DriveModel::DriveModel(double wheelBase) {
+	m_wheelBase = wheelBase;
+}
+
+/**
+ * Member function destructor which deletes an object: no return
+ */
+DriveModel::~DriveModel() {
+
+}
+
+/**
+ * Function which moves a pose for dt seconds with constant wheel speeds (exact arc integration)
+ *
+ * @param pose: starting pose
+ * @param vLeft: left wheel speed in m/s (positive is forward)
+ * @param vRight: right wheel speed in m/s
+ * @param dt: time step in seconds
+ * @return the new pose
+ */
+Pose DriveModel::integrate(const Pose& pose, double vLeft, double vRight, double dt) const {
+	double v = (vLeft + vRight) / 2;
+	double omega = (vRight - vLeft) / m_wheelBase;
+	double theta = pose.theta + omega * dt;
+
+	if (std::fabs(omega) < 1e-9) {
+		return Pose{pose.x + v * dt * std::cos(pose.theta), pose.y + v * dt * std::sin(pose.theta), theta};
+	}
+
+	double radius = v / omega;
+
+	return Pose{pose.x + radius * (std::sin(theta) - std::sin(pose.theta)), pose.y - radius * (std::cos(theta) - std::cos(pose.theta)), theta};
+}
+
+/**
+ * Function which returns the pose after an instruction has been executed
+ * MF/MB move along the heading, TL/TR pivot about the stopped wheel
+ *
+ * @param pose: pose before the instruction
+ * @param instruction: instruction to apply
+ * @return the new pose (unchanged for unknown actions)
+ */
+Pose DriveModel::applyInstruction(const Pose& pose, const Instruction& instruction) const {
+	double c = std::cos(pose.theta);
+	double s = std::sin(pose.theta);
+
+	if (instruction.action == "MF") {
+		return Pose{pose.x + instruction.value * c, pose.y + instruction.value * s, pose.theta};
+	} else if (instruction.action == "MB") {
+		return Pose{pose.x - instruction.value * c, pose.y - instruction.value * s, pose.theta};
+	} else if (instruction.action == "TL" || instruction.action == "TR") {
+		double sign = instruction.action == "TL" ? 1.0 : -1.0;
+		double angle = sign * instruction.value * M_PI / 180.0;
+
+		// the stopped wheel is on the inside of the turn
+		double pivotX = pose.x - sign * s * m_wheelBase / 2;
+		double pivotY = pose.y + sign * c * m_wheelBase / 2;
+		double dx = pose.x - pivotX;
+		double dy = pose.y - pivotY;
+
+		return Pose{pivotX + dx * std::cos(angle) - dy * std::sin(angle), pivotY + dx * std::sin(angle) + dy * std::cos(angle), pose.theta + angle};
+	}
+
+	return pose;
+}
+
+/**
+ * Function which returns the speed of the driven wheel during a pivot turn
+ *
+ * @param angle: turn angle in degrees
+ * @param durationMs: how long the wheel is powered for
+ * @return wheel speed in m/s
+ */
+double DriveModel::getTurnWheelSpeed(double angle, int durationMs) const {
+	if (durationMs <= 0) {
+		return 0;
+	}
+
+	return m_wheelBase * (angle * M_PI / 180.0) / (durationMs / 1000.0);
+}
+
+/**
+ * Getter function which returns the wheel base
+ */
+double DriveModel::getWheelBase() const {
+	return m_wheelBase;
+}
@@ -0,0 +1,133 @@
+/**
+ * This file contains the implementation of the EmergencyStop class and all associated member functions that are included in the EmergencyStop.h file.
+ * The EmergencyStop class writes every motor pin LOW from the e-stop interrupt and latches the fault.
+ *
+ */
+
+#include "EmergencyStop.h"
+#include <wiringPi.h>
+#include <ctime>
+
+/**
+ * Constructor which resolves the motor pins into a batch (nothing is written until trigger())
+ *
+ * @param pinStop: e-stop input, pulled up, LOW when the e-stop is pressed
+ * @param motorPins: every motor output pin (wheels and blade), at most PIN_BATCH_SIZE
+ * @param board: board the e-stop and the motors are on
+ *
+ */
+EmergencyStop::EmergencyStop(int pinStop, const std::vector<int>& motorPins, Board& board) : m_latched(false), m_triggerCount(0), m_lastTriggerNs(0) {
+	m_board = &board;
+	m_pinStop = pinStop;
+	m_errorNum = 0;
+
+	if (m_board->resolvePins(motorPins.data(), motorPins.size(), m_motorPins) != 0) {
+		m_errorNum = -1;
+		m_motorPins.count = 0;
+		m_motorPins.mask = 0;
+		m_motorPins.handle = -1;
+	}
+}
+
+/**
+ * Member function destructor which deletes an object: no return
+ */
+EmergencyStop::~EmergencyStop() {
+
+}
+
+/**
+ * Function which sets the e-stop input up and attaches the interrupt that calls trigger(), which is also called straight
+ * away if the e-stop is already pressed (LOW)
+ * @return 0: success
+ * @return -1: the motor pins could not be resolved or the board has no interrupt for the pin
+ */
+int EmergencyStop::arm() {
+	if (m_errorNum != 0) {
+		return -1;
+	}
+
+	m_board->pinMode(m_pinStop, INPUT);
+	m_board->pullUpDnControl(m_pinStop, PUD_UP);
+
+	if (m_board->attachInterrupt(m_pinStop, &EmergencyStop::onInterrupt, this) != 0) {
+		m_errorNum = -1;
+		return -1;
+	}
+
+	// a button already held down has no falling edge left to interrupt on, so its level is read once armed
+	if (m_board->digitalRead(m_pinStop) == LOW) {
+		trigger();
+	}
+
+	return 0;
+}
+
+/**
+ * Function which stops every motor and latches the fault
+ * The latch is set before the pins are written, so a thread that switches a motor on and then checks isLatched()
+ * either sees the fault or has its write cleared by the batch
+ * Return value is 0 for success
+ */
+int EmergencyStop::trigger() {
+	timespec now;
+
+	m_latched.store(true);
+	m_board->writeLow(m_motorPins);
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	m_lastTriggerNs.store(now.tv_sec * 1000000000LL + now.tv_nsec);
+	m_triggerCount.fetch_add(1);
+
+	return 0;
+}
+
+/**
+ * Function which clears the fault, the mower can be started again afterwards
+ * @return 0: success
+ * @return -1: the e-stop input is still pressed (LOW)
+ */
+int EmergencyStop::reset() {
+	if (m_board->digitalRead(m_pinStop) == LOW) {
+		return -1;
+	}
+
+	m_latched.store(false);
+
+	return 0;
+}
+
+/**
+ * Getter function which returns whether the fault is latched
+ */
+bool EmergencyStop::isLatched() const {
+	return m_latched.load();
+}
+
+/**
+ * Getter function which returns how many times the e-stop has been triggered
+ */
+long EmergencyStop::getTriggerCount() {
+	return m_triggerCount.load();
+}
+
+/**
+ * Getter function which returns the CLOCK_MONOTONIC time (ns) the motor pins were last written LOW, 0 if never
+ */
+long long EmergencyStop::getLastTriggerNs() {
+	return m_lastTriggerNs.load();
+}
+
+/**
+ * Getter function which returns the errorNum variable which holds the value of the current error call
+ */
+int EmergencyStop::getErrorNum() {
+	return m_errorNum;
+}
+
+/**
+ * Function called by the board's interrupt when the e-stop input goes LOW
+ */
+void EmergencyStop::onInterrupt(void* context) {
+	static_cast<EmergencyStop*>(context)->trigger();
+}
@@ -0,0 +1,158 @@
+/**
+ * This file contains the implementation of the EnergyModel class and all associated member functions that are included in the EnergyModel.h file.
+ * The EnergyModel class predicts how much battery energy instructions use.
+ *
+ */
+
+#include "EnergyModel.h"
+#include "CoveragePattern.h"
+#include "DriveModel.h"
+
+const size_t TRANSIT_BUFFER_BYTES = 2048;
+
+/**
+ * Constructor with the default motor powers
+ *
+ * @param wheelBase: distance between the wheels (the car diameter), used to plan transit legs
+ *
+ */
+EnergyModel::EnergyModel(double wheelBase) : EnergyModel(wheelBase, WHEEL_MOTOR_WATTS, BLADE_MOTOR_WATTS, BLADE_START_JOULES) {
+
+}
+
+/**
+ * Constructor
+ *
+ * @param wheelBase: distance between the wheels (the car diameter), used to plan transit legs
+ * @param wheelMotorWatts: power drawn by one wheel motor
+ * @param bladeMotorWatts: power drawn by the blade motor
+ * @param bladeStartJoules: extra energy each blade start takes
+ *
+ */
+EnergyModel::EnergyModel(double wheelBase, double wheelMotorWatts, double bladeMotorWatts, double bladeStartJoules) {
+	m_wheelBase = wheelBase;
+	m_wheelMotorWatts = wheelMotorWatts;
+	m_bladeMotorWatts = bladeMotorWatts;
+	m_bladeStartJoules = bladeStartJoules;
+}
+
+/**
+ * Member function destructor which deletes an object: no return
+ */
+EnergyModel::~EnergyModel() {
+
+}
+
+/**
+ * Function which returns the energy (Wh) an instruction uses
+ *
+ * @param instruction: instruction to estimate
+ * @param bladeWasOn: whether the blade was spinning before the instruction (a cutting instruction has to start it otherwise)
+ */
+double EnergyModel::getInstructionWh(const Instruction& instruction, bool bladeWasOn) const {
+	double seconds = getDurationSeconds(instruction);
+	double joules = 0;
+
+	if (instruction.action == "MF" || instruction.action == "MB") {
+		joules += 2 * m_wheelMotorWatts * seconds;
+	} else if (instruction.action == "TL" || instruction.action == "TR") {
+		joules += m_wheelMotorWatts * seconds;
+	}
+
+	if (instruction.cutting) {
+		joules += m_bladeMotorWatts * seconds + (bladeWasOn ? 0 : m_bladeStartJoules);
+	}
+
+	return joules / 3600;
+}
+
+/**
+ * Function which returns the energy (Wh) a whole plan uses, starting with the blade stopped
+ */
+double EnergyModel::getPlanWh(const Plan& plan) const {
+	double wh = 0;
+	bool bladeOn = false;
+
+	for (const Instruction& instruction : plan) {
+		wh += getInstructionWh(instruction, bladeOn);
+		bladeOn = instruction.cutting;
+	}
+
+	return wh;
+}
+
+/**
+ * Function which returns, for every instruction of a plan, the energy needed from that instruction to the end
+ * One pass from the back, so the executor can check the rest of the plan in constant time per instruction
+ *
+ * @param plan: plan to estimate
+ * @param remainingWh: receives plan.size() + 1 values, the last one 0
+ * @return 0: success
+ */
+int EnergyModel::getRemainingWh(const Plan& plan, std::vector<double>& remainingWh) const {
+	remainingWh.assign(plan.size() + 1, 0);
+
+	for (size_t i = plan.size(); i > 0; i--) {
+		bool bladeWasOn = i > 1 && plan[i - 2].cutting;
+		remainingWh[i - 1] = remainingWh[i] + getInstructionWh(plan[i - 1], bladeWasOn);
+	}
+
+	return 0;
+}
+
+/**
+ * Function which returns the energy (Wh) of a blade-off transit leg between two poses
+ */
+double EnergyModel::getTransitWh(const Pose& from, const Pose& to) const {
+	unsigned char buffer[TRANSIT_BUFFER_BYTES]; // the leg is at most three instructions, it is built on the stack
+	std::pmr::monotonic_buffer_resource legMemory(buffer, sizeof(buffer));
+	Plan leg(&legMemory);
+
+	getTransit(from, to, leg);
+
+	return getPlanWh(leg);
+}
+
+/**
+ * Function which plans a blade-off transit leg (turn, straight, turn) between two poses
+ *
+ * @param leg: receives the instructions
+ * @return 0: success
+ */
+int EnergyModel::getTransit(const Pose& from, const Pose& to, Plan& leg) const {
+	DriveModel model(m_wheelBase);
+	PlanTurtle<Plan> turtle(leg, model, from);
+
+	leg.clear();
+	turtle.driveTo(to.x, to.y, to.theta);
+
+	for (Instruction& instruction : leg) {
+		instruction.cutting = false;
+	}
+
+	return 0;
+}
+
+/**
+ * Getter function which returns the wheel base used to plan transit legs
+ */
+double EnergyModel::getWheelBase() const {
+	return m_wheelBase;
+}
+
+/**
+ * Function which returns how long an instruction takes, in seconds
+ */
+double EnergyModel::getDurationSeconds(const Instruction& instruction) const {
+	if (instruction.action == "MF" || instruction.action == "MB") {
+		return instruction.value * DRIVE_MS_PER_METRE / 1000;
+	} else if (instruction.action == "TL" || instruction.action == "TR") {
+		if (instruction.durationMs > 0) { // the plan measured this turn
+			return instruction.durationMs / 1000.0;
+		}
+
+		return instruction.value * 0.9 / 90; // standard 90 degree pivot takes 900 ms
+	}
+
+	return 0;
+}
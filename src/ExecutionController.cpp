@@ -5,8 +5,20 @@
  */
 
 #include "ExecutionController.h"
-#include <iostream>
-#include <wiringPi.h>
+#include "WiringPiBoard.h"
+#include "DriveModel.h"
+#include "Logger.h"
+#include "SpanTracer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+const int CHARGE_POLL_MS = 10000; // how often the battery is checked while charging at the base
+const unsigned int POSE_UPDATE_MS = 50; // how often the pose estimate is stepped while a motion runs
+const double CHARGED_FRACTION = 0.98; // charge level the mower leaves the base at
+const int TRANSIT_LEG_SIZE = 3; // instructions in a return or resume leg: turn, straight, turn
+const size_t TRANSIT_BUFFER_BYTES = 2048; // stack memory the return and resume legs are built in
+const size_t PLAN_STREAM_WINDOW = 16; // instructions of a streamed plan decoded ahead into the queue
 
 /**
  * Constructor that takes 3 parameters and initializes own variables
@@ -17,13 +29,55 @@
  * @param bladeControl: reference to the bladecontroller object that will be used (motor already assigned)
  *
  */
-ExecutionController::ExecutionController(State& currentState, Path& path, WheelController& wheelControl, BladeController& bladeControl) {
+ExecutionController::ExecutionController(State& currentState, Path& path, WheelController& wheelControl, BladeController& bladeControl)
+    : ExecutionController(currentState, path, wheelControl, bladeControl, WiringPiBoard::getInstance()) {
+
+}
+
+/**
+ * Constructor like the one above, with the board used for timing (must be the board the motors are on, e.g. a SimBoard)
+ *
+ * @param board: board whose clock times the instructions
+ *
+ */
+ExecutionController::ExecutionController(State& currentState, Path& path, WheelController& wheelControl, BladeController& bladeControl, Board& board)
+    : m_remainingInstructions(m_planArena.getResource()) {
     m_currentState = &currentState;
     m_path = &path;
     m_wheelControl = &wheelControl;
     m_bladeControl = &bladeControl;
-    m_shutDownFlag = false;
+    m_poseEstimator = nullptr;
+    m_board = &board;
+    m_phase = NO_INSTRUCTION;
+    m_currentDurationMs = 0;
+    m_preSpinLeadMs = 0;
+    m_poseMs = 0;
+    m_startedMs = 0;
+    m_batteryMonitor = nullptr;
+    m_energyModel = nullptr;
+    m_basePose = Pose{0, 0, 0};
+    m_reserveWh = 0;
+    m_plannedPose = Pose{0, 0, 0};
+    m_endToBaseWh = 0;
+    m_planIndex = 0;
+    m_planSize = 0;
+    m_startedCount = 0;
+    m_resumeIndex = 0;
+    m_chargeLegCount = 0;
+    m_returnCount = 0;
+    m_planStream = nullptr;
+    m_remainingCount = 0;
+    m_streamRemainingWh = 0;
+    m_streamBladeWasOn = false;
     m_isBladeSpinning = false;
+    m_verbose = true;
+    m_stateChangedNs = 0;
+
+    m_emergencyStop = nullptr;
+    m_missionLog = nullptr;
+    m_telemetry = nullptr;
+    m_cancelToken = &m_ownToken;
+    m_ownToken.onCancel([this]() { stopMotors(); });
 }
 
 /**
@@ -38,51 +92,313 @@ ExecutionController::~ExecutionController() {
  * Return value is 0 for success
  */
 int ExecutionController::startExecutionListener() {
-    while (!m_shutDownFlag) {
-        if (m_remainingInstructions.size() > 0) {
-            if (*m_currentState == MOWING) {
-                if (!m_isBladeSpinning) {
-                    m_bladeControl->startMotor();
-                    m_isBladeSpinning = true;
-                }
-
-                Instruction currentInstruction = m_remainingInstructions.front();
-                    
-                std::cout << "# of instructions left: " << m_remainingInstructions.size() << std::endl;
-                std::cout << "instruction: " << currentInstruction.action << currentInstruction.value << std::endl;
-
-                m_remainingInstructions.pop_front();
-                executeInstruction(currentInstruction);
-            } else { // this will be reach only if we are in paused state (i.e. we need to stop blade from spinning while paused)
-                m_bladeControl->stopMotor();
-                m_isBladeSpinning = false;
+    SpanTracer::getInstance().setThreadName("exec");
+
+    while (!m_cancelToken->isCancelled()) {
+        executeNext();
+    }
+
+    stopMotors(); // the motors are already stopped by the token, this only makes sure before the thread ends
+
+    return 0;
+}
+
+/**
+ * Function that takes one step of the listener: executes the next instruction if the mower is mowing
+ * Used directly (instead of the listener thread) to run a mission on a simulated board
+ * The wait is cut short when the cancellation token is cancelled, the instruction then ends where the mower got to
+ * @return 1: an instruction was executed (or cancelled part way)
+ * @return 0: nothing to execute (paused, idle, shut down, or just finished all instructions)
+ */
+int ExecutionController::executeNext() {
+    unsigned int waitMs;
+
+    if (startNext(waitMs) <= 0) {
+        return 0;
+    }
+
+    TRACE_SPAN("exec", "instruction"); // from the motors switching on to the instruction ending
+
+    do {
+        // with a pose estimator the wait is cut into slices, so the estimate follows the mower while it drives
+        while (waitMs > 0) {
+            unsigned int sliceMs = m_poseEstimator != nullptr ? std::min(waitMs, POSE_UPDATE_MS) : waitMs;
+
+            if (m_board->delay(sliceMs, *m_cancelToken) < sliceMs) {
+                cancelCurrent();
+                return 1;
+            }
+
+            waitMs -= sliceMs;
+
+            if (waitMs > 0) {
+                updatePose(m_board->millis() - m_startedMs);
+                publishTelemetry();
             }
-        } else { // if we finish all instructions
-            if (*m_currentState == MOWING) { // only if we were previously mowing and finished all instructions, return to idle state, stop blade motor
+        }
+    } while (continueCurrent(waitMs) == 1);
+
+    return 1;
+}
+
+/**
+ * Function that starts the next instruction without waiting for it: the motors are switched on and the caller
+ * is told how long to wait before calling continueCurrent() (used by the reactor runtime, which waits on a timer)
+ * @param waitMs: set to how long the motors should run before continueCurrent() is called
+ * @return 1: an instruction was started
+ * @return 0: nothing to execute (paused, idle, shut down, or just finished all instructions)
+ * @return -1: the last instruction has not finished yet
+ */
+int ExecutionController::startNext(unsigned int& waitMs) {
+    if (m_phase != NO_INSTRUCTION) {
+        return -1;
+    }
+
+    if (m_cancelToken->isCancelled()) {
+        stopMotors();
+        publishTelemetry();
+        return 0;
+    }
+
+    if (isFaulted()) {
+        return abortOnFault();
+    }
+
+    Instruction currentInstruction;
+    size_t instructionsLeft = m_remainingCount;
+    bool takeNext = false;
+
+    // the plan is only locked to take an instruction from it (never while the motors run, nor while paused or idle)
+    if (instructionsLeft > 0 && *m_currentState == MOWING) {
+        std::lock_guard<std::mutex> lock(m_planMutex);
+        instructionsLeft = m_remainingInstructions.size();
+        takeNext = instructionsLeft > 0;
+
+        if (takeNext) {
+            // before each plan instruction, go home to charge if the battery would not last otherwise
+            if (m_batteryMonitor != nullptr && m_chargeLegCount == 0 && m_planIndex < m_planSize) {
+                checkBattery(m_remainingInstructions.front());
+                instructionsLeft = m_remainingInstructions.size();
+            }
+
+            currentInstruction = m_remainingInstructions.front();
+            m_remainingInstructions.pop_front();
+            refillPlan();
+            updateRemainingCount();
+            m_startedCount++;
+        }
+    }
+
+    if (instructionsLeft > 0) {
+        if (takeNext) {
+            // the blade spins for cutting instructions and is stopped for transit legs
+            if (currentInstruction.cutting && !m_isBladeSpinning) {
+                m_bladeControl->startMotor();
+                m_isBladeSpinning = true;
+            } else if (!currentInstruction.cutting && m_isBladeSpinning) {
                 m_bladeControl->stopMotor();
                 m_isBladeSpinning = false;
-                *m_currentState = IDLE;
             }
+
+            // a turn is too short to split, so a turn that should pre-spin the blade starts it up front
+            if (!currentInstruction.cutting && currentInstruction.preSpinMs > 0 && (currentInstruction.action == "TL" || currentInstruction.action == "TR")) {
+                m_bladeControl->startMotor();
+                m_isBladeSpinning = true;
+            }
+
+            if (m_verbose) {
+                LOG_INFO("exec", "instruction %s%g, %zu instructions left", currentInstruction.action.c_str(), currentInstruction.value, instructionsLeft);
+            }
+
+            startInstruction(currentInstruction, waitMs);
+            recordStateChange();
+            publishTelemetry();
+
+            if (m_missionLog != nullptr) {
+                m_missionLog->logInstructionStart(currentInstruction, m_currentDurationMs);
+            }
+
+            // the token or the e-stop may have stopped the motors just before they were switched on
+            if (m_cancelToken->isCancelled() || isFaulted()) {
+                cancelCurrent();
+                return 0;
+            }
+
+            return 1;
+        } else { // this will be reach only if we are in paused state (i.e. we need to stop blade from spinning while paused)
+            m_bladeControl->stopMotor();
+            m_isBladeSpinning = false;
+            recordStateChange(); // the wheels stopped with the last instruction
+        }
+    } else { // if we finish all instructions
+        if (*m_currentState == MOWING) { // only if we were previously mowing and finished all instructions, return to idle state, stop blade motor
+            m_bladeControl->stopMotor();
+            m_isBladeSpinning = false;
+            setState(IDLE);
+
+            if (m_missionLog != nullptr) {
+                m_missionLog->logMissionEnd(true);
+            }
+        } else if (m_isBladeSpinning) { // instructions cleared by the start button, the blade was left spinning
+            m_bladeControl->stopMotor();
+            m_isBladeSpinning = false;
         }
     }
 
-    delay(1000); // small delay before destroying current thread to avoid any errors
+    publishTelemetry(); // only written to the segment if something changed
 
     return 0;
 }
 
 /**
- * Function that sets the remaining instructions
+ * Function that is called when the wait from startNext() (or the last continueCurrent()) is over
+ * @param waitMs: set to how long to wait before calling continueCurrent() again, if the instruction is not done
+ * @return 1: the instruction needs another wait (blade pre-spin, charging)
+ * @return 0: the instruction is done (or was cancelled) and the wheels are stopped
+ */
+int ExecutionController::continueCurrent(unsigned int& waitMs) {
+    TRACE_SPAN("exec", "continueCurrent");
+
+    if (m_phase != NO_INSTRUCTION && (m_cancelToken->isCancelled() || isFaulted())) {
+        return cancelCurrent();
+    }
+
+    updatePose(m_board->millis() - m_startedMs);
+
+    switch (m_phase) {
+        case PRE_SPIN: // blade-off leg nearly done, get the blade up to speed before cutting resumes
+            m_bladeControl->startMotor();
+            m_isBladeSpinning = true;
+            m_phase = DRIVING;
+            waitMs = m_preSpinLeadMs;
+            publishTelemetry();
+            return 1;
+        case CHARGING:
+            if (!isCharged()) {
+                waitMs = CHARGE_POLL_MS;
+                return 1;
+            }
+
+            m_batteryMonitor->stopCharging();
+            return finishInstruction(m_currentDurationMs);
+        case DRIVING:
+            return finishInstruction(m_currentDurationMs);
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Getter function that returns whether an instruction has been started and not finished yet
+ */
+bool ExecutionController::isInstructionActive() {
+    return m_phase != NO_INSTRUCTION;
+}
+
+/**
+ * Function that ends the current instruction early (on shutdown): the wheels and blade are stopped
+ * and the pose estimate only moves as far as the mower got
+ * @return 0: success
+ * @return -1: no instruction is active
+ */
+int ExecutionController::cancelCurrent() {
+    if (m_phase == NO_INSTRUCTION) {
+        return -1;
+    }
+
+    TRACE_SPAN("exec", "cancelCurrent");
+
+    int elapsedMs = std::min((int) (m_board->millis() - m_startedMs), m_currentDurationMs);
+
+    if (m_phase == CHARGING) {
+        m_batteryMonitor->stopCharging();
+    }
+
+    m_bladeControl->stopMotor();
+    m_isBladeSpinning = false;
+
+    return finishInstruction(elapsedMs);
+}
+
+/**
+ * Function that sets the remaining instructions, the blade scheduler decides from their annotations when the blade spins
  * Return value is 0 for success
  */
 int ExecutionController::assignInstructions() {
-    std::cout << "assigning instructions" << std::endl;
+    std::lock_guard<std::mutex> lock(m_planMutex);
+
+    if (m_verbose) {
+        LOG_INFO("exec", "assigning instructions");
+    }
 
     if (m_path->getInstructions().size() > 0) {
-        std::cout << "assigned" << std::endl;
+        if (m_verbose) {
+            LOG_INFO("exec", "assigned %zu instructions", m_path->getInstructions().size());
+        }
+
+        m_planStream = nullptr;
         m_remainingInstructions = m_path->getInstructions();
-    } else {
-        std::cout << "not assigned" << std::endl;
+        m_bladeScheduler.schedule(m_remainingInstructions);
+        preparePlan(m_path->getStartPose());
+        updateRemainingCount();
+
+        if (m_missionLog != nullptr) {
+            m_missionLog->logMissionStart(m_remainingInstructions.size());
+        }
+    } else if (m_verbose) {
+        LOG_WARN("exec", "not assigned: the path is empty");
+    }
+
+    return 0;
+}
+
+/**
+ * Function that sets the remaining instructions from a plan that did not come from the Path (e.g. PlanSearch or LawnPartitioner)
+ * @param start: pose the plan starts from (used to plan the way back to the base)
+ * @return 0: success
+ * @return -1: the plan is empty
+ */
+int ExecutionController::assignInstructions(const Plan& instructions, const Pose& start) {
+    if (instructions.size() == 0) {
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> lock(m_planMutex);
+    m_planStream = nullptr;
+    m_remainingInstructions = instructions;
+    m_bladeScheduler.schedule(m_remainingInstructions);
+    preparePlan(start);
+    updateRemainingCount();
+
+    if (m_missionLog != nullptr) {
+        m_missionLog->logMissionStart(m_remainingInstructions.size());
+    }
+
+    return 0;
+}
+
+/**
+ * Function that sets the remaining instructions from a compressed plan, which is decoded as it is executed: only the next
+ * PLAN_STREAM_WINDOW instructions are ever in the queue, however long the plan. The plan is executed as stored, it is not
+ * blade scheduled again (see CompressedPlanWriter.h), and it must stay open until the mission is over or cleared.
+ * @param start: pose the plan starts from (used to plan the way back to the base)
+ * @return 0: success
+ * @return -1: the plan is empty or not open
+ */
+int ExecutionController::assignInstructions(CompressedPlanReader& plan, const Pose& start) {
+    if (plan.getInstructionCount() == 0) {
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> lock(m_planMutex);
+    m_planStream = &plan;
+    m_remainingInstructions.clear();
+    preparePlan(start);
+    refillPlan();
+    updateRemainingCount();
+
+    if (m_missionLog != nullptr) {
+        m_missionLog->logMissionStart(plan.getInstructionCount());
     }
 
     return 0;
@@ -90,15 +406,55 @@ int ExecutionController::assignInstructions() {
 
 /**
  * Function that clears the current instruction set, assuming > 0
+ * Safe to call from the button thread while the executor runs: the plan (queue, energy table and position in it) is only
+ * changed under m_planMutex, which the executor holds while it takes the next instruction and counts it done.
+ * The instruction being driven is not cut short, nothing follows it
  * Return value is 0 for success
  */
 int ExecutionController::clearInstructions() {
-    std::cout << "clearing instructions" << std::endl;
+    std::lock_guard<std::mutex> lock(m_planMutex);
+
+    if (m_verbose) {
+        LOG_INFO("exec", "clearing instructions");
+    }
 
     if (m_remainingInstructions.size() > 0) {
         m_remainingInstructions.clear();
     }
 
+    m_planStream = nullptr;
+    m_remainingCount = 0;
+    m_remainingWh.clear();
+    m_planSize = 0;
+    m_chargeLegCount = 0;
+
+    // the plan was dropped before the end (start button, e-stop)
+    if (m_missionLog != nullptr) {
+        m_missionLog->logMissionEnd(false);
+    }
+
+    return 0;
+}
+
+/**
+ * Function that makes room for plans of up to maxInstructions (and the legs to the base and back), called once at start up:
+ * after it, assigning and executing such plans does not use the heap
+ * @return 0: success
+ * @return -1: a plan is assigned
+ */
+int ExecutionController::reservePlan(size_t maxInstructions) {
+    std::lock_guard<std::mutex> lock(m_planMutex);
+
+    if (m_remainingInstructions.size() > 0) {
+        return -1;
+    }
+
+    // the queue's blocks stay in the arena's pool when it is emptied again
+    m_remainingInstructions.resize(maxInstructions + 2 * TRANSIT_LEG_SIZE + 1);
+    m_remainingInstructions.clear();
+    updateRemainingCount();
+    m_remainingWh.reserve(maxInstructions + 1);
+
     return 0;
 }
 
@@ -109,53 +465,555 @@ State ExecutionController::getCurrentState() {
 	return *m_currentState;
 }
 
+/**
+ * Function that shuts the executor down: cancels the token, which stops the motors straight away
+ * and cuts short the wait of the instruction being executed
+ */
 void ExecutionController::sendShutDownSignal() {
-    m_shutDownFlag = true;
+    m_cancelToken->cancel();
 
     return;
 }
 
 /**
- * Function used in the executionlistener function to move the mower depending on the instruction
+ * Setter function which replaces the executor's own token with one shared with the other controllers (set before running)
+ * Cancelling it stops the wheel and blade motors from the cancelling thread
+ */
+int ExecutionController::setCancellationToken(CancellationToken& token) {
+    m_cancelToken = &token;
+    token.onCancel([this]() { stopMotors(); });
+
+    return 0;
+}
+
+/**
+ * Setter function for the (optional) e-stop: the e-stop switches the motors off itself, while its fault is latched
+ * the executor ends the current instruction, drops the rest of the plan and will not start anything
+ */
+void ExecutionController::setEmergencyStop(EmergencyStop& emergencyStop) {
+    m_emergencyStop = &emergencyStop;
+}
+
+/**
+ * Setter function for the (optional) pose estimator, which is fed every executed wheel command
+ */
+void ExecutionController::setPoseEstimator(PoseEstimator& poseEstimator) {
+    m_poseEstimator = &poseEstimator;
+}
+
+/**
+ * Setter function for the (optional) mission log, which records the missions, instructions and state changes of the executor
+ */
+void ExecutionController::setMissionLog(MissionLog& missionLog) {
+    m_missionLog = &missionLog;
+}
+
+/**
+ * Setter function for the (optional) telemetry segment, which the executor keeps up to date with its state, position
+ * in the plan, pose and motor pins (it must only be published to from the executor's thread)
+ */
+int ExecutionController::setTelemetry(TelemetryWriter& telemetry) {
+    m_telemetry = &telemetry;
+    publishTelemetry();
+
+    return 0;
+}
+
+/**
+ * Getter function for the estimated pose of the mower
+ * @return 0: success
+ * @return -1: no pose estimator has been set
+ */
+int ExecutionController::getPose(Pose& pose) {
+    if (m_poseEstimator == nullptr) {
+        return -1;
+    }
+
+    pose = m_poseEstimator->getPose();
+
+    return 0;
+}
+
+/**
+ * Setter function which turns the per instruction console output on or off (off for simulations)
+ */
+void ExecutionController::setVerbose(bool verbose) {
+    m_verbose = verbose;
+}
+
+/**
+ * Setter function which replaces the blade scheduler (e.g. with other spin up times, or disabled), used for the next assigned plan
+ */
+void ExecutionController::setBladeScheduler(const BladeScheduler& bladeScheduler) {
+    m_bladeScheduler = bladeScheduler;
+}
+
+/**
+ * Setter function which turns on return-to-base: before each instruction the executor checks the battery against
+ * what the rest of the plan needs and drives home to charge (and back) when it would not last
+ *
+ * @param batteryMonitor: battery of the mower
+ * @param energyModel: model used to predict the energy of the plan and of the drive home (must outlive the executor)
+ * @param base: pose of the charging base, in the frame of the plan
+ * @param reserveWh: charge that must be left when the mower gets home
+ * @return 0: success
+ * @return -1: negative reserve
+ */
+int ExecutionController::setReturnToBase(BatteryMonitor& batteryMonitor, const EnergyModel& energyModel, const Pose& base, double reserveWh) {
+    if (reserveWh < 0) {
+        return -1;
+    }
+
+    m_batteryMonitor = &batteryMonitor;
+    m_energyModel = &energyModel;
+    m_basePose = base;
+    m_reserveWh = reserveWh;
+
+    return 0;
+}
+
+/**
+ * Getter function that returns how many times the mower went home to charge during the current plan
+ */
+int ExecutionController::getReturnCount() {
+    return m_returnCount;
+}
+
+/**
+ * Getter function that returns how many instructions are left to execute (safe to call from any thread)
+ */
+int ExecutionController::getRemainingCount() {
+    return m_remainingCount;
+}
+
+/**
+ * Function the buttons call after changing the state to MOWING or PAUSED: the time until the executor next switches
+ * the motors for it is recorded (safe to call from another thread)
+ * Return value is 0 for success
+ */
+int ExecutionController::markStateChange() {
+    m_stateChangedNs.store(LatencyHistogram::now());
+
+    return 0;
+}
+
+/**
+ * Getter function that returns how long the motors took to follow a state change (see markStateChange())
+ */
+const LatencyHistogram& ExecutionController::getStateChangeHistogram() {
+    return m_stateChangeHistogram;
+}
+
+/**
+ * Getter function that returns how much longer than commanded the motions ran (ms resolution)
+ */
+const LatencyHistogram& ExecutionController::getOverrunHistogram() {
+    return m_overrunHistogram;
+}
+
+/**
+ * Function that publishes the current state to the telemetry segment, if there is one
+ * Only memory is touched (the motor levels are the ones last written, no pin is read), so it is called from the loop
+ * Return value is 0 for success
+ */
+int ExecutionController::publishTelemetry() {
+    if (m_telemetry == nullptr) {
+        return 0;
+    }
+
+    TelemetryFrame frame;
+    Pose pose;
+
+    memset(&frame, 0, sizeof(frame));
+
+    if (getPose(pose) == 0) {
+        frame.x = pose.x;
+        frame.y = pose.y;
+        frame.theta = pose.theta;
+        frame.poseValid = 1;
+    }
+
+    frame.state = *m_currentState;
+    frame.phase = m_phase;
+    frame.instructionIndex = m_startedCount;
+    frame.remainingCount = getRemainingCount();
+    frame.bladeSpinning = m_isBladeSpinning;
+
+    if (m_phase != NO_INSTRUCTION) {
+        strncpy(frame.action, m_currentInstruction.action.c_str(), sizeof(frame.action) - 1);
+        frame.value = m_currentInstruction.value;
+    }
+
+    Motor* leftWheelMotor = m_wheelControl->getLeftWheelMotor();
+    Motor* rightWheelMotor = m_wheelControl->getRightWheelMotor();
+    Motor* bladeMotor = m_bladeControl->getBladeMotor();
+
+    frame.motorLevels = leftWheelMotor->getLevels() | rightWheelMotor->getLevels() << 2 | bladeMotor->getLevels() << 4;
+
+    m_telemetry->publish(frame);
+
+    return 0;
+}
+
+/**
+ * Function that records the time since the last state change, if there is one the motors have not followed yet
  * Return value is 0 for success
  */
-int ExecutionController::executeInstruction(Instruction instruction) {
+int ExecutionController::recordStateChange() {
+    if (m_stateChangedNs.load(std::memory_order_relaxed) == 0) {
+        return 0;
+    }
+
+    long long changedNs = m_stateChangedNs.exchange(0);
+
+    if (changedNs != 0) {
+        m_stateChangeHistogram.recordSince(changedNs);
+    }
+
+    return 0;
+}
+
+/**
+ * Function used to move the mower depending on the instruction: switches the motors on and returns how long they should run
+ * @param waitMs: set to how long to wait before continueCurrent() is called
+ * @return 0: success
+ * @return -1: the value is negative or not finite, the instruction is skipped with a wait of 0
+ */
+int ExecutionController::startInstruction(const Instruction& instruction, unsigned int& waitMs) {
+    TRACE_SPAN("exec", "startInstruction");
+
     // parse instruction, call appropriate motor classes
-    double duration;
-
-    if (instruction.action == "MF") { // if move forward
-        duration = instruction.value * 925;
-
-        m_wheelControl->moveForward();
-        delay(duration);
-        m_wheelControl->stopMotor();
-    } else if (instruction.action == "MB") { // if move backwards
-        duration = instruction.value * 925;
-
-        m_wheelControl->moveBackward();
-        delay(duration);
-        m_wheelControl->stopMotor();
-    } else if (instruction.action == "TL") { // if turn left
-        if (instruction.value == 90.0) {
-            m_wheelControl->turnLeft(TurnDuration::positionOne);
-        } else if (instruction.value == 100.0) {
-            m_wheelControl->turnLeft(TurnDuration::positionThree);
-        } else if (instruction.value == 110.0) {
-            m_wheelControl->turnLeft(TurnDuration::positionFour);
-        } else { // 180.0
-            m_wheelControl->turnLeft(TurnDuration::positionOne);
-            m_wheelControl->turnLeft(TurnDuration::positionOne);
+    m_currentInstruction = instruction;
+    m_currentDurationMs = 0;
+    m_startedMs = m_board->millis();
+    m_poseMs = 0;
+    m_phase = DRIVING;
+
+    // a negative or not finite value would become a wait of billions of ms with the motors on: skip it, nothing is driven
+    if (!std::isfinite(instruction.value) || instruction.value < 0) {
+        LOG_WARN("exec", "skipped instruction %s%g", instruction.action.c_str(), instruction.value);
+        m_currentInstruction.value = 0;
+        waitMs = 0;
+        return -1;
+    }
+
+    if (instruction.action == "MF" || instruction.action == "MB") { // if move forward/backwards
+        m_currentDurationMs = instruction.value * DRIVE_MS_PER_METRE;
+
+        if (instruction.action == "MF") {
+            m_wheelControl->moveForward();
+        } else {
+            m_wheelControl->moveBackward();
+        }
+
+        // blade-off leg that should pre-spin: the blade starts preSpinMs before the end
+        if (!instruction.cutting && instruction.preSpinMs > 0 && !m_isBladeSpinning) {
+            m_preSpinLeadMs = std::min(m_currentDurationMs, instruction.preSpinMs);
+            m_phase = PRE_SPIN;
+            waitMs = m_currentDurationMs - m_preSpinLeadMs;
+            return 0;
         }
+    } else if (instruction.action == "TL") { // if turn left, any angle (duration comes from the calibration table unless the plan measured it)
+        m_currentDurationMs = std::max(0, m_wheelControl->startTurnLeft(instruction.value, instruction.durationMs));
     } else if (instruction.action == "TR") { // if turn right
-        if (instruction.value == 90.0) {
-            m_wheelControl->turnRight(TurnDuration::positionOne);
-        } else if (instruction.value == 100.0) {
-            m_wheelControl->turnRight(TurnDuration::positionTwo);
-        } else { // 180.0
-            m_wheelControl->turnRight(TurnDuration::positionOne);
-            m_wheelControl->turnRight(TurnDuration::positionOne);
+        m_currentDurationMs = std::max(0, m_wheelControl->startTurnRight(instruction.value, instruction.durationMs));
+    } else if (instruction.action == "CH" && m_batteryMonitor != nullptr) { // if charge (the mower is on the base)
+        m_bladeControl->stopMotor();
+        m_isBladeSpinning = false;
+        m_batteryMonitor->startCharging();
+        m_phase = CHARGING;
+        waitMs = isCharged() ? 0 : CHARGE_POLL_MS;
+        return 0;
+    }
+
+    waitMs = m_currentDurationMs;
+
+    return 0;
+}
+
+/**
+ * Function that ends the current instruction: stops the wheels and updates the pose estimate and the plan position
+ * @param elapsedMs: how long the wheels ran (less than the instruction's duration if it was cancelled)
+ * Return value is 0 for success
+ */
+int ExecutionController::finishInstruction(int elapsedMs) {
+    TRACE_SPAN("exec", "finishInstruction");
+
+    const Instruction& instruction = m_currentInstruction;
+
+    m_wheelControl->stopMotor();
+    m_phase = NO_INSTRUCTION;
+
+    if (m_missionLog != nullptr) {
+        m_missionLog->logInstructionEnd(instruction, m_currentDurationMs, m_board->millis() - m_startedMs, elapsedMs < m_currentDurationMs);
+    }
+
+    // commanded against actual duration of motions that ran to the end (the board clock counts in ms)
+    if (m_currentDurationMs > 0 && elapsedMs >= m_currentDurationMs) {
+        int overrunMs = (int) (m_board->millis() - m_startedMs) - m_currentDurationMs;
+        m_overrunHistogram.record(std::max(0, overrunMs) * 1000);
+    }
+
+    // the motion was stepped while it ran, only the rest of it and the coast to a stop are left
+    if (updatePose(elapsedMs) == 1) {
+        m_poseEstimator->coast();
+    }
+
+    if (m_batteryMonitor != nullptr) {
+        std::lock_guard<std::mutex> lock(m_planMutex);
+        m_plannedPose = DriveModel(m_path->getCarDiameter()).applyInstruction(m_plannedPose, instruction);
+
+        if (m_chargeLegCount > 0) {
+            m_chargeLegCount--;
+        } else {
+            if (m_planStream != nullptr) {
+                m_streamRemainingWh -= m_energyModel->getInstructionWh(instruction, m_streamBladeWasOn);
+                m_streamBladeWasOn = instruction.cutting;
+            }
+
+            m_planIndex++;
         }
     }
 
+    publishTelemetry();
+
     return 0;
 }
+
+/**
+ * Function that steps the pose estimate through the current motion up to elapsedMs, the part stepped before is skipped
+ * @param elapsedMs: how long the wheels have run so far (capped at the instruction's duration)
+ * @return 1: the current instruction is a motion and the estimate is up to date with it
+ * @return 0: no pose estimator has been set, or the instruction does not move the wheels
+ */
+int ExecutionController::updatePose(int elapsedMs) {
+    if (m_poseEstimator == nullptr) {
+        return 0;
+    }
+
+    const Instruction& instruction = m_currentInstruction;
+    double vLeft;
+    double vRight;
+
+    if (instruction.action == "MF") {
+        vLeft = DRIVE_SPEED;
+        vRight = DRIVE_SPEED;
+    } else if (instruction.action == "MB") {
+        vLeft = -DRIVE_SPEED;
+        vRight = -DRIVE_SPEED;
+    } else if (instruction.action == "TL") {
+        vLeft = 0;
+        vRight = m_poseEstimator->getDriveModel().getTurnWheelSpeed(instruction.value, m_currentDurationMs);
+    } else if (instruction.action == "TR") {
+        vLeft = m_poseEstimator->getDriveModel().getTurnWheelSpeed(instruction.value, m_currentDurationMs);
+        vRight = 0;
+    } else {
+        return 0;
+    }
+
+    int poseMs = std::min(elapsedMs, m_currentDurationMs);
+
+    if (poseMs > m_poseMs) {
+        m_poseEstimator->advance(vLeft, vRight, poseMs - m_poseMs);
+        m_poseMs = poseMs;
+    }
+
+    return 1;
+}
+
+/**
+ * Function that predicts the energy of a newly assigned plan: what is left from every instruction and the drive home from the end
+ */
+int ExecutionController::preparePlan(const Pose& start) {
+    m_plannedPose = start;
+    m_planIndex = 0;
+    m_planSize = m_planStream != nullptr ? m_planStream->getInstructionCount() : m_remainingInstructions.size();
+    m_startedCount = 0;
+    m_resumeIndex = 0;
+    m_chargeLegCount = 0;
+    m_returnCount = 0;
+    m_remainingWh.clear();
+
+    if (m_batteryMonitor == nullptr) {
+        return 0;
+    }
+
+    DriveModel model(m_path->getCarDiameter());
+    Pose end = start;
+
+    if (m_planStream != nullptr) {
+        // one pass through a streamed plan for its end and its energy, which is then counted down as it is executed
+        Instruction instruction;
+        bool bladeWasOn = false;
+
+        m_planStream->rewind();
+        m_streamRemainingWh = 0;
+        m_streamBladeWasOn = false;
+
+        while (m_planStream->next(instruction) == 1) {
+            end = model.applyInstruction(end, instruction);
+            m_streamRemainingWh += m_energyModel->getInstructionWh(instruction, bladeWasOn);
+            bladeWasOn = instruction.cutting;
+        }
+
+        m_planStream->rewind();
+    } else {
+        for (const Instruction& instruction : m_remainingInstructions) {
+            end = model.applyInstruction(end, instruction);
+        }
+
+        m_energyModel->getRemainingWh(m_remainingInstructions, m_remainingWh);
+    }
+
+    m_endToBaseWh = m_energyModel->getTransitWh(end, m_basePose);
+
+    return 0;
+}
+
+/**
+ * Function that decodes the next instructions of a streamed plan to the back of the queue, up to PLAN_STREAM_WINDOW
+ * Return value is the number of instructions decoded
+ */
+int ExecutionController::refillPlan() {
+    Instruction instruction;
+    int decoded = 0;
+
+    if (m_planStream == nullptr) {
+        return 0;
+    }
+
+    while (m_remainingInstructions.size() < PLAN_STREAM_WINDOW && m_planStream->next(instruction) == 1) {
+        m_remainingInstructions.push_back(instruction);
+        decoded++;
+    }
+
+    return decoded;
+}
+
+/**
+ * Function that counts the plan instructions left after the plan has changed, called with m_planMutex held
+ */
+void ExecutionController::updateRemainingCount() {
+    m_remainingCount = m_remainingInstructions.size() + (m_planStream != nullptr ? m_planStream->getRemainingCount() : 0);
+}
+
+/**
+ * Function that returns the energy needed from the next plan instruction to the end of the plan
+ */
+double ExecutionController::getRemainingPlanWh() {
+    return m_planStream != nullptr ? m_streamRemainingWh : m_remainingWh[m_planIndex];
+}
+
+/**
+ * Function that checks the battery before the next plan instruction
+ * Going home is left as late as possible: only when after the next instruction there would not be enough charge to get home
+ *
+ * @return 1: return, charge and resume legs were put in front of the plan
+ * @return 0: the battery lasts
+ */
+int ExecutionController::checkBattery(const Instruction& next) {
+    double remainingWh = m_batteryMonitor->getRemainingWh();
+
+    m_wheelControl->setBatteryVoltage(m_batteryMonitor->getVoltage());
+
+    // enough for the whole rest of the plan and the drive home (the usual case, constant time)
+    if (remainingWh >= getRemainingPlanWh() + m_endToBaseWh + m_reserveWh) {
+        return 0;
+    }
+
+    Pose afterNext = DriveModel(m_path->getCarDiameter()).applyInstruction(m_plannedPose, next);
+    double neededWh = m_energyModel->getInstructionWh(next, m_isBladeSpinning) + m_energyModel->getTransitWh(afterNext, m_basePose);
+
+    // right after coming back from the base a low battery is as full as it gets, going home again would not help
+    if (remainingWh >= neededWh + m_reserveWh || (m_returnCount > 0 && m_planIndex == m_resumeIndex)) {
+        return 0;
+    }
+
+    unsigned char buffer[TRANSIT_BUFFER_BYTES];
+    std::pmr::monotonic_buffer_resource legMemory(buffer, sizeof(buffer));
+    Plan returnLeg(&legMemory);
+    Plan resumeLeg(&legMemory);
+
+    m_energyModel->getTransit(m_plannedPose, m_basePose, returnLeg);
+    m_energyModel->getTransit(m_basePose, m_plannedPose, resumeLeg);
+
+    // resume leg goes in first so the queue ends up: return leg, charge, resume leg, rest of the plan
+    for (auto it = resumeLeg.rbegin(); it != resumeLeg.rend(); it++) {
+        m_remainingInstructions.push_front(*it);
+    }
+
+    m_remainingInstructions.push_front(Instruction{"CH", 0, false});
+
+    for (auto it = returnLeg.rbegin(); it != returnLeg.rend(); it++) {
+        m_remainingInstructions.push_front(*it);
+    }
+
+    m_chargeLegCount = returnLeg.size() + 1 + resumeLeg.size();
+    m_resumeIndex = m_planIndex;
+    m_returnCount++;
+
+    if (m_verbose) {
+        LOG_WARN("exec", "battery low (%g Wh), returning to base", remainingWh);
+    }
+
+    return 1;
+}
+
+/**
+ * Function that checks whether the battery is (nearly) full, so the mower can leave the base
+ */
+bool ExecutionController::isCharged() {
+    return m_batteryMonitor->getRemainingWh() >= m_batteryMonitor->getCapacityWh() * CHARGED_FRACTION;
+}
+
+/**
+ * Function that switches the wheel and blade motors off, called from the cancelling thread on shutdown
+ * (only writes pins, so it is safe while the executor thread is still running)
+ */
+int ExecutionController::stopMotors() {
+    m_wheelControl->stopMotor();
+    m_bladeControl->stopMotor();
+
+    return 0;
+}
+
+/**
+ * Function that returns whether an e-stop fault is latched
+ */
+bool ExecutionController::isFaulted() {
+    return m_emergencyStop != nullptr && m_emergencyStop->isLatched();
+}
+
+/**
+ * Function that abandons the mission after an e-stop: motors off, plan dropped, back to idle
+ * Return value is 0 (nothing started)
+ */
+int ExecutionController::abortOnFault() {
+    stopMotors();
+    m_isBladeSpinning = false;
+
+    if (getRemainingCount() > 0) {
+        clearInstructions();
+    } else if (m_missionLog != nullptr) { // stopped during the last instruction
+        m_missionLog->logMissionEnd(false);
+    }
+
+    if (*m_currentState == MOWING || *m_currentState == PAUSED) {
+        setState(IDLE);
+    }
+
+    publishTelemetry();
+
+    return 0;
+}
+
+/**
+ * Function that changes the mower's state, and records the change in the mission log
+ */
+void ExecutionController::setState(State state) {
+    if (m_missionLog != nullptr) {
+        m_missionLog->logState(*m_currentState, state);
+    }
+
+    *m_currentState = state;
+}
@@ -0,0 +1,317 @@
+/**
+ * This file contains the implementation of the FleetSimulator class and all associated member functions that are included in the FleetSimulator.h file.
+ * The FleetSimulator class runs many virtual mowers headless and sums up mission time, coverage and energy.
+ *
+ */
+
+#include "FleetSimulator.h"
+#include "State.h"
+#include "Path.h"
+#include "Motor.h"
+#include "WheelController.h"
+#include "BladeController.h"
+#include "ExecutionController.h"
+#include "CoverageGrid.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// same wiring as the real mower (see thread_test.cpp)
+const int LEFT_WHEEL_PIN_CW = 24;
+const int LEFT_WHEEL_PIN_CCW = 23; // left wheel forward
+const int RIGHT_WHEEL_PIN_CW = 21; // right wheel forward
+const int RIGHT_WHEEL_PIN_CCW = 22;
+const int BLADE_PIN_CW = 2;
+const int BLADE_PIN_CCW = 3;
+
+const double REPLAY_ARC_STEP = 10 * M_PI / 180; // pivots are replayed in steps of at most 10 degrees
+const int MOWERS_PER_SHARD = 16;
+
+/**
+ * Constructor
+ *
+ * @param carDiameter: diameter of the mowers (also used as the wheel base)
+ * @param bladeDiameter: diameter of the blades
+ * @param pool: thread pool the mowers are simulated on
+ *
+ */
+FleetSimulator::FleetSimulator(double carDiameter, double bladeDiameter, ThreadPool& pool) {
+	m_carDiameter = carDiameter;
+	m_bladeDiameter = bladeDiameter;
+	m_resolution = 0.05;
+	m_pool = &pool;
+	m_summary = FleetSummary{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+	m_errorNum = 0;
+}
+
+/**
+ * Member function destructor which deletes an object: no return
+ */
+FleetSimulator::~FleetSimulator() {
+
+}
+
+/**
+ * Function which adds a virtual mower with its own lawn
+ *
+ * @return 0: success
+ * @return -1: the lawn is smaller than the mower
+ */
+int FleetSimulator::addMower(double length, double width) {
+	if (length < m_carDiameter || width < m_carDiameter) {
+		m_errorNum = -1;
+		return -1;
+	}
+
+	m_results.push_back(MowerResult{length, width, 0, 0, 0, 0, 0, 0});
+
+	return 0;
+}
+
+/**
+ * Setter function for the coverage grid resolution in metres
+ */
+int FleetSimulator::setResolution(double resolution) {
+	if (resolution <= 0) {
+		m_errorNum = -1;
+		return -1;
+	}
+
+	m_resolution = resolution;
+
+	return 0;
+}
+
+/**
+ * Setter function for the blade scheduler every mower's executor uses
+ */
+int FleetSimulator::setBladeScheduler(const BladeScheduler& bladeScheduler) {
+	m_bladeScheduler = bladeScheduler;
+
+	return 0;
+}
+
+/**
+ * Function which simulates every mower on the thread pool and sums up the results
+ *
+ * @return 0: success
+ * @return -1: no mowers, or a mission failed
+ */
+int FleetSimulator::run() {
+	if (m_results.empty()) {
+		m_errorNum = -1;
+		return -1;
+	}
+
+	std::atomic<int> failures(0);
+	auto start = std::chrono::steady_clock::now();
+
+	// every task writes to its own results, so no locking is needed
+	for (size_t begin = 0; begin < m_results.size(); begin += MOWERS_PER_SHARD) {
+		size_t end = std::min(m_results.size(), begin + MOWERS_PER_SHARD);
+
+		m_pool->submit([this, begin, end, &failures]() {
+			for (size_t i = begin; i < end; i++) {
+				if (simulateMower(m_results[i]) != 0) {
+					failures++;
+				}
+			}
+		});
+	}
+
+	m_pool->wait();
+
+	auto finish = std::chrono::steady_clock::now();
+	std::vector<double> minutes;
+	FleetSummary summary = FleetSummary{(int) m_results.size(), 0, 0, 0, 0, 0, 0, 0, HUGE_VAL, 0, 0, 0};
+
+	for (const MowerResult& result : m_results) {
+		minutes.push_back(result.missionSeconds / 60);
+		summary.simulatedHours += result.missionSeconds / 3600;
+		summary.meanCoveragePercent += result.coveragePercent / m_results.size();
+		summary.minCoveragePercent = std::min(summary.minCoveragePercent, result.coveragePercent);
+		summary.totalEnergyWh += result.energyWh;
+		summary.meanBladeMinutes += result.bladeSeconds / 60 / m_results.size();
+	}
+
+	std::sort(minutes.begin(), minutes.end());
+
+	summary.wallSeconds = std::chrono::duration<double>(finish - start).count();
+	summary.mowerHoursPerSecond = summary.simulatedHours / summary.wallSeconds;
+	summary.meanMissionMinutes = summary.simulatedHours * 60 / m_results.size();
+	summary.p95MissionMinutes = minutes[(size_t) (0.95 * (minutes.size() - 1))];
+	summary.maxMissionMinutes = minutes.back();
+	summary.meanEnergyWh = summary.totalEnergyWh / m_results.size();
+	m_summary = summary;
+
+	if (failures > 0) {
+		m_errorNum = -1;
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * Getter function which returns the summary of the last run
+ */
+FleetSummary FleetSimulator::getSummary() {
+	return m_summary;
+}
+
+/**
+ * Getter function which returns the result of every mower, in the order they were added
+ */
+std::vector<MowerResult>& FleetSimulator::getResults() {
+	return m_results;
+}
+
+/**
+ * Getter function which returns the errorNum variable which holds the value of the current error call
+ */
+int FleetSimulator::getErrorNum() {
+	return m_errorNum;
+}
+
+/**
+ * Function which builds one mower on its own board, runs its whole mission and fills in the result
+ */
+int FleetSimulator::simulateMower(MowerResult& result) {
+	SimBoard board;
+	State currentState = MOWING;
+	Path path(result.length, result.width, m_carDiameter, m_bladeDiameter, false);
+
+	Motor leftWheelMotor(LEFT_WHEEL_PIN_CW, LEFT_WHEEL_PIN_CCW, board);
+	Motor rightWheelMotor(RIGHT_WHEEL_PIN_CW, RIGHT_WHEEL_PIN_CCW, board);
+	Motor bladeMotor(BLADE_PIN_CW, BLADE_PIN_CCW, board);
+	WheelController wheelControl(leftWheelMotor, rightWheelMotor);
+	BladeController bladeControl(bladeMotor);
+	ExecutionController exec(currentState, path, wheelControl, bladeControl, board);
+
+	exec.setVerbose(false);
+	exec.setBladeScheduler(m_bladeScheduler);
+	exec.assignInstructions();
+	result.instructionCount = exec.getRemainingCount();
+
+	// one instruction per executeNext(), in plan order: note when the turns with a measured time run for the replay
+	const Plan& plan = path.getInstructions();
+	DriveModel model(m_carDiameter);
+	std::vector<MeasuredTurn> measuredTurns;
+
+	for (size_t i = 0; ; i++) {
+		unsigned int startMs = board.millis();
+
+		if (exec.executeNext() <= 0) {
+			break;
+		}
+
+		if (i < plan.size() && plan[i].durationMs > 0 && (plan[i].action == "TL" || plan[i].action == "TR")) {
+			measuredTurns.push_back(MeasuredTurn{startMs, board.millis(), model.getTurnWheelSpeed(plan[i].value, plan[i].durationMs)});
+		}
+	}
+
+	exec.executeNext(); // out of instructions: stops the blade and goes back to idle
+
+	if (currentState != IDLE) {
+		return -1;
+	}
+
+	result.missionSeconds = board.millis() / 1000.0;
+
+	double wheelMs = board.getPinHighTime(LEFT_WHEEL_PIN_CW) + board.getPinHighTime(LEFT_WHEEL_PIN_CCW);
+	wheelMs += board.getPinHighTime(RIGHT_WHEEL_PIN_CW) + board.getPinHighTime(RIGHT_WHEEL_PIN_CCW);
+	double bladeMs = board.getPinHighTime(BLADE_PIN_CW) + board.getPinHighTime(BLADE_PIN_CCW);
+
+	result.bladeSeconds = bladeMs / 1000;
+	result.bladeStarts = 0;
+	bool bladeWasOn = false;
+
+	for (const PinInterval& interval : board.getIntervals()) {
+		bool bladeOn = ((interval.levels >> BLADE_PIN_CW) & 1) || ((interval.levels >> BLADE_PIN_CCW) & 1);
+		result.bladeStarts += bladeOn && !bladeWasOn ? 1 : 0;
+		bladeWasOn = bladeOn;
+	}
+
+	result.energyWh = (wheelMs * WHEEL_MOTOR_WATTS + bladeMs * BLADE_MOTOR_WATTS) / 3600000 + result.bladeStarts * BLADE_START_JOULES / 3600;
+
+	return replay(board, path.getStartPose(), std::max(result.length, result.width), std::min(result.length, result.width), measuredTurns, result);
+}
+
+/**
+ * Function which replays the pin intervals recorded by a board through the DriveModel and measures the coverage
+ * Pivots right after reversing slip like the WheelController after reverse correction describes,
+ * pivots of a turn the plan measured the time of reach its angle in that time
+ *
+ * @param start: pose of the mower when the mission started
+ * @param length: size of the lawn along x (the path puts the long side along x)
+ * @param width: size of the lawn along y
+ * @param measuredTurns: when the turns with a measured time ran, in order
+ */
+int FleetSimulator::replay(SimBoard& board, const Pose& start, double length, double width, const std::vector<MeasuredTurn>& measuredTurns, MowerResult& result) {
+	DriveModel model(m_carDiameter);
+	CoverageGrid grid(length, width, m_resolution);
+	double turnSpeed = model.getTurnWheelSpeed(90, TurnDuration::positionOne);
+	double turnLeftAfterReverseSpeed = model.getTurnWheelSpeed(90, TurnDuration::positionOne + LEFT_TURN_AFTER_REVERSE_MS);
+	double turnRightAfterReverseSpeed = model.getTurnWheelSpeed(90, TurnDuration::positionOne + RIGHT_TURN_AFTER_REVERSE_MS);
+	bool lastMoveBackward = false;
+	size_t measured = 0;
+	Pose pose = start;
+	std::vector<Pose> trace;
+
+	for (const PinInterval& interval : board.getIntervals()) {
+		int left = (int) ((interval.levels >> LEFT_WHEEL_PIN_CCW) & 1) - (int) ((interval.levels >> LEFT_WHEEL_PIN_CW) & 1);
+		int right = (int) ((interval.levels >> RIGHT_WHEEL_PIN_CW) & 1) - (int) ((interval.levels >> RIGHT_WHEEL_PIN_CCW) & 1);
+		bool bladeOn = ((interval.levels >> BLADE_PIN_CW) & 1) || ((interval.levels >> BLADE_PIN_CCW) & 1);
+		double dt = interval.durationMs / 1000.0;
+		double vLeft = left * DRIVE_SPEED;
+		double vRight = right * DRIVE_SPEED;
+
+		if (left == 0 && right == 0) {
+			continue;
+		}
+
+		while (measured < measuredTurns.size() && measuredTurns[measured].endMs <= interval.startMs) {
+			measured++;
+		}
+
+		bool inMeasuredTurn = measured < measuredTurns.size() && measuredTurns[measured].startMs <= interval.startMs;
+
+		if (left == 0) { // pivot about the left wheel (turn left)
+			vRight = right * (inMeasuredTurn ? measuredTurns[measured].wheelSpeed : lastMoveBackward ? turnLeftAfterReverseSpeed : turnSpeed);
+		} else if (right == 0) { // pivot about the right wheel (turn right)
+			vLeft = left * (inMeasuredTurn ? measuredTurns[measured].wheelSpeed : lastMoveBackward ? turnRightAfterReverseSpeed : turnSpeed);
+		}
+
+		lastMoveBackward = left < 0 && right < 0;
+
+		// the blade only cuts while it spins, sweep each spinning stretch separately
+		if (!bladeOn) {
+			if (trace.size() > 1) {
+				grid.sweepTrace(trace, m_bladeDiameter);
+			}
+
+			trace.clear();
+		} else if (trace.empty()) {
+			trace.push_back(pose);
+		}
+
+		double omega = std::fabs(vRight - vLeft) / m_carDiameter;
+		int steps = std::max(1, (int) std::ceil(omega * dt / REPLAY_ARC_STEP));
+
+		for (int i = 0; i < steps; i++) {
+			pose = model.integrate(pose, vLeft, vRight, dt / steps);
+
+			if (bladeOn) {
+				trace.push_back(pose);
+			}
+		}
+	}
+
+	if (trace.size() > 1) {
+		grid.sweepTrace(trace, m_bladeDiameter);
+	}
+
+	result.coveragePercent = grid.getCoveragePercent();
+
+	return 0;
+}
@@ -0,0 +1,150 @@
+/**
+ * This file contains the implementation of the LatencyHistogram class and all associated member functions that are included in the LatencyHistogram.h file.
+ * The LatencyHistogram class counts durations in log-linear buckets with atomic counters.
+ *
+ */
+
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <ctime>
+
+/**
+ * Constructor, every bucket starts empty
+ */
+LatencyHistogram::LatencyHistogram() : m_sumUs(0), m_maxUs(0) {
+	for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+		m_counts[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+/**
+ * Member function destructor which deletes an object: no return
+ */
+LatencyHistogram::~LatencyHistogram() {
+
+}
+
+/**
+ * Function which counts a duration, safe to call from any number of threads at once
+ * @param valueUs: the duration in microseconds
+ */
+void LatencyHistogram::record(unsigned int valueUs) {
+	m_counts[getBucketIndex(valueUs)].fetch_add(1, std::memory_order_relaxed);
+	m_sumUs.fetch_add(valueUs, std::memory_order_relaxed);
+
+	unsigned int maxUs = m_maxUs.load(std::memory_order_relaxed);
+
+	while (valueUs > maxUs && !m_maxUs.compare_exchange_weak(maxUs, valueUs, std::memory_order_relaxed)) {
+		// another thread changed the maximum, maxUs now holds its value
+	}
+}
+
+/**
+ * Function which counts the time from startNs (from now()) to now
+ */
+void LatencyHistogram::recordSince(long long startNs) {
+	long long elapsedUs = (now() - startNs) / 1000;
+
+	record(elapsedUs < 0 ? 0 : elapsedUs > UINT_MAX ? UINT_MAX : elapsedUs);
+}
+
+/**
+ * Function which copies the counts, while other threads keep recording (each bucket is read once, count is their sum)
+ * Return value is 0 for success
+ */
+int LatencyHistogram::getSnapshot(HistogramSnapshot& snapshot) const {
+	snapshot.counts.resize(HISTOGRAM_BUCKETS);
+	snapshot.count = 0;
+
+	for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+		snapshot.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+		snapshot.count += snapshot.counts[i];
+	}
+
+	snapshot.sumUs = m_sumUs.load(std::memory_order_relaxed);
+	snapshot.maxUs = m_maxUs.load(std::memory_order_relaxed);
+
+	return 0;
+}
+
+/**
+ * Function which empties every bucket, durations recorded at the same time may be kept or lost
+ * Return value is 0 for success
+ */
+int LatencyHistogram::reset() {
+	for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+		m_counts[i].store(0, std::memory_order_relaxed);
+	}
+
+	m_sumUs.store(0, std::memory_order_relaxed);
+	m_maxUs.store(0, std::memory_order_relaxed);
+
+	return 0;
+}
+
+/**
+ * Function which returns the duration that percentile of a snapshot's durations are at or below
+ * (the top of its bucket, at most the largest duration recorded)
+ *
+ * @param percentile: 0 to 100, e.g. 99.9
+ * @return the duration in microseconds, 0 for an empty snapshot
+ */
+unsigned int LatencyHistogram::getPercentileUs(const HistogramSnapshot& snapshot, double percentile) {
+	unsigned long wanted = std::max(1.0, std::ceil(snapshot.count * percentile / 100));
+	unsigned long seen = 0;
+
+	if (snapshot.count == 0) {
+		return 0;
+	}
+
+	for (int i = 0; i < (int) snapshot.counts.size(); i++) {
+		seen += snapshot.counts[i];
+
+		if (seen >= wanted) {
+			unsigned int topUs = i + 1 < HISTOGRAM_BUCKETS ? getBucketStartUs(i + 1) - 1 : UINT_MAX;
+			return std::min(topUs, snapshot.maxUs);
+		}
+	}
+
+	return snapshot.maxUs;
+}
+
+/**
+ * Function which returns the bucket a duration is counted in
+ */
+int LatencyHistogram::getBucketIndex(unsigned int valueUs) {
+	if (valueUs < (unsigned int) HISTOGRAM_SUB_BUCKETS) {
+		return valueUs;
+	}
+
+	// the top HISTOGRAM_SUB_BUCKET_BITS + 1 bits of the value pick the bucket
+	int shift = 31 - __builtin_clz(valueUs) - HISTOGRAM_SUB_BUCKET_BITS;
+
+	return (shift + 1) * HISTOGRAM_SUB_BUCKETS + (valueUs >> shift) - HISTOGRAM_SUB_BUCKETS;
+}
+
+/**
+ * Function which returns the smallest duration counted in a bucket
+ */
+unsigned int LatencyHistogram::getBucketStartUs(int index) {
+	if (index < HISTOGRAM_SUB_BUCKETS) {
+		return index;
+	}
+
+	int shift = index / HISTOGRAM_SUB_BUCKETS - 1;
+
+	return (unsigned int) (index % HISTOGRAM_SUB_BUCKETS + HISTOGRAM_SUB_BUCKETS) << shift;
+}
+
+/**
+ * Function which returns the clock durations are measured on, in nanoseconds (CLOCK_MONOTONIC)
+ */
+long long LatencyHistogram::now() {
+	timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
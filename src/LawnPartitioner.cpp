@@ -0,0 +1,341 @@
+/**
+ * This file contains the implementation of the LawnPartitioner class and all associated member functions that are included in the LawnPartitioner.h file.
+ * The LawnPartitioner class splits one lawn between several mowers so they all finish at about the same time.
+ *
+ */
+
+#include "LawnPartitioner.h"
+#include "CoveragePattern.h"
+#include "DriveModel.h"
+#include <algorithm>
+#include <cmath>
+
+const int SEARCH_ITERATIONS = 40; // bisection steps, plenty for mm precision on any lawn
+const double TURN_SECONDS_PER_DEGREE = 0.9 / 90;
+
+/**
+ * Constructor for a rectangular lawn [0, length] x [0, width]
+ *
+ * @param length: size of the lawn along x
+ * @param width: size of the lawn along y
+ * @param carDiameter: diameter of the mowers (also used as the wheel base)
+ * @param bladeDiameter: diameter of the blades
+ *
+ */
+LawnPartitioner::LawnPartitioner(double length, double width, double carDiameter, double bladeDiameter)
+	: LawnPartitioner({{0, 0}, {length, 0}, {length, width}, {0, width}}, carDiameter, bladeDiameter) {
+
+}
+
+/**
+ * Constructor for a polygonal lawn
+ *
+ * @param polygon: corners of the lawn in order (either direction)
+ * @param carDiameter: diameter of the mowers (also used as the wheel base)
+ * @param bladeDiameter: diameter of the blades
+ *
+ */
+LawnPartitioner::LawnPartitioner(const std::vector<LawnPoint>& polygon, double carDiameter, double bladeDiameter) {
+	m_polygon = polygon;
+	m_carDiameter = carDiameter;
+	m_bladeDiameter = bladeDiameter;
+	m_yMin = HUGE_VAL;
+	m_yMax = -HUGE_VAL;
+	m_errorNum = 0;
+
+	for (const LawnPoint& point : polygon) {
+		m_yMin = std::min(m_yMin, point.y);
+		m_yMax = std::max(m_yMax, point.y);
+	}
+
+	if (polygon.size() < 3) {
+		m_errorNum = -1;
+	}
+}
+
+/**
+ * Member function destructor which deletes an object: no return
+ */
+LawnPartitioner::~LawnPartitioner() {
+
+}
+
+/**
+ * Function which adds a mower, call partition() afterwards
+ *
+ * @param mowerId: id used in the assignments
+ * @param start: where the mower is now
+ * @return 0: success
+ * @return -1: already MAX_MOWERS mowers, or the id is in use
+ */
+int LawnPartitioner::addMower(int mowerId, const Pose& start) {
+	if ((int) m_mowers.size() >= MAX_MOWERS) {
+		m_errorNum = -1;
+		return -1;
+	}
+
+	for (const Mower& mower : m_mowers) {
+		if (mower.id == mowerId) {
+			m_errorNum = -1;
+			return -1;
+		}
+	}
+
+	m_mowers.push_back(Mower{mowerId, start});
+
+	return 0;
+}
+
+/**
+ * Function which removes a mower (e.g. it dropped out) and rebalances the lawn over the rest
+ *
+ * @return 0: success
+ * @return -1: no mower with that id, or no mowers left
+ */
+int LawnPartitioner::removeMower(int mowerId) {
+	for (size_t i = 0; i < m_mowers.size(); i++) {
+		if (m_mowers[i].id == mowerId) {
+			m_mowers.erase(m_mowers.begin() + i);
+
+			return partition();
+		}
+	}
+
+	m_errorNum = -1;
+	return -1;
+}
+
+/**
+ * Function which splits the lawn into one band per mower and generates every mower's instructions
+ * Mowers take bands in order of their start y, the band heights are found by bisecting on the common finish time
+ *
+ * @return 0: success
+ * @return -1: no mowers or invalid lawn
+ */
+int LawnPartitioner::partition() {
+	m_assignments.clear();
+
+	if (m_mowers.empty() || m_polygon.size() < 3) {
+		m_errorNum = -1;
+		return -1;
+	}
+
+	std::sort(m_mowers.begin(), m_mowers.end(), [](const Mower& a, const Mower& b) {
+		return a.start.y < b.start.y || (a.start.y == b.start.y && a.start.x < b.start.x);
+	});
+
+	int count = (int) m_mowers.size();
+	double low = 0;
+	double high = 0;
+
+	for (const Mower& mower : m_mowers) {
+		high = std::max(high, bandSeconds(mower, m_yMin, m_yMax, nullptr));
+	}
+
+	for (int i = 0; i < SEARCH_ITERATIONS; i++) {
+		double target = (low + high) / 2;
+		double y = m_yMin;
+
+		for (int k = 0; k < count - 1; k++) {
+			y = bandEnd(m_mowers[k], y, target);
+		}
+
+		if (bandSeconds(m_mowers[count - 1], y, m_yMax, nullptr) <= target) {
+			high = target;
+		} else {
+			low = target;
+		}
+	}
+
+	double y = m_yMin;
+
+	for (int k = 0; k < count; k++) {
+		double end = k == count - 1 ? m_yMax : bandEnd(m_mowers[k], y, high);
+		MowerAssignment assignment;
+
+		bandSeconds(m_mowers[k], y, end, &assignment);
+		generateInstructions(m_mowers[k], assignment);
+		m_assignments.push_back(assignment);
+
+		y = end;
+	}
+
+	return 0;
+}
+
+/**
+ * Getter function which returns one assignment per mower, from the bottom band to the top
+ */
+std::vector<MowerAssignment>& LawnPartitioner::getAssignments() {
+	return m_assignments;
+}
+
+/**
+ * Getter function which returns when the last mower is estimated to finish, in seconds
+ */
+double LawnPartitioner::getMakespan() {
+	double makespan = 0;
+
+	for (const MowerAssignment& assignment : m_assignments) {
+		makespan = std::max(makespan, assignment.transitSeconds + assignment.mowingSeconds);
+	}
+
+	return makespan;
+}
+
+/**
+ * Getter function which returns the number of mowers
+ */
+int LawnPartitioner::getMowerCount() {
+	return (int) m_mowers.size();
+}
+
+/**
+ * Getter function which returns the errorNum variable which holds the value of the current error call
+ */
+int LawnPartitioner::getErrorNum() {
+	return m_errorNum;
+}
+
+/**
+ * Function which estimates how long a mower needs for the band [y0, y1]: drive there, cut the strips, U-turn between them
+ * An empty band costs nothing (the mower stays where it is)
+ *
+ * @param assignment: if not null, receives the band geometry and estimates
+ */
+double LawnPartitioner::bandSeconds(const Mower& mower, double y0, double y1, MowerAssignment* assignment) {
+	std::vector<LawnPoint> clipped;
+	clipBand(y0, y1, clipped);
+
+	double area = 0;
+	double xMin = HUGE_VAL;
+	double xMax = -HUGE_VAL;
+
+	for (size_t i = 0; i < clipped.size(); i++) {
+		const LawnPoint& a = clipped[i];
+		const LawnPoint& b = clipped[(i + 1) % clipped.size()];
+
+		area += a.x * b.y - b.x * a.y;
+		xMin = std::min(xMin, a.x);
+		xMax = std::max(xMax, a.x);
+	}
+
+	area = std::fabs(area) / 2;
+
+	double transit = 0;
+	double mowing = 0;
+
+	if (area > 1e-9) {
+		double speed = 1000.0 / DRIVE_MS_PER_METRE;
+		double strips = std::ceil((y1 - y0) / m_bladeDiameter);
+		double uTurn = 180 * TURN_SECONDS_PER_DEGREE + std::fabs(m_bladeDiameter - m_carDiameter) / speed;
+
+		mowing = area / (m_bladeDiameter * speed) + strips * uTurn;
+
+		double startX = xMin + m_carDiameter / 2;
+		double startY = y0 + m_carDiameter / 2;
+		double distance = std::hypot(startX - mower.start.x, startY - mower.start.y);
+		double bearing = distance > 1e-6 ? std::atan2(startY - mower.start.y, startX - mower.start.x) : mower.start.theta;
+		double turns = std::fabs(std::remainder(bearing - mower.start.theta, 2 * M_PI)) + std::fabs(std::remainder(bearing, 2 * M_PI));
+
+		transit = distance / speed + turns * 180 / M_PI * TURN_SECONDS_PER_DEGREE;
+	}
+
+	if (assignment != nullptr) {
+		assignment->mowerId = mower.id;
+		assignment->xMin = area > 1e-9 ? xMin : 0;
+		assignment->xMax = area > 1e-9 ? xMax : 0;
+		assignment->yMin = y0;
+		assignment->yMax = y1;
+		assignment->area = area;
+		assignment->transitSeconds = transit;
+		assignment->mowingSeconds = mowing;
+	}
+
+	return transit + mowing;
+}
+
+/**
+ * Function which returns the highest band end (starting at y0) the mower can finish within target seconds
+ */
+double LawnPartitioner::bandEnd(const Mower& mower, double y0, double target) {
+	if (bandSeconds(mower, y0, m_yMax, nullptr) <= target) {
+		return m_yMax;
+	}
+
+	double low = y0;
+	double high = m_yMax;
+
+	for (int i = 0; i < SEARCH_ITERATIONS; i++) {
+		double middle = (low + high) / 2;
+
+		if (bandSeconds(mower, y0, middle, nullptr) <= target) {
+			low = middle;
+		} else {
+			high = middle;
+		}
+	}
+
+	return low;
+}
+
+/**
+ * Function which clips the lawn polygon to y0 <= y <= y1 (Sutherland-Hodgman against the two edges)
+ */
+void LawnPartitioner::clipBand(double y0, double y1, std::vector<LawnPoint>& clipped) {
+	std::vector<LawnPoint> lower;
+	double limits[] = {y0, y1};
+
+	for (int edge = 0; edge < 2; edge++) {
+		const std::vector<LawnPoint>& input = edge == 0 ? m_polygon : lower;
+		std::vector<LawnPoint>& output = edge == 0 ? lower : clipped;
+		double limit = limits[edge];
+		double sign = edge == 0 ? 1 : -1; // keep y >= y0, then y <= y1
+
+		output.clear();
+
+		for (size_t i = 0; i < input.size(); i++) {
+			const LawnPoint& a = input[i];
+			const LawnPoint& b = input[(i + 1) % input.size()];
+			bool aInside = sign * (a.y - limit) >= 0;
+			bool bInside = sign * (b.y - limit) >= 0;
+
+			if (aInside) {
+				output.push_back(a);
+			}
+
+			if (aInside != bInside) {
+				double t = (limit - a.y) / (b.y - a.y);
+				output.push_back(LawnPoint{a.x + t * (b.x - a.x), limit});
+			}
+		}
+	}
+}
+
+/**
+ * Function which generates a mower's instructions: drive to the corner of its band, then boustrophedon strips over it
+ * Bands are widened into their neighbours by the part of the car that is wider than the blade,
+ * so the shared edge between two bands is cut too (it is not a real boundary the mower has to stay inside)
+ */
+int LawnPartitioner::generateInstructions(const Mower& mower, MowerAssignment& assignment) {
+	assignment.instructions.clear();
+
+	if (assignment.area <= 1e-9) {
+		return 0;
+	}
+
+	double margin = (m_carDiameter - m_bladeDiameter) / 2;
+	double y0 = assignment.yMin > m_yMin ? assignment.yMin - margin : assignment.yMin;
+	double y1 = assignment.yMax < m_yMax ? assignment.yMax + margin : assignment.yMax;
+	LawnSpec lawn = LawnSpec{assignment.xMax - assignment.xMin, y1 - y0, m_carDiameter, m_bladeDiameter, 0};
+	Pose start = getPatternStartPose(lawn);
+	DriveModel model(m_carDiameter);
+	PlanTurtle<Plan> turtle(assignment.instructions, model, mower.start);
+
+	turtle.driveTo(assignment.xMin + start.x, y0 + start.y, start.theta);
+
+	// patterns only depend on the lawn size, so the band's plan is the same as at the origin
+	generateCoverage<Boustrophedon>(lawn, assignment.instructions);
+
+	return 0;
+}
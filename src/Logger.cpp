@@ -0,0 +1,366 @@
+/**
+ * This file contains the implementation of the Logger class and all associated member functions that are included in the Logger.h file.
+ * The Logger class buffers log lines per thread and writes them in batches from a background thread.
+ *
+ */
+
+#include "Logger.h"
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+
+const char* LOG_LEVEL_NAMES[] = {"DEBUG", "INFO", "WARN", "ERROR"};
+
+/**
+ * Function which returns the logger, the writer thread is started by the first line logged
+ */
+Logger& Logger::getInstance() {
+	static Logger logger;
+
+	return logger;
+}
+
+/**
+ * Constructor, lines go to stdout until open() is called
+ */
+Logger::Logger() : m_writerIdle(false), m_shutDownFlag(false), m_droppedCount(0) {
+	m_lineCount = 0;
+	m_writeCount = 0;
+	m_fd = STDOUT_FILENO;
+	m_maxFileBytes = 0;
+	m_maxFiles = 0;
+	m_fileBytes = 0;
+	m_batchBytes = 0;
+}
+
+/**
+ * Member function destructor which writes the lines still buffered and stops the writer: no return
+ */
+Logger::~Logger() {
+	{
+		std::lock_guard<std::mutex> lock(m_wakeMutex);
+		m_shutDownFlag.store(true);
+	}
+
+	m_wakeUp.notify_one();
+
+	if (m_writer.joinable()) {
+		m_writer.join();
+	}
+
+	flush();
+
+	if (m_fd != STDOUT_FILENO) {
+		::close(m_fd);
+	}
+}
+
+/**
+ * Function which sends the log to a file instead of stdout (the lines already buffered go to the file too)
+ * When the file is bigger than maxFileBytes it is renamed to path.1 (path.1 to path.2 and so on, up to path.maxFiles)
+ * and a new one is started, so the log never takes more than about (maxFiles + 1) * maxFileBytes of the SD card
+ *
+ * @param path: log file, appended to
+ * @param maxFileBytes: size the file is rotated at, 0 to never rotate
+ * @param maxFiles: rotated files kept
+ * @return 0: success
+ * @return -1: the file could not be opened
+ */
+int Logger::open(const std::string& path, size_t maxFileBytes, int maxFiles) {
+	std::lock_guard<std::mutex> lock(m_writeMutex);
+	int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+
+	if (fd < 0) {
+		return -1;
+	}
+
+	writeBatch();
+
+	if (m_fd != STDOUT_FILENO) {
+		::close(m_fd);
+	}
+
+	m_fd = fd;
+	m_path = path;
+	m_maxFileBytes = maxFileBytes;
+	m_maxFiles = maxFiles;
+	m_fileBytes = lseek(fd, 0, SEEK_END);
+
+	return 0;
+}
+
+/**
+ * Function which formats a line into the calling thread's buffer, called through the LOG_ macros
+ * The line is dropped if the buffer is full
+ *
+ * @param level: LOG_LEVEL_DEBUG to LOG_LEVEL_ERROR
+ * @param event: what the line is about, e.g. "exec" (a string literal)
+ * @param format: printf format of the message
+ */
+void Logger::log(int level, const char* event, const char* format, ...) {
+	ThreadBuffer* buffer = getThreadBuffer();
+	unsigned int head = buffer->head.load(std::memory_order_relaxed);
+
+	if (head - buffer->tail.load(std::memory_order_acquire) >= LOG_RING_SIZE) {
+		m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	LogRecord& record = buffer->records[head & (LOG_RING_SIZE - 1)];
+	timespec now;
+	va_list arguments;
+
+	clock_gettime(CLOCK_REALTIME, &now);
+	record.timeNs = now.tv_sec * 1000000000LL + now.tv_nsec;
+	record.event = event;
+	record.level = level;
+
+	va_start(arguments, format);
+	vsnprintf(record.text, LOG_TEXT_SIZE, format, arguments);
+	va_end(arguments);
+
+	buffer->head.store(head + 1);
+
+	// both this and the writer going idle are sequentially consistent: either the writer sees the line, or the line sees the writer idle
+	if (m_writerIdle.load() && m_writerIdle.exchange(false)) {
+		std::lock_guard<std::mutex> lock(m_wakeMutex);
+		m_wakeUp.notify_one();
+	}
+}
+
+/**
+ * Function which writes every buffered line now, and syncs the log file to the SD card
+ * Return value is 0 for success
+ */
+int Logger::flush() {
+	std::lock_guard<std::mutex> lock(m_writeMutex);
+
+	drain();
+
+	if (m_fd != STDOUT_FILENO) {
+		fsync(m_fd);
+	}
+
+	return 0;
+}
+
+/**
+ * Getter function which returns how many lines have been written
+ */
+long Logger::getLineCount() {
+	std::lock_guard<std::mutex> lock(m_writeMutex);
+
+	return m_lineCount;
+}
+
+/**
+ * Getter function which returns how many lines were dropped because a thread's buffer was full
+ */
+long Logger::getDroppedCount() {
+	return m_droppedCount.load();
+}
+
+/**
+ * Getter function which returns how many write() calls the lines took
+ */
+long Logger::getWriteCount() {
+	std::lock_guard<std::mutex> lock(m_writeMutex);
+
+	return m_writeCount;
+}
+
+/**
+ * Function which returns the calling thread's buffer, registering it (and starting the writer) the first time
+ */
+Logger::ThreadBuffer* Logger::getThreadBuffer() {
+	thread_local ThreadBuffer* threadBuffer = nullptr;
+
+	if (threadBuffer == nullptr) {
+		std::lock_guard<std::mutex> lock(m_buffersMutex);
+
+		m_buffers.push_back(std::unique_ptr<ThreadBuffer>(new ThreadBuffer()));
+		threadBuffer = m_buffers.back().get();
+		threadBuffer->head.store(0);
+		threadBuffer->tail.store(0);
+		threadBuffer->threadIndex = m_buffers.size() - 1;
+
+		if (!m_writer.joinable() && !m_shutDownFlag.load()) {
+			m_writer = std::thread(&Logger::writerLoop, this);
+		}
+	}
+
+	return threadBuffer;
+}
+
+/**
+ * Function run by the writer thread: empties the buffers every LOG_WRITE_INTERVAL_MS while lines come in, until shut down
+ */
+void Logger::writerLoop() {
+	while (!m_shutDownFlag.load()) {
+		int lines;
+
+		{
+			std::lock_guard<std::mutex> lock(m_writeMutex);
+			lines = drain();
+		}
+
+		if (lines > 0) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(LOG_WRITE_INTERVAL_MS));
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_wakeMutex);
+		m_writerIdle.store(true);
+
+		// a line logged just before the writer went idle did not wake it
+		if (hasPending()) {
+			m_writerIdle.store(false);
+			continue;
+		}
+
+		m_wakeUp.wait(lock, [this]() { return !m_writerIdle.load() || m_shutDownFlag.load(); });
+		m_writerIdle.store(false);
+	}
+}
+
+/**
+ * Function which moves the lines of every thread into the batch, oldest first per thread, and writes it
+ * m_writeMutex must be held
+ * Return value is the number of lines taken
+ */
+int Logger::drain() {
+	std::lock_guard<std::mutex> lock(m_buffersMutex);
+	int lines = 0;
+
+	for (std::unique_ptr<ThreadBuffer>& buffer : m_buffers) {
+		unsigned int tail = buffer->tail.load(std::memory_order_relaxed);
+		unsigned int head = buffer->head.load(std::memory_order_acquire);
+
+		for (; tail != head; tail++) {
+			appendRecord(buffer->records[tail & (LOG_RING_SIZE - 1)], buffer->threadIndex);
+			lines++;
+		}
+
+		buffer->tail.store(tail, std::memory_order_release);
+	}
+
+	writeBatch();
+	m_lineCount += lines;
+
+	return lines;
+}
+
+/**
+ * Function which returns whether any thread has lines the writer has not taken yet
+ */
+bool Logger::hasPending() {
+	std::lock_guard<std::mutex> lock(m_buffersMutex);
+
+	for (std::unique_ptr<ThreadBuffer>& buffer : m_buffers) {
+		if (buffer->head.load() != buffer->tail.load()) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Function which formats a record into the batch: time, level, thread, event and message on one line
+ * Return value is 0 for success
+ */
+int Logger::appendRecord(const LogRecord& record, int threadIndex) {
+	const size_t maxLineBytes = LOG_TEXT_SIZE + 96;
+
+	if (m_batchBytes + maxLineBytes > LOG_BATCH_BYTES) {
+		writeBatch();
+	}
+
+	time_t seconds = record.timeNs / 1000000000LL;
+	tm local;
+	char* line = m_batch + m_batchBytes;
+
+	localtime_r(&seconds, &local);
+	size_t length = strftime(line, maxLineBytes, "%Y-%m-%d %H:%M:%S", &local);
+	int written = snprintf(line + length, maxLineBytes - length, ".%06lld %-5s t%d %s: %s\n", record.timeNs % 1000000000LL / 1000,
+		LOG_LEVEL_NAMES[record.level], threadIndex, record.event, record.text);
+
+	length += written;
+
+	// a cut line still ends the line
+	if (length > maxLineBytes - 1) {
+		length = maxLineBytes - 1;
+		line[length - 1] = '\n';
+	}
+
+	m_batchBytes += length;
+
+	return 0;
+}
+
+/**
+ * Function which writes the batch with as few write() calls as it takes, rotating the file first if it is full
+ * Return value is 0 for success, -1 if the write failed (the batch is dropped)
+ */
+int Logger::writeBatch() {
+	size_t done = 0;
+	int result = 0;
+
+	if (m_batchBytes == 0) {
+		return 0;
+	}
+
+	if (m_fd != STDOUT_FILENO && m_maxFileBytes > 0 && m_fileBytes + m_batchBytes > m_maxFileBytes && m_fileBytes > 0) {
+		rotate();
+	}
+
+	while (done < m_batchBytes) {
+		ssize_t written = ::write(m_fd, m_batch + done, m_batchBytes - done);
+		m_writeCount++;
+
+		if (written <= 0) {
+			result = -1;
+			break;
+		}
+
+		done += written;
+	}
+
+	m_fileBytes += done;
+	m_batchBytes = 0;
+
+	return result;
+}
+
+/**
+ * Function which moves the log file to path.1 (and the older ones up by one) and starts a new file
+ * Return value is 0 for success, -1 if the new file could not be opened (the old one is kept)
+ */
+int Logger::rotate() {
+	for (int i = m_maxFiles - 1; i >= 1; i--) {
+		std::rename((m_path + "." + std::to_string(i)).c_str(), (m_path + "." + std::to_string(i + 1)).c_str());
+	}
+
+	if (m_maxFiles > 0) {
+		std::rename(m_path.c_str(), (m_path + ".1").c_str());
+	} else {
+		unlink(m_path.c_str());
+	}
+
+	int fd = ::open(m_path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+
+	if (fd < 0) {
+		return -1;
+	}
+
+	fsync(m_fd);
+	::close(m_fd);
+	m_fd = fd;
+	m_fileBytes = 0;
+
+	return 0;
+}
@@ -0,0 +1,174 @@
+/**
+ * This file contains the implementation of the MetricsPublisher class and all associated member functions that are included in the MetricsPublisher.h file.
+ * The MetricsPublisher class writes histogram snapshots as a Prometheus text file, on demand or from a background thread.
+ *
+ */
+
+#include "MetricsPublisher.h"
+#include <chrono>
+#include <cstdio>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+const int METRICS_FIRST_EDGE_BITS = 3; // the first bucket edge written is 2^3 us
+const int METRICS_LAST_EDGE_BITS = 27; // the last is 2^27 us (about 134 s), longer ones are only in +Inf
+const int METRICS_THREAD_NICE = 10; // the publisher yields to the button and motion threads
+
+/**
+ * Constructor, nothing is published until start() or publish()
+ */
+MetricsPublisher::MetricsPublisher() {
+	m_periodMs = 0;
+	m_stopFlag = false;
+	m_publishCount = 0;
+}
+
+/**
+ * Member function destructor which stops the publisher thread: no return
+ */
+MetricsPublisher::~MetricsPublisher() {
+	stop();
+}
+
+/**
+ * Function which adds a histogram to the snapshots, call it before start()
+ *
+ * @param name: metric name, in seconds as Prometheus expects (e.g. mower_oled_frame_seconds)
+ * @param help: one line saying what is measured
+ * @param histogram: must outlive the publisher
+ * Return value is 0 for success
+ */
+int MetricsPublisher::addHistogram(const std::string& name, const std::string& help, const LatencyHistogram& histogram) {
+	m_metrics.push_back(Metric{name, help, &histogram});
+
+	return 0;
+}
+
+/**
+ * Function which starts publishing to a file every periodMs on a background thread
+ * @return 0: success
+ * @return -1: already started
+ */
+int MetricsPublisher::start(const std::string& path, unsigned int periodMs) {
+	if (m_thread.joinable()) {
+		return -1;
+	}
+
+	m_path = path;
+	m_periodMs = periodMs;
+	m_stopFlag = false;
+	m_thread = std::thread(&MetricsPublisher::publisherLoop, this);
+
+	return 0;
+}
+
+/**
+ * Function which stops the background thread after one last snapshot
+ * Return value is 0 for success
+ */
+int MetricsPublisher::stop() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopFlag = true;
+	}
+
+	m_wakeUp.notify_one();
+
+	if (m_thread.joinable()) {
+		m_thread.join();
+		publish();
+	}
+
+	return 0;
+}
+
+/**
+ * Function which writes a snapshot now to the file given to start()
+ * @return 0: success
+ * @return -1: no file was given or it could not be written
+ */
+int MetricsPublisher::publish() {
+	if (m_path.empty()) {
+		return -1;
+	}
+
+	return publish(m_path);
+}
+
+/**
+ * Function which writes a snapshot of every histogram to a file in the Prometheus text format (as path.tmp, renamed over path)
+ * @return 0: success
+ * @return -1: the file could not be written
+ */
+int MetricsPublisher::publish(const std::string& path) {
+	std::lock_guard<std::mutex> lock(m_publishMutex);
+	std::string tmpPath = path + ".tmp";
+	FILE* file = fopen(tmpPath.c_str(), "w");
+
+	if (file == nullptr) {
+		return -1;
+	}
+
+	for (const Metric& metric : m_metrics) {
+		unsigned long below = 0;
+		int bucket = 0;
+
+		metric.histogram->getSnapshot(m_snapshot);
+
+		fprintf(file, "# HELP %s %s\n# TYPE %s histogram\n", metric.name.c_str(), metric.help.c_str(), metric.name.c_str());
+
+		// octave edges fall on bucket starts, so each cumulative count is exact
+		for (int bits = METRICS_FIRST_EDGE_BITS; bits <= METRICS_LAST_EDGE_BITS; bits++) {
+			unsigned int edgeUs = 1u << bits;
+
+			for (; bucket < LatencyHistogram::getBucketIndex(edgeUs); bucket++) {
+				below += m_snapshot.counts[bucket];
+			}
+
+			fprintf(file, "%s_bucket{le=\"%.9g\"} %lu\n", metric.name.c_str(), edgeUs / 1e6, below);
+		}
+
+		fprintf(file, "%s_bucket{le=\"+Inf\"} %lu\n", metric.name.c_str(), m_snapshot.count);
+		fprintf(file, "%s_sum %.6f\n%s_count %lu\n", metric.name.c_str(), m_snapshot.sumUs / 1e6, metric.name.c_str(), m_snapshot.count);
+		fprintf(file, "# HELP %s_max Longest duration so far\n# TYPE %s_max gauge\n", metric.name.c_str(), metric.name.c_str());
+		fprintf(file, "%s_max %.6f\n", metric.name.c_str(), m_snapshot.maxUs / 1e6);
+	}
+
+	if (fclose(file) != 0 || rename(tmpPath.c_str(), path.c_str()) != 0) {
+		std::remove(tmpPath.c_str());
+		return -1;
+	}
+
+	m_publishCount++;
+
+	return 0;
+}
+
+/**
+ * Getter function which returns how many snapshots have been written
+ */
+long MetricsPublisher::getPublishCount() {
+	std::lock_guard<std::mutex> lock(m_publishMutex);
+
+	return m_publishCount;
+}
+
+/**
+ * Function run by the publisher thread: writes a snapshot every m_periodMs until stop()
+ */
+void MetricsPublisher::publisherLoop() {
+	setpriority(PRIO_PROCESS, syscall(SYS_gettid), METRICS_THREAD_NICE); // only this thread, Linux nice values are per thread
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (!m_stopFlag) {
+		if (m_wakeUp.wait_for(lock, std::chrono::milliseconds(m_periodMs), [this]() { return m_stopFlag; })) {
+			break;
+		}
+
+		lock.unlock();
+		publish();
+		lock.lock();
+	}
+}
@@ -0,0 +1,300 @@
+/**
+ * This file contains the implementation of the MissionBuilder class and all associated member functions that are included in the MissionBuilder.h file.
+ * The MissionBuilder class stitches several lawns into one mission with blade-off transit legs between them.
+ *
+ */
+
+#include "MissionBuilder.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * Constructor
+ *
+ * @param carDiameter: diameter of the mower (also used as the wheel base)
+ * @param bladeDiameter: diameter of the blade
+ *
+ */
+MissionBuilder::MissionBuilder(double carDiameter, double bladeDiameter) {
+	m_carDiameter = carDiameter;
+	m_bladeDiameter = bladeDiameter;
+	m_overlap = 0;
+	m_startPose = Pose{0, 0, 0};
+	m_returnToStart = false;
+	m_transitDistance = 0;
+	m_nearestNeighbourDistance = 0;
+	m_errorNum = 0;
+	m_generator = &MissionBuilder::generateArea<Boustrophedon>;
+}
+
+/**
+ * Member function destructor which deletes an object: no return
+ */
+MissionBuilder::~MissionBuilder() {
+
+}
+
+/**
+ * Function which adds an area to the mission, call build() afterwards
+ *
+ * @return 0: success
+ * @return -1: the area is smaller than the mower
+ */
+int MissionBuilder::addArea(const MowingArea& area) {
+	if (area.length < m_carDiameter || area.width < m_carDiameter) {
+		m_errorNum = -1;
+		return -1;
+	}
+
+	m_areas.push_back(area);
+
+	return 0;
+}
+
+/**
+ * Setter function for where the mower is when the mission starts
+ */
+int MissionBuilder::setStartPose(const Pose& pose) {
+	m_startPose = pose;
+
+	return 0;
+}
+
+/**
+ * Setter function for whether the mission ends with a transit back to the start pose
+ */
+int MissionBuilder::setReturnToStart(bool returnToStart) {
+	m_returnToStart = returnToStart;
+
+	return 0;
+}
+
+/**
+ * Function which plans every area, orders the areas and stitches everything into one instruction stream
+ *
+ * @return 0: success
+ * @return -1: no areas
+ */
+int MissionBuilder::build() {
+	m_plans.clear();
+	m_instructions.clear();
+
+	if (m_areas.empty()) {
+		m_errorNum = -1;
+		return -1;
+	}
+
+	m_plans.resize(m_areas.size());
+
+	for (size_t i = 0; i < m_areas.size(); i++) {
+		(this->*m_generator)(m_areas[i], m_plans[i]);
+	}
+
+	nearestNeighbour();
+	m_nearestNeighbourDistance = tourLength(m_order);
+	twoOpt();
+	m_transitDistance = tourLength(m_order);
+
+	Pose pose = m_startPose;
+	DriveModel model(m_carDiameter);
+
+	for (int index : m_order) {
+		appendTransit(pose, m_plans[index].entry);
+
+		// follow the plan from where the transit really ended, so small transit errors do not add up
+		for (const Instruction& instruction : m_plans[index].instructions) {
+			m_instructions.push_back(instruction);
+			pose = model.applyInstruction(pose, instruction);
+		}
+	}
+
+	if (m_returnToStart) {
+		appendTransit(pose, m_startPose);
+	}
+
+	return 0;
+}
+
+/**
+ * Getter function which returns the stitched instruction stream of the last build
+ */
+Plan& MissionBuilder::getInstructions() {
+	return m_instructions;
+}
+
+/**
+ * Getter function which returns the order the areas are mowed in (indices in the order they were added)
+ */
+std::vector<int>& MissionBuilder::getOrder() {
+	return m_order;
+}
+
+/**
+ * Getter function which returns the total straight line transit distance of the last build, in metres
+ */
+double MissionBuilder::getTransitDistance() {
+	return m_transitDistance;
+}
+
+/**
+ * Getter function which returns the transit distance of the nearest neighbour order, before 2-opt improved it
+ */
+double MissionBuilder::getNearestNeighbourDistance() {
+	return m_nearestNeighbourDistance;
+}
+
+/**
+ * Getter function which returns the number of areas
+ */
+int MissionBuilder::getAreaCount() {
+	return m_areas.size();
+}
+
+/**
+ * Getter function which returns the errorNum variable which holds the value of the current error call
+ */
+int MissionBuilder::getErrorNum() {
+	return m_errorNum;
+}
+
+/**
+ * Function which returns the straight line distance between two poses
+ */
+double MissionBuilder::transit(const Pose& from, const Pose& to) {
+	return std::hypot(to.x - from.x, to.y - from.y);
+}
+
+/**
+ * Function which returns the transit distance of a complete order, from the start pose (and back, if set)
+ */
+double MissionBuilder::tourLength(const std::vector<int>& order) {
+	double length = 0;
+	Pose pose = m_startPose;
+
+	for (int index : order) {
+		length += transit(pose, m_plans[index].entry);
+		pose = m_plans[index].exit;
+	}
+
+	if (m_returnToStart) {
+		length += transit(pose, m_startPose);
+	}
+
+	return length;
+}
+
+/**
+ * Function which builds the first order: from the start, always drive to the closest unvisited area
+ */
+int MissionBuilder::nearestNeighbour() {
+	std::vector<bool> visited(m_plans.size(), false);
+	Pose pose = m_startPose;
+
+	m_order.clear();
+
+	for (size_t step = 0; step < m_plans.size(); step++) {
+		int closest = -1;
+		double closestDistance = HUGE_VAL;
+
+		for (size_t i = 0; i < m_plans.size(); i++) {
+			double distance = transit(pose, m_plans[i].entry);
+
+			if (!visited[i] && distance < closestDistance) {
+				closest = i;
+				closestDistance = distance;
+			}
+		}
+
+		visited[closest] = true;
+		m_order.push_back(closest);
+		pose = m_plans[closest].exit;
+	}
+
+	return 0;
+}
+
+/**
+ * Function which improves the order by reversing stretches of it while that shortens the transits (2-opt)
+ * Areas are always mowed from their own entry to their own exit, so the costs are not symmetric
+ * and every reversal is checked over the whole reversed stretch
+ *
+ * @return the number of improving reversals
+ */
+int MissionBuilder::twoOpt() {
+	int count = m_order.size();
+	int improvements = 0;
+	bool improved = true;
+	std::vector<double> distance(count * count); // exit of area a to entry of area b
+	std::vector<double> fromStart(count);
+	std::vector<double> toStart(count);
+
+	for (int a = 0; a < count; a++) {
+		fromStart[a] = transit(m_startPose, m_plans[a].entry);
+		toStart[a] = m_returnToStart ? transit(m_plans[a].exit, m_startPose) : 0;
+
+		for (int b = 0; b < count; b++) {
+			distance[a * count + b] = transit(m_plans[a].exit, m_plans[b].entry);
+		}
+	}
+
+	// cost of the edge into position i (from the start for i == 0) and out of the last position
+	auto edgeInto = [&](int previous, int next) {
+		return previous < 0 ? fromStart[next] : distance[previous * count + next];
+	};
+
+	while (improved) {
+		improved = false;
+
+		for (int i = 0; i < count - 1; i++) {
+			for (int j = i + 1; j < count; j++) {
+				int before = i > 0 ? m_order[i - 1] : -1;
+				double oldCost = edgeInto(before, m_order[i]);
+				double newCost = edgeInto(before, m_order[j]);
+
+				for (int k = i; k < j; k++) {
+					oldCost += distance[m_order[k] * count + m_order[k + 1]];
+					newCost += distance[m_order[k + 1] * count + m_order[k]];
+				}
+
+				if (j < count - 1) {
+					oldCost += distance[m_order[j] * count + m_order[j + 1]];
+					newCost += distance[m_order[i] * count + m_order[j + 1]];
+				} else {
+					oldCost += toStart[m_order[j]];
+					newCost += toStart[m_order[i]];
+				}
+
+				if (newCost < oldCost - 1e-9) {
+					std::reverse(m_order.begin() + i, m_order.begin() + j + 1);
+					improvements++;
+					improved = true;
+				}
+			}
+		}
+	}
+
+	return improvements;
+}
+
+/**
+ * Function which appends a blade-off leg from pose to target (turn, straight, turn onto the target heading)
+ *
+ * @param pose: where the mower is, moved to where the leg ends
+ * @param target: where the leg should end
+ */
+int MissionBuilder::appendTransit(Pose& pose, const Pose& target) {
+	Plan leg;
+	DriveModel model(m_carDiameter);
+	PlanTurtle<Plan> turtle(leg, model, pose);
+
+	turtle.driveTo(target.x, target.y, target.theta);
+
+	for (Instruction& instruction : leg) {
+		instruction.cutting = false;
+		m_instructions.push_back(instruction);
+	}
+
+	pose = turtle.getPose();
+
+	return 0;
+}
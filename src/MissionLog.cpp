@@ -0,0 +1,318 @@
+/**
+ * This file contains the implementation of the MissionLog class and all associated member functions that are included in the MissionLog.h file.
+ * The MissionLog class writes the binary mission log in batches.
+ *
+ */
+
+#include "MissionLog.h"
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * Constructor, nothing is recorded until open()
+ *
+ * @param board: board whose clock the records are timed with
+ *
+ */
+MissionLog::MissionLog(Board& board) {
+	m_board = &board;
+	m_fd = -1;
+	m_active = 0;
+	m_batchCount = 0;
+	m_mission = 0;
+	m_inMission = false;
+	m_missionStartMs = 0;
+	m_instructionIndex = 0;
+	m_recordCount = 0;
+	m_writeCount = 0;
+	m_syncCount = 0;
+}
+
+/**
+ * Member function destructor which writes what is buffered and closes the file: no return
+ */
+MissionLog::~MissionLog() {
+	close();
+}
+
+/**
+ * Function which starts a new log file (an existing file is replaced) and writes its header
+ * @return 0: success
+ * @return -1: the file could not be created or the header written
+ */
+int MissionLog::open(const std::string& path) {
+	close();
+
+	int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+	if (fd < 0) {
+		return -1;
+	}
+
+	MissionLogHeader header;
+	timespec now;
+
+	memset(&header, 0, sizeof(header));
+	clock_gettime(CLOCK_REALTIME, &now);
+	header.magic = MISSION_LOG_MAGIC;
+	header.version = MISSION_LOG_VERSION;
+	header.recordSize = sizeof(MissionRecord);
+	header.headerSize = sizeof(MissionLogHeader);
+	header.boardStartMs = m_board->millis();
+	header.wallStartNs = now.tv_sec * 1000000000LL + now.tv_nsec;
+
+	if (::write(fd, &header, sizeof(header)) != sizeof(header)) {
+		::close(fd);
+		return -1;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_fd = fd;
+	m_batchCount = 0;
+	m_mission = 0;
+	m_inMission = false;
+
+	return 0;
+}
+
+/**
+ * Function which writes what is buffered, syncs and closes the file
+ * Return value is 0 for success
+ */
+int MissionLog::close() {
+	if (m_fd < 0) {
+		return 0;
+	}
+
+	flush();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	std::lock_guard<std::mutex> fileLock(m_fileMutex);
+	::close(m_fd);
+	m_fd = -1;
+
+	return 0;
+}
+
+/**
+ * Function which records the start of a mission
+ * @param instructionCount: instructions in the plan
+ * @return 0: success, -1: the log is not open or could not be written
+ */
+int MissionLog::logMissionStart(size_t instructionCount) {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_mission++;
+		m_inMission = true;
+		m_missionStartMs = m_board->millis();
+		m_instructionIndex = 0;
+	}
+
+	return append(MISSION_START, 0, instructionCount, 0, 0, "");
+}
+
+/**
+ * Function which records that an instruction was started
+ * @param plannedMs: how long the instruction should take
+ * @return 0: success, -1: the log is not open or could not be written
+ */
+int MissionLog::logInstructionStart(const Instruction& instruction, int plannedMs) {
+	uint32_t index;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		index = m_instructionIndex++;
+	}
+
+	return append(INSTRUCTION_START, instruction.cutting ? MISSION_FLAG_CUTTING : 0, index, plannedMs, instruction.value, instruction.action.c_str());
+}
+
+/**
+ * Function which records that an instruction was finished (or stopped early)
+ * @param plannedMs: how long the instruction should have taken
+ * @param elapsedMs: how long it took by the board clock
+ * @return 0: success, -1: the log is not open or could not be written
+ */
+int MissionLog::logInstructionEnd(const Instruction& instruction, int plannedMs, int elapsedMs, bool cancelled) {
+	uint32_t index;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		index = m_instructionIndex > 0 ? m_instructionIndex - 1 : 0;
+	}
+
+	uint16_t flags = (instruction.cutting ? MISSION_FLAG_CUTTING : 0) | (cancelled ? MISSION_FLAG_CANCELLED : 0);
+
+	return append(INSTRUCTION_END, flags, index, elapsedMs, plannedMs, instruction.action.c_str());
+}
+
+/**
+ * Function which records a state change (nothing is recorded if the state stays the same)
+ * @return 0: success, -1: the log is not open or could not be written
+ */
+int MissionLog::logState(State from, State to) {
+	if (from == to) {
+		return 0;
+	}
+
+	return append(STATE_CHANGE, 0, to, from, 0, "");
+}
+
+/**
+ * Function which records that an output pin changed level
+ * @return 0: success, -1: the log is not open or could not be written
+ */
+int MissionLog::logPinEdge(int pin, int level) {
+	return append(PIN_EDGE, 0, pin, level, 0, "");
+}
+
+/**
+ * Function which records a button press (after the lockout, i.e. one that was acted on)
+ * @return 0: success, -1: the log is not open or could not be written
+ */
+int MissionLog::logButton(int pin) {
+	return append(BUTTON_PRESS, 0, pin, 0, 0, "");
+}
+
+/**
+ * Function which records the end of the mission and syncs the file (nothing happens if no mission is running)
+ * @param completed: false if the plan was dropped part way (start button, e-stop)
+ * @return 0: success, -1: the log is not open or could not be written
+ */
+int MissionLog::logMissionEnd(bool completed) {
+	uint32_t durationMs;
+	uint32_t instructions;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (!m_inMission) {
+			return 0;
+		}
+
+		m_inMission = false;
+		durationMs = m_board->millis() - m_missionStartMs;
+		instructions = m_instructionIndex;
+	}
+
+	int result = append(MISSION_END, completed ? 0 : MISSION_FLAG_CANCELLED, instructions, durationMs, 0, "");
+
+	return flush() == 0 ? result : -1;
+}
+
+/**
+ * Function which writes the records buffered so far and syncs the file to the SD card
+ * @return 0: success, -1: the log is not open or could not be written
+ */
+int MissionLog::flush() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	std::lock_guard<std::mutex> fileLock(m_fileMutex);
+
+	if (m_fd < 0) {
+		return -1;
+	}
+
+	int result = writeRecords(m_batches[m_active], m_batchCount);
+	m_batchCount = 0;
+
+	if (fsync(m_fd) != 0) {
+		result = -1;
+	}
+
+	m_syncCount++;
+
+	return result;
+}
+
+/**
+ * Getter function which returns how many records have been logged
+ */
+long MissionLog::getRecordCount() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return m_recordCount;
+}
+
+/**
+ * Getter function which returns how many write() calls the records took
+ */
+long MissionLog::getWriteCount() {
+	std::lock_guard<std::mutex> lock(m_fileMutex);
+
+	return m_writeCount;
+}
+
+/**
+ * Getter function which returns how many times the file was synced
+ */
+long MissionLog::getSyncCount() {
+	std::lock_guard<std::mutex> lock(m_fileMutex);
+
+	return m_syncCount;
+}
+
+/**
+ * Function which adds a record to the active batch, and writes the batch when it is full
+ * The other batch is written with only the file lock held, so other threads can keep logging into this one
+ * @return 0: success, -1: the log is not open or could not be written
+ */
+int MissionLog::append(uint16_t type, uint16_t flags, uint32_t index, uint32_t arg, double value, const char* action) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	if (m_fd < 0) {
+		return -1;
+	}
+
+	MissionRecord& record = m_batches[m_active][m_batchCount++];
+
+	record.timeMs = m_board->millis();
+	record.type = type;
+	record.flags = flags;
+	record.index = index;
+	record.arg = arg;
+	record.value = value;
+	record.action[0] = action[0];
+	record.action[1] = action[0] != '\0' ? action[1] : '\0';
+	record.reserved = 0;
+	record.mission = m_mission;
+	m_recordCount++;
+
+	if (m_batchCount < MISSION_LOG_BATCH_RECORDS) {
+		return 0;
+	}
+
+	// waits for the other batch to be written before it is filled again
+	std::lock_guard<std::mutex> fileLock(m_fileMutex);
+	int full = m_active;
+
+	m_active = 1 - m_active;
+	m_batchCount = 0;
+	lock.unlock();
+
+	return writeRecords(m_batches[full], MISSION_LOG_BATCH_RECORDS);
+}
+
+/**
+ * Function which writes records to the file, m_fileMutex must be held
+ * @return 0: success, -1: the write failed
+ */
+int MissionLog::writeRecords(const MissionRecord* records, int count) {
+	const char* data = reinterpret_cast<const char*>(records);
+	size_t bytes = count * sizeof(MissionRecord);
+	size_t done = 0;
+
+	while (done < bytes) {
+		ssize_t written = ::write(m_fd, data + done, bytes - done);
+		m_writeCount++;
+
+		if (written <= 0) {
+			return -1;
+		}
+
+		done += written;
+	}
+
+	return 0;
+}
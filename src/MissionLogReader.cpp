@@ -0,0 +1,282 @@
+/**
+ * This file contains the implementation of the MissionLogReader class and all associated member functions that are included in the MissionLogReader.h file.
+ * The MissionLogReader class memory maps mission logs and adds their records to a summary.
+ *
+ */
+
+#include "MissionLogReader.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const char* MISSION_LOG_ACTION_NAMES[MISSION_LOG_ACTIONS] = {"MF", "MB", "TL", "TR", "CH"};
+
+/**
+ * Constructor, starts with an empty summary
+ */
+MissionLogReader::MissionLogReader() {
+	for (int i = 0; i < MISSION_LOG_ACTIONS; i++) {
+		m_summary.actions[i].histogram.resize(MISSION_LOG_HISTOGRAM_MS);
+	}
+
+	reset();
+}
+
+/**
+ * Member function destructor which deletes an object: no return
+ */
+MissionLogReader::~MissionLogReader() {
+
+}
+
+/**
+ * Function which adds every record of a log file to the summary
+ * A record cut off at the end of the file (the mower lost power while writing) is ignored
+ * @return 0: success
+ * @return -1: the file could not be opened or mapped
+ * @return -2: the file is not a mission log
+ */
+int MissionLogReader::read(const std::string& path) {
+	int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	struct stat status;
+
+	if (fd < 0) {
+		return -1;
+	}
+
+	if (fstat(fd, &status) != 0) {
+		close(fd);
+		return -1;
+	}
+
+	size_t size = status.st_size;
+
+	if (size < sizeof(MissionLogHeader)) {
+		close(fd);
+		return -2;
+	}
+
+	void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (mapping == MAP_FAILED) {
+		return -1;
+	}
+
+	madvise(mapping, size, MADV_SEQUENTIAL);
+
+	const char* data = static_cast<const char*>(mapping);
+	MissionLogHeader header;
+
+	memcpy(&header, data, sizeof(header));
+
+	// later versions only add fields at the end of the header and of the records
+	if (header.magic != MISSION_LOG_MAGIC || header.version < 1 || header.recordSize < sizeof(MissionRecord)
+		|| header.headerSize < sizeof(MissionLogHeader) || header.headerSize > size) {
+		munmap(mapping, size);
+		return -2;
+	}
+
+	const char* end = data + size - (size - header.headerSize) % header.recordSize;
+
+	if (header.recordSize == sizeof(MissionRecord) && header.headerSize % alignof(MissionRecord) == 0) {
+		// records are packed and aligned: read them in place
+		const MissionRecord* record = reinterpret_cast<const MissionRecord*>(data + header.headerSize);
+		const MissionRecord* last = reinterpret_cast<const MissionRecord*>(end);
+
+		for (; record < last; record++) {
+			addRecord(*record);
+		}
+	} else {
+		for (const char* position = data + header.headerSize; position < end; position += header.recordSize) {
+			MissionRecord record;
+
+			memcpy(&record, position, sizeof(record));
+			addRecord(record);
+		}
+	}
+
+	m_summary.files++;
+	m_summary.bytes += size;
+	munmap(mapping, size);
+
+	return 0;
+}
+
+/**
+ * Function which adds the summary of another reader to this one (e.g. one reader per thread)
+ * Return value is 0 for success
+ */
+int MissionLogReader::merge(const MissionLogReader& other) {
+	const MissionLogSummary& from = other.m_summary;
+
+	m_summary.files += from.files;
+	m_summary.bytes += from.bytes;
+	m_summary.records += from.records;
+	m_summary.unknownRecords += from.unknownRecords;
+	m_summary.missions += from.missions;
+	m_summary.completedMissions += from.completedMissions;
+	m_summary.endedMissions += from.endedMissions;
+	m_summary.missionMsSum += from.missionMsSum;
+	m_summary.minMissionMs = std::min(m_summary.minMissionMs, from.minMissionMs);
+	m_summary.maxMissionMs = std::max(m_summary.maxMissionMs, from.maxMissionMs);
+	m_summary.pauses += from.pauses;
+	m_summary.stateChanges += from.stateChanges;
+	m_summary.buttonPresses += from.buttonPresses;
+	m_summary.pinEdges += from.pinEdges;
+
+	for (int i = 0; i < MISSION_LOG_ACTIONS; i++) {
+		ActionSummary& action = m_summary.actions[i];
+
+		action.count += from.actions[i].count;
+		action.cancelled += from.actions[i].cancelled;
+		action.elapsedMsSum += from.actions[i].elapsedMsSum;
+		action.lateMsSum += from.actions[i].lateMsSum;
+		action.maxMs = std::max(action.maxMs, from.actions[i].maxMs);
+
+		for (int ms = 0; ms < MISSION_LOG_HISTOGRAM_MS; ms++) {
+			action.histogram[ms] += from.actions[i].histogram[ms];
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Function which empties the summary
+ * Return value is 0 for success
+ */
+int MissionLogReader::reset() {
+	m_summary.files = 0;
+	m_summary.bytes = 0;
+	m_summary.records = 0;
+	m_summary.unknownRecords = 0;
+	m_summary.missions = 0;
+	m_summary.completedMissions = 0;
+	m_summary.endedMissions = 0;
+	m_summary.missionMsSum = 0;
+	m_summary.minMissionMs = ~0u;
+	m_summary.maxMissionMs = 0;
+	m_summary.pauses = 0;
+	m_summary.stateChanges = 0;
+	m_summary.buttonPresses = 0;
+	m_summary.pinEdges = 0;
+
+	for (int i = 0; i < MISSION_LOG_ACTIONS; i++) {
+		ActionSummary& action = m_summary.actions[i];
+
+		strcpy(action.action, MISSION_LOG_ACTION_NAMES[i]);
+		action.count = 0;
+		action.cancelled = 0;
+		action.elapsedMsSum = 0;
+		action.lateMsSum = 0;
+		action.maxMs = 0;
+		std::fill(action.histogram.begin(), action.histogram.end(), 0);
+	}
+
+	return 0;
+}
+
+/**
+ * Getter function which returns the summary of every file read so far
+ */
+const MissionLogSummary& MissionLogReader::getSummary() {
+	return m_summary;
+}
+
+/**
+ * Function which returns how long the given share of the instructions of a type took at most, e.g. 0.95 for the 95th percentile
+ * @param action: index in the summary's actions (see getActionIndex())
+ * Return value is in ms (0 if no instruction of the type was finished)
+ */
+unsigned int MissionLogReader::getPercentileMs(int action, double percentile) {
+	const ActionSummary& summary = m_summary.actions[action];
+	long target = std::max(1L, (long) (percentile * summary.count + 0.5));
+	long seen = 0;
+
+	if (summary.count == 0) {
+		return 0;
+	}
+
+	for (int ms = 0; ms < MISSION_LOG_HISTOGRAM_MS; ms++) {
+		seen += summary.histogram[ms];
+
+		if (seen >= target) {
+			return ms == MISSION_LOG_HISTOGRAM_MS - 1 ? summary.maxMs : ms;
+		}
+	}
+
+	return summary.maxMs;
+}
+
+/**
+ * Function which returns the index of an instruction type in the summary's actions
+ * Return value is -1 for an unknown action
+ */
+int MissionLogReader::getActionIndex(const char* action) {
+	switch (action[0]) {
+		case 'M':
+			return action[1] == 'F' ? 0 : (action[1] == 'B' ? 1 : -1);
+		case 'T':
+			return action[1] == 'L' ? 2 : (action[1] == 'R' ? 3 : -1);
+		case 'C':
+			return action[1] == 'H' ? 4 : -1;
+		default:
+			return -1;
+	}
+}
+
+/**
+ * Function which adds one record to the summary
+ */
+void MissionLogReader::addRecord(const MissionRecord& record) {
+	m_summary.records++;
+
+	switch (record.type) {
+		case MISSION_START:
+			m_summary.missions++;
+			break;
+		case INSTRUCTION_START:
+			break;
+		case INSTRUCTION_END: {
+			int index = getActionIndex(record.action);
+
+			if (index < 0) {
+				break;
+			}
+
+			ActionSummary& action = m_summary.actions[index];
+
+			action.count++;
+			action.cancelled += (record.flags & MISSION_FLAG_CANCELLED) != 0;
+			action.elapsedMsSum += record.arg;
+			action.lateMsSum += record.arg - record.value;
+			action.maxMs = std::max(action.maxMs, record.arg);
+			action.histogram[std::min(record.arg, (uint32_t) MISSION_LOG_HISTOGRAM_MS - 1)]++;
+			break;
+		}
+		case STATE_CHANGE:
+			m_summary.stateChanges++;
+			m_summary.pauses += record.index == PAUSED;
+			break;
+		case PIN_EDGE:
+			m_summary.pinEdges++;
+			break;
+		case BUTTON_PRESS:
+			m_summary.buttonPresses++;
+			break;
+		case MISSION_END:
+			m_summary.endedMissions++;
+			m_summary.completedMissions += (record.flags & MISSION_FLAG_CANCELLED) == 0;
+			m_summary.missionMsSum += record.arg;
+			m_summary.minMissionMs = std::min(m_summary.minMissionMs, record.arg);
+			m_summary.maxMissionMs = std::max(m_summary.maxMissionMs, record.arg);
+			break;
+		default:
+			m_summary.unknownRecords++;
+			break;
+	}
+}
@@ -7,6 +7,7 @@
  */
 
 #include "Motor.h"
+#include "WiringPiBoard.h"
 #include <wiringPi.h>
 #include <iostream>
 
@@ -17,14 +18,28 @@
  * @param pinCCW: GPIO pin for the left wheel which tells the motor to spin it counter clockwise 
  *
  */
-Motor::Motor(int pinCW, int pinCCW) {
-	wiringPiSetup();
-	pinMode(pinCW, OUTPUT);
-	pinMode(pinCCW, OUTPUT);
+Motor::Motor(int pinCW, int pinCCW) : Motor(pinCW, pinCCW, WiringPiBoard::getInstance()) {
+
+}
+
+/**
+ * Constructor like the one above, for a motor wired to another board (e.g. a SimBoard)
+ *
+ * @param board: board the pins are on
+ *
+ */
+Motor::Motor(int pinCW, int pinCCW, Board& board) {
+	m_board = &board;
+	m_board->setup();
+	m_board->pinMode(pinCW, OUTPUT);
+	m_board->pinMode(pinCCW, OUTPUT);
 	
 	m_pinCW = pinCW;
 	m_pinCCW = pinCCW;
 	m_errorNum = 0;
+	m_missionLog = nullptr;
+	m_levelCW = -1;
+	m_levelCCW = -1;
 }
 
 /**
@@ -40,8 +55,8 @@ Motor::~Motor() {
  * Return value is 0 for successful stoppage
  */
 int Motor::stop() {
-	digitalWrite(m_pinCW, LOW);
-	digitalWrite(m_pinCCW, LOW);
+	writePin(m_pinCW, LOW, m_levelCW);
+	writePin(m_pinCCW, LOW, m_levelCCW);
 	
 	return 0;
 }
@@ -73,11 +88,11 @@ int Motor::start(Direction direction, int duration) {
 	switch (direction) {
 		case CW:
 			spinClockwise();
-			delay(duration);
+			m_board->delay(duration);
 			return stop();
 		case CCW:
 			spinCounterClockwise();
-			delay(duration);
+			m_board->delay(duration);
 			return stop();
 		default:
 			m_errorNum = -2;
@@ -85,6 +100,30 @@ int Motor::start(Direction direction, int duration) {
 	}
 }
 
+/**
+ * Function like start above that stops the motor early when the token is cancelled (and does not start it if it already is)
+ * Return value is 0 if the motor ran for the whole duration
+ * Or -3 if the token was cancelled, the motor is stopped either way
+ * Else, the function returns -2 for error
+ */
+int Motor::start(Direction direction, int duration, CancellationToken& token) {
+	if (direction != CW && direction != CCW) {
+		m_errorNum = -2;
+		return -2;
+	}
+
+	if (token.isCancelled()) {
+		return -3;
+	}
+
+	start(direction);
+
+	unsigned int waited = m_board->delay(duration, token);
+	stop();
+
+	return waited < (unsigned int) duration ? -3 : 0;
+}
+
 /**
  * Getter function which returns the value of the right wheel GPIO pin 
  */
@@ -99,6 +138,29 @@ int Motor::getPinCCW() {
 	return m_pinCCW;	
 }
 
+/**
+ * Getter function which returns the last levels written to the pins: bit 0 the clockwise pin, bit 1 the counter-clockwise pin
+ * (no pin is read, pins switched off by the e-stop show until the motor is next stopped)
+ */
+int Motor::getLevels() {
+	return (m_levelCW == HIGH ? 1 : 0) | (m_levelCCW == HIGH ? 2 : 0);
+}
+
+/**
+ * Getter function which returns the board the motor is wired to
+ */
+Board* Motor::getBoard() {
+	return m_board;
+}
+
+/**
+ * Setter function for the (optional) mission log, which records every change of level on the motor's pins
+ * (pins switched off by the e-stop are written directly and not recorded)
+ */
+void Motor::setMissionLog(MissionLog& missionLog) {
+	m_missionLog = &missionLog;
+}
+
 /**
  * Getter function which returns the errorNum variable which holds the value of the current error call 
  */
@@ -112,7 +174,7 @@ int Motor::getErrorNum() {
  */
 int Motor::spinClockwise() {
 	try {
-		digitalWrite(m_pinCW, HIGH);
+		writePin(m_pinCW, HIGH, m_levelCW);
 	} catch (...) {
 		m_errorNum = -1;
 		return -1;
@@ -127,7 +189,7 @@ int Motor::spinClockwise() {
  */
 int Motor::spinCounterClockwise() {
 	try {
-		digitalWrite(m_pinCCW, HIGH);
+		writePin(m_pinCCW, HIGH, m_levelCCW);
 	} catch (...) {
 		m_errorNum = -1;
 		return -1;
@@ -136,3 +198,18 @@ int Motor::spinCounterClockwise() {
 	return 0;
 }
 
+/**
+ * Function which writes a level to a pin, and records it in the mission log if it changed
+ * Return value is 0 for success
+ */
+int Motor::writePin(int pin, int level, int& lastLevel) {
+	m_board->digitalWrite(pin, level);
+
+	if (m_missionLog != nullptr && level != lastLevel) {
+		m_missionLog->logPinEdge(pin, level);
+	}
+
+	lastLevel = level;
+
+	return 0;
+}
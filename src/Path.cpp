@@ -5,7 +5,8 @@
  */
 
 #include "Path.h"
-#include <iostream>
+#include "CoverageGrid.h"
+#include "Logger.h"
 #include <cmath>
 #include <string>
 
@@ -17,15 +18,23 @@
  * @param width: width of the lawn, user determined
  * @param carDiameter: diameter of the lawn mower, used to understand how car size will impact mowing
  * @param bladeDiameter: diameter of the mowers blade underneath
+ * @param verbose: print the dimensions and moves while generating (off for simulations)
+ * @param generateNow: false to leave the path empty until generate() is called (e.g. on a start up thread)
  *
  */
-Path::Path(double length, double width, double carDiameter, double bladeDiameter) {
+Path::Path(double length, double width, double carDiameter, double bladeDiameter, bool verbose, bool generateNow) {
     m_length = length;
     m_width = width;
     m_carDiameter = carDiameter;
     m_bladeDiameter = bladeDiameter;
+    m_overlap = 0;
+    m_verbose = verbose;
+    m_generator = &Path::generatePath;
+    m_startPose = Pose{0, 0, 0};
 
-    generatePath();
+    if (generateNow) {
+        runGenerator();
+    }
 }
 
 Path::~Path() {
@@ -63,184 +72,125 @@ double Path::getBladeDiameter() {
 /**
  * Getter function that returns the instructions double ended queue
  */
-std::deque<Instruction> Path::getInstructions() {
+const Plan& Path::getInstructions() {
     return m_instructions;
 }
 
+/**
+ * Getter function that returns where the generated path expects the mower to start
+ * The lawn is laid out with the long side along x and the short side along y, starting in the corner at the origin
+ * (facing +y for the original serpentine, so the short side is on the mower's left, facing +x for pattern policies)
+ */
+Pose Path::getStartPose() {
+    return m_startPose;
+}
+
 /**
  * Setter function that sets dimensions to the new ones passed and recalculates the path
  */
 int Path::setDimensions(double length, double width) {
     m_length = length;
     m_width = width;
-    generatePath();
 
-    return 0;
+    return runGenerator();
+}
+
+/**
+ * Function that (re)generates the path for the current dimensions with the current pattern
+ */
+int Path::generate() {
+    return runGenerator();
+}
+
+/**
+ * Getter function that returns how long the plans took to generate
+ */
+const LatencyHistogram& Path::getGenerationHistogram() {
+    return m_generationHistogram;
+}
+
+/**
+ * Function that runs the current generator and records how long it took
+ */
+int Path::runGenerator() {
+    long long startNs = LatencyHistogram::now();
+    int result = (this->*m_generator)();
+
+    m_generationHistogram.recordSince(startNs);
+
+    return result;
 }
 
 /**
  * Function that generates the path as per l/w and car/blade diameter
- * Is effectively the logic of the mower
+ * Is effectively the logic of the mower: the serpentine is planned by generatePresetSerpentine() (PresetPlan.h),
+ * the same planner the compiler runs for preset lawns, writing into the path through an InstructionSink
  * @return 0: working correctly!
+ * @return -1: the lawn is too small for the mower, the path is left empty
  * @return !0: returned by another function this function calls, experiencing an error somewhere
  */
 int Path::generatePath() {
     // clear previous instructions before generating new path
     m_instructions.clear();
+    m_startPose = getPresetStartPose(m_carDiameter);
 
-    double firstMoveDistance = 0;
-    double secondMoveDistance = 0;
-
-    std::cout << "m_length: " << m_length << std::endl;
-    std::cout << "m_width: " << m_width << std::endl;
-    std::cout << "m_carDiameter: " << m_carDiameter << std::endl;
-    std::cout << "m_bladeDiameter: " << m_bladeDiameter << std::endl;
-    std::cout << "\nBegin Path: \n" << std::endl;
-    
-    // Mower will always start with short side on left (could be input as length or width, depending on user)
-    if (m_length > m_width) {
-        firstMoveDistance = m_width - m_carDiameter;
-        secondMoveDistance = m_length - m_carDiameter * 2;
-    } else {
-        firstMoveDistance = m_length - m_carDiameter;
-        secondMoveDistance = m_width - m_carDiameter * 2;
+    if (m_verbose) {
+        LOG_DEBUG("path", "length %g width %g carDiameter %g bladeDiameter %g", m_length, m_width, m_carDiameter, m_bladeDiameter);
+        LOG_DEBUG("path", "begin path");
     }
 
-    // move forward ___ seconds based on firstMoveDistance
-    std::cout << "MF" << firstMoveDistance << std::endl;
-
-    // turn right 90 degrees
-    std::cout << "TR90" << std::endl;
-
-    // move forward ___ seconds based on secondMoveDistance
-    std::cout << "MF" << secondMoveDistance << std::endl;
-
-    addAFew("MF", firstMoveDistance, "TR", 90, "MF", secondMoveDistance);
-
-
-    int loopCount = 0;
-    double remainder = 0.0;
-
-    // Calculate number of strips we need to cut (lengthwise)
-    // The remainder is the width of the final strip that we need to cut
-    if (m_length > m_width) {
-        loopCount = std::ceil((m_width - m_carDiameter) / m_bladeDiameter);
-        remainder = calculateRemainder(m_width - m_carDiameter, m_bladeDiameter);
-    } else {
-        loopCount = std::ceil((m_length - m_carDiameter) / m_bladeDiameter);
-        remainder = calculateRemainder(m_length - m_carDiameter, m_bladeDiameter);
-    }
-
-    double stripWidth = m_bladeDiameter; // amount to move forward between strips (moving down)
-    double stripLength = secondMoveDistance - m_bladeDiameter; // amount to move forward for each strip
-
-    // Generate instructions for each strip of grass that we need to cut
-    for (int i = 0; i < loopCount - 1; i++) {
-
-        // Mower will turn left/right, depending on if we are cutting an even or odd numbered strip
-        if (i % 2 == 0) {
-            std::cout << "TR90" << std::endl;
-            std::cout << "MB" << m_carDiameter - stripWidth << std::endl;
-            std::cout << "TR100" << std::endl;
-
-            addAFew("TR", 90, "MB", m_carDiameter - stripWidth, "TR", 100);
-
-        } else {
-            std::cout << "TL90" << std::endl;
-            std::cout << "MB" << m_carDiameter - stripWidth << std::endl;
-            std::cout << "TL120" << std::endl;
-
-            addAFew("TL", 90, "MB", m_carDiameter - stripWidth, "TL", 120);
-        }
-        
-        std::cout << "MF" << stripLength << std::endl;
-        addAFew("MF", stripLength);
+    // Mower will always start with short side on left (could be input as length or width, depending on user)
+    double firstMoveDistance = std::min(m_length, m_width) - m_carDiameter;
+    double secondMoveDistance = std::max(m_length, m_width) - m_carDiameter * 2;
+
+    // on a lawn too small for the mower the strips (secondMoveDistance - m_bladeDiameter) or the reverse between them
+    // (m_carDiameter - m_bladeDiameter) would be negative, which the wheels cannot drive: leave the plan empty
+    if (firstMoveDistance <= 0 || secondMoveDistance - m_bladeDiameter <= 0 || m_bladeDiameter <= 0 || m_bladeDiameter > m_carDiameter) {
+        LOG_WARN("path", "lawn %g x %g is too small for a %g m mower with a %g m blade", m_length, m_width, m_carDiameter, m_bladeDiameter);
+        return -1;
     }
 
-    // Generate instructions for cutting final strip (usually this will be smaller than m_bladeDiameter, so we use remainder value)
-    if (loopCount % 2 == 0) {
-        std::cout << "TR90" << std::endl;
-
-        addAFew("TR", 90);
-        addConditionally(remainder, "MB", stripWidth, remainder);
-
-
-
-        addAFew("TR", 100, "MF", stripLength, "TL", 180, "MF", secondMoveDistance);
-
-        addAFew("TR", 90, "MB", m_carDiameter * 2);
-    } else {
-        std::cout << "TL110" << std::endl;
-
-        addAFew("TL", 110);
-        addConditionally(remainder, "MB", stripWidth, remainder);
-
-        std::cout << "TL120" << std::endl;
-        std::cout << "MF" << secondMoveDistance << std::endl;
-        std::cout << "TR100" << std::endl;
-        std::cout << "MB" << m_carDiameter << std::endl;
+    InstructionSink sink{this};
+    generatePresetSerpentine(m_length, m_width, m_carDiameter, m_bladeDiameter, sink);
 
-        addAFew("TL", 120, "MF", secondMoveDistance);
-
-        addAFew("TR", 100, "MB", m_carDiameter);
-    }
-
-    return 0;
+    return annotateCutting();
 }
 
 /**
- * Function used to calculate the remainder of a lawn we weren't able to cut because of the lawn mower or blade size
- * Used to understand how much is left so we can take that into account in path creation/movement
+ * Function that predicts how much battery energy (Wh) the path uses
  */
-double Path::calculateRemainder(double numer, double denom) {
-    while (numer >= denom) {
-        numer -= denom;
-    }
-
-    return numer;
+double Path::getEnergyEstimate(const EnergyModel& energyModel) {
+    return energyModel.getPlanWh(m_instructions);
 }
 
-
 /**
- * Helper function used with the generatePath function to generate the instructions
- * @param firstMove: is a turn left/right, or move forward/backward
- * @param firstDis: the distance the move will cover, these two will always be passed
- * @param secMove: is a turn left/right, or move forward/backward
- * @param secDis: the distance the move will cover, these two will always be passed as well
- * Continues on for third/fourth move/dis
- * Will effectively push them onto the deck
+ * Function that marks which instructions need the blade: each one is swept over the lawn in order,
+ * and an instruction that cuts less than MIN_NEW_CUT_AREA of grass no earlier instruction has cut is marked not cutting
+ * (e.g. the reverse between strips and the return leg along the first strip at the end of the serpentine)
+ * @return 0: success
  */
-void Path::addAFew(std::string firstMove, double firstDis, std::string secMove, double secDis, std::string thirdMove, double thirdDis, std::string fourthMove , double fourthDis){
-    m_instructions.push_back(Instruction{firstMove, firstDis});
-
-    if(secMove != ""){
-        m_instructions.push_back(Instruction{secMove, secDis});
-    }
-
-    if(thirdMove != ""){
-        m_instructions.push_back(Instruction{thirdMove, thirdDis});
+int Path::annotateCutting() {
+    CoverageGrid grid(std::max(m_length, m_width), std::min(m_length, m_width), ANNOTATION_RESOLUTION);
+    DriveModel model(m_carDiameter);
+    Pose pose = m_startPose;
+    double cellArea = ANNOTATION_RESOLUTION * ANNOTATION_RESOLUTION;
+
+    for (Instruction& instruction : m_instructions) {
+        pose = grid.sweepInstruction(pose, instruction, m_bladeDiameter, model);
+        instruction.cutting = grid.getNewCellCount() * cellArea >= MIN_NEW_CUT_AREA;
+        grid.endPass();
     }
 
-    if(fourthMove != ""){
-        m_instructions.push_back(Instruction{fourthMove, fourthDis});
-    }
+    return 0;
 }
 
-
 /**
- * Helper function used with the generatePath function to generate the instructions
- * Adds instructions based on a passed condition
- * @param condition: remainder passed, checks if its 0 or not
- * @param move: move forward/backward
- * @param firstDis: stripwidth, buffer caused by blade diameter
- * @param secondDis: the remainder
+ * Function that adds an instruction generatePresetSerpentine() planned to the end of the path
  */
-void Path:: addConditionally(double condition, std::string move, double firstDis, double secDis){
-    if (condition == 0) {
-        std::cout << move << firstDis << std::endl;
-        m_instructions.push_back(Instruction{move, firstDis});
-    } else {
-        std::cout << move << secDis << std::endl;
-        m_instructions.push_back(Instruction{move, secDis});
+void Path::InstructionSink::add(const char* action, double value, int durationMs) {
+    if (path->m_verbose) {
+        LOG_DEBUG("path", "%s%g", action, value);
     }
+
+    path->m_instructions.push_back(Instruction{action, value, true, 0, durationMs});
 }
@@ -0,0 +1,122 @@
+/**
+ * This file contains the implementation of the PlanArena class and all associated member functions that are included in the PlanArena.h file.
+ * The PlanArena class hands out memory for plans from large blocks and reuses what the plans free.
+ *
+ */
+
+#include "PlanArena.h"
+#include <algorithm>
+#include <memory>
+
+/**
+ * Constructor, the pool takes the first block from the heap straight away
+ *
+ * @param blockBytes: size of every block (a larger allocation gets a block of its own size)
+ *
+ */
+PlanArena::PlanArena(size_t blockBytes)
+	: m_blockBytes(std::max(blockBytes, (size_t) 1024)), m_current(0), m_offset(0), m_usedBytes(0), m_heapAllocations(0),
+	m_pool(std::pmr::pool_options{0, m_blockBytes / 4}, this) {
+
+}
+
+/**
+ * Member function destructor which gives every block back to the heap: no return
+ */
+PlanArena::~PlanArena() {
+	m_pool.release();
+
+	for (Block& block : m_blocks) {
+		delete[] block.data;
+	}
+}
+
+/**
+ * Getter function which returns the resource to construct plans with
+ */
+std::pmr::memory_resource* PlanArena::getResource() {
+	return &m_pool;
+}
+
+/**
+ * Function which takes back everything allocated from the arena, no Plan may be using it any more
+ * The blocks are kept: the next plans are built in them without touching the heap
+ * Return value is 0 for success
+ */
+int PlanArena::reset() {
+	m_pool.release();
+	m_current = 0;
+	m_offset = 0;
+	m_usedBytes = 0;
+
+	return 0;
+}
+
+/**
+ * Getter function which returns the bytes handed out since the last reset()
+ */
+size_t PlanArena::getUsedBytes() {
+	return m_usedBytes;
+}
+
+/**
+ * Getter function which returns the size of all the blocks
+ */
+size_t PlanArena::getReservedBytes() {
+	size_t bytes = 0;
+
+	for (const Block& block : m_blocks) {
+		bytes += block.size;
+	}
+
+	return bytes;
+}
+
+/**
+ * Getter function which returns how many blocks the arena has taken from the heap
+ */
+long PlanArena::getHeapAllocations() {
+	return m_heapAllocations;
+}
+
+/**
+ * Function which hands out memory from the current block, moving on to the next block (or a new one) when it is full
+ */
+void* PlanArena::do_allocate(size_t bytes, size_t alignment) {
+	while (true) {
+		if (m_current == m_blocks.size()) {
+			size_t size = std::max(m_blockBytes, bytes + alignment);
+
+			m_blocks.push_back(Block{new unsigned char[size], size});
+			m_heapAllocations++;
+		}
+
+		Block& block = m_blocks[m_current];
+		void* pointer = block.data + m_offset;
+		size_t space = block.size - m_offset;
+
+		if (std::align(alignment, bytes, pointer, space) != nullptr) {
+			m_offset = static_cast<unsigned char*>(pointer) + bytes - block.data;
+			m_usedBytes += bytes;
+
+			return pointer;
+		}
+
+		m_current++;
+		m_offset = 0;
+	}
+}
+
+/**
+ * Function which does nothing: the pool reuses what plans free, the blocks are only given back by reset()
+ */
+void PlanArena::do_deallocate(void*, size_t, size_t) {
+
+}
+
+/**
+ * Function which returns whether memory from one resource can be freed by the other
+ */
+bool PlanArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+	return this == &other;
+}
@@ -0,0 +1,316 @@
+/**
+ * This file contains the implementation of the PlanSearch class and all associated member functions that are included in the PlanSearch.h file.
+ * The PlanSearch class builds many candidate plans, scores them in parallel and keeps the cheapest.
+ *
+ */
+
+#include "PlanSearch.h"
+#include "CoveragePattern.h"
+#include "DriveModel.h"
+#include <chrono>
+#include <cmath>
+
+const double OVERLAPS[] = {0.0, 0.05, 0.1, 0.15, 0.2, 0.25, 0.3};
+const double TURN_SECONDS_PER_DEGREE = 0.9 / 90; // standard 90 degree pivot takes 900 ms, same as MissionTimeSink
+
+/**
+ * Constructor
+ *
+ * @param length: size of the lawn along x
+ * @param width: size of the lawn along y
+ * @param carDiameter: diameter of the mower (also used as the wheel base)
+ * @param bladeDiameter: diameter of the blade
+ * @param pool: thread pool the candidates are scored on
+ *
+ */
+PlanSearch::PlanSearch(double length, double width, double carDiameter, double bladeDiameter, ThreadPool& pool) {
+	m_length = length;
+	m_width = width;
+	m_carDiameter = carDiameter;
+	m_bladeDiameter = bladeDiameter;
+	m_resolution = 0.05;
+	m_missedAreaPenalty = 60;
+	m_startPose = Pose{0, 0, 0};
+	m_pool = &pool;
+	m_bestCandidate = PlanCandidate{BOUSTROPHEDON, 0, 0, 0};
+	m_bestScore = PlanScore{HUGE_VAL, 0, 0, 0};
+	m_scoredCount = 0;
+}
+
+/**
+ * Member function destructor which deletes an object: no return
+ */
+PlanSearch::~PlanSearch() {
+
+}
+
+/**
+ * Setter function for where the mower is now, used to charge the drive to each candidate's start corner
+ */
+int PlanSearch::setStartPose(const Pose& pose) {
+	m_startPose = pose;
+
+	return 0;
+}
+
+/**
+ * Setter function for how many seconds of mowing one square metre of missed grass is worth
+ */
+int PlanSearch::setMissedAreaPenalty(double secondsPerSquareMetre) {
+	m_missedAreaPenalty = secondsPerSquareMetre;
+
+	return 0;
+}
+
+/**
+ * Setter function for the coverage grid resolution in metres
+ */
+int PlanSearch::setResolution(double resolution) {
+	if (resolution <= 0) {
+		return -1;
+	}
+
+	m_resolution = resolution;
+	m_grids.clear();
+
+	return 0;
+}
+
+/**
+ * Function which scores every candidate on the thread pool and keeps the cheapest
+ * Candidates that have not started by the deadline are skipped
+ *
+ * @param deadlineMs: time budget for the whole search
+ * @return 0: at least one candidate was scored
+ * @return -1: the deadline passed before any candidate was scored
+ */
+int PlanSearch::search(int deadlineMs) {
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(deadlineMs);
+
+	while ((int) m_grids.size() < m_pool->getThreadCount()) {
+		m_grids.push_back(std::unique_ptr<CoverageGrid>(new CoverageGrid(m_length, m_width, m_resolution)));
+	}
+
+	while ((int) m_arenas.size() < m_pool->getThreadCount()) {
+		m_arenas.push_back(std::unique_ptr<PlanArena>(new PlanArena()));
+	}
+
+	m_bestScore = PlanScore{HUGE_VAL, 0, 0, 0};
+	m_scoredCount = 0;
+
+	for (const PlanCandidate& candidate : getCandidates()) {
+		m_pool->submit([this, candidate, deadline]() {
+			if (std::chrono::steady_clock::now() > deadline) {
+				return;
+			}
+
+			int worker = ThreadPool::getWorkerIndex();
+			PlanScore result = score(candidate, *m_grids[worker], *m_arenas[worker]);
+			std::lock_guard<std::mutex> lock(m_bestMutex);
+
+			m_scoredCount++;
+
+			if (result.cost < m_bestScore.cost) {
+				m_bestScore = result;
+				m_bestCandidate = candidate;
+			}
+		});
+	}
+
+	m_pool->wait();
+
+	return m_scoredCount > 0 ? 0 : -1;
+}
+
+/**
+ * Function which generates the instructions of a candidate, in the lawn frame
+ *
+ * @param candidate: candidate to generate
+ * @param instructions: receives the instructions
+ * @param start: receives the pose the mower has to be in before the first instruction
+ * @return 0: success
+ */
+int PlanSearch::generate(const PlanCandidate& candidate, Plan& instructions, Pose& start) {
+	LawnSpec lawn = LawnSpec{0, 0, m_carDiameter, m_bladeDiameter, candidate.overlap};
+
+	instructions.clear();
+	generateCanonical(candidate, instructions);
+
+	// a mirrored frame turns the other way
+	if (isMirrored(candidate)) {
+		for (Instruction& instruction : instructions) {
+			if (instruction.action == "TL") {
+				instruction.action = "TR";
+			} else if (instruction.action == "TR") {
+				instruction.action = "TL";
+			}
+		}
+	}
+
+	start = toLawnFrame(candidate, getPatternStartPose(lawn));
+
+	return 0;
+}
+
+/**
+ * Function which scores a single candidate
+ *
+ * @param candidate: candidate to score
+ * @param grid: scratch grid covering the lawn, reset here
+ * @param arena: scratch arena the candidate is built in, reset here
+ * @return the score
+ */
+PlanScore PlanSearch::score(const PlanCandidate& candidate, CoverageGrid& grid, PlanArena& arena) {
+	arena.reset();
+
+	Plan instructions(arena.getResource());
+	Pose start;
+	DriveModel model(m_carDiameter);
+
+	generate(candidate, instructions, start);
+
+	grid.reset();
+	grid.sweepPlan(instructions, start, m_bladeDiameter, model);
+
+	// drive to the start: turn towards it, go straight, turn onto the start heading
+	double distance = std::hypot(start.x - m_startPose.x, start.y - m_startPose.y);
+	double transitTurns = std::fabs(std::remainder(start.theta - m_startPose.theta, 2 * M_PI));
+
+	if (distance > 1e-6) {
+		double heading = std::atan2(start.y - m_startPose.y, start.x - m_startPose.x);
+		transitTurns = std::fabs(std::remainder(heading - m_startPose.theta, 2 * M_PI)) + std::fabs(std::remainder(start.theta - heading, 2 * M_PI));
+	}
+
+	double seconds = estimateSeconds(instructions) + distance * DRIVE_MS_PER_METRE / 1000 + transitTurns * 180 / M_PI * TURN_SECONDS_PER_DEGREE;
+
+	return PlanScore{seconds + grid.getMissedArea() * m_missedAreaPenalty, seconds, grid.getCoveragePercent(), grid.getOverlapPercent()};
+}
+
+/**
+ * Function which lists every candidate: each pattern, strip direction, start corner and overlap
+ */
+std::vector<PlanCandidate> PlanSearch::getCandidates() {
+	std::vector<PlanCandidate> candidates;
+	CoveragePatternType patterns[] = {BOUSTROPHEDON, INWARD_SPIRAL, PERIMETER_FIRST};
+
+	for (CoveragePatternType pattern : patterns) {
+		for (int axis = 0; axis < 2; axis++) {
+			for (int corner = 0; corner < 4; corner++) {
+				for (double overlap : OVERLAPS) {
+					candidates.push_back(PlanCandidate{pattern, axis, corner, overlap});
+				}
+			}
+		}
+	}
+
+	return candidates;
+}
+
+/**
+ * Getter function which returns the cheapest candidate of the last search
+ */
+PlanCandidate PlanSearch::getBestCandidate() {
+	return m_bestCandidate;
+}
+
+/**
+ * Getter function which returns the score of the cheapest candidate of the last search
+ */
+PlanScore PlanSearch::getBestScore() {
+	return m_bestScore;
+}
+
+/**
+ * Getter function which generates the instructions of the cheapest candidate
+ * @return 0: success
+ * @return -1: no search has completed
+ */
+int PlanSearch::getBestInstructions(Plan& instructions, Pose& start) {
+	if (m_scoredCount == 0) {
+		return -1;
+	}
+
+	return generate(m_bestCandidate, instructions, start);
+}
+
+/**
+ * Getter function which returns how many candidates the last search scored before its deadline
+ */
+int PlanSearch::getScoredCount() {
+	return m_scoredCount;
+}
+
+/**
+ * Function which generates a candidate in the pattern's own frame (strips along x, starting at the origin)
+ */
+int PlanSearch::generateCanonical(const PlanCandidate& candidate, Plan& instructions) {
+	LawnSpec lawn;
+	lawn.sizeX = candidate.stripAxis == 0 ? m_length : m_width;
+	lawn.sizeY = candidate.stripAxis == 0 ? m_width : m_length;
+	lawn.carDiameter = m_carDiameter;
+	lawn.bladeDiameter = m_bladeDiameter;
+	lawn.overlap = candidate.overlap;
+
+	switch (candidate.pattern) {
+		case BOUSTROPHEDON:
+			generateCoverage<Boustrophedon>(lawn, instructions);
+			break;
+		case INWARD_SPIRAL:
+			generateCoverage<InwardSpiral>(lawn, instructions);
+			break;
+		case PERIMETER_FIRST:
+			generateCoverage<PerimeterFirst>(lawn, instructions);
+			break;
+		default:
+			return -2;
+	}
+
+	return 0;
+}
+
+/**
+ * Function which maps a pose from the pattern frame onto the lawn for the candidate's strip direction and start corner
+ */
+Pose PlanSearch::toLawnFrame(const PlanCandidate& candidate, const Pose& pose) {
+	double x = pose.x;
+	double y = pose.y;
+	double dx = std::cos(pose.theta);
+	double dy = std::sin(pose.theta);
+
+	if (candidate.stripAxis == 1) {
+		std::swap(x, y);
+		std::swap(dx, dy);
+	}
+
+	if (candidate.startCorner & 1) {
+		x = m_length - x;
+		dx = -dx;
+	}
+
+	if (candidate.startCorner & 2) {
+		y = m_width - y;
+		dy = -dy;
+	}
+
+	return Pose{x, y, std::atan2(dy, dx)};
+}
+
+/**
+ * Function which returns whether the mapping onto the lawn is a reflection (left and right turns swap)
+ */
+bool PlanSearch::isMirrored(const PlanCandidate& candidate) {
+	return ((candidate.stripAxis == 1) ^ ((candidate.startCorner & 1) != 0) ^ ((candidate.startCorner & 2) != 0));
+}
+
+/**
+ * Function which estimates how long the instructions take to drive, in seconds
+ */
+double PlanSearch::estimateSeconds(const Plan& instructions) {
+	MissionTimeSink time;
+
+	for (const Instruction& instruction : instructions) {
+		time.push_back(instruction);
+	}
+
+	return time.seconds;
+}
@@ -0,0 +1,256 @@
+/**
+ * This file contains the implementation of the PlanTextReader class and all associated member functions that are included in the PlanTextReader.h file.
+ * The PlanTextReader class memory maps plan files and parses them in place into a Plan.
+ *
+ */
+
+#include "PlanTextReader.h"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * Function which checks the two letters of an action
+ * @return true for MF, MB, TL, TR and CH
+ */
+static bool isAction(char first, char second) {
+	switch (first) {
+		case 'M':
+			return second == 'F' || second == 'B';
+		case 'T':
+			return second == 'L' || second == 'R';
+		case 'C':
+			return second == 'H';
+		default:
+			return false;
+	}
+}
+
+/**
+ * Function which reads a value of at most 15 digits without an exponent (e.g. 90 or 2.13, as most plans are) the quick way:
+ * the digits as an integer and the power of ten are both exact doubles, so dividing them rounds the same as std::from_chars
+ * @return the end of the value, nullptr if it has to go through std::from_chars
+ */
+static const char* parseShortValue(const char* position, const char* end, double& value) {
+	static const double POWERS_OF_TEN[16] = {1, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+	long long digits = 0;
+	int count = 0;
+	int decimals = 0;
+
+	if (position == end || *position < '0' || *position > '9') {
+		return nullptr;
+	}
+
+	for (; position < end && *position >= '0' && *position <= '9' && count < 16; position++, count++) {
+		digits = digits * 10 + (*position - '0');
+	}
+
+	if (position < end && *position == '.') {
+		for (position++; position < end && *position >= '0' && *position <= '9' && count < 16; position++, count++, decimals++) {
+			digits = digits * 10 + (*position - '0');
+		}
+	}
+
+	if (count > 15 || (position < end && (*position == 'e' || *position == 'E'))) {
+		return nullptr;
+	}
+
+	value = digits / POWERS_OF_TEN[decimals];
+
+	return position;
+}
+
+/**
+ * Constructor, nothing read yet
+ */
+PlanTextReader::PlanTextReader() {
+	m_lineCount = 0;
+	m_errorLine = 0;
+	m_byteCount = 0;
+}
+
+/**
+ * Member function destructor which deletes an object: no return
+ */
+PlanTextReader::~PlanTextReader() {
+
+}
+
+/**
+ * Function which adds the instructions of a plan file to the end of a plan
+ * @return 0: success
+ * @return -1: the file could not be opened or mapped
+ * @return -2: a line is malformed (see getErrorLine()), the plan is left as it was
+ */
+int PlanTextReader::read(const std::string& path, Plan& plan) {
+	int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	struct stat status;
+
+	m_lineCount = 0;
+	m_errorLine = 0;
+
+	if (fd < 0) {
+		return -1;
+	}
+
+	if (fstat(fd, &status) != 0) {
+		close(fd);
+		return -1;
+	}
+
+	size_t size = status.st_size;
+
+	if (size == 0) {
+		close(fd);
+		return 0;
+	}
+
+	void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (mapping == MAP_FAILED) {
+		return -1;
+	}
+
+	madvise(mapping, size, MADV_SEQUENTIAL);
+
+	int result = parse(static_cast<const char*>(mapping), size, plan);
+
+	munmap(mapping, size);
+
+	return result;
+}
+
+/**
+ * Function which adds the instructions of plan text in memory to the end of a plan (the text need not end with a newline)
+ * @return 0: success
+ * @return -2: a line is malformed (see getErrorLine()), the plan is left as it was
+ */
+int PlanTextReader::parse(const char* data, size_t size, Plan& plan) {
+	const char* position = data;
+	const char* end = data + size;
+	size_t planSize = plan.size();
+
+	m_lineCount = 0;
+	m_errorLine = 0;
+
+	while (position < end) {
+		m_lineCount++;
+
+		while (position < end && (*position == ' ' || *position == '\t')) {
+			position++;
+		}
+
+		if (position == end) {
+			break;
+		}
+
+		// blank line or comment
+		if (*position == '\n' || *position == '\r' || *position == '#') {
+			const char* newline = static_cast<const char*>(memchr(position, '\n', end - position));
+			position = newline != nullptr ? newline + 1 : end;
+			continue;
+		}
+
+		Instruction instruction;
+		double value;
+
+		if (end - position < 3 || !isAction(position[0], position[1])) {
+			break;
+		}
+
+		const char* valueEnd = parseShortValue(position + 2, end, value);
+
+		if (valueEnd == nullptr) {
+			std::from_chars_result parsed = std::from_chars(position + 2, end, value);
+
+			if (parsed.ec != std::errc() || !std::isfinite(value) || std::signbit(value)) {
+				break;
+			}
+
+			valueEnd = parsed.ptr;
+		}
+
+		instruction.action.code[0] = position[0];
+		instruction.action.code[1] = position[1];
+		instruction.value = value;
+		position = valueEnd;
+
+		while (position < end && (*position == ' ' || *position == '\t')) {
+			position++;
+		}
+
+		// measured turn time
+		if (position < end && *position >= '0' && *position <= '9') {
+			std::from_chars_result parsed = std::from_chars(position, end, instruction.durationMs);
+
+			if (parsed.ec != std::errc() || end - parsed.ptr < 2 || memcmp(parsed.ptr, "ms", 2) != 0) {
+				break;
+			}
+
+			position = parsed.ptr + 2;
+
+			while (position < end && (*position == ' ' || *position == '\t')) {
+				position++;
+			}
+		}
+
+		if (end - position >= 3 && memcmp(position, "off", 3) == 0) {
+			instruction.cutting = false;
+			position += 3;
+
+			while (position < end && (*position == ' ' || *position == '\t')) {
+				position++;
+			}
+		}
+
+		if (position < end && *position == '\r') {
+			position++;
+		}
+
+		if (position < end) {
+			if (*position != '\n') {
+				break;
+			}
+
+			position++;
+		}
+
+		plan.push_back(instruction);
+	}
+
+	m_byteCount += position - data;
+
+	if (position < end) {
+		m_errorLine = m_lineCount;
+		plan.erase(plan.begin() + planSize, plan.end());
+		return -2;
+	}
+
+	return 0;
+}
+
+/**
+ * Getter function which returns how many lines the last read() or parse() went through (up to the malformed one)
+ */
+long PlanTextReader::getLineCount() {
+	return m_lineCount;
+}
+
+/**
+ * Getter function which returns the line the last read() or parse() stopped at, 0 if it succeeded
+ */
+long PlanTextReader::getErrorLine() {
+	return m_errorLine;
+}
+
+/**
+ * Getter function which returns how many bytes have been parsed since the reader was made
+ */
+long PlanTextReader::getByteCount() {
+	return m_byteCount;
+}
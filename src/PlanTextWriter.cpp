@@ -0,0 +1,204 @@
+/**
+ * This file contains the implementation of the PlanTextWriter class and all associated member functions that are included in the PlanTextWriter.h file.
+ * The PlanTextWriter class formats plans as text into a buffer and writes it out when it is full.
+ *
+ */
+
+#include "PlanTextWriter.h"
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * Constructor, nothing is written until open()
+ */
+PlanTextWriter::PlanTextWriter() {
+	m_fd = -1;
+	m_used = 0;
+	m_instructionCount = 0;
+	m_byteCount = 0;
+}
+
+/**
+ * Member function destructor which writes what is buffered and closes the file: no return
+ */
+PlanTextWriter::~PlanTextWriter() {
+	close();
+}
+
+/**
+ * Function which starts a new plan file (an existing file is replaced)
+ * @return 0: success
+ * @return -1: the file could not be created
+ */
+int PlanTextWriter::open(const std::string& path) {
+	close();
+
+	m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	m_used = 0;
+	m_instructionCount = 0;
+	m_byteCount = 0;
+
+	return m_fd >= 0 ? 0 : -1;
+}
+
+/**
+ * Function which writes what is buffered and closes the file
+ * @return 0: success
+ * @return -1: the last write failed, the file is incomplete
+ */
+int PlanTextWriter::close() {
+	int result = 0;
+
+	if (m_fd >= 0) {
+		result = flush();
+		::close(m_fd);
+		m_fd = -1;
+	}
+
+	return result;
+}
+
+/**
+ * Function which adds an instruction to the file
+ * @return 0: success
+ * @return -1: not open, or a write failed
+ */
+int PlanTextWriter::write(const Instruction& instruction) {
+	if (reserve(PLAN_TEXT_MAX_LINE) != 0) {
+		return -1;
+	}
+
+	int length = format(instruction, m_buffer + m_used);
+	m_used += length;
+	m_byteCount += length;
+	m_instructionCount++;
+
+	return 0;
+}
+
+/**
+ * Function which adds every instruction of a plan to the file, in order
+ * @return 0: success
+ * @return -1: not open, or a write failed
+ */
+int PlanTextWriter::writePlan(const Plan& plan) {
+	for (const Instruction& instruction : plan) {
+		if (write(instruction) != 0) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Function which adds a comment line, e.g. where the plan came from
+ * @param comment: one line, without the '#' and the newline
+ * @return 0: success
+ * @return -1: not open, the comment does not fit in the buffer, or a write failed
+ */
+int PlanTextWriter::writeComment(const char* comment) {
+	int length = strlen(comment);
+
+	if (length + 3 > PLAN_TEXT_BUFFER || reserve(length + 3) != 0) {
+		return -1;
+	}
+
+	m_buffer[m_used] = '#';
+	m_buffer[m_used + 1] = ' ';
+	memcpy(m_buffer + m_used + 2, comment, length);
+	m_buffer[m_used + length + 2] = '\n';
+	m_used += length + 3;
+	m_byteCount += length + 3;
+
+	return 0;
+}
+
+/**
+ * Function which writes what is buffered to the file
+ * @return 0: success
+ * @return -1: not open, or the write failed
+ */
+int PlanTextWriter::flush() {
+	int done = 0;
+
+	if (m_fd < 0) {
+		return -1;
+	}
+
+	while (done < m_used) {
+		ssize_t written = ::write(m_fd, m_buffer + done, m_used - done);
+
+		if (written <= 0) {
+			m_used = 0;
+			return -1;
+		}
+
+		done += written;
+	}
+
+	m_used = 0;
+
+	return 0;
+}
+
+/**
+ * Getter function which returns how many instructions have been added since open()
+ */
+long PlanTextWriter::getInstructionCount() {
+	return m_instructionCount;
+}
+
+/**
+ * Getter function which returns how many bytes have been added since open()
+ */
+long PlanTextWriter::getByteCount() {
+	return m_byteCount;
+}
+
+/**
+ * Function which formats an instruction as one line of the file, newline included
+ * @param line: receives the line, at least PLAN_TEXT_MAX_LINE chars (it is not null terminated)
+ * Return value is the length of the line
+ */
+int PlanTextWriter::format(const Instruction& instruction, char* line) {
+	line[0] = instruction.action.code[0];
+	line[1] = instruction.action.code[1];
+
+	// shortest form that reads back to the same double, e.g. 90, 2.13 or 0.30000000000000004
+	char* end = std::to_chars(line + 2, line + PLAN_TEXT_MAX_LINE - 20, instruction.value).ptr;
+
+	if (instruction.durationMs > 0) {
+		*end++ = ' ';
+		end = std::to_chars(end, line + PLAN_TEXT_MAX_LINE - 7, instruction.durationMs).ptr;
+		memcpy(end, "ms", 2);
+		end += 2;
+	}
+
+	if (!instruction.cutting) {
+		memcpy(end, " off", 4);
+		end += 4;
+	}
+
+	*end++ = '\n';
+
+	return end - line;
+}
+
+/**
+ * Function which makes room for a line in the buffer, writing it out if it is too full
+ * @return 0: success, -1: not open, or the write failed
+ */
+int PlanTextWriter::reserve(int bytes) {
+	if (m_fd < 0) {
+		return -1;
+	}
+
+	if (m_used + bytes > PLAN_TEXT_BUFFER) {
+		return flush();
+	}
+
+	return 0;
+}
@@ -0,0 +1,240 @@
+/**
+ * This file contains the implementation of the PoseEstimator class and all associated member functions that are included in the PoseEstimator.h file.
+ * The PoseEstimator class keeps track of where the mower is by dead reckoning the wheel commands through the DriveModel.
+ *
+ */
+
+#include "PoseEstimator.h"
+#include <cmath>
+
+/**
+ * Constructor, the mower starts at the origin facing +x
+ *
+ * @param wheelBase: distance between the wheels in metres
+ *
+ */
+PoseEstimator::PoseEstimator(double wheelBase) : PoseEstimator(wheelBase, Pose{0, 0, 0}) {
+
+}
+
+/**
+ * Constructor
+ *
+ * @param wheelBase: distance between the wheels in metres
+ * @param start: starting pose
+ *
+ */
+PoseEstimator::PoseEstimator(double wheelBase, const Pose& start) : m_model(wheelBase) {
+	m_motorTimeConstant = 0.05;
+	m_encoderNoise = 0.01 * 0.01;
+	m_gyroNoise = 0.02 * 0.02;
+	m_headingNoise = 0.05 * 0.05;
+
+	reset(start);
+}
+
+/**
+ * Member function destructor which deletes an object: no return
+ */
+PoseEstimator::~PoseEstimator() {
+
+}
+
+/**
+ * Function which moves the estimate to a known pose (e.g. the starting corner) and stops the wheels
+ */
+int PoseEstimator::reset(const Pose& pose) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	Matrix<5, 1> state;
+	state(0, 0) = pose.x;
+	state(1, 0) = pose.y;
+	state(2, 0) = pose.theta;
+
+	Matrix<5, 5> covariance;
+
+	for (int i = 0; i < 5; i++) {
+		covariance(i, i) = 1e-6;
+	}
+
+	m_filter.reset(state, covariance);
+
+	return 0;
+}
+
+/**
+ * Function which runs a single filter predict step
+ *
+ * @param vLeft: commanded left wheel speed (m/s)
+ * @param vRight: commanded right wheel speed (m/s)
+ * @param dt: step length in seconds
+ * @return 0: success
+ */
+int PoseEstimator::predict(double vLeft, double vRight, double dt) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return predictLocked(vLeft, vRight, dt);
+}
+
+/**
+ * Function which steps the filter through a wheel command held for durationMs, one filter step per ms
+ * Called by the ExecutionController while a motion runs, so the estimate follows the mower
+ */
+int PoseEstimator::advance(double vLeft, double vRight, int durationMs) {
+	for (int elapsed = 0; elapsed < durationMs; elapsed += POSE_STEP_MS) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		predictLocked(vLeft, vRight, POSE_STEP_MS / 1000.0);
+	}
+
+	return 0;
+}
+
+/**
+ * Function which lets the wheels coast to a stop, which is what happens between instructions
+ * Called by the ExecutionController after each motion
+ */
+int PoseEstimator::coast() {
+	return advance(0, 0, (int) (5 * m_motorTimeConstant * 1000));
+}
+
+/**
+ * Function which integrates a whole wheel command that was held for durationMs and the coast after it
+ */
+int PoseEstimator::integrate(double vLeft, double vRight, int durationMs) {
+	advance(vLeft, vRight, durationMs);
+
+	return coast();
+}
+
+/**
+ * Function which corrects the estimate with wheel encoder speeds
+ *
+ * @param vLeft: measured left wheel speed (m/s)
+ * @param vRight: measured right wheel speed (m/s)
+ * @return 0: success
+ * @return -1: measurement rejected
+ */
+int PoseEstimator::updateEncoders(double vLeft, double vRight) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	Matrix<5, 1>& state = m_filter.getState();
+	Matrix<2, 1> innovation;
+	innovation(0, 0) = (vLeft + vRight) / 2 - state(3, 0);
+	innovation(1, 0) = (vRight - vLeft) / m_model.getWheelBase() - state(4, 0);
+
+	Matrix<2, 5> observation;
+	observation(0, 3) = 1;
+	observation(1, 4) = 1;
+
+	Matrix<2, 2> noise;
+	noise(0, 0) = m_encoderNoise;
+	noise(1, 1) = 2 * m_encoderNoise / (m_model.getWheelBase() * m_model.getWheelBase());
+
+	return m_filter.update(innovation, observation, noise);
+}
+
+/**
+ * Function which corrects the estimate with an IMU yaw rate sample (rad/s)
+ */
+int PoseEstimator::updateGyro(double yawRate) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	Matrix<1, 1> innovation;
+	innovation(0, 0) = yawRate - m_filter.getState()(4, 0);
+
+	Matrix<1, 5> observation;
+	observation(0, 4) = 1;
+
+	Matrix<1, 1> noise;
+	noise(0, 0) = m_gyroNoise;
+
+	return m_filter.update(innovation, observation, noise);
+}
+
+/**
+ * Function which corrects the estimate with an absolute heading (rad), e.g. from an IMU compass
+ */
+int PoseEstimator::updateHeading(double heading) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	Matrix<1, 1> innovation;
+	innovation(0, 0) = std::remainder(heading - m_filter.getState()(2, 0), 2 * M_PI);
+
+	Matrix<1, 5> observation;
+	observation(0, 2) = 1;
+
+	Matrix<1, 1> noise;
+	noise(0, 0) = m_headingNoise;
+
+	return m_filter.update(innovation, observation, noise);
+}
+
+/**
+ * Getter function which returns the current pose estimate
+ */
+Pose PoseEstimator::getPose() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	Matrix<5, 1>& state = m_filter.getState();
+
+	return Pose{state(0, 0), state(1, 0), state(2, 0)};
+}
+
+/**
+ * Getter function which returns the x + y variance of the estimate (m^2), grows while dead reckoning
+ */
+double PoseEstimator::getPositionVariance() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return m_filter.getCovariance()(0, 0) + m_filter.getCovariance()(1, 1);
+}
+
+/**
+ * Getter function which returns the drive model used for prediction
+ */
+DriveModel& PoseEstimator::getDriveModel() {
+	return m_model;
+}
+
+/**
+ * Function which runs the EKF predict step, caller holds m_mutex
+ * The wheels approach the commanded speed with a first order lag, the pose integrates the filtered speeds
+ */
+int PoseEstimator::predictLocked(double vLeft, double vRight, double dt) {
+	Matrix<5, 1>& state = m_filter.getState();
+	double theta = state(2, 0);
+	double v = state(3, 0);
+	double omega = state(4, 0);
+	double c = std::cos(theta);
+	double s = std::sin(theta);
+	double alpha = dt / (m_motorTimeConstant + dt);
+
+	Matrix<5, 1> predicted;
+	predicted(0, 0) = state(0, 0) + v * c * dt;
+	predicted(1, 0) = state(1, 0) + v * s * dt;
+	predicted(2, 0) = theta + omega * dt;
+	predicted(3, 0) = v + alpha * ((vLeft + vRight) / 2 - v);
+	predicted(4, 0) = omega + alpha * ((vRight - vLeft) / m_model.getWheelBase() - omega);
+
+	Matrix<5, 5> jacobian = Matrix<5, 5>::identity();
+	jacobian(0, 2) = -v * s * dt;
+	jacobian(0, 3) = c * dt;
+	jacobian(1, 2) = v * c * dt;
+	jacobian(1, 3) = s * dt;
+	jacobian(2, 4) = dt;
+	jacobian(3, 3) = 1 - alpha;
+	jacobian(4, 4) = 1 - alpha;
+
+	// wheel slip on grass: noise grows with how hard the wheels are driven
+	double slip = (std::fabs(vLeft) + std::fabs(vRight)) * dt;
+	Matrix<5, 5> noise;
+	noise(0, 0) = 1e-4 * slip;
+	noise(1, 1) = 1e-4 * slip;
+	noise(2, 2) = 1e-3 * slip;
+	noise(3, 3) = 1e-3 * dt;
+	noise(4, 4) = 1e-2 * dt;
+
+	m_filter.predict(predicted, jacobian, noise);
+
+	return 0;
+}
@@ -0,0 +1,323 @@
+/**
+ * This file contains the implementation of the Reactor class and all associated member functions that are included in the Reactor.h file.
+ * The Reactor class is a single threaded epoll event loop for fds, timers and events.
+ *
+ */
+
+#include "Reactor.h"
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <ctime>
+#include <cerrno>
+#include <algorithm>
+#include <cstdint>
+
+const int REACTOR_MAX_EVENTS = 16; // events taken from the kernel per epoll_wait
+
+/**
+ * Constructor, creates the epoll instance
+ */
+Reactor::Reactor() {
+	m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+	m_running = false;
+	m_latencyCount = 0;
+	m_latencyTotalUs = 0;
+	m_latencyMaxUs = 0;
+	m_errorNum = m_epollFd < 0 ? -1 : 0;
+}
+
+/**
+ * Member function destructor which closes the epoll instance and every timer and event it created
+ */
+Reactor::~Reactor() {
+	for (const Source& source : m_sources) {
+		if (source.type != FD_SOURCE) {
+			close(source.fd);
+		}
+	}
+
+	if (m_epollFd >= 0) {
+		close(m_epollFd);
+	}
+}
+
+/**
+ * Function which watches a file descriptor, the handler runs every time it is readable and must consume what is pending
+ * (the fd stays owned by the caller)
+ *
+ * @return 0: success
+ * @return -1: the fd could not be added
+ */
+int Reactor::addFd(int fd, std::function<void()> handler) {
+	return addSource(fd, FD_SOURCE, handler) < 0 ? -1 : 0;
+}
+
+/**
+ * Function which stops watching a file descriptor added with addFd(), e.g. a client that hung up
+ * Can be called from the fd's own handler, which then runs to the end (the fd stays owned by the caller, close it after)
+ *
+ * @return 0: success
+ * @return -1: the fd is not watched
+ */
+int Reactor::removeFd(int fd) {
+	for (Source& source : m_sources) {
+		if (source.type == FD_SOURCE && source.fd == fd && fd >= 0) {
+			epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+			source.fd = -1;
+			source.handler = nullptr;
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+/**
+ * Function which creates a timer (disarmed)
+ *
+ * @return the timer id for armTimer() and disarmTimer()
+ * @return -1: no timer could be created
+ */
+int Reactor::addTimer(std::function<void()> handler) {
+	int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+	if (fd < 0) {
+		m_errorNum = -1;
+		return -1;
+	}
+
+	return addSource(fd, TIMER_SOURCE, handler);
+}
+
+/**
+ * Function which arms a timer, replacing any earlier setting
+ *
+ * @param timer: id from addTimer()
+ * @param delayMs: time until the handler first runs (0 runs it on the next loop iteration)
+ * @param periodMs: time between runs after that, 0 for a one shot timer
+ * @return 0: success
+ * @return -1: not a timer
+ */
+int Reactor::armTimer(int timer, unsigned int delayMs, unsigned int periodMs) {
+	if (timer < 0 || timer >= (int) m_sources.size() || m_sources[timer].type != TIMER_SOURCE) {
+		m_errorNum = -1;
+		return -1;
+	}
+
+	Source& source = m_sources[timer];
+	itimerspec spec;
+
+	// absolute expiry, so a delay of 0 fires straight away instead of disarming the timer
+	source.dueNs = getMonotonicNs() + delayMs * 1000000LL;
+	source.periodMs = periodMs;
+	spec.it_value.tv_sec = source.dueNs / 1000000000LL;
+	spec.it_value.tv_nsec = source.dueNs % 1000000000LL;
+	spec.it_interval.tv_sec = periodMs / 1000;
+	spec.it_interval.tv_nsec = (periodMs % 1000) * 1000000L;
+
+	return timerfd_settime(source.fd, TFD_TIMER_ABSTIME, &spec, nullptr) == 0 ? 0 : -1;
+}
+
+/**
+ * Function which stops a timer, its handler will not run until it is armed again
+ *
+ * @return 0: success
+ * @return -1: not a timer
+ */
+int Reactor::disarmTimer(int timer) {
+	if (timer < 0 || timer >= (int) m_sources.size() || m_sources[timer].type != TIMER_SOURCE) {
+		m_errorNum = -1;
+		return -1;
+	}
+
+	itimerspec spec = {};
+	m_sources[timer].dueNs = 0;
+
+	return timerfd_settime(m_sources[timer].fd, 0, &spec, nullptr) == 0 ? 0 : -1;
+}
+
+/**
+ * Function which creates an event, its handler runs on the loop thread after notify()
+ *
+ * @return the event id for notify()
+ * @return -1: no event could be created
+ */
+int Reactor::addEvent(std::function<void()> handler) {
+	int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+	if (fd < 0) {
+		m_errorNum = -1;
+		return -1;
+	}
+
+	return addSource(fd, EVENT_SOURCE, handler);
+}
+
+/**
+ * Function which wakes the loop to run an event's handler
+ * Safe to call from any thread and from a signal handler (it is a single write)
+ *
+ * @return 0: success
+ * @return -1: not an event
+ */
+int Reactor::notify(int event) {
+	if (event < 0 || event >= (int) m_sources.size() || m_sources[event].type != EVENT_SOURCE) {
+		return -1;
+	}
+
+	return eventfd_write(m_sources[event].fd, 1) == 0 ? 0 : -1;
+}
+
+/**
+ * Function which runs the loop on the calling thread until stop() is called from a handler
+ *
+ * @return 0: stopped
+ * @return -1: epoll failed
+ */
+int Reactor::run() {
+	epoll_event events[REACTOR_MAX_EVENTS];
+
+	m_running = true;
+
+	while (m_running) {
+		int count = epoll_wait(m_epollFd, events, REACTOR_MAX_EVENTS, -1);
+
+		if (count < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			m_errorNum = -1;
+			return -1;
+		}
+
+		for (int i = 0; i < count && m_running; i++) {
+			dispatch(events[i].data.u32);
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Function which makes run() return once the current handler is done (only from the loop thread, use an event otherwise)
+ */
+int Reactor::stop() {
+	m_running = false;
+
+	return 0;
+}
+
+/**
+ * Function which records how late an event was handled, measured from when it happened
+ *
+ * @param eventNs: CLOCK_MONOTONIC time of the event (see getMonotonicNs())
+ */
+int Reactor::recordLatency(long long eventNs) {
+	double latencyUs = std::max(0LL, getMonotonicNs() - eventNs) / 1000.0;
+
+	m_latencyCount++;
+	m_latencyTotalUs += latencyUs;
+	m_latencyMaxUs = std::max(m_latencyMaxUs, latencyUs);
+
+	return 0;
+}
+
+/**
+ * Getter function which returns how late events have been handled so far (timers and recorded fd events)
+ */
+LatencyStats Reactor::getLatency() {
+	return LatencyStats{m_latencyCount, m_latencyCount > 0 ? m_latencyTotalUs / m_latencyCount : 0, m_latencyMaxUs};
+}
+
+/**
+ * Function which returns the CLOCK_MONOTONIC time in nanoseconds (the clock timers and GPIO edge timestamps use)
+ */
+long long Reactor::getMonotonicNs() {
+	timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * Getter function which returns the errorNum variable which holds the value of the current error call
+ */
+int Reactor::getErrorNum() {
+	return m_errorNum;
+}
+
+/**
+ * Function which registers a file descriptor with epoll
+ *
+ * @return the index of the new source
+ * @return -1: epoll refused the fd
+ */
+int Reactor::addSource(int fd, SourceType type, std::function<void()> handler) {
+	epoll_event event = {};
+	int index = m_sources.size();
+
+	// the slot of a removed fd is reused, so clients coming and going do not grow m_sources
+	for (int i = 0; i < (int) m_sources.size() && type == FD_SOURCE; i++) {
+		if (m_sources[i].type == FD_SOURCE && m_sources[i].fd < 0) {
+			index = i;
+			break;
+		}
+	}
+
+	event.events = EPOLLIN;
+	event.data.u32 = index;
+
+	if (fd < 0 || epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+		if (fd >= 0 && type != FD_SOURCE) {
+			close(fd);
+		}
+
+		m_errorNum = -1;
+		return -1;
+	}
+
+	if (index < (int) m_sources.size()) {
+		m_sources[index] = Source{fd, type, handler, 0, 0};
+	} else {
+		m_sources.push_back(Source{fd, type, handler, 0, 0});
+	}
+
+	return index;
+}
+
+/**
+ * Function which runs the handler of a ready source
+ * Timers and events are read first: a timer disarmed by an earlier handler in the same batch has nothing to read and is skipped
+ */
+int Reactor::dispatch(int index) {
+	Source& source = m_sources[index];
+	uint64_t count = 0;
+
+	// removed by an earlier handler in the same batch
+	if (source.fd < 0 || !source.handler) {
+		return 0;
+	}
+
+	if (source.type == TIMER_SOURCE) {
+		if (read(source.fd, &count, sizeof(count)) != sizeof(count)) {
+			return 0;
+		}
+
+		recordLatency(source.dueNs);
+		source.dueNs = source.periodMs > 0 ? source.dueNs + count * source.periodMs * 1000000LL : 0;
+	} else if (source.type == EVENT_SOURCE) {
+		if (read(source.fd, &count, sizeof(count)) != sizeof(count)) {
+			return 0;
+		}
+	}
+
+	// copy, the handler may add sources (which can move m_sources)
+	std::function<void()> handler = source.handler;
+	handler();
+
+	return 1;
+}
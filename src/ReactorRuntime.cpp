@@ -0,0 +1,176 @@
+/**
+ * This file contains the implementation of the ReactorRuntime class and all associated member functions that are included in the ReactorRuntime.h file.
+ * The ReactorRuntime class runs the buttons, display and execution on one epoll loop.
+ *
+ */
+
+#include "ReactorRuntime.h"
+#include "SpanTracer.h"
+
+/**
+ * Constructor which registers every event source, run() starts handling them
+ *
+ * @param buttonControl: buttons and display
+ * @param exeControl: executor, driven with startNext()/continueCurrent() (its listener thread must not run)
+ * @param board: board the buttons are on
+ *
+ */
+ReactorRuntime::ReactorRuntime(ButtonController& buttonControl, ExecutionController& exeControl, Board& board) {
+	m_buttonControl = &buttonControl;
+	m_exeControl = &exeControl;
+	m_board = &board;
+	m_shuttingDown = false;
+	m_pollTimer = -1;
+	m_errorNum = 0;
+
+	m_motionTimer = m_reactor.addTimer([this]() { onMotionDeadline(); });
+	m_displayTimer = m_reactor.addTimer([this]() { m_buttonControl->refreshDisplay(); });
+	m_shutdownEvent = m_reactor.addEvent([this]() { onShutdown(); });
+
+	for (int pin : m_buttonControl->getButtonPins()) {
+		int fd = m_board->getEdgeFd(pin);
+
+		if (fd < 0 || m_reactor.addFd(fd, [this, pin]() {
+			long long edgeNs = 0;
+
+			if (m_board->readEdges(pin, edgeNs) > 0 && edgeNs > 0) {
+				m_reactor.recordLatency(edgeNs);
+				m_buttonControl->setEdgeTime(edgeNs);
+			}
+
+			onButtons();
+		}) != 0) {
+			// no edge events for this pin, fall back to polling all buttons
+			if (m_pollTimer < 0) {
+				m_pollTimer = m_reactor.addTimer([this]() { onButtons(); });
+			}
+		}
+	}
+
+	if (m_motionTimer < 0 || m_displayTimer < 0 || m_shutdownEvent < 0) {
+		m_errorNum = -1;
+	}
+}
+
+/**
+ * Member function destructor which deletes an object: no return
+ */
+ReactorRuntime::~ReactorRuntime() {
+
+}
+
+/**
+ * Function which runs the mower on the calling thread until the shutdown button is pressed or requestShutdown() is called
+ *
+ * @return 0: shut down
+ * @return -1: an event source could not be created
+ */
+int ReactorRuntime::run() {
+	if (m_errorNum != 0) {
+		return -1;
+	}
+
+	SpanTracer::getInstance().setThreadName("reactor");
+	m_buttonControl->setupInputs();
+	m_reactor.armTimer(m_displayTimer, DISPLAY_REFRESH_MS, DISPLAY_REFRESH_MS);
+
+	if (m_pollTimer >= 0) {
+		m_reactor.armTimer(m_pollTimer, BUTTON_POLL_MS, BUTTON_POLL_MS);
+	}
+
+	int result = m_reactor.run();
+
+	m_buttonControl->showGoodbye();
+
+	return result;
+}
+
+/**
+ * Function which asks the runtime to shut down, safe to call from any thread
+ */
+int ReactorRuntime::requestShutdown() {
+	return m_reactor.notify(m_shutdownEvent);
+}
+
+/**
+ * Function which serves control clients on the loop as well, their commands go through the buttons' state machine
+ * Call it before run()
+ * @return 0: success
+ * @return -1: the server is not open
+ */
+int ReactorRuntime::setControlServer(ControlServer& controlServer) {
+	return controlServer.attach(m_reactor, [this]() { startNextInstruction(); });
+}
+
+/**
+ * Getter function which returns how late the loop handled its events (button edges, motion deadlines, display refreshes)
+ */
+LatencyStats ReactorRuntime::getLatency() {
+	return m_reactor.getLatency();
+}
+
+/**
+ * Getter function which returns the errorNum variable which holds the value of the current error call
+ */
+int ReactorRuntime::getErrorNum() {
+	return m_errorNum;
+}
+
+/**
+ * Function which handles the buttons after a pin changed: a press can start, pause, resume or end the mission
+ */
+int ReactorRuntime::onButtons() {
+	m_buttonControl->pollButtons();
+
+	if (m_buttonControl->isShutDown()) {
+		return onShutdown();
+	}
+
+	// starting or resuming only changes the state, the executor has to be kicked if it is not busy
+	return startNextInstruction();
+}
+
+/**
+ * Function which handles a motion deadline: moves the current instruction on, or starts the next one when it is done
+ */
+int ReactorRuntime::onMotionDeadline() {
+	unsigned int waitMs = 0;
+
+	if (m_exeControl->continueCurrent(waitMs) == 1) {
+		m_reactor.armTimer(m_motionTimer, waitMs, 0);
+		return 0;
+	}
+
+	return startNextInstruction();
+}
+
+/**
+ * Function which shuts down: the executor's token stops the motors, the instruction being executed ends where the mower got to
+ * and the loop stops without waiting for the motion deadline
+ */
+int ReactorRuntime::onShutdown() {
+	m_shuttingDown = true;
+	m_exeControl->sendShutDownSignal();
+	m_exeControl->cancelCurrent();
+	m_reactor.disarmTimer(m_motionTimer);
+	m_reactor.stop();
+
+	return 0;
+}
+
+/**
+ * Function which starts the next instruction if the executor is free and arms the motion timer for it
+ */
+int ReactorRuntime::startNextInstruction() {
+	unsigned int waitMs = 0;
+
+	if (m_shuttingDown || m_exeControl->isInstructionActive()) {
+		return 0;
+	}
+
+	if (m_exeControl->startNext(waitMs) == 1) {
+		m_reactor.armTimer(m_motionTimer, waitMs, 0);
+	}
+
+	return 0;
+}
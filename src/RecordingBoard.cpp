@@ -0,0 +1,200 @@
+/**
+ * This file contains the implementation of the RecordingBoard class and all associated member functions that are included in the RecordingBoard.h file.
+ * The RecordingBoard class passes every call on to another board and records it into a BoardTrace.
+ *
+ */
+
+#include "RecordingBoard.h"
+
+/**
+ * Constructor, recording starts straight away
+ *
+ * @param board: board every call is passed on to
+ *
+ */
+RecordingBoard::RecordingBoard(Board& board) {
+	m_board = &board;
+	m_startMs = board.millis();
+
+	for (int i = 0; i < RECORDING_PIN_COUNT; i++) {
+		m_lastRead[i] = -1;
+		m_interrupts[i] = RecordedInterrupt{this, i, nullptr, nullptr};
+	}
+}
+
+/**
+ * Member function destructor which deletes an object: no return
+ */
+RecordingBoard::~RecordingBoard() {
+
+}
+
+/**
+ * Function which sets the other board up
+ */
+int RecordingBoard::setup() {
+	return m_board->setup();
+}
+
+/**
+ * Function which sets the mode of a pin on the other board
+ */
+int RecordingBoard::pinMode(int pin, int mode) {
+	return m_board->pinMode(pin, mode);
+}
+
+/**
+ * Function which sets the pull resistor of a pin on the other board
+ */
+int RecordingBoard::pullUpDnControl(int pin, int pud) {
+	return m_board->pullUpDnControl(pin, pud);
+}
+
+/**
+ * Function which writes a pin on the other board and records the write
+ */
+int RecordingBoard::digitalWrite(int pin, int value) {
+	int result = m_board->digitalWrite(pin, value);
+	record(m_board->millis(), TRACE_WRITE, pin, value);
+
+	return result;
+}
+
+/**
+ * Function which reads a pin on the other board, and records the level if it changed since the last read
+ */
+int RecordingBoard::digitalRead(int pin) {
+	int value = m_board->digitalRead(pin);
+
+	if (pin >= 0 && pin < RECORDING_PIN_COUNT) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (m_lastRead[pin] != value) {
+			m_lastRead[pin] = value;
+			m_trace.add(m_board->millis() - m_startMs, TRACE_READ, pin, value);
+		}
+	}
+
+	return value;
+}
+
+/**
+ * Function which waits on the other board and records the delay
+ */
+void RecordingBoard::delay(unsigned int milliseconds) {
+	record(m_board->millis(), TRACE_DELAY, -1, milliseconds);
+	m_board->delay(milliseconds);
+}
+
+/**
+ * Function like delay() above that stops early when the token is cancelled, the time actually waited is recorded
+ * @return the milliseconds actually waited
+ */
+unsigned int RecordingBoard::delay(unsigned int milliseconds, CancellationToken& token) {
+	unsigned int startMs = m_board->millis();
+	unsigned int waited = m_board->delay(milliseconds, token);
+
+	record(startMs, TRACE_DELAY, -1, waited);
+
+	return waited;
+}
+
+/**
+ * Function which returns the other board's clock (reading the clock is not recorded)
+ */
+unsigned int RecordingBoard::millis() {
+	return m_board->millis();
+}
+
+/**
+ * Function which returns the edge file descriptor of a pin on the other board
+ */
+int RecordingBoard::getEdgeFd(int pin) {
+	return m_board->getEdgeFd(pin);
+}
+
+/**
+ * Function which consumes the pending edges of a pin on the other board (the levels are recorded when they are read)
+ */
+int RecordingBoard::readEdges(int pin, long long& firstEdgeNs) {
+	return m_board->readEdges(pin, firstEdgeNs);
+}
+
+/**
+ * Function which resolves output pins on the other board
+ */
+int RecordingBoard::resolvePins(const int* pins, int count, PinBatch& batch) {
+	return m_board->resolvePins(pins, count, batch);
+}
+
+/**
+ * Function which writes a batch LOW on the other board, recorded as a write of 0 to each of its pins
+ */
+int RecordingBoard::writeLow(const PinBatch& batch) {
+	int result = m_board->writeLow(batch);
+	unsigned int now = m_board->millis();
+
+	for (int i = 0; i < batch.count; i++) {
+		record(now, TRACE_WRITE, batch.pins[i], 0);
+	}
+
+	return result;
+}
+
+/**
+ * Function which attaches a handler on the other board through onInterrupt(), which records each call
+ * @return 0: success
+ * @return -1: pin out of range or the other board could not attach it
+ */
+int RecordingBoard::attachInterrupt(int pin, InterruptHandler handler, void* context) {
+	if (pin < 0 || pin >= RECORDING_PIN_COUNT) {
+		return -1;
+	}
+
+	m_interrupts[pin].handler = handler;
+	m_interrupts[pin].context = context;
+
+	return m_board->attachInterrupt(pin, &RecordingBoard::onInterrupt, &m_interrupts[pin]);
+}
+
+/**
+ * Function which returns a copy of everything recorded so far
+ */
+BoardTrace RecordingBoard::getTrace() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return m_trace;
+}
+
+/**
+ * Function which saves everything recorded so far
+ * @param header: free text saved with the trace, e.g. how the mower was set up
+ * @return 0: success
+ * @return -1: the file could not be written
+ */
+int RecordingBoard::save(const std::string& path, const std::string& header) {
+	BoardTrace trace = getTrace();
+
+	trace.setHeader(header);
+
+	return trace.save(path);
+}
+
+/**
+ * Function which adds an event to the trace, timed from the start of the recording
+ */
+void RecordingBoard::record(unsigned int timeMs, char type, int pin, int value) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_trace.add(timeMs - m_startMs, type, pin, value);
+}
+
+/**
+ * Function called by the other board's interrupt: records it, then calls the handler that was attached
+ */
+void RecordingBoard::onInterrupt(void* context) {
+	RecordedInterrupt* interrupt = static_cast<RecordedInterrupt*>(context);
+
+	interrupt->board->record(interrupt->board->m_board->millis(), TRACE_INTERRUPT, interrupt->pin, 0);
+	interrupt->handler(interrupt->context);
+}
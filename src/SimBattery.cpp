@@ -0,0 +1,128 @@
+/**
+ * This file contains the implementation of the SimBattery class and all associated member functions that are included in the SimBattery.h file.
+ * The SimBattery class is a simulated battery driven by the pins of a SimBoard.
+ *
+ */
+
+#include "SimBattery.h"
+#include <algorithm>
+
+/**
+ * Constructor, the battery starts full
+ *
+ * @param board: board whose pins drain the battery and whose clock times charging
+ * @param capacityWh: usable capacity
+ * @param chargeWatts: charging power at the base
+ *
+ */
+SimBattery::SimBattery(SimBoard& board, double capacityWh, double chargeWatts) {
+	m_board = &board;
+	m_capacityWh = capacityWh;
+	m_chargeWatts = chargeWatts;
+	m_levelWh = capacityWh;
+	m_charging = false;
+	m_chargeStartMs = 0;
+	m_chargeCount = 0;
+}
+
+/**
+ * Member function destructor which deletes an object: no return
+ */
+SimBattery::~SimBattery() {
+
+}
+
+/**
+ * Function which adds a pin that draws power from the battery while it is HIGH (a motor direction pin)
+ */
+int SimBattery::addLoad(int pin, double watts) {
+	sync();
+	m_loads.push_back(Load{pin, watts, m_board->getPinHighTime(pin)});
+
+	return 0;
+}
+
+/**
+ * Getter function which returns the charge left in Wh
+ */
+double SimBattery::getRemainingWh() {
+	sync();
+
+	return m_levelWh;
+}
+
+/**
+ * Getter function which returns the usable capacity in Wh
+ */
+double SimBattery::getCapacityWh() {
+	return m_capacityWh;
+}
+
+/**
+ * Getter function which returns the pack voltage, linear between empty and full
+ */
+double SimBattery::getVoltage() {
+	return SIM_BATTERY_EMPTY_VOLTS + (SIM_BATTERY_FULL_VOLTS - SIM_BATTERY_EMPTY_VOLTS) * getRemainingWh() / m_capacityWh;
+}
+
+/**
+ * Function which starts charging (the mower is on the base)
+ */
+int SimBattery::startCharging() {
+	sync();
+	m_charging = true;
+	m_chargeStartMs = m_board->millis();
+	m_chargeCount++;
+
+	return 0;
+}
+
+/**
+ * Function which stops charging
+ */
+int SimBattery::stopCharging() {
+	sync();
+	m_charging = false;
+
+	return 0;
+}
+
+/**
+ * Setter function for the charge left, e.g. to start a simulation with a part charged battery
+ */
+int SimBattery::setRemainingWh(double remainingWh) {
+	sync();
+	m_levelWh = std::min(m_capacityWh, std::max(0.0, remainingWh));
+
+	return 0;
+}
+
+/**
+ * Getter function which returns how many times charging has started
+ */
+int SimBattery::getChargeCount() {
+	return m_chargeCount;
+}
+
+/**
+ * Function which brings the level up to date with the board: drain since the last sync, then charging
+ */
+int SimBattery::sync() {
+	for (Load& load : m_loads) {
+		unsigned int highTime = m_board->getPinHighTime(load.pin);
+
+		m_levelWh -= load.watts * (highTime - load.highTimeAtSync) / 3600000.0;
+		load.highTimeAtSync = highTime;
+	}
+
+	if (m_charging) {
+		unsigned int now = m_board->millis();
+
+		m_levelWh += m_chargeWatts * (now - m_chargeStartMs) / 3600000.0;
+		m_chargeStartMs = now;
+	}
+
+	m_levelWh = std::min(m_capacityWh, std::max(0.0, m_levelWh));
+
+	return 0;
+}
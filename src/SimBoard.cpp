@@ -0,0 +1,330 @@
+/**
+ * This file contains the implementation of the SimBoard class and all associated member functions that are included in the SimBoard.h file.
+ * The SimBoard class is a Board with no hardware behind it, running on a virtual clock.
+ *
+ */
+
+#include "SimBoard.h"
+#include "CancellationToken.h"
+#include "SpanTracer.h"
+#include <thread>
+#include <ctime>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+/**
+ * Constructor, every pin starts LOW and the clock at 0
+ */
+SimBoard::SimBoard() {
+	m_errorNum = 0;
+	m_realTime = false;
+
+	for (int i = 0; i < SIM_PIN_COUNT; i++) {
+		m_edgeFds[i] = -1;
+		m_firstEdgeNs[i] = 0;
+		m_interruptHandlers[i] = nullptr;
+		m_interruptContexts[i] = nullptr;
+	}
+
+	reset();
+}
+
+/**
+ * Member function destructor which deletes an object: no return
+ */
+SimBoard::~SimBoard() {
+	for (int i = 0; i < SIM_PIN_COUNT; i++) {
+		if (m_edgeFds[i] >= 0) {
+			close(m_edgeFds[i]);
+		}
+	}
+}
+
+/**
+ * Function which does nothing, there is no hardware to set up
+ */
+int SimBoard::setup() {
+	return 0;
+}
+
+/**
+ * Function which checks the pin number, modes are not simulated
+ * @return 0: success
+ * @return -1: pin out of range
+ */
+int SimBoard::pinMode(int pin, int) {
+	if (pin < 0 || pin >= SIM_PIN_COUNT) {
+		m_errorNum = -1;
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * Function which checks the pin number, pull resistors are not simulated (inputs are set with setInput())
+ * @return 0: success
+ * @return -1: pin out of range
+ */
+int SimBoard::pullUpDnControl(int pin, int) {
+	if (pin < 0 || pin >= SIM_PIN_COUNT) {
+		m_errorNum = -1;
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * Function which sets a pin HIGH (any non zero value) or LOW
+ * @return 0: success
+ * @return -1: pin out of range
+ */
+int SimBoard::digitalWrite(int pin, int value) {
+	if (pin < 0 || pin >= SIM_PIN_COUNT) {
+		m_errorNum = -1;
+		return -1;
+	}
+
+	if (value) {
+		m_levels.fetch_or((uint64_t) 1 << pin, std::memory_order_relaxed);
+	} else {
+		m_levels.fetch_and(~((uint64_t) 1 << pin), std::memory_order_relaxed);
+	}
+
+	return 0;
+}
+
+/**
+ * Function which returns the level of a pin (1 for HIGH, 0 for LOW or out of range)
+ */
+int SimBoard::digitalRead(int pin) {
+	if (pin < 0 || pin >= SIM_PIN_COUNT) {
+		return 0;
+	}
+
+	return (m_levels.load(std::memory_order_relaxed) >> pin) & 1;
+}
+
+/**
+ * Function which moves the virtual clock forward and records the pin levels during the delay
+ */
+void SimBoard::delay(unsigned int milliseconds) {
+	if (m_realTime) {
+		TRACE_SPAN("board", "delay"); // the virtual clock does not wait, so only real time delays are spans
+		std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+		return;
+	}
+
+	if (milliseconds == 0) {
+		return;
+	}
+
+	uint64_t levels = m_levels.load(std::memory_order_relaxed);
+	m_intervals.push_back(PinInterval{m_now, milliseconds, levels});
+
+	for (; levels != 0; levels &= levels - 1) {
+		m_highTime[__builtin_ctzll(levels)] += milliseconds;
+	}
+
+	m_now += milliseconds;
+}
+
+/**
+ * Function like delay() above that stops early when the token is cancelled
+ * On the virtual clock a delay takes no real time, so it is either skipped (token already cancelled) or done in full
+ * @return the milliseconds actually waited
+ */
+unsigned int SimBoard::delay(unsigned int milliseconds, CancellationToken& token) {
+	if (m_realTime) {
+		TRACE_SPAN("board", "delay");
+		return token.sleepFor(milliseconds);
+	}
+
+	if (token.isCancelled()) {
+		return 0;
+	}
+
+	delay(milliseconds);
+
+	return milliseconds;
+}
+
+/**
+ * Function which returns the virtual time in milliseconds (wall-clock time since setRealTime() in real time mode)
+ */
+unsigned int SimBoard::millis() {
+	if (m_realTime) {
+		return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_realTimeStart).count();
+	}
+
+	return m_now;
+}
+
+/**
+ * Function which returns an eventfd that becomes readable when setInput() changes the pin (created on first use)
+ * @return the file descriptor
+ * @return -1: pin out of range or no eventfd could be created
+ */
+int SimBoard::getEdgeFd(int pin) {
+	if (pin < 0 || pin >= SIM_PIN_COUNT) {
+		m_errorNum = -1;
+		return -1;
+	}
+
+	if (m_edgeFds[pin] < 0) {
+		m_edgeFds[pin] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	}
+
+	return m_edgeFds[pin];
+}
+
+/**
+ * Function which consumes the pending edges of a pin
+ * @param firstEdgeNs: set to the CLOCK_MONOTONIC time setInput() first changed the pin since the last call, unchanged if it did not
+ * @return the number of edges consumed
+ */
+int SimBoard::readEdges(int pin, long long& firstEdgeNs) {
+	if (pin < 0 || pin >= SIM_PIN_COUNT || m_edgeFds[pin] < 0) {
+		return 0;
+	}
+
+	eventfd_t count = 0;
+
+	if (eventfd_read(m_edgeFds[pin], &count) != 0) {
+		return 0;
+	}
+
+	firstEdgeNs = m_firstEdgeNs[pin].exchange(0);
+
+	return count;
+}
+
+/**
+ * Function which resolves output pins into a batch for writeLow(): the mask has bit n set for pin n
+ * @return 0: success
+ * @return -1: too many pins or a pin out of range
+ */
+int SimBoard::resolvePins(const int* pins, int count, PinBatch& batch) {
+	if (count < 0 || count > PIN_BATCH_SIZE) {
+		m_errorNum = -1;
+		return -1;
+	}
+
+	batch.mask = 0;
+	batch.handle = -1;
+	batch.count = count;
+
+	for (int i = 0; i < count; i++) {
+		if (pins[i] < 0 || pins[i] >= SIM_PIN_COUNT) {
+			m_errorNum = -1;
+			return -1;
+		}
+
+		batch.pins[i] = pins[i];
+		batch.mask |= (uint64_t) 1 << pins[i];
+	}
+
+	return 0;
+}
+
+/**
+ * Function which sets every pin of a batch LOW in one atomic operation
+ */
+int SimBoard::writeLow(const PinBatch& batch) {
+	m_levels.fetch_and(~(uint64_t) batch.mask);
+
+	return 0;
+}
+
+/**
+ * Function which attaches a handler that setInput() calls every time the pin goes LOW
+ * (set before other threads use the board, a handler cannot be detached)
+ * @return 0: success
+ * @return -1: pin out of range
+ */
+int SimBoard::attachInterrupt(int pin, InterruptHandler handler, void* context) {
+	if (pin < 0 || pin >= SIM_PIN_COUNT) {
+		m_errorNum = -1;
+		return -1;
+	}
+
+	m_interruptContexts[pin] = context;
+	m_interruptHandlers[pin] = handler;
+
+	return 0;
+}
+
+/**
+ * Function which sets the level of an input pin, e.g. a simulated button press
+ * A change is signalled on the pin's edge file descriptor, if one was requested, and a change to LOW runs the pin's interrupt handler
+ */
+int SimBoard::setInput(int pin, int value) {
+	int oldValue = digitalRead(pin);
+	int result = digitalWrite(pin, value);
+
+	if (result == 0 && oldValue == 1 && !value && m_interruptHandlers[pin] != nullptr) {
+		m_interruptHandlers[pin](m_interruptContexts[pin]);
+	}
+
+	if (result == 0 && oldValue != (value ? 1 : 0) && m_edgeFds[pin] >= 0) {
+		timespec now;
+		long long expected = 0;
+
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		m_firstEdgeNs[pin].compare_exchange_strong(expected, now.tv_sec * 1000000000LL + now.tv_nsec);
+		eventfd_write(m_edgeFds[pin], 1);
+	}
+
+	return result;
+}
+
+/**
+ * Setter function for real time mode: delay() sleeps and millis() is wall-clock time instead of the virtual clock
+ */
+int SimBoard::setRealTime(bool realTime) {
+	m_realTime = realTime;
+	m_realTimeStart = std::chrono::steady_clock::now();
+
+	return 0;
+}
+
+/**
+ * Function which sets every pin LOW, the clock back to 0 and forgets the recorded intervals
+ */
+int SimBoard::reset() {
+	m_levels = 0;
+	m_now = 0;
+	m_intervals.clear();
+
+	for (int i = 0; i < SIM_PIN_COUNT; i++) {
+		m_highTime[i] = 0;
+	}
+
+	return 0;
+}
+
+/**
+ * Getter function which returns every delay so far with the pin levels during it
+ */
+const std::vector<PinInterval>& SimBoard::getIntervals() {
+	return m_intervals;
+}
+
+/**
+ * Getter function which returns how many virtual milliseconds a pin has been HIGH
+ */
+unsigned int SimBoard::getPinHighTime(int pin) {
+	if (pin < 0 || pin >= SIM_PIN_COUNT) {
+		return 0;
+	}
+
+	return m_highTime[pin];
+}
+
+/**
+ * Getter function which returns the errorNum variable which holds the value of the current error call
+ */
+int SimBoard::getErrorNum() {
+	return m_errorNum;
+}
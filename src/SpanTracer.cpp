@@ -0,0 +1,243 @@
+/**
+ * This file contains the implementation of the SpanTracer class and all associated member functions that are included in the SpanTracer.h file.
+ * The SpanTracer class keeps the last spans of every thread in per-thread rings and writes them as Chrome trace JSON.
+ *
+ */
+
+#include "SpanTracer.h"
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+
+std::atomic<bool> SpanTracer::s_running(false);
+
+/**
+ * Function which returns the tracer, tracing is stopped until start() is called
+ */
+SpanTracer& SpanTracer::getInstance() {
+	static SpanTracer tracer;
+
+	return tracer;
+}
+
+/**
+ * Constructor, no thread has a buffer yet
+ */
+SpanTracer::SpanTracer() {
+
+}
+
+/**
+ * Member function destructor which deletes an object: no return
+ */
+SpanTracer::~SpanTracer() {
+	s_running.store(false);
+}
+
+/**
+ * Function which starts recording spans (the ones already recorded are kept, see clear())
+ * Return value is 0 for success
+ */
+int SpanTracer::start() {
+	s_running.store(true);
+
+	return 0;
+}
+
+/**
+ * Function which stops recording spans, a span that started before this is still recorded when it ends
+ * Return value is 0 for success
+ */
+int SpanTracer::stop() {
+	s_running.store(false);
+
+	return 0;
+}
+
+/**
+ * Function which forgets every span recorded so far, only call it while tracing is stopped and no span is open
+ * Return value is 0 for success
+ */
+int SpanTracer::clear() {
+	std::lock_guard<std::mutex> lock(m_buffersMutex);
+
+	for (std::unique_ptr<ThreadBuffer>& buffer : m_buffers) {
+		buffer->head.store(0);
+	}
+
+	return 0;
+}
+
+/**
+ * Function which adds a span to the calling thread's ring, overwriting its oldest span when the ring is full
+ *
+ * @param category: what the span belongs to, e.g. "exec" (a string literal)
+ * @param name: what it did, e.g. "executeNext" (a string literal)
+ * @param startNs: from now()
+ * @param endNs: from now()
+ */
+void SpanTracer::record(const char* category, const char* name, long long startNs, long long endNs) {
+	ThreadBuffer* buffer = getThreadBuffer();
+	unsigned int head = buffer->head.load(std::memory_order_relaxed);
+	SpanRecord& record = buffer->records[head & (SPAN_RING_SIZE - 1)];
+
+	record.startNs = startNs;
+	record.durationNs = endNs - startNs;
+	record.category = category;
+	record.name = name;
+
+	buffer->head.store(head + 1, std::memory_order_release);
+}
+
+/**
+ * Setter function for the name the calling thread is shown with, e.g. "exec" (a string literal)
+ */
+void SpanTracer::setThreadName(const char* name) {
+	getThreadBuffer()->name = name;
+}
+
+/**
+ * Function which writes the spans still in the rings (the last SPAN_RING_SIZE - 1 of each thread) as a Chrome trace JSON file
+ * for chrome://tracing or ui.perfetto.dev. Can be called while tracing runs: the threads are not stopped, and a span
+ * one of them overwrites while its ring is copied is left out
+ *
+ * @param path: file to write, an existing file is replaced
+ * @return the number of spans written
+ * @return -1: the file could not be written
+ */
+int SpanTracer::writeChromeTrace(const std::string& path) {
+	struct ThreadSpans {
+		int threadIndex;
+		const char* name;
+		std::vector<SpanRecord> spans;
+	};
+
+	std::vector<ThreadSpans> threads;
+	long long firstNs = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(m_buffersMutex);
+
+		for (std::unique_ptr<ThreadBuffer>& buffer : m_buffers) {
+			ThreadSpans thread = ThreadSpans{buffer->threadIndex, buffer->name, {}};
+			// the slot after the newest span is the oldest one, and may be half written over by the next span: it is left out
+			unsigned int head = buffer->head.load(std::memory_order_acquire);
+			unsigned int first = head + 1 > SPAN_RING_SIZE ? head + 1 - SPAN_RING_SIZE : 0;
+
+			thread.spans.reserve(head - first);
+
+			for (unsigned int i = first; i < head; i++) {
+				thread.spans.push_back(buffer->records[i & (SPAN_RING_SIZE - 1)]);
+			}
+
+			// spans the thread wrote over (or started to) while they were copied are not whole
+			unsigned int headAfter = buffer->head.load(std::memory_order_acquire);
+			unsigned int overwritten = headAfter + 1 > SPAN_RING_SIZE ? headAfter + 1 - SPAN_RING_SIZE : 0;
+
+			if (overwritten > first) {
+				thread.spans.erase(thread.spans.begin(), thread.spans.begin() + std::min(overwritten - first, (unsigned int) thread.spans.size()));
+			}
+
+			threads.push_back(std::move(thread));
+		}
+	}
+
+	for (const ThreadSpans& thread : threads) {
+		for (const SpanRecord& span : thread.spans) {
+			if (firstNs == 0 || span.startNs < firstNs) {
+				firstNs = span.startNs;
+			}
+		}
+	}
+
+	FILE* file = fopen(path.c_str(), "w");
+	int count = 0;
+
+	if (file == nullptr) {
+		return -1;
+	}
+
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	for (const ThreadSpans& thread : threads) {
+		if (thread.name != nullptr) {
+			fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}},\n", thread.threadIndex, thread.name);
+		} else {
+			fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}},\n", thread.threadIndex, thread.threadIndex);
+		}
+
+		for (const SpanRecord& span : thread.spans) {
+			fprintf(file, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f},\n", span.name, span.category,
+				thread.threadIndex, (span.startNs - firstNs) / 1000.0, span.durationNs / 1000.0);
+			count++;
+		}
+	}
+
+	// the list ends with an object, as trailing commas are not JSON
+	fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"mower\"}}\n]}\n");
+
+	if (fclose(file) != 0) {
+		return -1;
+	}
+
+	return count;
+}
+
+/**
+ * Getter function which returns how many spans have been recorded by every thread (including overwritten ones)
+ */
+long SpanTracer::getSpanCount() {
+	std::lock_guard<std::mutex> lock(m_buffersMutex);
+	long count = 0;
+
+	for (std::unique_ptr<ThreadBuffer>& buffer : m_buffers) {
+		count += buffer->head.load(std::memory_order_relaxed);
+	}
+
+	return count;
+}
+
+/**
+ * Getter function which returns how many spans were overwritten because a thread's ring was full
+ */
+long SpanTracer::getOverwrittenCount() {
+	std::lock_guard<std::mutex> lock(m_buffersMutex);
+	long count = 0;
+
+	for (std::unique_ptr<ThreadBuffer>& buffer : m_buffers) {
+		unsigned int head = buffer->head.load(std::memory_order_relaxed);
+		count += head > SPAN_RING_SIZE ? head - SPAN_RING_SIZE : 0;
+	}
+
+	return count;
+}
+
+/**
+ * Function which returns the span clock in nanoseconds (CLOCK_MONOTONIC)
+ */
+long long SpanTracer::now() {
+	timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * Function which returns the calling thread's buffer, registering it the first time
+ */
+SpanTracer::ThreadBuffer* SpanTracer::getThreadBuffer() {
+	thread_local ThreadBuffer* threadBuffer = nullptr;
+
+	if (threadBuffer == nullptr) {
+		std::lock_guard<std::mutex> lock(m_buffersMutex);
+
+		m_buffers.push_back(std::unique_ptr<ThreadBuffer>(new ThreadBuffer()));
+		threadBuffer = m_buffers.back().get();
+		threadBuffer->head.store(0);
+		threadBuffer->threadIndex = m_buffers.size() - 1;
+		threadBuffer->name = nullptr;
+	}
+
+	return threadBuffer;
+}
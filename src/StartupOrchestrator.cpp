@@ -0,0 +1,191 @@
+/**
+ * This file contains the implementation of the StartupOrchestrator class and all associated member functions that are included in the StartupOrchestrator.h file.
+ * The StartupOrchestrator class runs and times the start up steps, some of them in parallel.
+ *
+ */
+
+#include "StartupOrchestrator.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <ctime>
+#include <unistd.h>
+
+/**
+ * Constructor, the report times are from here (and from the start of the process, read from /proc)
+ *
+ * @param board: board whose GPIO setupGpio() sets up
+ *
+ */
+StartupOrchestrator::StartupOrchestrator(Board& board) {
+	m_board = &board;
+	m_start = std::chrono::steady_clock::now();
+	m_readyMs = -1;
+	m_processAgeMs = -1;
+
+	// field 22 of /proc/self/stat is when the process started, in clock ticks since boot
+	std::ifstream statFile("/proc/self/stat");
+	std::string stat;
+	std::getline(statFile, stat);
+	size_t commEnd = stat.rfind(')');
+
+	if (commEnd != std::string::npos) {
+		std::istringstream fields(stat.substr(commEnd + 2));
+		std::string field;
+		timespec now;
+
+		for (int i = 3; i <= 22; i++) { // the fields after the command name start at 3
+			fields >> field;
+		}
+
+		if (fields && clock_gettime(CLOCK_BOOTTIME, &now) == 0) {
+			m_processAgeMs = now.tv_sec * 1000.0 + now.tv_nsec / 1e6 - std::stod(field) * 1000.0 / sysconf(_SC_CLK_TCK);
+		}
+	}
+}
+
+/**
+ * Member function destructor, waits for the steps still running
+ */
+StartupOrchestrator::~StartupOrchestrator() {
+	waitAll();
+}
+
+/**
+ * Function which sets the GPIO up, the one time it is done for the whole program
+ * @return the board's setup() result
+ */
+int StartupOrchestrator::setupGpio() {
+	std::function<int()> step = [this]() { return m_board->setup(); };
+
+	return timeStep("gpio setup", false, step);
+}
+
+/**
+ * Function which runs a start up step on the calling thread
+ * @return the step's result
+ */
+int StartupOrchestrator::runStep(const std::string& name, std::function<int()> step) {
+	return timeStep(name, false, step);
+}
+
+/**
+ * Function which starts a start up step on its own thread
+ * @return a future for the step's result, e.g. for ButtonController::setPlanReady()
+ */
+std::shared_future<int> StartupOrchestrator::startStep(const std::string& name, std::function<int()> step) {
+	std::shared_future<int> result = std::async(std::launch::async, [this, name, step]() mutable { return timeStep(name, true, step); }).share();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_pending.push_back(result);
+
+	return result;
+}
+
+/**
+ * Function which records that the mower is ready: the buttons are live
+ * Return value is 0 for success
+ */
+int StartupOrchestrator::markReady() {
+	m_readyMs = getElapsedMs();
+
+	return 0;
+}
+
+/**
+ * Function which waits for every parallel step
+ * @return 0: every step returned 0
+ * @return -1: a step failed
+ */
+int StartupOrchestrator::waitAll() {
+	std::vector<std::shared_future<int>> pending;
+	int result = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		pending = m_pending;
+	}
+
+	for (std::shared_future<int>& step : pending) {
+		if (step.get() != 0) {
+			result = -1;
+		}
+	}
+
+	return result;
+}
+
+/**
+ * Getter function which returns when markReady() was called (ms since the orchestrator was created), -1 if it was not
+ */
+double StartupOrchestrator::getReadyMs() {
+	return m_readyMs;
+}
+
+/**
+ * Getter function which returns how long (ms) the process had been running when the orchestrator was created, -1 if unknown
+ * (the kernel counts in clock ticks, usually 10 ms)
+ */
+double StartupOrchestrator::getProcessAgeMs() {
+	return m_processAgeMs;
+}
+
+/**
+ * Getter function which returns the steps finished so far, in the order they finished
+ */
+std::vector<StartupStep> StartupOrchestrator::getSteps() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return m_steps;
+}
+
+/**
+ * Function which prints when each step started and how long it took, and when the mower was ready
+ * Return value is 0 for success
+ */
+int StartupOrchestrator::printReport(std::ostream& out) {
+	double offsetMs = m_processAgeMs > 0 ? m_processAgeMs : 0;
+
+	out << std::fixed << std::setprecision(1);
+	out << "Start up (ms since the process started):" << std::endl;
+
+	if (m_processAgeMs >= 0) {
+		out << "  " << std::left << std::setw(24) << "process to main" << std::right << std::setw(8) << 0.0 << " +" << std::setw(8) << m_processAgeMs << std::endl;
+	}
+
+	for (const StartupStep& step : getSteps()) {
+		out << "  " << std::left << std::setw(24) << (step.name + (step.parallel ? " (parallel)" : "")) << std::right;
+		out << std::setw(8) << offsetMs + step.startMs << " +" << std::setw(8) << step.durationMs;
+		out << (step.result != 0 ? "  failed" : "") << std::endl;
+	}
+
+	if (m_readyMs >= 0) {
+		out << "  ready at " << offsetMs + m_readyMs << " ms" << std::endl;
+	}
+
+	out << std::defaultfloat << std::setprecision(6);
+
+	return 0;
+}
+
+/**
+ * Function which returns the milliseconds since the orchestrator was created
+ */
+double StartupOrchestrator::getElapsedMs() {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+}
+
+/**
+ * Function which runs a step and records its start, duration and result
+ * @return the step's result
+ */
+int StartupOrchestrator::timeStep(const std::string& name, bool parallel, std::function<int()>& step) {
+	double startMs = getElapsedMs();
+	int result = step();
+	double durationMs = getElapsedMs() - startMs;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_steps.push_back(StartupStep{name, parallel, startMs, durationMs, result});
+
+	return result;
+}
@@ -0,0 +1,146 @@
+/**
+ * This file contains the implementation of the TelemetryReader class and all associated member functions that are included in the TelemetryReader.h file.
+ * The TelemetryReader class maps the telemetry segment read only and copies consistent frames out of it.
+ *
+ */
+
+#include "TelemetryReader.h"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * Constructor, read() fails until open()
+ */
+TelemetryReader::TelemetryReader() {
+	m_segment = nullptr;
+	m_retryCount = 0;
+}
+
+/**
+ * Member function destructor which unmaps the segment: no return
+ */
+TelemetryReader::~TelemetryReader() {
+	close();
+}
+
+/**
+ * Function which maps a segment created by TelemetryWriter::open()
+ *
+ * @param name: the name the writer was opened with
+ * @return 0: success
+ * @return -1: there is no such segment or it could not be mapped
+ * @return -2: the segment is not telemetry, or from another version of the frame
+ */
+int TelemetryReader::open(const std::string& name) {
+	int fd = shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+	struct stat status;
+
+	if (fd < 0) {
+		return -1;
+	}
+
+	if (fstat(fd, &status) != 0 || (size_t) status.st_size < sizeof(TelemetrySegment)) {
+		::close(fd);
+		return -2;
+	}
+
+	void* mapping = mmap(nullptr, sizeof(TelemetrySegment), PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+
+	if (mapping == MAP_FAILED) {
+		return -1;
+	}
+
+	const TelemetrySegment* segment = static_cast<const TelemetrySegment*>(mapping);
+
+	if (segment->magic.load(std::memory_order_acquire) != TELEMETRY_MAGIC || segment->version != TELEMETRY_VERSION
+		|| segment->frameSize != sizeof(TelemetryFrame)) {
+		munmap(mapping, sizeof(TelemetrySegment));
+		return -2;
+	}
+
+	close();
+	m_segment = segment;
+
+	return 0;
+}
+
+/**
+ * Function which unmaps the segment
+ * Return value is 0 for success
+ */
+int TelemetryReader::close() {
+	if (m_segment != nullptr) {
+		munmap(const_cast<TelemetrySegment*>(m_segment), sizeof(TelemetrySegment));
+		m_segment = nullptr;
+	}
+
+	return 0;
+}
+
+/**
+ * Function which copies the latest frame out of the segment
+ * @return 0: success
+ * @return -1: not open
+ * @return -2: the writer kept overwriting the frame for TELEMETRY_READ_RETRIES tries
+ */
+int TelemetryReader::read(TelemetryFrame& frame) {
+	unsigned int sequence;
+
+	return read(frame, sequence);
+}
+
+/**
+ * Function which copies the latest frame out of the segment
+ * @param sequence: set to the frame's sequence number, it changes every time the writer publishes (by 2)
+ * @return 0: success
+ * @return -1: not open
+ * @return -2: the writer kept overwriting the frame for TELEMETRY_READ_RETRIES tries
+ */
+int TelemetryReader::read(TelemetryFrame& frame, unsigned int& sequence) {
+	if (m_segment == nullptr) {
+		return -1;
+	}
+
+	unsigned int words[TELEMETRY_WORDS];
+
+	for (int attempt = 0; attempt < TELEMETRY_READ_RETRIES; attempt++) {
+		unsigned int before = m_segment->sequence.load(std::memory_order_acquire);
+
+		if (before % 2 == 0) {
+			for (int i = 0; i < TELEMETRY_WORDS; i++) {
+				words[i] = m_segment->words[i].load(std::memory_order_relaxed);
+			}
+
+			// the copy must be done before the sequence is read again
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			if (m_segment->sequence.load(std::memory_order_relaxed) == before) {
+				memcpy(&frame, words, sizeof(frame));
+				sequence = before;
+				return 0;
+			}
+		}
+
+		m_retryCount++;
+	}
+
+	return -2;
+}
+
+/**
+ * Getter function which returns whether a segment is mapped
+ */
+bool TelemetryReader::isOpen() {
+	return m_segment != nullptr;
+}
+
+/**
+ * Getter function which returns how many times a read overlapped a write and was repeated
+ */
+unsigned long TelemetryReader::getRetryCount() {
+	return m_retryCount;
+}
@@ -0,0 +1,150 @@
+/**
+ * This file contains the implementation of the TelemetryWriter class and all associated member functions that are included in the TelemetryWriter.h file.
+ * The TelemetryWriter class creates the telemetry shared-memory segment and publishes frames into it under a seqlock.
+ *
+ */
+
+#include "TelemetryWriter.h"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/**
+ * Constructor, nothing is published until open()
+ */
+TelemetryWriter::TelemetryWriter() {
+	m_segment = nullptr;
+	m_publishCount = 0;
+	memset(&m_lastFrame, 0, sizeof(m_lastFrame));
+}
+
+/**
+ * Member function destructor which unmaps the segment (it stays for the readers until unlink()): no return
+ */
+TelemetryWriter::~TelemetryWriter() {
+	close();
+}
+
+/**
+ * Function which creates (or reuses) the shared-memory segment and maps it, the page is touched here so publish() never faults
+ *
+ * @param name: POSIX shared-memory name, e.g. TELEMETRY_DEFAULT_NAME (it shows up in /dev/shm)
+ * @return 0: success
+ * @return -1: the segment could not be created or mapped
+ * @return -2: already open
+ */
+int TelemetryWriter::open(const std::string& name) {
+	if (m_segment != nullptr) {
+		return -2;
+	}
+
+	int fd = shm_open(name.c_str(), O_CREAT | O_RDWR | O_CLOEXEC, 0644);
+
+	if (fd < 0) {
+		return -1;
+	}
+
+	if (ftruncate(fd, sizeof(TelemetrySegment)) != 0) {
+		::close(fd);
+		return -1;
+	}
+
+	void* mapping = mmap(nullptr, sizeof(TelemetrySegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+
+	if (mapping == MAP_FAILED) {
+		return -1;
+	}
+
+	m_name = name;
+	m_segment = static_cast<TelemetrySegment*>(mapping);
+
+	// readers that opened an older segment of the same name see it go invalid, then the first frame
+	m_segment->magic.store(0, std::memory_order_relaxed);
+	m_segment->version = TELEMETRY_VERSION;
+	m_segment->frameSize = sizeof(TelemetryFrame);
+	m_segment->sequence.store(0, std::memory_order_relaxed);
+
+	for (int i = 0; i < TELEMETRY_WORDS; i++) {
+		m_segment->words[i].store(0, std::memory_order_relaxed);
+	}
+
+	memset(&m_lastFrame, 0, sizeof(m_lastFrame));
+	m_segment->magic.store(TELEMETRY_MAGIC, std::memory_order_release);
+
+	return 0;
+}
+
+/**
+ * Function which unmaps the segment, readers keep the last frame
+ * Return value is 0 for success
+ */
+int TelemetryWriter::close() {
+	if (m_segment != nullptr) {
+		munmap(m_segment, sizeof(TelemetrySegment));
+		m_segment = nullptr;
+	}
+
+	return 0;
+}
+
+/**
+ * Function which removes the segment's name, readers that have it open keep their mapping
+ * @return 0: success
+ * @return -1: open() was never called or the name is already gone
+ */
+int TelemetryWriter::unlink() {
+	if (m_name.empty() || shm_unlink(m_name.c_str()) != 0) {
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * Function which publishes a frame, skipped if it is the same as the last one
+ * Only one thread may publish to a writer
+ *
+ * @return 1: the frame was published
+ * @return 0: the frame was unchanged, or the writer is not open
+ */
+int TelemetryWriter::publish(const TelemetryFrame& frame) {
+	if (m_segment == nullptr || memcmp(&frame, &m_lastFrame, sizeof(frame)) == 0) {
+		return 0;
+	}
+
+	unsigned int words[TELEMETRY_WORDS];
+	unsigned int sequence = m_segment->sequence.load(std::memory_order_relaxed);
+
+	memcpy(words, &frame, sizeof(words));
+
+	// odd sequence: readers that start now retry, readers already copying see the sequence change
+	m_segment->sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	for (int i = 0; i < TELEMETRY_WORDS; i++) {
+		m_segment->words[i].store(words[i], std::memory_order_relaxed);
+	}
+
+	m_segment->sequence.store(sequence + 2, std::memory_order_release);
+
+	m_lastFrame = frame;
+	m_publishCount++;
+
+	return 1;
+}
+
+/**
+ * Getter function which returns whether the segment is mapped
+ */
+bool TelemetryWriter::isOpen() {
+	return m_segment != nullptr;
+}
+
+/**
+ * Getter function which returns how many frames have been published (unchanged ones not counted)
+ */
+unsigned long TelemetryWriter::getPublishCount() {
+	return m_publishCount;
+}
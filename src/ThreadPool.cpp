@@ -0,0 +1,176 @@
+/**
+ * This file contains the implementation of the ThreadPool class and all associated member functions that are included in the ThreadPool.h file.
+ * The ThreadPool class runs tasks on a fixed number of worker threads using work stealing.
+ *
+ */
+
+#include "ThreadPool.h"
+#include <algorithm>
+
+static thread_local int t_workerIndex = -1; // index of the worker running on this thread, -1 for other threads
+
+/**
+ * Constructor which starts the worker threads
+ *
+ * @param threadCount: number of workers, 0 or less uses one per core
+ *
+ */
+ThreadPool::ThreadPool(int threadCount) : m_pending(0), m_queued(0), m_steals(0), m_nextQueue(0), m_shutDownFlag(false) {
+	if (threadCount <= 0) {
+		threadCount = std::max(1, (int) std::thread::hardware_concurrency());
+	}
+
+	for (int i = 0; i < threadCount; i++) {
+		m_queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+	}
+
+	for (int i = 0; i < threadCount; i++) {
+		m_threads.push_back(std::thread(&ThreadPool::workerLoop, this, i));
+	}
+}
+
+/**
+ * Member function destructor which finishes all queued tasks and joins the workers
+ */
+ThreadPool::~ThreadPool() {
+	wait();
+
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_shutDownFlag = true;
+	}
+
+	m_workAvailable.notify_all();
+
+	for (std::thread& thread : m_threads) {
+		thread.join();
+	}
+}
+
+/**
+ * Function which queues a task, tasks submitted from a worker go onto that worker's own queue
+ * @return 0: success
+ */
+int ThreadPool::submit(std::function<void()> task) {
+	int index = t_workerIndex;
+
+	if (index < 0) {
+		index = m_nextQueue++ % m_queues.size();
+	}
+
+	m_pending++;
+
+	{
+		std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+		m_queues[index]->tasks.push_back(std::move(task));
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_queued++;
+	}
+
+	m_workAvailable.notify_one();
+
+	return 0;
+}
+
+/**
+ * Function which blocks until every submitted task has finished
+ * @return 0: success
+ */
+int ThreadPool::wait() {
+	std::unique_lock<std::mutex> lock(m_sleepMutex);
+
+	m_allDone.wait(lock, [this]() {
+		return m_pending == 0;
+	});
+
+	return 0;
+}
+
+/**
+ * Getter function which returns the number of workers
+ */
+int ThreadPool::getThreadCount() {
+	return (int) m_threads.size();
+}
+
+/**
+ * Getter function which returns how many tasks were stolen from another worker's queue
+ */
+long ThreadPool::getStealCount() {
+	return m_steals;
+}
+
+/**
+ * Getter function which returns the index of the worker calling it (0..threadCount-1), or -1 when not called from a worker
+ * Useful for giving each worker its own scratch buffers
+ */
+int ThreadPool::getWorkerIndex() {
+	return t_workerIndex;
+}
+
+/**
+ * Function run by every worker thread: run own tasks, steal when empty, sleep when there is nothing anywhere
+ */
+void ThreadPool::workerLoop(int index) {
+	t_workerIndex = index;
+	std::function<void()> task;
+
+	while (true) {
+		if (takeTask(index, task)) {
+			task();
+			task = nullptr;
+
+			if (--m_pending == 0) {
+				std::lock_guard<std::mutex> lock(m_sleepMutex);
+				m_allDone.notify_all();
+			}
+
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_sleepMutex);
+
+		m_workAvailable.wait(lock, [this]() {
+			return m_queued > 0 || m_shutDownFlag;
+		});
+
+		if (m_shutDownFlag && m_queued == 0) {
+			return;
+		}
+	}
+}
+
+/**
+ * Function which takes the newest task from the worker's own queue, or steals the oldest from another queue
+ * @return true if a task was taken
+ */
+bool ThreadPool::takeTask(int index, std::function<void()>& task) {
+	int count = (int) m_queues.size();
+
+	for (int i = 0; i < count; i++) {
+		WorkerQueue& queue = *m_queues[(index + i) % count];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+
+		if (queue.tasks.empty()) {
+			continue;
+		}
+
+		if (i == 0) {
+			task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+		} else {
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+			m_steals++;
+		}
+
+		m_queued--;
+
+		return true;
+	}
+
+	return false;
+}
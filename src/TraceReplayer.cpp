@@ -0,0 +1,194 @@
+/**
+ * This file contains the implementation of the TraceReplayer class and all associated member functions that are included in the TraceReplayer.h file.
+ * The TraceReplayer class replays recorded inputs on a SimBoard and runs the controllers on its virtual clock.
+ *
+ */
+
+#include "TraceReplayer.h"
+#include <algorithm>
+#include <climits>
+#include <set>
+
+/**
+ * Constructor
+ *
+ * @param buttonControl: buttons, on a board that ends at the SimBoard
+ * @param exeControl: executor, driven with startNext()/continueCurrent() (its listener thread must not run)
+ * @param board: simulated board the inputs are played into, in virtual time mode
+ *
+ */
+TraceReplayer::TraceReplayer(ButtonController& buttonControl, ExecutionController& exeControl, SimBoard& board) {
+	m_buttonControl = &buttonControl;
+	m_exeControl = &exeControl;
+	m_board = &board;
+	m_deadlineMs = 0;
+	m_motionArmed = false;
+	m_shuttingDown = false;
+	m_inputCount = 0;
+}
+
+/**
+ * Member function destructor which deletes an object: no return
+ */
+TraceReplayer::~TraceReplayer() {
+
+}
+
+/**
+ * Function which replays the inputs of a trace from the board's current time (the trace's time 0) to the end of the trace
+ * @return 0: the end of the trace was reached
+ * @return 1: the buttons shut the mower down before the end
+ */
+int TraceReplayer::run(const BoardTrace& trace) {
+	std::set<int> outputs;
+	std::vector<TraceEvent> inputs;
+	std::vector<int> buttons = m_buttonControl->getButtonPins();
+	unsigned int startMs = m_board->millis();
+	unsigned int endMs = startMs + trace.getEndMs();
+
+	for (const TraceEvent& event : trace.getEvents()) {
+		if (event.type == TRACE_WRITE) {
+			outputs.insert(event.pin);
+		}
+	}
+
+	for (const TraceEvent& event : trace.getEvents()) {
+		if ((event.type == TRACE_READ || event.type == TRACE_INTERRUPT) && outputs.count(event.pin) == 0) {
+			inputs.push_back(event);
+		}
+	}
+
+	// events recorded from different threads can be a millisecond out of order
+	std::stable_sort(inputs.begin(), inputs.end(), [](const TraceEvent& a, const TraceEvent& b) { return a.timeMs < b.timeMs; });
+
+	std::set<int> started;
+
+	for (const TraceEvent& event : inputs) {
+		if (started.insert(event.pin).second) {
+			m_board->setInput(event.pin, event.type == TRACE_READ ? event.value : 1);
+		}
+	}
+
+	m_deadlineMs = 0;
+	m_motionArmed = false;
+	m_shuttingDown = false;
+	m_inputCount = 0;
+	m_buttonControl->setupInputs();
+
+	size_t next = 0;
+
+	while (!m_shuttingDown) {
+		unsigned int now = m_board->millis();
+		bool buttonChanged = false;
+
+		for (; next < inputs.size() && startMs + inputs[next].timeMs <= now; next++) {
+			const TraceEvent& event = inputs[next];
+
+			if (event.type == TRACE_INTERRUPT) {
+				// the interrupt runs on a falling edge, the release may not have been read
+				if (m_board->digitalRead(event.pin) == 0) {
+					m_board->setInput(event.pin, 1);
+				}
+
+				m_board->setInput(event.pin, 0);
+			} else if (m_board->digitalRead(event.pin) != event.value) {
+				m_board->setInput(event.pin, event.value);
+			} else {
+				continue;
+			}
+
+			m_inputCount++;
+			buttonChanged = buttonChanged || std::find(buttons.begin(), buttons.end(), event.pin) != buttons.end();
+		}
+
+		if (buttonChanged) {
+			onButtons();
+			continue;
+		}
+
+		if (m_motionArmed && m_deadlineMs <= now) {
+			m_motionArmed = false;
+			onMotionDeadline();
+			continue;
+		}
+
+		unsigned long long until = next < inputs.size() ? startMs + inputs[next].timeMs : ULLONG_MAX;
+
+		if (m_motionArmed) {
+			until = std::min(until, m_deadlineMs);
+		}
+
+		if (until > endMs) {
+			return 0;
+		}
+
+		m_board->delay(until - now);
+	}
+
+	return 1;
+}
+
+/**
+ * Getter function which returns how many input changes the last run() played back
+ */
+long TraceReplayer::getInputCount() {
+	return m_inputCount;
+}
+
+/**
+ * Function which handles the buttons after a pin changed, as ReactorRuntime::onButtons() does
+ */
+int TraceReplayer::onButtons() {
+	m_buttonControl->pollButtons();
+
+	if (m_buttonControl->isShutDown()) {
+		return onShutdown();
+	}
+
+	return startNextInstruction();
+}
+
+/**
+ * Function which handles a motion deadline, as ReactorRuntime::onMotionDeadline() does
+ */
+int TraceReplayer::onMotionDeadline() {
+	unsigned int waitMs = 0;
+
+	if (m_exeControl->continueCurrent(waitMs) == 1) {
+		m_deadlineMs = (unsigned long long) m_board->millis() + waitMs;
+		m_motionArmed = true;
+		return 0;
+	}
+
+	return startNextInstruction();
+}
+
+/**
+ * Function which shuts down, as ReactorRuntime::onShutdown() does
+ */
+int TraceReplayer::onShutdown() {
+	m_shuttingDown = true;
+	m_exeControl->sendShutDownSignal();
+	m_exeControl->cancelCurrent();
+	m_motionArmed = false;
+
+	return 0;
+}
+
+/**
+ * Function which starts the next instruction if the executor is free and sets the motion deadline for it
+ */
+int TraceReplayer::startNextInstruction() {
+	unsigned int waitMs = 0;
+
+	if (m_shuttingDown || m_exeControl->isInstructionActive()) {
+		return 0;
+	}
+
+	if (m_exeControl->startNext(waitMs) == 1) {
+		m_deadlineMs = (unsigned long long) m_board->millis() + waitMs;
+		m_motionArmed = true;
+	}
+
+	return 0;
+}
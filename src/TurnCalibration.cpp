@@ -0,0 +1,171 @@
+/**
+ * This file contains the implementation of the TurnCalibration class and all associated member functions that are included in the TurnCalibration.h file.
+ * The TurnCalibration class converts a requested turn angle into the time a wheel motor has to be powered for.
+ *
+ */
+
+#include "TurnCalibration.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * Constructor that creates an empty calibration, tables have to be added with addTable() before use
+ */
+TurnCalibration::TurnCalibration() {
+	m_errorNum = 0;
+}
+
+/**
+ * Constructor that creates a calibration with a single table which is used for every battery voltage
+ *
+ * @param points: measured (angle, duration) pairs, in any order
+ *
+ */
+TurnCalibration::TurnCalibration(const std::vector<CalibrationPoint>& points) {
+	m_errorNum = 0;
+	addTable(0.0, points);
+}
+
+/**
+ * Member function destructor which deletes an object: no return
+ */
+TurnCalibration::~TurnCalibration() {
+
+}
+
+/**
+ * Function which adds (or replaces) the table measured at a given battery voltage
+ *
+ * @param voltage: battery voltage the points were measured at
+ * @param points: measured (angle, duration) pairs, angles must be positive and distinct
+ * @return 0: success
+ * @return -1: invalid points, errnum is set too
+ */
+int TurnCalibration::addTable(double voltage, const std::vector<CalibrationPoint>& points) {
+	Table table;
+	table.voltage = voltage;
+	table.points.push_back(CalibrationPoint{0.0, 0.0});
+
+	std::vector<CalibrationPoint> sorted = points;
+	std::sort(sorted.begin(), sorted.end(), [](const CalibrationPoint& a, const CalibrationPoint& b) {
+		return a.angle < b.angle;
+	});
+
+	for (const CalibrationPoint& point : sorted) {
+		if (point.angle <= table.points.back().angle || point.duration < 0) {
+			m_errorNum = -1;
+			return -1;
+		}
+
+		table.points.push_back(point);
+	}
+
+	if (table.points.size() < 2) {
+		m_errorNum = -1;
+		return -1;
+	}
+
+	// keep tables sorted by voltage so getDuration can find the two closest ones
+	std::vector<Table>::iterator it = m_tables.begin();
+
+	while (it != m_tables.end() && it->voltage < voltage) {
+		it++;
+	}
+
+	if (it != m_tables.end() && it->voltage == voltage) {
+		*it = table;
+	} else {
+		m_tables.insert(it, table);
+	}
+
+	return 0;
+}
+
+/**
+ * Function which returns the duration of a turn using the first (or only) table
+ *
+ * @param angle: turn angle in degrees
+ * @return duration in ms
+ * @return -1: no table has been added
+ */
+int TurnCalibration::getDuration(double angle) const {
+	if (m_tables.empty()) {
+		return -1;
+	}
+
+	return (int) std::lround(interpolate(m_tables.front(), angle));
+}
+
+/**
+ * Function which returns the duration of a turn, interpolating between the tables of the two closest voltages
+ * Voltages outside of the calibrated range use the closest table
+ *
+ * @param angle: turn angle in degrees
+ * @param voltage: current battery voltage
+ * @return duration in ms
+ * @return -1: no table has been added
+ */
+int TurnCalibration::getDuration(double angle, double voltage) const {
+	if (m_tables.empty()) {
+		return -1;
+	}
+
+	if (voltage <= m_tables.front().voltage) {
+		return (int) std::lround(interpolate(m_tables.front(), angle));
+	}
+
+	if (voltage >= m_tables.back().voltage) {
+		return (int) std::lround(interpolate(m_tables.back(), angle));
+	}
+
+	size_t upper = 1;
+
+	while (m_tables[upper].voltage < voltage) {
+		upper++;
+	}
+
+	const Table& low = m_tables[upper - 1];
+	const Table& high = m_tables[upper];
+	double t = (voltage - low.voltage) / (high.voltage - low.voltage);
+
+	return (int) std::lround(interpolate(low, angle) * (1 - t) + interpolate(high, angle) * t);
+}
+
+/**
+ * Getter function which returns the number of voltage tables
+ */
+int TurnCalibration::getTableCount() const {
+	return (int) m_tables.size();
+}
+
+/**
+ * Getter function which returns the errorNum variable which holds the value of the current error call
+ */
+int TurnCalibration::getErrorNum() const {
+	return m_errorNum;
+}
+
+/**
+ * Function which linearly interpolates a duration from a single table
+ * Angles past the last measured point are extrapolated using the slope of the last segment
+ */
+double TurnCalibration::interpolate(const Table& table, double angle) const {
+	if (angle <= 0) {
+		return 0;
+	}
+
+	const std::vector<CalibrationPoint>& points = table.points;
+	std::vector<CalibrationPoint>::const_iterator it = std::upper_bound(points.begin(), points.end(), angle,
+		[](double value, const CalibrationPoint& point) {
+			return value < point.angle;
+		});
+
+	if (it == points.end()) {
+		it--; // extrapolate from the last segment
+	}
+
+	const CalibrationPoint& b = *it;
+	const CalibrationPoint& a = *(it - 1);
+
+	return a.duration + (angle - a.angle) * (b.duration - a.duration) / (b.angle - a.angle);
+}
@@ -7,6 +7,7 @@
  */
 
 #include "WheelController.h"
+#include "SpanTracer.h"
 #include <iostream>
 #include <wiringPi.h>
 
@@ -22,6 +23,16 @@ WheelController::WheelController(Motor& leftWheelMotor, Motor& rightWheelMotor)
 	m_leftWheelMotor = &leftWheelMotor;
 	m_rightWheelMotor = &rightWheelMotor;
 
+	// default tables measured on grass with a full battery: a standard 90 degree turn (TurnDuration positionOne)
+	// and 180, which the mower drives as two of them
+	m_leftTurns = TurnCalibration({{90, TurnDuration::positionOne}, {180, 2 * TurnDuration::positionOne}});
+	m_rightTurns = TurnCalibration({{90, TurnDuration::positionOne}, {180, 2 * TurnDuration::positionOne}});
+	m_leftTurnAfterReverseMs = LEFT_TURN_AFTER_REVERSE_MS;
+	m_rightTurnAfterReverseMs = RIGHT_TURN_AFTER_REVERSE_MS;
+	m_batteryVoltage = 0;
+	m_lastMoveBackward = false;
+	m_cancelToken = nullptr;
+
 	m_errorNum = 0;
 }
 
@@ -41,6 +52,8 @@ WheelController::~WheelController() {
  * calls the stop() function which is provided via Motor.h
  */
 int WheelController::stopMotor() {
+	TRACE_SPAN("wheels", "stopMotor");
+
 	m_leftWheelMotor->stop();
 	m_rightWheelMotor->stop();
 	
@@ -56,6 +69,9 @@ int WheelController::stopMotor() {
  * start() takes parameter based on Direction enum (Motor.h)
  */
 int WheelController::moveForward() {
+	TRACE_SPAN("wheels", "moveForward");
+
+	m_lastMoveBackward = false;
 	m_leftWheelMotor->start(Direction::CCW);
 	m_rightWheelMotor->start(Direction::CW);
 	
@@ -71,6 +87,9 @@ int WheelController::moveForward() {
  * start() takes parameter based on Direction enum (Motor.h)
  */
 int WheelController::moveBackward() {
+	TRACE_SPAN("wheels", "moveBackward");
+
+	m_lastMoveBackward = true;
 	m_leftWheelMotor->start(Direction::CW);
 	m_rightWheelMotor->start(Direction::CCW);
 	
@@ -86,7 +105,9 @@ int WheelController::moveBackward() {
  * start() takes parameter based on Direction enum (Motor.h)
  */
 int WheelController::turnLeft(TurnDuration turnDuration) {
-	return m_rightWheelMotor->start(Direction::CW, turnDuration);
+	TRACE_SPAN("wheels", "turnLeft");
+
+	return runMotor(m_rightWheelMotor, Direction::CW, turnDuration);
 }
 
 /**
@@ -98,7 +119,193 @@ int WheelController::turnLeft(TurnDuration turnDuration) {
  * start() takes parameter based on Direction enum (Motor.h)
  */
 int WheelController::turnRight(TurnDuration turnDuration) {
-	return m_leftWheelMotor->start(Direction::CCW, turnDuration);
+	TRACE_SPAN("wheels", "turnRight");
+
+	return runMotor(m_leftWheelMotor, Direction::CCW, turnDuration);
+}
+
+/**
+ * Function which turns left by any angle, the duration is looked up in the left turn calibration table
+ * (plus the after reverse correction, if the last move was backward)
+ *
+ * @param angle: turn angle in degrees
+ * @return int from start function return
+ *  0: if successful stop
+ * -1: if error
+ */
+int WheelController::turnLeft(double angle) {
+	TRACE_SPAN("wheels", "turnLeft");
+
+	int duration = getTurnLeftDuration(angle);
+
+	if (duration < 0) {
+		m_errorNum = -1;
+		return -1;
+	}
+
+	m_lastMoveBackward = false;
+
+	return runMotor(m_rightWheelMotor, Direction::CW, duration);
+}
+
+/**
+ * Function which turns right by any angle, the duration is looked up in the right turn calibration table
+ * (plus the after reverse correction, if the last move was backward)
+ *
+ * @param angle: turn angle in degrees
+ * @return int from start function return
+ *  0: if successful stop
+ * -1: if error
+ */
+int WheelController::turnRight(double angle) {
+	TRACE_SPAN("wheels", "turnRight");
+
+	int duration = getTurnRightDuration(angle);
+
+	if (duration < 0) {
+		m_errorNum = -1;
+		return -1;
+	}
+
+	m_lastMoveBackward = false;
+
+	return runMotor(m_leftWheelMotor, Direction::CCW, duration);
+}
+
+/**
+ * Function which starts a left turn by any angle without waiting for it, the caller stops the motors after the returned duration
+ *
+ * @param angle: turn angle in degrees
+ * @param durationMs: motor-on time measured for this turn (Instruction::durationMs), used instead of the table
+ * and the after reverse correction; 0 looks the angle up
+ * @return duration of the turn in ms
+ * @return -1: if error
+ */
+int WheelController::startTurnLeft(double angle, int durationMs) {
+	TRACE_SPAN("wheels", "startTurnLeft");
+
+	int duration = durationMs > 0 ? durationMs : getTurnLeftDuration(angle);
+
+	if (duration < 0) {
+		m_errorNum = -1;
+		return -1;
+	}
+
+	m_lastMoveBackward = false;
+	m_rightWheelMotor->start(Direction::CW);
+
+	return duration;
+}
+
+/**
+ * Function which starts a right turn by any angle without waiting for it, the caller stops the motors after the returned duration
+ *
+ * @param angle: turn angle in degrees
+ * @param durationMs: motor-on time measured for this turn (Instruction::durationMs), used instead of the table
+ * and the after reverse correction; 0 looks the angle up
+ * @return duration of the turn in ms
+ * @return -1: if error
+ */
+int WheelController::startTurnRight(double angle, int durationMs) {
+	TRACE_SPAN("wheels", "startTurnRight");
+
+	int duration = durationMs > 0 ? durationMs : getTurnRightDuration(angle);
+
+	if (duration < 0) {
+		m_errorNum = -1;
+		return -1;
+	}
+
+	m_lastMoveBackward = false;
+	m_leftWheelMotor->start(Direction::CCW);
+
+	return duration;
+}
+
+/**
+ * Setter function which replaces the default turn calibration tables
+ *
+ * @param leftTurns: table used by turnLeft(angle)
+ * @param rightTurns: table used by turnRight(angle)
+ * @return 0: success
+ * @return -1: one of the tables is empty
+ */
+int WheelController::setTurnCalibration(const TurnCalibration& leftTurns, const TurnCalibration& rightTurns) {
+	if (leftTurns.getTableCount() == 0 || rightTurns.getTableCount() == 0) {
+		m_errorNum = -1;
+		return -1;
+	}
+
+	m_leftTurns = leftTurns;
+	m_rightTurns = rightTurns;
+
+	return 0;
+}
+
+/**
+ * Setter function which replaces the default extra time given to turns made straight after moving backward
+ *
+ * @param leftMs: added to turnLeft(angle) after moveBackward()
+ * @param rightMs: added to turnRight(angle) after moveBackward()
+ * @return 0: success
+ * @return -1: one of the corrections is negative
+ */
+int WheelController::setTurnAfterReverseCorrection(int leftMs, int rightMs) {
+	if (leftMs < 0 || rightMs < 0) {
+		m_errorNum = -1;
+		return -1;
+	}
+
+	m_leftTurnAfterReverseMs = leftMs;
+	m_rightTurnAfterReverseMs = rightMs;
+
+	return 0;
+}
+
+/**
+ * Setter function for the current battery voltage, used to pick between calibration tables
+ */
+int WheelController::setBatteryVoltage(double voltage) {
+	m_batteryVoltage = voltage;
+
+	return 0;
+}
+
+/**
+ * Setter function for the token that interrupts blocking turns on shutdown
+ * Cancelling the token also stops both wheel motors straight away, from the cancelling thread
+ */
+int WheelController::setCancellationToken(CancellationToken& token) {
+	m_cancelToken = &token;
+	token.onCancel([this]() { stopMotor(); });
+
+	return 0;
+}
+
+/**
+ * Getter function which returns how long (ms) a left turn of the given angle will take, -1 if there is no table
+ */
+int WheelController::getTurnLeftDuration(double angle) {
+	int duration = m_leftTurns.getDuration(angle, m_batteryVoltage);
+
+	if (duration > 0 && m_lastMoveBackward) {
+		duration += m_leftTurnAfterReverseMs;
+	}
+
+	return duration;
+}
+
+/**
+ * Getter function which returns how long (ms) a right turn of the given angle will take, -1 if there is no table
+ */
+int WheelController::getTurnRightDuration(double angle) {
+	int duration = m_rightTurns.getDuration(angle, m_batteryVoltage);
+
+	if (duration > 0 && m_lastMoveBackward) {
+		duration += m_rightTurnAfterReverseMs;
+	}
+
+	return duration;
 }
 
 /**
@@ -119,3 +326,15 @@ Motor* WheelController::getRightWheelMotor() {
 	return m_rightWheelMotor;
 }
 
+/**
+ * Function which runs one wheel motor for a duration, interruptible if a cancellation token is set
+ *
+ * @return int from start function return
+ */
+int WheelController::runMotor(Motor* motor, Direction direction, int duration) {
+	if (m_cancelToken != nullptr) {
+		return motor->start(direction, duration, *m_cancelToken);
+	}
+
+	return motor->start(direction, duration);
+}
@@ -0,0 +1,337 @@
+/**
+ * This file contains the implementation of the WiringPiBoard class and all associated member functions that are included in the WiringPiBoard.h file.
+ * The WiringPiBoard class is the Board used on the mower: every call goes straight to wiringPi.
+ *
+ */
+
+#include "WiringPiBoard.h"
+#include "CancellationToken.h"
+#include "SpanTracer.h"
+#include <wiringPi.h>
+#include <linux/gpio.h>
+#include <sys/ioctl.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+
+/**
+ * Constructor, takes no parameters
+ */
+WiringPiBoard::WiringPiBoard() {
+	m_setupResult = -1;
+	m_chipFd = -1;
+	m_interruptStopFd = -1;
+
+	for (int i = 0; i < WIRINGPI_PIN_COUNT; i++) {
+		m_edgeFds[i] = -1;
+	}
+}
+
+/**
+ * Member function destructor which deletes an object: no return
+ */
+WiringPiBoard::~WiringPiBoard() {
+	if (m_interruptStopFd >= 0) {
+		eventfd_write(m_interruptStopFd, 1);
+	}
+
+	for (std::thread& thread : m_interruptThreads) {
+		thread.join();
+	}
+
+	if (m_interruptStopFd >= 0) {
+		close(m_interruptStopFd);
+	}
+
+	for (int fd : m_batchFds) {
+		close(fd);
+	}
+
+	for (int i = 0; i < WIRINGPI_PIN_COUNT; i++) {
+		if (m_edgeFds[i] >= 0) {
+			close(m_edgeFds[i]);
+		}
+	}
+
+	if (m_chipFd >= 0) {
+		close(m_chipFd);
+	}
+}
+
+/**
+ * Function which initializes wiringPi the first time it is called, and returns the result of that setup after
+ */
+int WiringPiBoard::setup() {
+	std::call_once(m_setupOnce, [this]() { m_setupResult = wiringPiSetup(); });
+
+	return m_setupResult;
+}
+
+/**
+ * Function which sets a GPIO pin to INPUT or OUTPUT
+ */
+int WiringPiBoard::pinMode(int pin, int mode) {
+	::pinMode(pin, mode);
+
+	return 0;
+}
+
+/**
+ * Function which sets the pull up/down resistor of a GPIO input pin
+ */
+int WiringPiBoard::pullUpDnControl(int pin, int pud) {
+	::pullUpDnControl(pin, pud);
+
+	return 0;
+}
+
+/**
+ * Function which sets a GPIO output pin HIGH or LOW
+ */
+int WiringPiBoard::digitalWrite(int pin, int value) {
+	::digitalWrite(pin, value);
+
+	return 0;
+}
+
+/**
+ * Function which reads a GPIO pin, returns HIGH or LOW
+ */
+int WiringPiBoard::digitalRead(int pin) {
+	return ::digitalRead(pin);
+}
+
+/**
+ * Function which blocks for the given number of milliseconds
+ */
+void WiringPiBoard::delay(unsigned int milliseconds) {
+	TRACE_SPAN("board", "delay");
+
+	::delay(milliseconds);
+}
+
+/**
+ * Function which blocks for the given number of milliseconds or until the token is cancelled
+ * @return the milliseconds actually waited
+ */
+unsigned int WiringPiBoard::delay(unsigned int milliseconds, CancellationToken& token) {
+	TRACE_SPAN("board", "delay");
+
+	return token.sleepFor(milliseconds);
+}
+
+/**
+ * Function which returns the milliseconds since wiringPi was set up
+ */
+unsigned int WiringPiBoard::millis() {
+	return ::millis();
+}
+
+/**
+ * Function which returns a file descriptor that becomes readable on every edge of an input pin (requested on first use)
+ * @return the file descriptor
+ * @return -1: pin out of range or the GPIO character device is not available
+ */
+int WiringPiBoard::getEdgeFd(int pin) {
+	if (pin < 0 || pin >= WIRINGPI_PIN_COUNT) {
+		return -1;
+	}
+
+	if (m_edgeFds[pin] >= 0) {
+		return m_edgeFds[pin];
+	}
+
+	if (openChip() < 0) {
+		return -1;
+	}
+
+	gpio_v2_line_request request;
+	memset(&request, 0, sizeof(request));
+	request.offsets[0] = wpiPinToGpio(pin);
+	request.num_lines = 1;
+	request.config.flags = GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_EDGE_RISING | GPIO_V2_LINE_FLAG_EDGE_FALLING;
+	strncpy(request.consumer, "mower", sizeof(request.consumer) - 1);
+
+	if (ioctl(m_chipFd, GPIO_V2_GET_LINE_IOCTL, &request) < 0) {
+		return -1;
+	}
+
+	fcntl(request.fd, F_SETFL, fcntl(request.fd, F_GETFL) | O_NONBLOCK);
+	m_edgeFds[pin] = request.fd;
+
+	return request.fd;
+}
+
+/**
+ * Function which consumes the pending edges of a pin requested with getEdgeFd()
+ * @param firstEdgeNs: set to the CLOCK_MONOTONIC time of the first pending edge (from the kernel), unchanged if there was none
+ * @return the number of edges consumed
+ */
+int WiringPiBoard::readEdges(int pin, long long& firstEdgeNs) {
+	if (pin < 0 || pin >= WIRINGPI_PIN_COUNT || m_edgeFds[pin] < 0) {
+		return 0;
+	}
+
+	gpio_v2_line_event events[16];
+	int count = 0;
+	ssize_t bytes;
+
+	while ((bytes = read(m_edgeFds[pin], events, sizeof(events))) > 0) {
+		if (count == 0) {
+			firstEdgeNs = events[0].timestamp_ns;
+		}
+
+		count += bytes / sizeof(gpio_v2_line_event);
+	}
+
+	return count;
+}
+
+/**
+ * Function which resolves output pins into one line request, so writeLow() sets them all with one ioctl
+ * (the pins are driven LOW when they are requested, wiringPi can still write them)
+ * Without the GPIO character device the batch falls back to a digitalWrite() per pin
+ * @return 0: success
+ * @return -1: too many pins
+ */
+int WiringPiBoard::resolvePins(const int* pins, int count, PinBatch& batch) {
+	if (count < 0 || count > PIN_BATCH_SIZE) {
+		return -1;
+	}
+
+	batch.mask = 0;
+	batch.handle = -1;
+	batch.count = count;
+
+	gpio_v2_line_request request;
+	memset(&request, 0, sizeof(request));
+
+	for (int i = 0; i < count; i++) {
+		batch.pins[i] = pins[i];
+		request.offsets[i] = wpiPinToGpio(pins[i]);
+	}
+
+	request.num_lines = count;
+	request.config.flags = GPIO_V2_LINE_FLAG_OUTPUT;
+	strncpy(request.consumer, "mower-estop", sizeof(request.consumer) - 1);
+
+	if (openChip() >= 0 && ioctl(m_chipFd, GPIO_V2_GET_LINE_IOCTL, &request) >= 0) {
+		batch.handle = request.fd;
+		batch.mask = (1ULL << count) - 1; // bit i is the i-th line of the request
+		m_batchFds.push_back(request.fd);
+	}
+
+	return 0;
+}
+
+/**
+ * Function which sets every pin of a batch LOW: one ioctl on the batch's line request, no locks or allocation
+ */
+int WiringPiBoard::writeLow(const PinBatch& batch) {
+	if (batch.handle >= 0) {
+		gpio_v2_line_values values;
+		values.bits = 0;
+		values.mask = batch.mask;
+
+		if (ioctl(batch.handle, GPIO_V2_LINE_SET_VALUES_IOCTL, &values) == 0) {
+			return 0;
+		}
+	}
+
+	for (int i = 0; i < batch.count; i++) {
+		::digitalWrite(batch.pins[i], LOW);
+	}
+
+	return 0;
+}
+
+/**
+ * Function which calls a handler every time an input pin goes LOW (the pin gets a pull up)
+ * The handler runs on a thread of its own that does nothing else, so it is not held up by the buttons or the executor
+ * @return 0: success
+ * @return -1: pin out of range, or the line could not be requested (e.g. its edges are already used with getEdgeFd())
+ */
+int WiringPiBoard::attachInterrupt(int pin, InterruptHandler handler, void* context) {
+	if (pin < 0 || pin >= WIRINGPI_PIN_COUNT || openChip() < 0) {
+		return -1;
+	}
+
+	if (m_interruptStopFd < 0) {
+		m_interruptStopFd = eventfd(0, EFD_CLOEXEC);
+
+		if (m_interruptStopFd < 0) {
+			return -1;
+		}
+	}
+
+	gpio_v2_line_request request;
+	memset(&request, 0, sizeof(request));
+	request.offsets[0] = wpiPinToGpio(pin);
+	request.num_lines = 1;
+	request.config.flags = GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_EDGE_FALLING | GPIO_V2_LINE_FLAG_BIAS_PULL_UP;
+	strncpy(request.consumer, "mower-estop", sizeof(request.consumer) - 1);
+
+	if (ioctl(m_chipFd, GPIO_V2_GET_LINE_IOCTL, &request) < 0) {
+		return -1;
+	}
+
+	m_interruptThreads.push_back(std::thread(&WiringPiBoard::runInterrupt, request.fd, m_interruptStopFd, handler, context));
+
+	return 0;
+}
+
+/**
+ * Getter function which returns the board shared by every class constructed without one
+ */
+WiringPiBoard& WiringPiBoard::getInstance() {
+	static WiringPiBoard board;
+
+	return board;
+}
+
+/**
+ * Function which opens the GPIO character device (once)
+ * @return the file descriptor
+ * @return -1: the device is not available
+ */
+int WiringPiBoard::openChip() {
+	if (m_chipFd < 0) {
+		m_chipFd = open("/dev/gpiochip0", O_RDONLY | O_CLOEXEC);
+	}
+
+	return m_chipFd;
+}
+
+/**
+ * Function run by an interrupt thread: sleeps until the line has a falling edge and calls the handler, until the board is destroyed
+ */
+int WiringPiBoard::runInterrupt(int lineFd, int stopFd, InterruptHandler handler, void* context) {
+	sched_param param;
+	param.sched_priority = sched_get_priority_max(SCHED_FIFO);
+	pthread_setschedparam(pthread_self(), SCHED_FIFO, &param); // needs CAP_SYS_NICE, runs at normal priority otherwise
+
+	pollfd fds[2] = {{lineFd, POLLIN, 0}, {stopFd, POLLIN, 0}};
+	gpio_v2_line_event events[16];
+
+	while (!(fds[1].revents & POLLIN)) {
+		if (poll(fds, 2, -1) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			break;
+		}
+
+		if ((fds[0].revents & POLLIN) && read(lineFd, events, sizeof(events)) > 0) {
+			handler(context);
+		}
+	}
+
+	close(lineFd);
+
+	return 0;
+}
@@ -0,0 +1,238 @@
+/**
+ * This file counts heap allocations without any hardware: operator new is replaced by one that counts every call.
+ * It runs missions on a SimBoard (the path's plan, and a plan on a battery too small for it so the mower goes home
+ * to charge) with the executor's plan reserved at start up, and prints the allocations made assigning and executing
+ * each mission. Every mission after the first must run without any allocation (the first one warms the SimBoard up).
+ * It also prints the allocations per candidate when PlanSearch plans are built on the heap and in a PlanArena.
+ *
+ */
+
+#include "EnergyModel.h"
+#include "SimBattery.h"
+#include "SimBoard.h"
+#include "Path.h"
+#include "Motor.h"
+#include "WheelController.h"
+#include "BladeController.h"
+#include "ExecutionController.h"
+#include "PlanArena.h"
+#include "PlanSearch.h"
+#include "ThreadPool.h"
+#include <iostream>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+const double CAR_DIAMETER = 0.87;
+const double BLADE_DIAMETER = 0.435;
+const double CHARGE_WATTS = 100;
+const double RESERVE_WH = 0.1;
+const int MISSIONS = 4;
+const size_t MAX_INSTRUCTIONS = 2000;
+
+// same wiring as the real mower (see thread_test.cpp)
+const int LEFT_WHEEL_PIN_CW = 24;
+const int LEFT_WHEEL_PIN_CCW = 23;
+const int RIGHT_WHEEL_PIN_CW = 21;
+const int RIGHT_WHEEL_PIN_CCW = 22;
+const int BLADE_PIN_CW = 2;
+const int BLADE_PIN_CCW = 3;
+
+std::atomic<long> allocationCount(0);
+
+void* operator new(size_t bytes) {
+	allocationCount++;
+	void* pointer = std::malloc(bytes > 0 ? bytes : 1);
+
+	if (pointer == nullptr) {
+		throw std::bad_alloc();
+	}
+
+	return pointer;
+}
+
+// the default memory resource of a Plan allocates with the aligned form
+void* operator new(size_t bytes, std::align_val_t alignment) {
+	allocationCount++;
+	void* pointer = std::aligned_alloc(static_cast<size_t>(alignment), (bytes + static_cast<size_t>(alignment) - 1) / static_cast<size_t>(alignment) * static_cast<size_t>(alignment));
+
+	if (pointer == nullptr) {
+		throw std::bad_alloc();
+	}
+
+	return pointer;
+}
+
+void operator delete(void* pointer) noexcept {
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept {
+	std::free(pointer);
+}
+
+struct MissionAllocations {
+	long assign;
+	long execute;
+	int instructionCount;
+	int returnCount;
+};
+
+/**
+ * Function which runs the same mission again and again on one executor, with its plan reserved, and counts the allocations of each run
+ *
+ * @param path: path whose plan is run
+ * @param capacityWh: battery capacity, 0 for no battery (no return to base)
+ * @param missions: receives the allocations of every run
+ */
+void runMissions(Path& path, double capacityWh, std::vector<MissionAllocations>& missions) {
+	SimBoard board;
+	SimBattery battery(board, capacityWh > 0 ? capacityWh : 1, CHARGE_WATTS);
+	EnergyModel energyModel(CAR_DIAMETER);
+	State currentState = IDLE;
+
+	Motor leftWheelMotor(LEFT_WHEEL_PIN_CW, LEFT_WHEEL_PIN_CCW, board);
+	Motor rightWheelMotor(RIGHT_WHEEL_PIN_CW, RIGHT_WHEEL_PIN_CCW, board);
+	Motor bladeMotor(BLADE_PIN_CW, BLADE_PIN_CCW, board);
+	WheelController wheelControl(leftWheelMotor, rightWheelMotor);
+	BladeController bladeControl(bladeMotor);
+	ExecutionController exec(currentState, path, wheelControl, bladeControl, board);
+
+	battery.addLoad(LEFT_WHEEL_PIN_CW, WHEEL_MOTOR_WATTS);
+	battery.addLoad(LEFT_WHEEL_PIN_CCW, WHEEL_MOTOR_WATTS);
+	battery.addLoad(RIGHT_WHEEL_PIN_CW, WHEEL_MOTOR_WATTS);
+	battery.addLoad(RIGHT_WHEEL_PIN_CCW, WHEEL_MOTOR_WATTS);
+	battery.addLoad(BLADE_PIN_CW, BLADE_MOTOR_WATTS);
+	battery.addLoad(BLADE_PIN_CCW, BLADE_MOTOR_WATTS);
+
+	exec.setVerbose(false);
+
+	if (capacityWh > 0) {
+		exec.setReturnToBase(battery, energyModel, path.getStartPose(), RESERVE_WH);
+	}
+
+	exec.reservePlan(MAX_INSTRUCTIONS);
+
+	missions.clear();
+	missions.reserve(MISSIONS);
+
+	for (int mission = 0; mission < MISSIONS; mission++) {
+		battery.setRemainingWh(capacityWh > 0 ? capacityWh : 1);
+
+		long before = allocationCount.load();
+		exec.assignInstructions();
+		long assigned = allocationCount.load();
+		int instructionCount = 0;
+
+		currentState = MOWING;
+
+		while (exec.executeNext() > 0) {
+			instructionCount++;
+		}
+
+		exec.executeNext(); // out of instructions: stops the blade and goes back to idle
+
+		missions.push_back(MissionAllocations{assigned - before, allocationCount.load() - assigned, instructionCount, exec.getReturnCount()});
+		board.reset();
+	}
+}
+
+/**
+ * Function which prints the allocations of every run and returns how many the runs after the first made
+ */
+long printMissions(const char* name, const std::vector<MissionAllocations>& missions) {
+	long steadyState = 0;
+
+	std::cout << name << ":" << std::endl;
+
+	for (size_t i = 0; i < missions.size(); i++) {
+		std::cout << "  mission " << i + 1 << ": " << missions[i].instructionCount << " instructions (" << missions[i].returnCount;
+		std::cout << " returns to base), " << missions[i].assign << " allocations assigning, " << missions[i].execute << " executing" << std::endl;
+
+		if (i > 0) {
+			steadyState += missions[i].assign + missions[i].execute;
+		}
+	}
+
+	return steadyState;
+}
+
+/**
+ * main function, counts the allocations of the missions and of the plan search
+ *
+ * @return 0: working properly
+ * @return 1: a mission after the first allocated
+ */
+int main (void) {
+	EnergyModel energyModel(CAR_DIAMETER);
+	Path path(40, 30, CAR_DIAMETER, BLADE_DIAMETER, false);
+	double missionWh = path.getEnergyEstimate(energyModel);
+	std::vector<MissionAllocations> missions;
+	int failures = 0;
+
+	// what assigning a mission cost when the executor copied the plan to the heap
+	long before = allocationCount.load();
+	Plan heapCopy = path.getInstructions();
+	std::cout << "Copying the " << heapCopy.size() << " instruction plan to the heap: " << allocationCount.load() - before << " allocations" << std::endl;
+
+	runMissions(path, 0, missions);
+
+	if (printMissions("Plan reserved at start up", missions) != 0) {
+		std::cout << "FAIL: allocations after the first mission" << std::endl;
+		failures++;
+	}
+
+	runMissions(path, missionWh / 3, missions);
+
+	if (printMissions("Plan reserved, battery for a third of the mission", missions) != 0 || missions.back().returnCount == 0) {
+		std::cout << "FAIL: allocations after the first mission, or the mower did not go home" << std::endl;
+		failures++;
+	}
+
+	// plan search candidates: the same plans built on the heap and in an arena that is reset for every candidate
+	ThreadPool pool(0);
+	PlanSearch search(path.getLength(), path.getWidth(), CAR_DIAMETER, BLADE_DIAMETER, pool);
+	std::vector<PlanCandidate> candidates = search.getCandidates();
+	PlanArena arena;
+	Pose start;
+
+	before = allocationCount.load();
+
+	for (const PlanCandidate& candidate : candidates) {
+		Plan instructions;
+		search.generate(candidate, instructions, start);
+	}
+
+	long onHeap = allocationCount.load() - before;
+
+	for (int round = 0; round < 2; round++) { // the first round grows the arena
+		before = allocationCount.load();
+
+		for (const PlanCandidate& candidate : candidates) {
+			arena.reset();
+
+			Plan instructions(arena.getResource());
+			search.generate(candidate, instructions, start);
+		}
+	}
+
+	long inArena = allocationCount.load() - before;
+
+	std::cout << "Plan search, " << candidates.size() << " candidates: " << (double) onHeap / candidates.size();
+	std::cout << " allocations per candidate on the heap, " << (double) inArena / candidates.size() << " in a warm arena (";
+	std::cout << arena.getReservedBytes() / 1024 << " KiB in " << arena.getHeapAllocations() << " blocks)" << std::endl;
+
+	if (failures == 0) {
+		std::cout << "PASS" << std::endl;
+	}
+
+	return failures == 0 ? 0 : 1;
+}
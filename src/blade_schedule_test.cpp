@@ -0,0 +1,62 @@
+/**
+ * This file tests blade scheduling without any hardware.
+ * The same fleet of simulated missions is run with the blade spinning the whole time (scheduling disabled)
+ * and with the BladeScheduler stopping it on legs that only cross grass that is already cut,
+ * and the energy saved per mission is printed next to the coverage of both runs.
+ *
+ * Usage: ./test [mowers]
+ *
+ */
+
+#include "FleetSimulator.h"
+#include "BladeScheduler.h"
+#include <iostream>
+#include <random>
+#include <cstdlib>
+
+const double CAR_DIAMETER = 0.87;
+const double BLADE_DIAMETER = 0.435;
+
+/**
+ * Function which runs the fleet with a blade scheduler and returns the summary
+ */
+FleetSummary simulate(ThreadPool& pool, int mowers, const BladeScheduler& scheduler) {
+	FleetSimulator simulator(CAR_DIAMETER, BLADE_DIAMETER, pool);
+	std::mt19937 random(7);
+	std::uniform_real_distribution<double> size(3.0, 15.0);
+
+	for (int i = 0; i < mowers; i++) {
+		simulator.addMower(size(random), size(random));
+	}
+
+	simulator.setBladeScheduler(scheduler);
+	simulator.run();
+
+	return simulator.getSummary();
+}
+
+/**
+ * main function, runs the comparison
+ *
+ * @return 0: working properly
+ */
+int main (int argc, char* argv[]) {
+	int mowers = argc > 1 ? std::atoi(argv[1]) : 1000;
+	ThreadPool pool(0);
+	BladeScheduler alwaysOn;
+	BladeScheduler scheduled;
+
+	alwaysOn.setEnabled(false);
+
+	FleetSummary before = simulate(pool, mowers, alwaysOn);
+	FleetSummary after = simulate(pool, mowers, scheduled);
+
+	std::cout << mowers << " missions, blade always on: " << before.meanEnergyWh << " Wh, blade " << before.meanBladeMinutes;
+	std::cout << " min, coverage " << before.meanCoveragePercent << "%" << std::endl;
+	std::cout << mowers << " missions, blade scheduled: " << after.meanEnergyWh << " Wh, blade " << after.meanBladeMinutes;
+	std::cout << " min, coverage " << after.meanCoveragePercent << "%" << std::endl;
+	std::cout << "Energy saved per mission: " << before.meanEnergyWh - after.meanEnergyWh << " Wh (";
+	std::cout << 100 * (before.meanEnergyWh - after.meanEnergyWh) / before.meanEnergyWh << "%)" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,341 @@
+/**
+ * This file tests the CompressedPlanWriter, the CompressedPlanReader and the executor's streamed plans without any hardware.
+ * The plan of a lawn and of a property of several lawns (MissionBuilder) are compressed, written, read back and must
+ * decode to the same instructions; the compression ratio is printed against the Plan in memory and the text format.
+ * Every byte of a compressed plan is then corrupted in turn and every cut-off length tried: the reader must refuse the
+ * file or decode exactly the instruction count it announces. The property is mowed on a SimBoard with a battery too
+ * small for it, once as a Plan and once streamed from the compressed file, and both missions must go the same way.
+ * Last, the decode throughput.
+ *
+ * Usage: ./test [instructions to decode for the throughput]
+ *
+ */
+
+#include "BladeScheduler.h"
+#include "CompressedPlanReader.h"
+#include "CompressedPlanWriter.h"
+#include "EnergyModel.h"
+#include "ExecutionController.h"
+#include "MissionBuilder.h"
+#include "Motor.h"
+#include "Path.h"
+#include "PlanTextWriter.h"
+#include "SimBattery.h"
+#include "SimBoard.h"
+#include "WheelController.h"
+#include "BladeController.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <unistd.h>
+
+const char PLAN_PATH[] = "/tmp/nomo_compressed_plan_test.npz";
+const double CAR_DIAMETER = 0.87;
+const double BLADE_DIAMETER = 0.435;
+const double CHARGE_WATTS = 100;
+const double RESERVE_WH = 0.1;
+
+// same wiring as the real mower (see thread_test.cpp)
+const int LEFT_WHEEL_PIN_CW = 24;
+const int LEFT_WHEEL_PIN_CCW = 23;
+const int RIGHT_WHEEL_PIN_CW = 21;
+const int RIGHT_WHEEL_PIN_CCW = 22;
+const int BLADE_PIN_CW = 2;
+const int BLADE_PIN_CCW = 3;
+
+struct MissionRun {
+	bool finished;
+	int instructionCount; // remaining when assigned
+	int returnCount;
+	unsigned int boardMs; // board time the mission took
+};
+
+/**
+ * Function which builds the plan of a property: lawns of different sizes spread over a 300 x 200 m site
+ */
+void buildProperty(Plan& plan) {
+	const MowingArea areas[] = {
+		{0, 0, 120, 80}, {130, 0, 90, 60}, {230, 0, 60, 45}, {0, 90, 75, 100}, {85, 90, 140, 70}, {235, 70, 55, 120},
+		{85, 170, 40, 25}, {135, 170, 90, 28}
+	};
+	MissionBuilder builder(CAR_DIAMETER, BLADE_DIAMETER);
+
+	for (const MowingArea& area : areas) {
+		builder.addArea(area);
+	}
+
+	builder.setStartPose(Pose{0, 0, 0});
+	builder.build();
+	plan = builder.getInstructions();
+}
+
+/**
+ * Function which compares two plans, values, blade schedule and measured turn times included
+ * @return the index of the first instruction that differs, -1 if the plans are the same
+ */
+long comparePlans(const Plan& expected, CompressedPlanReader& reader) {
+	Instruction instruction;
+	size_t i = 0;
+
+	reader.rewind();
+
+	for (; reader.next(instruction) == 1; i++) {
+		if (i >= expected.size() || expected[i].action != instruction.action || memcmp(&expected[i].value, &instruction.value, sizeof(double)) != 0
+			|| expected[i].cutting != instruction.cutting || expected[i].preSpinMs != instruction.preSpinMs || expected[i].durationMs != instruction.durationMs) {
+			return i;
+		}
+	}
+
+	return i == expected.size() && reader.getRemainingCount() == 0 ? -1 : i;
+}
+
+/**
+ * Function which compresses a blade scheduled plan, reads it back from a file and prints the compression ratio
+ * @return the number of failed checks
+ */
+int checkRoundTrip(const char* name, Plan plan) {
+	CompressedPlanWriter writer;
+	CompressedPlanReader reader;
+	char line[PLAN_TEXT_MAX_LINE];
+	size_t textBytes = 0;
+
+	BladeScheduler().schedule(plan);
+
+	for (const Instruction& instruction : plan) {
+		textBytes += PlanTextWriter::format(instruction, line);
+	}
+
+	if (writer.compress(plan) != 0 || writer.write(PLAN_PATH) != 0 || reader.open(PLAN_PATH) != 0) {
+		std::cout << "FAIL: " << name << " could not be compressed and read back" << std::endl;
+		return 1;
+	}
+
+	long differs = comparePlans(plan, reader);
+	size_t bytes = reader.getFileSize();
+
+	std::cout << name << ": " << plan.size() << " instructions (" << writer.getSymbolCount() << " different) in ";
+	std::cout << writer.getOpCount() << " ops, " << bytes << " bytes; " << (double) plan.size() * sizeof(Instruction) / bytes;
+	std::cout << ":1 against the Plan in memory, " << (double) textBytes / bytes << ":1 against the text format, ";
+	std::cout << (differs < 0 ? "decoded unchanged" : "NOT decoded unchanged") << std::endl;
+
+	if (differs >= 0) {
+		std::cout << "FAIL: first difference at instruction " << differs << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * Function which corrupts every byte of a compressed plan in turn, and cuts it off at every length
+ * @return the number of failed checks
+ */
+int checkCorruption() {
+	Path path(12, 9, CAR_DIAMETER, BLADE_DIAMETER, false);
+	CompressedPlanWriter writer;
+	CompressedPlanReader reader;
+	Instruction instruction;
+	long refused = 0;
+	long decoded = 0;
+	int failures = 0;
+
+	writer.compress(path.getInstructions());
+
+	std::vector<unsigned char> data = writer.getData();
+
+	for (size_t i = 0; i < data.size(); i++) {
+		for (unsigned char mask : {0x01, 0x80, 0xff}) {
+			data[i] ^= mask;
+
+			if (reader.open(data.data(), data.size()) != 0) {
+				refused++;
+			} else {
+				size_t count = 0;
+
+				while (reader.next(instruction) == 1 && count <= reader.getInstructionCount()) {
+					count++;
+				}
+
+				if (count != reader.getInstructionCount()) {
+					std::cout << "FAIL: byte " << i << " ^ " << (int) mask << " decoded " << count << " of " << reader.getInstructionCount() << std::endl;
+					failures++;
+				}
+
+				decoded++;
+			}
+
+			data[i] ^= mask;
+		}
+	}
+
+	for (size_t size = 0; size < data.size(); size++) {
+		if (reader.open(data.data(), size) == 0) {
+			std::cout << "FAIL: cut off at " << size << " of " << data.size() << " bytes and not refused" << std::endl;
+			failures++;
+		}
+	}
+
+	reader.close();
+
+	std::cout << "Corruption: " << data.size() * 3 << " corrupted plans, " << refused << " refused, " << decoded;
+	std::cout << " still well formed (a value or flag changed) and decoded to their count, " << data.size() << " cut off plans refused" << std::endl;
+
+	return failures;
+}
+
+/**
+ * Function which mows a plan on a simulated board and battery
+ * @param plan: assigned as a Plan (and blade scheduled by the executor), unless stream is given
+ * @param stream: compressed plan, already blade scheduled, or nullptr
+ */
+MissionRun runMission(const Plan& plan, CompressedPlanReader* stream, double capacityWh) {
+	SimBoard board;
+	SimBattery battery(board, capacityWh, CHARGE_WATTS);
+	EnergyModel energyModel(CAR_DIAMETER);
+	Path path(4, 4, CAR_DIAMETER, BLADE_DIAMETER, false);
+	State currentState = MOWING;
+	Pose start = Pose{0, 0, 0};
+
+	Motor leftWheelMotor(LEFT_WHEEL_PIN_CW, LEFT_WHEEL_PIN_CCW, board);
+	Motor rightWheelMotor(RIGHT_WHEEL_PIN_CW, RIGHT_WHEEL_PIN_CCW, board);
+	Motor bladeMotor(BLADE_PIN_CW, BLADE_PIN_CCW, board);
+	WheelController wheelControl(leftWheelMotor, rightWheelMotor);
+	BladeController bladeControl(bladeMotor);
+	ExecutionController exec(currentState, path, wheelControl, bladeControl, board);
+
+	battery.addLoad(LEFT_WHEEL_PIN_CW, WHEEL_MOTOR_WATTS);
+	battery.addLoad(LEFT_WHEEL_PIN_CCW, WHEEL_MOTOR_WATTS);
+	battery.addLoad(RIGHT_WHEEL_PIN_CW, WHEEL_MOTOR_WATTS);
+	battery.addLoad(RIGHT_WHEEL_PIN_CCW, WHEEL_MOTOR_WATTS);
+	battery.addLoad(BLADE_PIN_CW, BLADE_MOTOR_WATTS);
+	battery.addLoad(BLADE_PIN_CCW, BLADE_MOTOR_WATTS);
+
+	exec.setVerbose(false);
+	exec.setReturnToBase(battery, energyModel, start, RESERVE_WH);
+
+	if (stream == nullptr) {
+		exec.assignInstructions(plan, start);
+	} else {
+		exec.assignInstructions(*stream, start);
+	}
+
+	MissionRun run = MissionRun{false, exec.getRemainingCount(), 0, 0};
+	unsigned int startMs = board.millis();
+
+	while (exec.executeNext() > 0) {
+	}
+
+	exec.executeNext(); // out of instructions: stops the blade and goes back to idle
+
+	run.finished = currentState == IDLE && exec.getRemainingCount() == 0;
+	run.returnCount = exec.getReturnCount();
+	run.boardMs = board.millis() - startMs;
+
+	return run;
+}
+
+/**
+ * Function which mows the property from a Plan and streamed, on a battery for a third of it
+ * @return the number of failed checks
+ */
+int checkMission(const Plan& property) {
+	EnergyModel energyModel(CAR_DIAMETER);
+	Plan scheduled = property;
+	CompressedPlanWriter writer;
+	CompressedPlanReader reader;
+
+	BladeScheduler().schedule(scheduled);
+
+	if (writer.compress(scheduled) != 0 || writer.write(PLAN_PATH) != 0 || reader.open(PLAN_PATH) != 0) {
+		std::cout << "FAIL: the property could not be compressed" << std::endl;
+		return 1;
+	}
+
+	double capacityWh = energyModel.getPlanWh(scheduled) / 3;
+	MissionRun fromPlan = runMission(property, nullptr, capacityWh);
+	MissionRun streamed = runMission(property, &reader, capacityWh);
+
+	std::cout << "Mission on a " << capacityWh << " Wh battery: as a Plan " << fromPlan.instructionCount << " instructions, ";
+	std::cout << fromPlan.returnCount << " returns to base, " << fromPlan.boardMs / 1000 << " s; streamed " << streamed.instructionCount;
+	std::cout << " instructions, " << streamed.returnCount << " returns to base, " << streamed.boardMs / 1000 << " s" << std::endl;
+
+	if (!fromPlan.finished || !streamed.finished || fromPlan.returnCount == 0 || fromPlan.instructionCount != streamed.instructionCount
+		|| fromPlan.returnCount != streamed.returnCount || fromPlan.boardMs != streamed.boardMs) {
+		std::cout << "FAIL: the streamed mission did not go the same way" << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * Function which times decoding the property again and again
+ * @return the number of failed checks
+ */
+int benchmark(const Plan& property, long instructions) {
+	CompressedPlanWriter writer;
+	CompressedPlanReader reader;
+	Instruction instruction;
+	double valueSum = 0; // so the decoding is not optimised away
+	long decoded = 0;
+
+	writer.compress(property);
+	reader.open(writer.getData().data(), writer.getData().size());
+
+	auto start = std::chrono::steady_clock::now();
+
+	while (decoded < instructions) {
+		reader.rewind();
+
+		while (reader.next(instruction) == 1) {
+			valueSum += instruction.value;
+			decoded++;
+		}
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << "Decode: " << decoded / seconds / 1e6 << " M instructions/s (" << decoded * sizeof(Instruction) / seconds / 1e9;
+	std::cout << " GB/s of Instructions out of " << writer.getData().size() / 1024.0 << " KiB, checksum " << valueSum << ")" << std::endl;
+
+	if (decoded / seconds < 10e6) {
+		std::cout << "FAIL: decoding slower than 10 M instructions/s" << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * main function, runs the checks and the benchmark
+ *
+ * @return 0: working properly
+ * @return 1: a plan did not decode as it was written, a corrupt plan was accepted, or the streamed mission differed
+ */
+int main (int argc, char* argv[]) {
+	long instructions = argc > 1 ? atol(argv[1]) : 50000000;
+	Path lawn(60, 40, CAR_DIAMETER, BLADE_DIAMETER, false);
+	Plan property;
+	int failures = 0;
+
+	buildProperty(property);
+
+	failures += checkRoundTrip("generatePath() 60 x 40 m", lawn.getInstructions());
+	failures += checkRoundTrip("Property of 8 lawns", property);
+	failures += checkCorruption();
+	failures += checkMission(property);
+	failures += benchmark(property, instructions);
+
+	unlink(PLAN_PATH);
+
+	if (failures > 0) {
+		std::cout << "FAIL" << std::endl;
+		return 1;
+	}
+
+	std::cout << "PASS" << std::endl;
+
+	return 0;
+}
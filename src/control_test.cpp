@@ -0,0 +1,340 @@
+/**
+ * This file tests the ControlServer and ControlClient without any hardware.
+ * The ReactorRuntime runs a mower on a SimBoard in real time with a ControlServer on a socket in /tmp. A client uploads a
+ * plan in a memfd, starts, pauses, resumes and stops it, and checks that malformed requests, a plan whose memfd is not
+ * sealed against writing and commands in the wrong state are refused. Then the load test: one client goes round START, PAUSE, RESUME, STOP with a STATUS after each as
+ * fast as the replies come back, while more clients ask for the status, and every reply must show the state the command
+ * leads to. It prints the commands per second and the round trip times.
+ *
+ * Usage: ./test [load seconds]
+ *
+ */
+
+#include "State.h"
+#include "Path.h"
+#include "Motor.h"
+#include "WheelController.h"
+#include "BladeController.h"
+#include "ButtonController.h"
+#include "ExecutionController.h"
+#include "ReactorRuntime.h"
+#include "ControlServer.h"
+#include "ControlClient.h"
+#include "LatencyHistogram.h"
+#include "SimBoard.h"
+#include "CancellationToken.h"
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+const char SOCKET_PATH[] = "/tmp/nomo_control_test.sock";
+const int STATUS_CLIENTS = 3;
+const int START_PIN = 29;
+const int INPUT_PIN = 1;
+const int UP_PIN = 4;
+const int DOWN_PIN = 28;
+const double CAR_DIAMETER = 0.87;
+const double BLADE_DIAMETER = 0.435;
+
+struct Step {
+	ControlCommand command;
+	int result;
+	State state; // after the command
+};
+
+/**
+ * Function which sends a command and checks the reply
+ * @return 0 if the reply came with the result and state expected, 1 otherwise
+ */
+int expect(ControlClient& client, const Step& step, ControlReply& reply) {
+	if (client.sendCommand(step.command, reply) != 0 || reply.result != step.result || reply.state != step.state) {
+		std::cout << "FAIL: command " << step.command << " got result " << reply.result << " in state " << reply.state;
+		std::cout << ", expected " << step.result << " in state " << step.state << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * Function which sends a request the server cannot parse on a fresh connection
+ * @return the result in the reply, 1 if no reply came
+ */
+int sendMalformed() {
+	sockaddr_un address = {};
+	char garbage[3] = {1, 2, 3};
+	ControlReply reply = {};
+	int fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, SOCKET_PATH);
+
+	if (connect(fd, (sockaddr*) &address, sizeof(address)) != 0 || send(fd, garbage, sizeof(garbage), 0) != sizeof(garbage)
+		|| recv(fd, &reply, sizeof(reply), 0) != sizeof(reply)) {
+		close(fd);
+		return 1;
+	}
+
+	close(fd);
+
+	return reply.result;
+}
+
+/**
+ * Function which uploads a valid plan in a memfd that is only sealed against shrinking, on a fresh connection
+ * The client could still rewrite the plan while the server reads it, so it must be refused
+ * @return the result in the reply, 1 if no reply came
+ */
+int sendWritablePlan() {
+	size_t size = sizeof(ControlPlanHeader) + sizeof(ControlPlanInstruction);
+	int planFd = memfd_create("nomo_writable_plan", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	void* mapping = planFd >= 0 && ftruncate(planFd, size) == 0 ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, planFd, 0) : MAP_FAILED;
+
+	if (mapping == MAP_FAILED) {
+		close(planFd);
+		return 1;
+	}
+
+	ControlPlanHeader header = {CONTROL_PLAN_MAGIC, 1, 0.5, 0.5, 0};
+	ControlPlanInstruction instruction = {{'M', 'F'}, 1, 0, 0, 1.0};
+
+	memcpy(mapping, &header, sizeof(header));
+	memcpy(static_cast<char*>(mapping) + sizeof(header), &instruction, sizeof(instruction));
+	munmap(mapping, size);
+
+	sockaddr_un address = {};
+	ControlRequest request = {CONTROL_MAGIC, 1, CONTROL_UPLOAD, 0};
+	ControlReply reply = {};
+	alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+	iovec data = {&request, sizeof(request)};
+	msghdr message = {};
+	int fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, SOCKET_PATH);
+	message.msg_iov = &data;
+	message.msg_iovlen = 1;
+	message.msg_control = control;
+	message.msg_controllen = sizeof(control);
+
+	cmsghdr* rights = CMSG_FIRSTHDR(&message);
+	rights->cmsg_level = SOL_SOCKET;
+	rights->cmsg_type = SCM_RIGHTS;
+	rights->cmsg_len = CMSG_LEN(sizeof(int));
+	memcpy(CMSG_DATA(rights), &planFd, sizeof(planFd));
+
+	if (fcntl(planFd, F_ADD_SEALS, F_SEAL_SHRINK) != 0 || connect(fd, (sockaddr*) &address, sizeof(address)) != 0
+		|| sendmsg(fd, &message, MSG_NOSIGNAL) != sizeof(request) || recv(fd, &reply, sizeof(reply), 0) != sizeof(reply)) {
+		close(fd);
+		close(planFd);
+		return 1;
+	}
+
+	close(fd);
+	close(planFd);
+
+	return reply.result;
+}
+
+/**
+ * Function which runs the functional checks, with the runtime serving on another thread
+ * @return the number of failed checks
+ */
+int checkCommands(Plan& plan) {
+	ControlClient client;
+	ControlReply reply;
+	int failures = 0;
+
+	if (client.open(SOCKET_PATH) != 0) {
+		std::cout << "FAIL: could not connect to " << SOCKET_PATH << std::endl;
+		return 1;
+	}
+
+	failures += expect(client, Step{CONTROL_STATUS, CONTROL_OK, IDLE}, reply);
+	failures += expect(client, Step{CONTROL_PAUSE, CONTROL_REFUSED, IDLE}, reply);
+	failures += expect(client, Step{CONTROL_UPLOAD, CONTROL_BAD_PLAN, IDLE}, reply); // no memfd passed
+	failures += expect(client, Step{(ControlCommand) 99, CONTROL_BAD_REQUEST, IDLE}, reply);
+	failures += sendMalformed() != CONTROL_BAD_REQUEST;
+	failures += sendWritablePlan() != CONTROL_BAD_PLAN;
+
+	if (client.uploadPlan(plan, Pose{0.5, 0.5, 0}, reply) != 0 || reply.result != CONTROL_OK || reply.planSize != plan.size()) {
+		std::cout << "FAIL: the plan upload was not accepted" << std::endl;
+		failures++;
+	}
+
+	failures += expect(client, Step{CONTROL_START, CONTROL_OK, MOWING}, reply);
+
+	// the first instruction was started straight away
+	if (reply.remainingCount != plan.size() - 1) {
+		std::cout << "FAIL: the uploaded plan is not the one being mowed (" << reply.remainingCount << " left)" << std::endl;
+		failures++;
+	}
+
+	failures += expect(client, Step{CONTROL_START, CONTROL_REFUSED, MOWING}, reply);
+	failures += expect(client, Step{CONTROL_PAUSE, CONTROL_OK, PAUSED}, reply);
+	failures += expect(client, Step{CONTROL_RESUME, CONTROL_OK, MOWING}, reply);
+	failures += expect(client, Step{CONTROL_STOP, CONTROL_OK, IDLE}, reply);
+
+	if (reply.remainingCount != 0) {
+		failures++;
+	}
+
+	std::cout << "Commands: upload of " << plan.size() << " instructions, start, pause, resume, stop and refusals ";
+	std::cout << (failures == 0 ? "as expected" : "NOT as expected") << std::endl;
+
+	return failures;
+}
+
+/**
+ * Function which issues commands as fast as the replies come back for a while, with status clients alongside
+ * @return the number of failed checks
+ */
+int loadTest(double seconds) {
+	const Step cycle[] = {
+		{CONTROL_START, CONTROL_OK, MOWING}, {CONTROL_STATUS, CONTROL_OK, MOWING},
+		{CONTROL_PAUSE, CONTROL_OK, PAUSED}, {CONTROL_STATUS, CONTROL_OK, PAUSED},
+		{CONTROL_RESUME, CONTROL_OK, MOWING}, {CONTROL_STATUS, CONTROL_OK, MOWING},
+		{CONTROL_STOP, CONTROL_OK, IDLE}, {CONTROL_STATUS, CONTROL_OK, IDLE}
+	};
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds((int) (seconds * 1000));
+	std::atomic<long> statusCommands(0);
+	std::atomic<int> failures(0);
+	std::vector<std::thread> statusClients;
+
+	for (int i = 0; i < STATUS_CLIENTS; i++) {
+		statusClients.emplace_back([&]() {
+			ControlClient client;
+			ControlReply reply;
+
+			if (client.open(SOCKET_PATH) != 0) {
+				failures++;
+				return;
+			}
+
+			while (std::chrono::steady_clock::now() < deadline) {
+				if (client.sendCommand(CONTROL_STATUS, reply) != 0 || reply.result != CONTROL_OK) {
+					failures++;
+					return;
+				}
+
+				statusCommands++;
+			}
+		});
+	}
+
+	ControlClient client;
+	ControlReply reply;
+	LatencyHistogram roundTrips;
+	long commands = 0;
+
+	if (client.open(SOCKET_PATH) != 0) {
+		failures++;
+	}
+
+	while (failures == 0 && std::chrono::steady_clock::now() < deadline) {
+		for (const Step& step : cycle) {
+			long long startNs = LatencyHistogram::now();
+
+			if (expect(client, step, reply) != 0) {
+				failures++;
+				break;
+			}
+
+			roundTrips.recordSince(startNs);
+			commands++;
+		}
+	}
+
+	for (std::thread& statusClient : statusClients) {
+		statusClient.join();
+	}
+
+	HistogramSnapshot snapshot;
+	roundTrips.getSnapshot(snapshot);
+
+	std::cout << "Load: " << commands / seconds << " state commands/s from one client, ";
+	std::cout << statusCommands / seconds << " status/s from " << STATUS_CLIENTS << " more; round trip p50 ";
+	std::cout << LatencyHistogram::getPercentileUs(snapshot, 50) << " us, p99 " << LatencyHistogram::getPercentileUs(snapshot, 99);
+	std::cout << " us, max " << snapshot.maxUs << " us" << std::endl;
+
+	if (commands < 1000 * seconds) {
+		std::cout << "FAIL: fewer than 1000 commands/s" << std::endl;
+		failures++;
+	}
+
+	return failures;
+}
+
+/**
+ * main function, runs the mower on the reactor and the clients on other threads
+ *
+ * @return 0: working properly
+ * @return 1: a command was not carried out as expected, or the server was too slow
+ */
+int main (int argc, char* argv[]) {
+	double seconds = argc > 1 ? atof(argv[1]) : 2;
+	SimBoard board;
+	State currentState = IDLE;
+	Path path(3.0, 3.0, CAR_DIAMETER, BLADE_DIAMETER, false);
+	Path uploaded(5.0, 4.0, CAR_DIAMETER, BLADE_DIAMETER, false);
+
+	board.setRealTime(true);
+
+	for (int pin : {START_PIN, INPUT_PIN, UP_PIN, DOWN_PIN}) {
+		board.setInput(pin, 1); // released
+	}
+
+	Motor leftWheelMotor(24, 23, board);
+	Motor rightWheelMotor(21, 22, board);
+	Motor bladeMotor(2, 3, board);
+	CancellationToken shutdown;
+	WheelController wheelControl(leftWheelMotor, rightWheelMotor);
+	wheelControl.setCancellationToken(shutdown);
+	BladeController bladeControl(bladeMotor);
+	ExecutionController exec(currentState, path, wheelControl, bladeControl, board);
+	exec.setVerbose(false);
+	exec.setCancellationToken(shutdown);
+
+	ButtonController btn(START_PIN, INPUT_PIN, UP_PIN, DOWN_PIN, currentState, path, exec, board);
+	btn.setCancellationToken(shutdown);
+
+	ControlServer server(btn, exec);
+	ReactorRuntime runtime(btn, exec, board);
+
+	if (server.open(SOCKET_PATH) != 0 || runtime.setControlServer(server) != 0) {
+		std::cout << "FAIL: could not serve on " << SOCKET_PATH << std::endl;
+		return 1;
+	}
+
+	int failures = 0;
+	Plan plan = uploaded.getInstructions();
+	std::thread clients([&]() {
+		failures += checkCommands(plan);
+		failures += loadTest(seconds);
+		runtime.requestShutdown();
+	});
+
+	runtime.run();
+	clients.join();
+
+	std::cout << "Server: " << server.getCommandCount() << " requests answered" << std::endl;
+	server.close();
+
+	if (failures > 0 || access(SOCKET_PATH, F_OK) == 0) {
+		std::cout << "FAIL" << std::endl;
+		return 1;
+	}
+
+	std::cout << "PASS" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,120 @@
+/**
+ * This file tests the coverage pattern policies in CoveragePattern.h without any hardware.
+ * For a set of lawn shapes it compares how fast each pattern generates its plan, the estimated mission time,
+ * and the coverage it achieves, next to the original serpentine from Path.
+ *
+ */
+
+#include "Path.h"
+#include "CoveragePattern.h"
+#include "CoverageGrid.h"
+#include <iostream>
+#include <chrono>
+#include <deque>
+
+const double CAR_DIAMETER = 0.87;
+const double BLADE_DIAMETER = 0.435;
+const double RESOLUTION = 0.05;
+const int ITERATIONS = 20000;
+
+/**
+ * Function which prints one row of the report for a pattern policy
+ */
+template <class Pattern>
+void report(double sizeX, double sizeY) {
+	LawnSpec lawn = LawnSpec{sizeX, sizeY, CAR_DIAMETER, BLADE_DIAMETER, 0.1};
+	Plan instructions;
+	MissionTimeSink time;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < ITERATIONS; i++) {
+		instructions.clear();
+		generateCoverage<Pattern>(lawn, instructions);
+	}
+
+	auto end = std::chrono::steady_clock::now();
+	double us = std::chrono::duration<double, std::micro>(end - start).count() / ITERATIONS;
+
+	generateCoverage<Pattern>(lawn, time);
+
+	CoverageGrid grid(sizeX, sizeY, RESOLUTION);
+	DriveModel model(CAR_DIAMETER);
+	grid.sweepPlan(instructions, getPatternStartPose(lawn), BLADE_DIAMETER, model);
+
+	std::cout << "  " << Pattern::getName() << ": " << instructions.size() << " instructions, " << us << " us to generate, ";
+	std::cout << time.seconds / 60 << " min, coverage " << grid.getCoveragePercent() << "%, overlap " << grid.getOverlapPercent() << "%" << std::endl;
+}
+
+/**
+ * main function, runs the comparison and checks Path refuses patterns it cannot generate
+ *
+ * @return 0: working properly
+ * @return -1: Path lost its pattern, or generated one it should have refused
+ */
+int main (void) {
+	const double SHAPES[][2] = {{3.0, 3.0}, {8.0, 5.0}, {12.0, 8.0}, {20.0, 10.0}, {30.0, 4.0}};
+
+	for (const double* shape : SHAPES) {
+		std::cout << shape[0] << " x " << shape[1] << " m" << std::endl;
+
+		// the original serpentine, for reference
+		Path path(shape[0], shape[1], CAR_DIAMETER, BLADE_DIAMETER, false);
+
+		MissionTimeSink time;
+		Plan original = path.getInstructions();
+
+		for (const Instruction& instruction : original) {
+			time.push_back(instruction);
+		}
+
+		CoverageGrid grid(shape[0], shape[1], RESOLUTION);
+		DriveModel model(CAR_DIAMETER);
+		grid.sweepPlan(original, path.getStartPose(), BLADE_DIAMETER, model);
+
+		std::cout << "  Path::generatePath: " << original.size() << " instructions, " << time.seconds / 60 << " min, coverage ";
+		std::cout << grid.getCoveragePercent() << "%, overlap " << grid.getOverlapPercent() << "%" << std::endl;
+
+		report<Boustrophedon>(shape[0], shape[1]);
+		report<InwardSpiral>(shape[0], shape[1]);
+		report<PerimeterFirst>(shape[0], shape[1]);
+	}
+
+	// Path keeps the chosen pattern when the dimensions change
+	Path path(3.0, 3.0, CAR_DIAMETER, BLADE_DIAMETER, false);
+
+	path.usePattern<InwardSpiral>(0.1);
+	path.setDimensions(8.0, 5.0);
+
+	Plan expected;
+	generateCoverage<InwardSpiral>(LawnSpec{8.0, 5.0, CAR_DIAMETER, BLADE_DIAMETER, 0.1}, expected);
+
+	if (path.getInstructions().size() != expected.size()) {
+		std::cout << "Path lost its pattern after setDimensions" << std::endl;
+		return -1;
+	}
+
+	// overlaps that never finish, no blade, or a lawn smaller than the mower are refused instead of generated
+	Path refused(5.0, 4.0, CAR_DIAMETER, BLADE_DIAMETER, false);
+	Path noBlade(5.0, 4.0, CAR_DIAMETER, 0, false);
+	Path small(0.5, 4.0, CAR_DIAMETER, BLADE_DIAMETER, false);
+
+	if (refused.usePattern<Boustrophedon>(1.0) != -1 || refused.usePattern<InwardSpiral>(1.0) != -1 || refused.usePattern<PerimeterFirst>(-0.1) != -1
+			|| noBlade.usePattern<Boustrophedon>() != -1 || small.usePattern<InwardSpiral>() != -1 || !small.getInstructions().empty()) {
+		std::cout << "Path generated a pattern it should have refused" << std::endl;
+		return -1;
+	}
+
+	// a refused overlap leaves the path as it was
+	refused.usePattern<InwardSpiral>(0.1);
+	size_t before = refused.getInstructions().size();
+
+	if (refused.usePattern<Boustrophedon>(1.5) != -1 || refused.getInstructions().size() != before || refused.setDimensions(0.5, 0.5) != -1) {
+		std::cout << "Path changed its pattern on a refused overlap" << std::endl;
+		return -1;
+	}
+
+	std::cout << "Refused: overlap 1 and -0.1, no blade, lawn smaller than the mower" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,93 @@
+/**
+ * This file tests the CoverageGrid class without any hardware.
+ * It scores the plans generated by Path for a few lawn sizes (coverage, overlap, missed area at 5 cm resolution)
+ * and measures how many plans can be scored per second on one core: every lawn, up to 10 x 20 m, must score at least 10,000.
+ * The plans are scored in batches and the fastest batch counts, so another process taking the core does not fail the test.
+ *
+ */
+
+#include "Path.h"
+#include "CoverageGrid.h"
+#include "DriveModel.h"
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+const int BATCHES = 50;
+const int PLANS_PER_BATCH = 200; // short batches, so one of them runs while nothing else wants the core
+
+/**
+ * main function, runs the report and benchmark
+ *
+ * @return 0: working properly
+ * @return -1: a full sweep was not scored as fully covered
+ * @return 1: fewer plans of a lawn were scored per second than its minimum
+ */
+int main (void) {
+	const double RESOLUTION = 0.05;
+	const double CAR_DIAMETER = 0.87;
+	const double BLADE_DIAMETER = 0.435;
+	const double SIZES[][3] = {{3.0, 3.0, 10000}, {4.5, 4.5, 10000}, {5.0, 8.0, 10000}, {10.0, 20.0, 10000}}; // length, width, minimum plans/s
+
+	// sanity check: a blade as wide as the lawn driven along its middle covers all of it
+	CoverageGrid check(2.0, 1.0, RESOLUTION);
+	check.sweepSegment(-1.0, 0.5, 3.0, 0.5, 1.2);
+	check.endPass();
+
+	if (check.getCoveragePercent() != 100.0 || check.getOverlapPercent() != 0.0) {
+		std::cout << "Full sweep scored " << check.getCoveragePercent() << "%" << std::endl;
+		return -1;
+	}
+
+	std::cout << "lawn (m)    instructions  coverage %  overlap %  missed (m^2)  plans/s" << std::endl;
+
+	int failures = 0;
+
+	for (const double* size : SIZES) {
+		Path path(size[0], size[1], CAR_DIAMETER, BLADE_DIAMETER, false);
+		Plan plan = path.getInstructions();
+		DriveModel model(CAR_DIAMETER);
+		CoverageGrid grid(std::max(size[0], size[1]), std::min(size[0], size[1]), RESOLUTION);
+
+		grid.sweepPlan(plan, path.getStartPose(), BLADE_DIAMETER, model);
+
+		double coverage = grid.getCoveragePercent();
+		double overlap = grid.getOverlapPercent();
+		double missed = grid.getMissedArea();
+
+		double seconds = HUGE_VAL;
+
+		for (int batch = 0; batch < BATCHES; batch++) {
+			auto start = std::chrono::steady_clock::now();
+
+			for (int i = 0; i < PLANS_PER_BATCH; i++) {
+				grid.reset();
+				grid.sweepPlan(plan, path.getStartPose(), BLADE_DIAMETER, model);
+				coverage += grid.getCoveragePercent() * 0; // keep the work from being optimised away
+			}
+
+			auto end = std::chrono::steady_clock::now();
+			seconds = std::min(seconds, std::chrono::duration<double>(end - start).count());
+		}
+
+		double plansPerSecond = PLANS_PER_BATCH / seconds;
+
+		std::cout << size[0] << "x" << size[1] << "     " << plan.size() << "            " << coverage << "     " << overlap;
+		std::cout << "     " << missed << "        " << (long) plansPerSecond << std::endl;
+
+		if (plansPerSecond < size[2]) {
+			std::cout << "FAIL: " << (long) plansPerSecond << " plans/s, " << (long) size[2] << " needed" << std::endl;
+			failures++;
+		}
+	}
+
+	if (failures > 0) {
+		std::cout << "FAIL" << std::endl;
+		return 1;
+	}
+
+	std::cout << "PASS" << std::endl;
+
+	return 0;
+}
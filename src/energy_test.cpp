@@ -0,0 +1,257 @@
+/**
+ * This file tests the EnergyModel, SimBattery and the executor's return-to-base without any hardware.
+ * It compares the predicted energy of missions with what a simulated battery measures, runs a mission on a battery
+ * too small for it (the mower has to go home to charge and come back), clears missions from another thread while the
+ * executor checks the battery against them, and benchmarks the planning cost of the energy checks on a 10k-instruction plan.
+ *
+ */
+
+#include "EnergyModel.h"
+#include "SimBattery.h"
+#include "SimBoard.h"
+#include "Path.h"
+#include "Motor.h"
+#include "WheelController.h"
+#include "BladeController.h"
+#include "BladeScheduler.h"
+#include "ExecutionController.h"
+#include "MissionBuilder.h"
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <thread>
+#include <atomic>
+
+const double CAR_DIAMETER = 0.87;
+const double BLADE_DIAMETER = 0.435;
+const double CHARGE_WATTS = 100;
+const double RESERVE_WH = 0.1;
+const size_t BENCHMARK_INSTRUCTIONS = 10000;
+
+// same wiring as the real mower (see thread_test.cpp)
+const int LEFT_WHEEL_PIN_CW = 24;
+const int LEFT_WHEEL_PIN_CCW = 23;
+const int RIGHT_WHEEL_PIN_CW = 21;
+const int RIGHT_WHEEL_PIN_CCW = 22;
+const int BLADE_PIN_CW = 2;
+const int BLADE_PIN_CCW = 3;
+
+struct MissionRun {
+	bool finished;
+	double usedWh;
+	double minRemainingWh; // lowest charge seen between instructions
+	int returnCount;
+	int instructionCount;
+	double wallMs;
+};
+
+/**
+ * Function which runs a plan on a simulated board and battery
+ *
+ * @param path: path the executor belongs to (its instructions are used when plan is null)
+ * @param plan: plan to run instead of the path's own instructions, or nullptr
+ * @param start: pose the plan starts from
+ * @param capacityWh: battery capacity
+ * @param returnToBase: whether the executor goes home to charge when the battery runs low
+ */
+MissionRun runMission(Path& path, const Plan* plan, const Pose& start, double capacityWh, bool returnToBase) {
+	SimBoard board;
+	SimBattery battery(board, capacityWh, CHARGE_WATTS);
+	EnergyModel energyModel(CAR_DIAMETER);
+	State currentState = MOWING;
+
+	Motor leftWheelMotor(LEFT_WHEEL_PIN_CW, LEFT_WHEEL_PIN_CCW, board);
+	Motor rightWheelMotor(RIGHT_WHEEL_PIN_CW, RIGHT_WHEEL_PIN_CCW, board);
+	Motor bladeMotor(BLADE_PIN_CW, BLADE_PIN_CCW, board);
+	WheelController wheelControl(leftWheelMotor, rightWheelMotor);
+	BladeController bladeControl(bladeMotor);
+	ExecutionController exec(currentState, path, wheelControl, bladeControl, board);
+
+	battery.addLoad(LEFT_WHEEL_PIN_CW, WHEEL_MOTOR_WATTS);
+	battery.addLoad(LEFT_WHEEL_PIN_CCW, WHEEL_MOTOR_WATTS);
+	battery.addLoad(RIGHT_WHEEL_PIN_CW, WHEEL_MOTOR_WATTS);
+	battery.addLoad(RIGHT_WHEEL_PIN_CCW, WHEEL_MOTOR_WATTS);
+	battery.addLoad(BLADE_PIN_CW, BLADE_MOTOR_WATTS);
+	battery.addLoad(BLADE_PIN_CCW, BLADE_MOTOR_WATTS);
+
+	exec.setVerbose(false);
+
+	if (returnToBase) {
+		exec.setReturnToBase(battery, energyModel, start, RESERVE_WH);
+	}
+
+	if (plan == nullptr) {
+		exec.assignInstructions();
+	} else {
+		exec.assignInstructions(*plan, start);
+	}
+
+	MissionRun run = MissionRun{false, 0, capacityWh, 0, exec.getRemainingCount(), 0};
+	double drainedWh = 0; // everything the loads took, charging not counted
+	double lastWh = capacityWh;
+	auto wallStart = std::chrono::steady_clock::now();
+
+	while (exec.executeNext() > 0) {
+		double remainingWh = battery.getRemainingWh();
+
+		drainedWh += std::max(0.0, lastWh - remainingWh);
+		lastWh = remainingWh;
+		run.minRemainingWh = std::min(run.minRemainingWh, remainingWh);
+	}
+
+	exec.executeNext(); // out of instructions: stops the blade and goes back to idle
+
+	auto wallFinish = std::chrono::steady_clock::now();
+
+	run.finished = currentState == IDLE;
+	run.usedWh = drainedWh;
+	run.returnCount = exec.getReturnCount();
+	run.wallMs = std::chrono::duration<double, std::milli>(wallFinish - wallStart).count();
+
+	return run;
+}
+
+/**
+ * Function which starts and clears missions from a second thread, as the start button does, while the executor runs them
+ * on its own thread and checks the battery against the plan's energy table before every instruction
+ *
+ * @param missions: how many missions to start and clear
+ * @return 0: every clear left the executor with an empty plan, 1: instructions were left after a clear
+ */
+int checkClearWhileMowing(int missions) {
+	SimBoard board;
+	SimBattery battery(board, 1000, CHARGE_WATTS);
+	EnergyModel energyModel(CAR_DIAMETER);
+	State currentState = IDLE;
+	Path path(8, 6, CAR_DIAMETER, BLADE_DIAMETER, false);
+
+	Motor leftWheelMotor(LEFT_WHEEL_PIN_CW, LEFT_WHEEL_PIN_CCW, board);
+	Motor rightWheelMotor(RIGHT_WHEEL_PIN_CW, RIGHT_WHEEL_PIN_CCW, board);
+	Motor bladeMotor(BLADE_PIN_CW, BLADE_PIN_CCW, board);
+	WheelController wheelControl(leftWheelMotor, rightWheelMotor);
+	BladeController bladeControl(bladeMotor);
+	ExecutionController exec(currentState, path, wheelControl, bladeControl, board);
+	std::atomic<bool> done(false);
+	int leftOver = 0;
+
+	exec.setVerbose(false);
+	exec.setReturnToBase(battery, energyModel, path.getStartPose(), RESERVE_WH);
+
+	std::thread executor([&]() {
+		while (!done) {
+			if (exec.executeNext() == 0) {
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	for (int i = 0; i < missions; i++) {
+		exec.assignInstructions();
+		currentState = MOWING;
+		std::this_thread::yield();
+		exec.clearInstructions();
+		currentState = IDLE;
+
+		leftOver += exec.getRemainingCount() > 0 ? 1 : 0;
+	}
+
+	done = true;
+	executor.join();
+
+	std::cout << missions << " missions cleared while the executor ran them: " << leftOver << " left instructions behind" << std::endl;
+
+	return leftOver == 0 ? 0 : 1;
+}
+
+/**
+ * main function, runs the comparison, the return-to-base mission and the benchmark
+ *
+ * @return 0: working properly
+ * @return 1: a mission did not finish, the battery ran below the reserve or a cleared mission left instructions
+ */
+int main (void) {
+	EnergyModel energyModel(CAR_DIAMETER);
+	int failures = 0;
+
+	// predicted vs measured, the executor's blade scheduler decides which stretches run with the blade off
+	std::cout << "Predicted vs measured mission energy:" << std::endl;
+
+	for (double size : {4.0, 8.0, 12.0, 20.0}) {
+		Path path(size, size * 0.75, CAR_DIAMETER, BLADE_DIAMETER, false);
+		Plan scheduled = path.getInstructions();
+		BladeScheduler().schedule(scheduled);
+
+		double predictedWh = energyModel.getPlanWh(scheduled);
+		MissionRun run = runMission(path, nullptr, path.getStartPose(), 1000, false);
+
+		std::cout << "  " << size << " x " << size * 0.75 << " m: predicted " << predictedWh << " Wh (";
+		std::cout << path.getEnergyEstimate(energyModel) << " Wh with the blade always on), measured " << run.usedWh;
+		std::cout << " Wh, error " << 100 * (predictedWh - run.usedWh) / run.usedWh << "%" << std::endl;
+	}
+
+	// a battery that only holds about a third of the mission
+	Path bigLawn(20, 15, CAR_DIAMETER, BLADE_DIAMETER, false);
+	double missionWh = bigLawn.getEnergyEstimate(energyModel);
+	MissionRun smallBattery = runMission(bigLawn, nullptr, bigLawn.getStartPose(), missionWh / 3, true);
+
+	std::cout << "20 x 15 m lawn (" << missionWh << " Wh) on a " << missionWh / 3 << " Wh battery: ";
+	std::cout << (smallBattery.finished ? "finished" : "did not finish") << " after " << smallBattery.returnCount;
+	std::cout << " returns to base, lowest charge " << smallBattery.minRemainingWh << " Wh (reserve " << RESERVE_WH << " Wh)" << std::endl;
+
+	if (!smallBattery.finished || smallBattery.returnCount == 0 || smallBattery.minRemainingWh < RESERVE_WH * 0.5) {
+		failures++;
+	}
+
+	failures += checkClearWhileMowing(2000);
+
+	// a 10k-instruction plan: many small lawns stitched together
+	std::mt19937 random(7);
+	std::uniform_real_distribution<double> size(3.0, 15.0);
+	MissionBuilder builder(CAR_DIAMETER, BLADE_DIAMETER);
+
+	for (int i = 0; i < 400; i++) {
+		builder.addArea(MowingArea{(i % 20) * 20.0, (i / 20) * 20.0, size(random), size(random)});
+	}
+
+	builder.setStartPose(Pose{0, 0, 0});
+	builder.build();
+
+	Plan plan = builder.getInstructions();
+	plan.resize(std::min(plan.size(), BENCHMARK_INSTRUCTIONS));
+
+	std::vector<double> remainingWh;
+	int repeats = 100;
+	auto start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < repeats; i++) {
+		energyModel.getRemainingWh(plan, remainingWh);
+	}
+
+	auto finish = std::chrono::steady_clock::now();
+	double suffixMs = std::chrono::duration<double, std::milli>(finish - start).count() / repeats;
+
+	start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < repeats; i++) {
+		energyModel.getTransitWh(Pose{i * 1.0, 0, 0}, Pose{0, i * 1.0, M_PI / 2});
+	}
+
+	finish = std::chrono::steady_clock::now();
+	double transitUs = std::chrono::duration<double, std::micro>(finish - start).count() / repeats;
+
+	Path dummy(4, 4, CAR_DIAMETER, BLADE_DIAMETER, false);
+	MissionRun without = runMission(dummy, &plan, Pose{0, 0, 0}, 1000000, false);
+	MissionRun with = runMission(dummy, &plan, Pose{0, 0, 0}, 1000000, true);
+
+	std::cout << plan.size() << " instruction plan (" << remainingWh[0] << " Wh): remaining energy table in " << suffixMs;
+	std::cout << " ms, drive home estimate in " << transitUs << " us" << std::endl;
+	std::cout << "  executor without return-to-base " << 1000 * without.wallMs / without.instructionCount << " us per instruction, with ";
+	std::cout << 1000 * with.wallMs / with.instructionCount << " us per instruction" << std::endl;
+
+	if (!without.finished || !with.finished) {
+		failures++;
+	}
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,243 @@
+/**
+ * This file measures the emergency stop without any hardware: the executor runs a mission on its own thread
+ * on a SimBoard in real time mode, and the e-stop input is pulled LOW while the mower is driving with the blade on.
+ * It prints the time from the e-stop edge to every motor pin being LOW, and compares it with the old way of stopping
+ * (the start button clears the instructions and the motors stop when the executor's current delay is over).
+ * It also checks that a move with a negative value is skipped rather than driven, and that an e-stop already
+ * held down when it is armed stops the mower without waiting for an edge.
+ *
+ * Usage: ./test [trials]
+ *
+ */
+
+#include "State.h"
+#include "Path.h"
+#include "Motor.h"
+#include "WheelController.h"
+#include "BladeController.h"
+#include "ExecutionController.h"
+#include "EmergencyStop.h"
+#include "SimBoard.h"
+#include "DriveModel.h"
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <algorithm>
+
+const int ESTOP_PIN = 25;
+const double CAR_DIAMETER = 0.87;
+const double BLADE_DIAMETER = 0.435;
+const int MOVE_COUNT = 20;
+const double MOVE_METRES = 0.5; // about 460 ms per move
+const int MOTOR_PINS[] = {24, 23, 21, 22, 2, 3};
+
+struct StopResult {
+	double meanUs;
+	double maxUs;
+	int restarts; // trials where a motor was on again 20 ms after the stop
+};
+
+/**
+ * Function which returns whether any motor pin is HIGH
+ */
+bool motorsOn(SimBoard& board) {
+	for (int pin : MOTOR_PINS) {
+		if (board.digitalRead(pin) == 1) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Function which stops the mower part way through a mission, again and again, and measures how long the motors kept running
+ *
+ * @param useEmergencyStop: true to pull the e-stop input LOW, false to clear the instructions like the start button does
+ * @param trials: how many missions to stop
+ */
+StopResult measureStop(bool useEmergencyStop, int trials) {
+	SimBoard board;
+	State currentState = IDLE;
+	Path path(3.0, 3.0, CAR_DIAMETER, BLADE_DIAMETER, false);
+	std::mt19937 random(7);
+	std::uniform_int_distribution<int> stopAfterMs(0, 300);
+	Plan mission(MOVE_COUNT, Instruction{"MF", MOVE_METRES, true});
+
+	board.setRealTime(true);
+	board.setInput(ESTOP_PIN, 1); // released
+
+	Motor leftWheelMotor(24, 23, board);
+	Motor rightWheelMotor(21, 22, board);
+	Motor bladeMotor(2, 3, board);
+	WheelController wheelControl(leftWheelMotor, rightWheelMotor);
+	BladeController bladeControl(bladeMotor);
+	ExecutionController exec(currentState, path, wheelControl, bladeControl, board);
+	exec.setVerbose(false);
+
+	EmergencyStop emergencyStop(ESTOP_PIN, std::vector<int>(std::begin(MOTOR_PINS), std::end(MOTOR_PINS)), board);
+
+	if (emergencyStop.arm() != 0) {
+		std::cout << "e-stop could not be armed" << std::endl;
+		return StopResult{0, 0, 0};
+	}
+
+	exec.setEmergencyStop(emergencyStop);
+
+	StopResult result = StopResult{0, 0, 0};
+
+	for (int trial = 0; trial < trials; trial++) {
+		exec.assignInstructions(mission, Pose{0, 0, 0});
+		currentState = MOWING;
+
+		std::thread executor([&]() {
+			while (exec.executeNext() == 1) {
+			}
+		});
+
+		while (!motorsOn(board)) {
+			std::this_thread::yield();
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(stopAfterMs(random)));
+		auto start = std::chrono::steady_clock::now();
+
+		if (useEmergencyStop) {
+			board.setInput(ESTOP_PIN, 0);
+		} else {
+			exec.clearInstructions();
+			currentState = IDLE;
+		}
+
+		while (motorsOn(board)) {
+			std::this_thread::yield();
+		}
+
+		double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+		result.meanUs += us / trials;
+		result.maxUs = std::max(result.maxUs, us);
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+		if (motorsOn(board)) {
+			result.restarts++;
+		}
+
+		executor.join();
+
+		board.setInput(ESTOP_PIN, 1);
+		emergencyStop.reset();
+		exec.clearInstructions();
+		currentState = IDLE;
+	}
+
+	return result;
+}
+
+/**
+ * Function which runs a plan with a negative move on the virtual clock: the move must be skipped, not turned into
+ * an unsigned wait of about 49 days with the motors on
+ * @return 0: only the valid move was driven, 1: the motors ran for the negative one
+ */
+int checkNegativeMove() {
+	SimBoard board;
+	State currentState = IDLE;
+	Path path(3.0, 3.0, CAR_DIAMETER, BLADE_DIAMETER, false);
+	Plan plan;
+
+	plan.push_back(Instruction{"MF", -0.5, true});
+	plan.push_back(Instruction{"MF", MOVE_METRES, true});
+
+	Motor leftWheelMotor(24, 23, board);
+	Motor rightWheelMotor(21, 22, board);
+	Motor bladeMotor(2, 3, board);
+	WheelController wheelControl(leftWheelMotor, rightWheelMotor);
+	BladeController bladeControl(bladeMotor);
+	ExecutionController exec(currentState, path, wheelControl, bladeControl, board);
+	exec.setVerbose(false);
+
+	exec.assignInstructions(plan, Pose{0, 0, 0});
+	currentState = MOWING;
+
+	while (exec.executeNext() == 1) {
+	}
+
+	unsigned int expectedMs = MOVE_METRES * DRIVE_MS_PER_METRE;
+	bool skipped = board.millis() < expectedMs + 1000 && !motorsOn(board);
+
+	std::cout << "Plan with a negative move: " << board.millis() << " ms on the virtual clock, ";
+	std::cout << (skipped ? "the negative move was skipped" : "the negative move was DRIVEN") << std::endl;
+
+	return skipped ? 0 : 1;
+}
+
+/**
+ * Function which arms the e-stop while its input is already LOW: there is no falling edge to interrupt on,
+ * so arming must latch the stop and the executor must not start a motor
+ * @return 0: the stop was latched and the motors stayed off, 1: the mower started with the e-stop held down
+ */
+int checkHeldAtArm() {
+	SimBoard board;
+	State currentState = IDLE;
+	Path path(3.0, 3.0, CAR_DIAMETER, BLADE_DIAMETER, false);
+	Plan mission(MOVE_COUNT, Instruction{"MF", MOVE_METRES, true});
+
+	board.setInput(ESTOP_PIN, 0); // held down before start up
+
+	Motor leftWheelMotor(24, 23, board);
+	Motor rightWheelMotor(21, 22, board);
+	Motor bladeMotor(2, 3, board);
+	WheelController wheelControl(leftWheelMotor, rightWheelMotor);
+	BladeController bladeControl(bladeMotor);
+	ExecutionController exec(currentState, path, wheelControl, bladeControl, board);
+	exec.setVerbose(false);
+
+	EmergencyStop emergencyStop(ESTOP_PIN, std::vector<int>(std::begin(MOTOR_PINS), std::end(MOTOR_PINS)), board);
+
+	if (emergencyStop.arm() != 0) {
+		std::cout << "e-stop could not be armed" << std::endl;
+		return 1;
+	}
+
+	exec.setEmergencyStop(emergencyStop);
+	exec.assignInstructions(mission, Pose{0, 0, 0});
+	currentState = MOWING;
+
+	bool started = exec.executeNext() == 1 && motorsOn(board);
+	bool latched = emergencyStop.isLatched() && !started && !motorsOn(board);
+
+	std::cout << "E-stop held down when armed: " << (latched ? "latched, motors off" : "NOT latched, the mower started") << std::endl;
+
+	return latched ? 0 : 1;
+}
+
+/**
+ * Function which prints the result of one way of stopping
+ */
+void printResult(const char* name, const StopResult& result) {
+	std::cout << name << ": stop to every motor pin LOW mean " << result.meanUs << " us, max " << result.maxUs << " us";
+	std::cout << ", motors back on after the stop in " << result.restarts << " trials" << std::endl;
+}
+
+/**
+ * main function, stops the mower both ways
+ *
+ * @return 0: working properly
+ * @return 1: the e-stop let a motor run again, a negative move was driven or a held e-stop was not latched
+ */
+int main (int argc, char* argv[]) {
+	int trials = argc > 1 ? std::atoi(argv[1]) : 20;
+
+	StopResult clearing = measureStop(false, trials);
+	printResult("Clearing the instructions", clearing);
+
+	StopResult emergencyStop = measureStop(true, trials);
+	printResult("E-stop", emergencyStop);
+
+	int failures = checkNegativeMove();
+	failures += checkHeldAtArm();
+
+	return emergencyStop.restarts == 0 && failures == 0 ? 0 : 1;
+}
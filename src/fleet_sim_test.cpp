@@ -0,0 +1,50 @@
+/**
+ * This file runs the FleetSimulator without any hardware.
+ * Thousands of virtual mowers, each on a random lawn, run their whole mission on simulated boards across all cores.
+ * It prints the mission time, coverage and energy statistics and the throughput in simulated mower-hours per second.
+ *
+ * Usage: ./test [mowers] [threads]
+ *
+ */
+
+#include "FleetSimulator.h"
+#include <iostream>
+#include <random>
+#include <cstdlib>
+
+const double CAR_DIAMETER = 0.87;
+const double BLADE_DIAMETER = 0.435;
+
+/**
+ * main function, runs the simulation
+ *
+ * @return 0: working properly
+ * @return 1: a mission failed
+ */
+int main (int argc, char* argv[]) {
+	int mowers = argc > 1 ? std::atoi(argv[1]) : 2000;
+	int threads = argc > 2 ? std::atoi(argv[2]) : 0;
+
+	ThreadPool pool(threads);
+	FleetSimulator simulator(CAR_DIAMETER, BLADE_DIAMETER, pool);
+	std::mt19937 random(42);
+	std::uniform_real_distribution<double> size(3.0, 15.0);
+
+	for (int i = 0; i < mowers; i++) {
+		simulator.addMower(size(random), size(random));
+	}
+
+	std::cout << "Simulating " << mowers << " mowers on " << pool.getThreadCount() << " threads" << std::endl;
+
+	int result = simulator.run();
+	FleetSummary summary = simulator.getSummary();
+
+	std::cout << "Mission time: mean " << summary.meanMissionMinutes << " min, p95 " << summary.p95MissionMinutes;
+	std::cout << " min, max " << summary.maxMissionMinutes << " min" << std::endl;
+	std::cout << "Coverage: mean " << summary.meanCoveragePercent << "%, min " << summary.minCoveragePercent << "%" << std::endl;
+	std::cout << "Energy: mean " << summary.meanEnergyWh << " Wh, total " << summary.totalEnergyWh / 1000 << " kWh" << std::endl;
+	std::cout << "Simulated " << summary.simulatedHours << " mower-hours in " << summary.wallSeconds << " s: ";
+	std::cout << summary.mowerHoursPerSecond << " mower-hours per second" << std::endl;
+
+	return result == 0 ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+/**
+ * This file tests the Logger without any hardware.
+ * It benchmarks the cost of one log call on the calling thread (against std::cout << ... << std::endl to a file, and a
+ * LOG_DEBUG line that is compiled out), then logs from several threads at once into a small rotating file and checks
+ * that every line was written whole, or counted as dropped, and that the rotated files stay within the limit.
+ *
+ * Usage: ./test [log file]
+ *
+ */
+
+#include "Logger.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+
+const int BENCHMARK_LINES = 100000;
+const int BURST = 500; // lines logged between flushes, less than LOG_RING_SIZE
+const int THREADS = 4;
+const int LINES_PER_THREAD = 20000;
+const size_t MAX_FILE_BYTES = 256 * 1024;
+const int MAX_FILES = 3;
+
+/**
+ * Function which counts the lines of the log file and its rotated files, and the ones that are not whole
+ */
+void countLines(const std::string& path, long& lines, long& broken, int& files) {
+	lines = 0;
+	broken = 0;
+	files = 0;
+
+	for (int i = 0; i <= MAX_FILES + 1; i++) {
+		std::ifstream file(i == 0 ? path : path + "." + std::to_string(i));
+		std::string line;
+
+		if (!file) {
+			continue;
+		}
+
+		files++;
+
+		while (std::getline(file, line)) {
+			int thread;
+			int number;
+
+			if (line.find(" INFO  t") == std::string::npos || sscanf(line.c_str() + line.find("stress: ") + 8, "thread %d line %d end", &thread, &number) != 2) {
+				broken++;
+			}
+
+			lines++;
+		}
+	}
+}
+
+/**
+ * main function, runs the benchmark and the multi-thread test
+ *
+ * @return 0: working properly
+ * @return 1: lines went missing or were not whole, or the files were not rotated
+ */
+int main (int argc, char* argv[]) {
+	std::string path = argc > 1 ? argv[1] : "/tmp/mower_logger_test.log";
+	Logger& logger = Logger::getInstance();
+
+	for (int i = 0; i <= MAX_FILES + 1; i++) {
+		std::remove((i == 0 ? path : path + "." + std::to_string(i)).c_str());
+	}
+
+	if (logger.open(path, MAX_FILE_BYTES, MAX_FILES) != 0) {
+		std::cout << "could not open " << path << std::endl;
+		return 1;
+	}
+
+	// per call cost, the writer is kept from falling behind by flushing between bursts (not timed)
+	double loggerNs = 0;
+
+	for (int done = 0; done < BENCHMARK_LINES; done += BURST) {
+		auto start = std::chrono::steady_clock::now();
+
+		for (int i = 0; i < BURST; i++) {
+			LOG_INFO("bench", "instruction %s%g, %d instructions left", "MF", 3.25, done + i);
+		}
+
+		loggerNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		logger.flush();
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < BENCHMARK_LINES; i++) {
+		LOG_DEBUG("bench", "instruction %s%g, %d instructions left", "MF", 3.25, i);
+	}
+
+	double debugNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+	std::ofstream coutFile(path + ".cout");
+	std::streambuf* stdoutBuffer = std::cout.rdbuf(coutFile.rdbuf());
+	start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < BENCHMARK_LINES; i++) {
+		std::cout << "instruction: " << "MF" << 3.25 << " " << i << " instructions left" << std::endl;
+	}
+
+	double coutNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	std::cout.rdbuf(stdoutBuffer);
+	coutFile.close();
+	std::remove((path + ".cout").c_str());
+
+	std::cout << "Per call on the logging thread: LOG_INFO " << loggerNs / BENCHMARK_LINES << " ns, compiled out LOG_DEBUG ";
+	std::cout << debugNs / BENCHMARK_LINES << " ns, std::cout with std::endl " << coutNs / BENCHMARK_LINES << " ns" << std::endl;
+
+	// several threads at once, the writer empties the buffers on its own
+	long linesBefore = logger.getLineCount() + logger.getDroppedCount();
+	long writesBefore = logger.getWriteCount();
+	std::vector<std::thread> threads;
+
+	for (int t = 0; t < THREADS; t++) {
+		threads.push_back(std::thread([t]() {
+			for (int i = 0; i < LINES_PER_THREAD; i++) {
+				LOG_INFO("stress", "thread %d line %d end", t, i);
+
+				if (i % 50 == 49) {
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				}
+			}
+		}));
+	}
+
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	logger.flush();
+
+	long logged = logger.getLineCount() + logger.getDroppedCount() - linesBefore;
+	long writes = logger.getWriteCount() - writesBefore;
+	long dropped = logger.getDroppedCount();
+
+	// only the stress lines are still in the files: the benchmark lines were rotated out
+	long lines;
+	long broken;
+	int files;
+	countLines(path, lines, broken, files);
+
+	std::cout << THREADS << " threads x " << LINES_PER_THREAD << " lines: " << logged << " logged, " << dropped << " dropped, ";
+	std::cout << writes << " write() calls (" << (double) (logged - dropped) / writes << " lines per write)" << std::endl;
+	std::cout << "  " << files << " files, " << lines << " lines in them, " << broken << " not whole or not from the stress threads" << std::endl;
+
+	if (logged != THREADS * LINES_PER_THREAD || broken > 0 || files < 2 || files > MAX_FILES + 1) {
+		std::cout << "FAIL: lines missing or the log was not rotated" << std::endl;
+		return 1;
+	}
+
+	std::cout << "PASS" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,341 @@
+/**
+ * This file tests the LatencyHistogram and MetricsPublisher without any hardware.
+ * It checks the buckets and percentiles against exact values, records from several threads at once (no count may be
+ * lost) and benchmarks record(). Then it runs the button and execution threads on a SimBoard in real time while a
+ * script presses start, pause, resume and shutdown, with a MetricsPublisher writing the five mower histograms to a
+ * Prometheus text file, and reads the file back: every histogram must have counts and well formed buckets.
+ *
+ * Usage: ./test [metrics file]
+ *
+ */
+
+#include "State.h"
+#include "Path.h"
+#include "Motor.h"
+#include "WheelController.h"
+#include "BladeController.h"
+#include "ButtonController.h"
+#include "ExecutionController.h"
+#include "SimBoard.h"
+#include "CancellationToken.h"
+#include "LatencyHistogram.h"
+#include "MetricsPublisher.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+const int BENCHMARK_RECORDS = 10000000;
+const int RECORD_THREADS = 4;
+const int RECORDS_PER_THREAD = 1000000;
+const int EXACT_VALUES = 200000;
+const unsigned int PUBLISH_PERIOD_MS = 200;
+const int START_PIN = 29;
+const int INPUT_PIN = 1;
+const int UP_PIN = 4;
+const int DOWN_PIN = 28;
+const double CAR_DIAMETER = 0.87;
+const double BLADE_DIAMETER = 0.435;
+
+struct ParsedHistogram {
+	std::vector<std::pair<double, unsigned long>> buckets; // le, cumulative count (+Inf last)
+	unsigned long count = 0;
+	double sum = 0;
+	double max = 0;
+	bool hasCount = false;
+};
+
+/**
+ * Function which presses and releases a button, like a finger
+ */
+void press(SimBoard& board, int pin) {
+	board.setInput(pin, 0);
+	std::this_thread::sleep_for(std::chrono::milliseconds(120));
+	board.setInput(pin, 1);
+}
+
+/**
+ * Function which compares the histogram's percentiles and buckets with the exact values recorded in it
+ * @return the number of failed checks
+ */
+int checkAccuracy() {
+	LatencyHistogram histogram;
+	HistogramSnapshot snapshot;
+	std::vector<unsigned int> values;
+	int failures = 0;
+
+	srand(45);
+
+	// spread over six decades, like the mower's latencies
+	for (int i = 0; i < EXACT_VALUES; i++) {
+		unsigned int value = (unsigned int) std::pow(10.0, 6.0 * rand() / RAND_MAX);
+		values.push_back(value);
+		histogram.record(value);
+	}
+
+	std::sort(values.begin(), values.end());
+	histogram.getSnapshot(snapshot);
+
+	for (double percentile : {50.0, 90.0, 99.0, 99.9, 100.0}) {
+		unsigned int exact = values[(size_t) std::ceil(values.size() * percentile / 100) - 1];
+		unsigned int estimate = LatencyHistogram::getPercentileUs(snapshot, percentile);
+		double error = exact == 0 ? estimate : std::fabs((double) estimate - exact) / exact;
+
+		std::cout << "p" << percentile << ": exact " << exact << " us, histogram " << estimate << " us" << std::endl;
+
+		if (estimate < exact || error > 1.0 / HISTOGRAM_SUB_BUCKETS) {
+			std::cout << "FAIL: p" << percentile << " off by " << error * 100 << "%" << std::endl;
+			failures++;
+		}
+	}
+
+	if (snapshot.count != values.size() || snapshot.maxUs != values.back()) {
+		std::cout << "FAIL: count or max wrong" << std::endl;
+		failures++;
+	}
+
+	// every value lands in the bucket that starts at or below it and ends above it
+	for (unsigned int value : {0u, 1u, 31u, 32u, 33u, 63u, 64u, 65u, 1000u, 123456u, 4000000000u, 4294967295u}) {
+		int index = LatencyHistogram::getBucketIndex(value);
+		unsigned int start = LatencyHistogram::getBucketStartUs(index);
+		bool last = index + 1 >= HISTOGRAM_BUCKETS;
+
+		if (index < 0 || index >= HISTOGRAM_BUCKETS || start > value || (!last && LatencyHistogram::getBucketStartUs(index + 1) <= value)) {
+			std::cout << "FAIL: " << value << " us is in bucket " << index << " starting at " << start << std::endl;
+			failures++;
+		}
+	}
+
+	return failures;
+}
+
+/**
+ * Function which records from several threads at once
+ * @return the number of failed checks
+ */
+int checkConcurrent() {
+	LatencyHistogram histogram;
+	HistogramSnapshot snapshot;
+	std::vector<std::thread> threads;
+
+	for (int t = 0; t < RECORD_THREADS; t++) {
+		threads.emplace_back([&histogram, t]() {
+			for (int i = 0; i < RECORDS_PER_THREAD; i++) {
+				histogram.record(i % 1000 + t);
+			}
+		});
+	}
+
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	histogram.getSnapshot(snapshot);
+
+	unsigned long long expectedSum = 0;
+
+	for (int t = 0; t < RECORD_THREADS; t++) {
+		expectedSum += (unsigned long long) (RECORDS_PER_THREAD / 1000) * (999 * 1000 / 2 + 1000 * t);
+	}
+
+	std::cout << "Concurrent: " << snapshot.count << " of " << (unsigned long) RECORD_THREADS * RECORDS_PER_THREAD;
+	std::cout << " records counted, max " << snapshot.maxUs << " us" << std::endl;
+
+	if (snapshot.count != (unsigned long) RECORD_THREADS * RECORDS_PER_THREAD || snapshot.sumUs != expectedSum || snapshot.maxUs != 999 + RECORD_THREADS - 1) {
+		std::cout << "FAIL: records were lost" << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * Function which reads the histograms back from a file written by MetricsPublisher::publish()
+ * Return value is 0 for success, -1 if the file could not be read
+ */
+int readMetrics(const std::string& path, std::map<std::string, ParsedHistogram>& histograms) {
+	std::ifstream file(path);
+	std::string line;
+
+	if (!file) {
+		return -1;
+	}
+
+	while (std::getline(file, line)) {
+		char name[128];
+		char le[32];
+		unsigned long count;
+		double value;
+
+		if (line.empty() || line[0] == '#') {
+			continue;
+		}
+
+		size_t bucket = line.find("_bucket{le=\"");
+
+		if (bucket != std::string::npos && sscanf(line.c_str() + bucket, "_bucket{le=\"%31[^\"]\"} %lu", le, &count) == 2) {
+			double edge = std::string(le) == "+Inf" ? INFINITY : atof(le);
+			histograms[line.substr(0, bucket)].buckets.push_back({edge, count});
+		} else if (sscanf(line.c_str(), "%127s %lf", name, &value) == 2) {
+			std::string metric = name;
+			size_t underscore = metric.rfind('_');
+			std::string base = metric.substr(0, underscore);
+			std::string suffix = metric.substr(underscore + 1);
+
+			if (suffix == "count") {
+				histograms[base].count = (unsigned long) value;
+				histograms[base].hasCount = true;
+			} else if (suffix == "sum") {
+				histograms[base].sum = value;
+			} else if (suffix == "max") {
+				histograms[base].max = value;
+			} else {
+				return -1;
+			}
+		} else {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Function which runs the two threads through the script while the metrics are published
+ * @return the number of failed checks
+ */
+int checkMower(const std::string& metricsPath) {
+	SimBoard board;
+	State currentState = IDLE;
+	Path path(3.0, 3.0, CAR_DIAMETER, BLADE_DIAMETER, false);
+	int failures = 0;
+
+	board.setRealTime(true);
+
+	for (int pin : {START_PIN, INPUT_PIN, UP_PIN, DOWN_PIN}) {
+		board.setInput(pin, 1); // released
+	}
+
+	Motor leftWheelMotor(24, 23, board);
+	Motor rightWheelMotor(21, 22, board);
+	Motor bladeMotor(2, 3, board);
+	CancellationToken shutdown;
+	WheelController wheelControl(leftWheelMotor, rightWheelMotor);
+	wheelControl.setCancellationToken(shutdown);
+	BladeController bladeControl(bladeMotor);
+	ExecutionController exec(currentState, path, wheelControl, bladeControl, board);
+	exec.setVerbose(false);
+	exec.setCancellationToken(shutdown);
+
+	ButtonController btn(START_PIN, INPUT_PIN, UP_PIN, DOWN_PIN, currentState, path, exec, board);
+	btn.setCancellationToken(shutdown);
+
+	MetricsPublisher publisher;
+	publisher.addHistogram("mower_button_press_to_handler_seconds", "Button press to the end of its handler", btn.getPressHistogram());
+	publisher.addHistogram("mower_state_change_to_motor_seconds", "State change to the motors being switched for it", exec.getStateChangeHistogram());
+	publisher.addHistogram("mower_motion_overrun_seconds", "Actual minus commanded duration of each motion", exec.getOverrunHistogram());
+	publisher.addHistogram("mower_oled_frame_seconds", "Time to send one frame to the OLED", btn.getFrameHistogram());
+	publisher.addHistogram("mower_plan_generation_seconds", "Time to generate a path plan", path.getGenerationHistogram());
+	publisher.start(metricsPath, PUBLISH_PERIOD_MS);
+
+	btn.initDisplay();
+	btn.setupInputs();
+
+	std::thread buttonThread(&ButtonController::startInputListener, &btn);
+	std::thread execThread(&ExecutionController::startExecutionListener, &exec);
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(300));
+	press(board, START_PIN);
+	std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+	press(board, INPUT_PIN); // pause
+	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+	press(board, INPUT_PIN); // resume
+	std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+	press(board, DOWN_PIN); // shutdown
+
+	execThread.join();
+	buttonThread.join();
+	publisher.stop();
+
+	std::map<std::string, ParsedHistogram> histograms;
+
+	if (readMetrics(metricsPath, histograms) != 0) {
+		std::cout << "FAIL: " << metricsPath << " could not be parsed" << std::endl;
+		return 1;
+	}
+
+	std::cout << "Mower: " << publisher.getPublishCount() << " snapshots written to " << metricsPath << std::endl;
+
+	for (const auto& entry : histograms) {
+		const ParsedHistogram& histogram = entry.second;
+		unsigned long previous = 0;
+		bool cumulative = true;
+
+		for (const auto& bucket : histogram.buckets) {
+			cumulative = cumulative && bucket.second >= previous;
+			previous = bucket.second;
+		}
+
+		std::cout << "  " << entry.first << ": " << histogram.count << " counted, mean ";
+		std::cout << (histogram.count > 0 ? histogram.sum / histogram.count * 1e6 : 0) << " us, max " << histogram.max * 1e6 << " us" << std::endl;
+
+		if (!histogram.hasCount || histogram.count == 0 || histogram.buckets.empty() || !cumulative
+			|| !std::isinf(histogram.buckets.back().first) || histogram.buckets.back().second != histogram.count) {
+			std::cout << "FAIL: " << entry.first << " is empty or its buckets are not cumulative" << std::endl;
+			failures++;
+		}
+	}
+
+	if (histograms.size() != 5 || publisher.getPublishCount() < 2) {
+		std::cout << "FAIL: expected 5 histograms published more than once" << std::endl;
+		failures++;
+	}
+
+	return failures;
+}
+
+/**
+ * main function, runs the accuracy, concurrency and benchmark checks and the mower run
+ *
+ * @return 0: working properly
+ * @return 1: a histogram was inaccurate, lost counts or was not published properly
+ */
+int main (int argc, char* argv[]) {
+	std::string metricsPath = argc > 1 ? argv[1] : "/tmp/mower_metrics.prom";
+	int failures = 0;
+
+	failures += checkAccuracy();
+	failures += checkConcurrent();
+
+	// per record cost on the calling thread
+	LatencyHistogram histogram;
+	auto start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < BENCHMARK_RECORDS; i++) {
+		histogram.record(i & 0xFFFF);
+	}
+
+	double recordNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / BENCHMARK_RECORDS;
+	HistogramSnapshot snapshot;
+	histogram.getSnapshot(snapshot);
+
+	std::cout << "Per record: " << recordNs << " ns (" << snapshot.count << " recorded)" << std::endl;
+
+	failures += checkMower(metricsPath);
+
+	if (failures > 0) {
+		std::cout << "FAIL" << std::endl;
+		return 1;
+	}
+
+	std::cout << "PASS" << std::endl;
+
+	return 0;
+}
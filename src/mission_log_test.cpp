@@ -0,0 +1,222 @@
+/**
+ * This file tests the MissionLog and MissionLogReader without any hardware.
+ * A mission runs on a SimBoard with the log attached to the executor and the motors, is paused part way, and is read back:
+ * every instruction, the pause and the mission end must be in the log, and the instruction times must match the plan.
+ * Then a season of logs is written (one file per day, many missions each) and summarised, which prints how many records
+ * went into each write() and fsync, and how fast the reader gets through the files.
+ *
+ * Usage: ./test [season MB] [log directory]
+ *
+ */
+
+#include "State.h"
+#include "Path.h"
+#include "Motor.h"
+#include "WheelController.h"
+#include "BladeController.h"
+#include "ExecutionController.h"
+#include "SimBoard.h"
+#include "MissionLog.h"
+#include "MissionLogReader.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <cstdio>
+#include <sys/stat.h>
+
+const double CAR_DIAMETER = 0.87;
+const double BLADE_DIAMETER = 0.435;
+const int SEASON_DAYS = 16;
+const int MISSION_INSTRUCTIONS = 400;
+
+/**
+ * Function which runs a mission on a simulated board with the log attached, pausing it once part way
+ * Return value is 0 if the log read back matches the mission
+ */
+int testMission(const std::string& directory) {
+	std::string path = directory + "/mission.mlog";
+	SimBoard board;
+	State currentState = IDLE;
+	Path lawn(6.0, 4.0, CAR_DIAMETER, BLADE_DIAMETER, false);
+	MissionLog missionLog(board);
+
+	Motor leftWheelMotor(24, 23, board);
+	Motor rightWheelMotor(21, 22, board);
+	Motor bladeMotor(2, 3, board);
+	WheelController wheelControl(leftWheelMotor, rightWheelMotor);
+	BladeController bladeControl(bladeMotor);
+	ExecutionController exec(currentState, lawn, wheelControl, bladeControl, board);
+
+	if (missionLog.open(path) != 0) {
+		std::cout << "could not open " << path << std::endl;
+		return 1;
+	}
+
+	exec.setVerbose(false);
+	exec.setMissionLog(missionLog);
+	leftWheelMotor.setMissionLog(missionLog);
+	rightWheelMotor.setMissionLog(missionLog);
+	bladeMotor.setMissionLog(missionLog);
+
+	size_t planned = lawn.getInstructions().size();
+	exec.assignInstructions();
+	missionLog.logState(currentState, MOWING);
+	currentState = MOWING;
+
+	for (size_t i = 0; exec.executeNext() == 1; i++) {
+		// pause half way for a minute, the way the blue button does
+		if (i == planned / 2) {
+			missionLog.logButton(5);
+			missionLog.logState(MOWING, PAUSED);
+			currentState = PAUSED;
+			exec.executeNext(); // stops the blade
+			board.delay(60000);
+			missionLog.logButton(5);
+			missionLog.logState(PAUSED, MOWING);
+			currentState = MOWING;
+		}
+	}
+
+	missionLog.close();
+
+	MissionLogReader reader;
+	long instructions = 0;
+	double lateMs = 0;
+
+	if (reader.read(path) != 0) {
+		std::cout << "FAIL: the log could not be read back" << std::endl;
+		return 1;
+	}
+
+	const MissionLogSummary& summary = reader.getSummary();
+
+	for (int i = 0; i < MISSION_LOG_ACTIONS; i++) {
+		instructions += summary.actions[i].count;
+		lateMs += summary.actions[i].lateMsSum;
+	}
+
+	std::cout << "Mission of " << planned << " instructions: " << summary.records << " records, " << instructions << " instructions, ";
+	std::cout << summary.pauses << " pause, " << summary.pinEdges << " pin edges, " << summary.stateChanges << " state changes, ";
+	std::cout << summary.maxMissionMs / 60000.0 << " min, " << missionLog.getWriteCount() << " write() calls" << std::endl;
+
+	if (summary.missions != 1 || summary.completedMissions != 1 || (size_t) instructions != planned || summary.pauses != 1
+		|| summary.buttonPresses != 2 || summary.stateChanges != 4 || summary.pinEdges == 0 || lateMs != 0 || currentState != IDLE) {
+		std::cout << "FAIL: the log does not match the mission" << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * Function which writes a season of logs, SEASON_DAYS files of about totalBytes together, of made up missions
+ * Return value is the number of records written, -1 if a file could not be written
+ */
+long writeSeason(const std::string& directory, long totalBytes, std::vector<std::string>& files) {
+	const char* actions[] = {"MF", "TL", "MF", "TR"};
+	std::mt19937 random(42);
+	std::uniform_int_distribution<int> jitter(-15, 40);
+	long recordsPerDay = totalBytes / sizeof(MissionRecord) / SEASON_DAYS;
+	long records = 0;
+	long writes = 0;
+	long syncs = 0;
+
+	for (int day = 0; day < SEASON_DAYS; day++) {
+		SimBoard board;
+		MissionLog missionLog(board);
+		std::string path = directory + "/day" + std::to_string(day) + ".mlog";
+
+		if (missionLog.open(path) != 0) {
+			return -1;
+		}
+
+		files.push_back(path);
+
+		while (missionLog.getRecordCount() < recordsPerDay) {
+			missionLog.logMissionStart(MISSION_INSTRUCTIONS);
+			missionLog.logState(IDLE, MOWING);
+
+			for (int i = 0; i < MISSION_INSTRUCTIONS; i++) {
+				Instruction instruction = Instruction{actions[i % 4], i % 2 == 0 ? 4.0 : 90.0, true};
+				int plannedMs = i % 2 == 0 ? 3680 : 1250;
+				int elapsedMs = plannedMs + jitter(random);
+
+				missionLog.logInstructionStart(instruction, plannedMs);
+				missionLog.logPinEdge(24, 1);
+				board.delay(elapsedMs);
+				missionLog.logPinEdge(24, 0);
+				missionLog.logInstructionEnd(instruction, plannedMs, elapsedMs, false);
+			}
+
+			missionLog.logState(MOWING, IDLE);
+			missionLog.logMissionEnd(true);
+		}
+
+		missionLog.close();
+		records += missionLog.getRecordCount();
+		writes += missionLog.getWriteCount();
+		syncs += missionLog.getSyncCount();
+	}
+
+	std::cout << "Season of " << SEASON_DAYS << " days: " << records << " records, " << (double) records / writes;
+	std::cout << " records per write(), " << (double) records / syncs << " records per fsync" << std::endl;
+
+	return records;
+}
+
+/**
+ * main function, runs the mission test and the season benchmark
+ *
+ * @return 0: working properly
+ * @return 1: the log did not match what was written
+ */
+int main (int argc, char* argv[]) {
+	long seasonBytes = (argc > 1 ? std::atol(argv[1]) : 64) * 1000000L;
+	std::string directory = argc > 2 ? argv[2] : "/tmp/mower_mission_log_test";
+	std::vector<std::string> files;
+
+	mkdir(directory.c_str(), 0755);
+
+	if (testMission(directory) != 0) {
+		return 1;
+	}
+
+	long records = writeSeason(directory, seasonBytes, files);
+
+	if (records < 0) {
+		std::cout << "FAIL: could not write to " << directory << std::endl;
+		return 1;
+	}
+
+	MissionLogReader reader;
+	auto start = std::chrono::steady_clock::now();
+
+	for (const std::string& file : files) {
+		reader.read(file);
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	const MissionLogSummary& summary = reader.getSummary();
+	int forward = MissionLogReader::getActionIndex("MF");
+
+	std::cout << "Summarised " << summary.bytes / 1e6 << " MB in " << seconds * 1000 << " ms: " << summary.bytes / 1e9 / seconds;
+	std::cout << " GB/s, " << summary.records / seconds / 1e6 << " M records/s" << std::endl;
+	std::cout << "  " << summary.missions << " missions, MF p50 " << reader.getPercentileMs(forward, 0.5) << " ms, p99 ";
+	std::cout << reader.getPercentileMs(forward, 0.99) << " ms, mean vs plan " << summary.actions[forward].lateMsSum / summary.actions[forward].count << " ms" << std::endl;
+
+	for (const std::string& file : files) {
+		std::remove(file.c_str());
+	}
+
+	if (summary.records != records || summary.completedMissions != summary.missions || reader.getPercentileMs(forward, 0.5) < 3665) {
+		std::cout << "FAIL: the summary does not match the season written" << std::endl;
+		return 1;
+	}
+
+	std::cout << "PASS" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,78 @@
+/**
+ * This file is a command line tool that summarises mission logs written by MissionLog (e.g. copied off the mower's SD card).
+ * It prints the number of missions and how long they took, the pauses and button presses, and per instruction type
+ * how long the instructions took (mean, p50, p95, p99, max) and how far that was from the plan.
+ *
+ * Usage: ./mission_log_tool file...
+ *
+ */
+
+#include "MissionLogReader.h"
+#include <iostream>
+#include <chrono>
+
+/**
+ * main function, reads every file given and prints the summary
+ *
+ * @return 0: every file was read
+ * @return 1: no file given, or a file could not be read
+ */
+int main (int argc, char* argv[]) {
+	MissionLogReader reader;
+	int result = 0;
+
+	if (argc < 2) {
+		std::cout << "Usage: " << argv[0] << " file..." << std::endl;
+		return 1;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (int i = 1; i < argc; i++) {
+		int read = reader.read(argv[i]);
+
+		if (read == -1) {
+			std::cout << argv[i] << ": could not be read" << std::endl;
+			result = 1;
+		} else if (read == -2) {
+			std::cout << argv[i] << ": not a mission log" << std::endl;
+			result = 1;
+		}
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	const MissionLogSummary& summary = reader.getSummary();
+
+	std::cout << summary.files << " files, " << summary.records << " records (" << summary.bytes / 1e6 << " MB) in " << seconds << " s: ";
+	std::cout << summary.bytes / 1e9 / seconds << " GB/s" << std::endl;
+
+	if (summary.unknownRecords > 0) {
+		std::cout << summary.unknownRecords << " records of a newer format skipped" << std::endl;
+	}
+
+	std::cout << "Missions: " << summary.missions << " started, " << summary.completedMissions << " completed, ";
+	std::cout << summary.endedMissions - summary.completedMissions << " stopped early" << std::endl;
+
+	if (summary.endedMissions > 0) {
+		std::cout << "Mission time: mean " << summary.missionMsSum / summary.endedMissions / 60000 << " min, min ";
+		std::cout << summary.minMissionMs / 60000.0 << " min, max " << summary.maxMissionMs / 60000.0 << " min" << std::endl;
+	}
+
+	std::cout << "Pauses: " << summary.pauses << ", state changes: " << summary.stateChanges << ", button presses: ";
+	std::cout << summary.buttonPresses << ", motor pin edges: " << summary.pinEdges << std::endl;
+
+	for (int i = 0; i < MISSION_LOG_ACTIONS; i++) {
+		const ActionSummary& action = summary.actions[i];
+
+		if (action.count == 0) {
+			continue;
+		}
+
+		std::cout << action.action << ": " << action.count << " instructions, " << action.cancelled << " stopped early, mean ";
+		std::cout << action.elapsedMsSum / action.count << " ms, p50 " << reader.getPercentileMs(i, 0.50) << " ms, p95 ";
+		std::cout << reader.getPercentileMs(i, 0.95) << " ms, p99 " << reader.getPercentileMs(i, 0.99) << " ms, max ";
+		std::cout << action.maxMs << " ms, mean vs plan " << action.lateMsSum / action.count << " ms" << std::endl;
+	}
+
+	return result;
+}
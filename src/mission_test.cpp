@@ -0,0 +1,101 @@
+/**
+ * This file tests the MissionBuilder class without any hardware.
+ * It stitches a front/back/side property into one mission, then benchmarks ordering and stitching
+ * on synthetic 100-area properties (transit distance of nearest neighbour vs nearest neighbour + 2-opt, and build time).
+ *
+ */
+
+#include "MissionBuilder.h"
+#include "DriveModel.h"
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <cmath>
+
+const double CAR_DIAMETER = 0.87;
+const double BLADE_DIAMETER = 0.435;
+const int AREAS = 100;
+const double CELL = 25.0; // synthetic areas are scattered one per cell of a 10 x 10 grid
+
+/**
+ * Function which replays a mission through the DriveModel and returns the final pose
+ */
+Pose replay(const Plan& instructions, const Pose& start) {
+	DriveModel model(CAR_DIAMETER);
+	Pose pose = start;
+
+	for (const Instruction& instruction : instructions) {
+		pose = model.applyInstruction(pose, instruction);
+	}
+
+	return pose;
+}
+
+/**
+ * main function, runs the example and the benchmark
+ *
+ * @return 0: working properly
+ */
+int main (void) {
+	// front, back and side lawn of a house at the origin
+	MissionBuilder property(CAR_DIAMETER, BLADE_DIAMETER);
+	property.addArea(MowingArea{-6, -12, 20, 8}); // front
+	property.addArea(MowingArea{-6, 12, 20, 10}); // back
+	property.addArea(MowingArea{16, -4, 5, 14}); // side
+	property.setStartPose(Pose{0, 0, 0});
+	property.setReturnToStart(true);
+	property.build();
+
+	int transitCount = 0;
+
+	for (const Instruction& instruction : property.getInstructions()) {
+		transitCount += instruction.cutting ? 0 : 1;
+	}
+
+	Pose end = replay(property.getInstructions(), Pose{0, 0, 0});
+
+	std::cout << "Front/back/side property: order";
+
+	for (int index : property.getOrder()) {
+		std::cout << " " << index;
+	}
+
+	std::cout << ", " << property.getInstructions().size() << " instructions (" << transitCount << " blade-off), transit ";
+	std::cout << property.getTransitDistance() << " m, ends at (" << end.x << ", " << end.y << ")" << std::endl;
+
+	std::cout << "Synthetic properties with " << AREAS << " areas:" << std::endl;
+
+	for (int seed = 1; seed <= 5; seed++) {
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<double> size(3.0, 15.0);
+		std::uniform_real_distribution<double> offset(0.0, 1.0);
+		MissionBuilder builder(CAR_DIAMETER, BLADE_DIAMETER);
+
+		for (int i = 0; i < AREAS; i++) {
+			double length = size(random);
+			double width = size(random);
+			double x = (i % 10) * CELL + offset(random) * (CELL - length);
+			double y = (i / 10) * CELL + offset(random) * (CELL - width);
+
+			builder.addArea(MowingArea{x, y, length, width});
+		}
+
+		builder.setStartPose(Pose{0, 0, 0});
+		builder.setReturnToStart(true);
+
+		auto start = std::chrono::steady_clock::now();
+		builder.build();
+		auto finish = std::chrono::steady_clock::now();
+		double ms = std::chrono::duration<double, std::milli>(finish - start).count();
+
+		double nearest = builder.getNearestNeighbourDistance();
+		double improved = builder.getTransitDistance();
+		Pose last = replay(builder.getInstructions(), Pose{0, 0, 0});
+
+		std::cout << "  seed " << seed << ": nearest neighbour " << nearest << " m, with 2-opt " << improved << " m (";
+		std::cout << 100 * (nearest - improved) / nearest << "% shorter), " << builder.getInstructions().size() << " instructions, built in ";
+		std::cout << ms << " ms, ends " << std::hypot(last.x, last.y) << " m from the start" << std::endl;
+	}
+
+	return 0;
+}
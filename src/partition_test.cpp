@@ -0,0 +1,106 @@
+/**
+ * This file tests the LawnPartitioner class without any hardware.
+ * For 2 to 32 mowers on a rectangle and on a polygon it prints the makespan, how unevenly the work is spread,
+ * the coverage of all instruction streams together, and how long partitioning and rebalancing after a dropout take.
+ *
+ */
+
+#include "LawnPartitioner.h"
+#include "CoverageGrid.h"
+#include "DriveModel.h"
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+const double CAR_DIAMETER = 0.87;
+const double BLADE_DIAMETER = 0.435;
+const double RESOLUTION = 0.05;
+
+/**
+ * Function which prints one row of the report
+ * The lawn is [0, sizeX] x [0, sizeY] without the corner x > notchX, y > notchY
+ */
+void report(LawnPartitioner& partitioner, double sizeX, double sizeY, double notchX, double notchY, int mowers) {
+	// mowers wait along the left edge, spread over the lawn, facing in
+	for (int i = 0; i < mowers; i++) {
+		partitioner.addMower(i, Pose{0.5, sizeY * (i + 0.5) / mowers, 0});
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	partitioner.partition();
+	auto end = std::chrono::steady_clock::now();
+	double partitionMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+	double fastest = HUGE_VAL;
+	double slowest = 0;
+	CoverageGrid grid(sizeX, sizeY, RESOLUTION);
+	DriveModel model(CAR_DIAMETER);
+	std::vector<Pose> starts;
+
+	for (int i = 0; i < mowers; i++) {
+		starts.push_back(Pose{0.5, sizeY * (i + 0.5) / mowers, 0});
+	}
+
+	for (MowerAssignment& assignment : partitioner.getAssignments()) {
+		double seconds = assignment.transitSeconds + assignment.mowingSeconds;
+		fastest = std::min(fastest, seconds);
+		slowest = std::max(slowest, seconds);
+		grid.sweepPlan(assignment.instructions, starts[assignment.mowerId], BLADE_DIAMETER, model);
+	}
+
+	// coverage of the lawn itself, the grid also holds the notch
+	long lawnCells = 0;
+	long coveredCells = 0;
+
+	for (double x = RESOLUTION / 2; x < sizeX; x += RESOLUTION) {
+		for (double y = RESOLUTION / 2; y < sizeY; y += RESOLUTION) {
+			if (x <= notchX || y <= notchY) {
+				lawnCells++;
+				coveredCells += grid.isCovered(x, y) ? 1 : 0;
+			}
+		}
+	}
+
+	start = std::chrono::steady_clock::now();
+	partitioner.removeMower(mowers / 2);
+	end = std::chrono::steady_clock::now();
+	double rebalanceMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+	std::cout << "  " << mowers << " mowers: makespan " << slowest / 60 << " min, imbalance " << (slowest - fastest)  << " s, coverage ";
+	std::cout << 100.0 * coveredCells / lawnCells << "%, partition " << partitionMs << " ms, rebalance after dropout " << rebalanceMs;
+	std::cout << " ms (makespan " << partitioner.getMakespan() / 60 << " min)" << std::endl;
+}
+
+/**
+ * main function, runs the report
+ *
+ * @return 0: working properly
+ */
+int main (void) {
+	const int MOWERS[] = {2, 4, 8, 16, 32};
+
+	std::cout << "40 x 30 m rectangle" << std::endl;
+
+	for (int mowers : MOWERS) {
+		LawnPartitioner partitioner(40, 30, CAR_DIAMETER, BLADE_DIAMETER);
+		report(partitioner, 40, 30, 40, 30, mowers);
+	}
+
+	std::cout << "40 x 30 m L-shaped polygon" << std::endl;
+
+	for (int mowers : MOWERS) {
+		LawnPartitioner partitioner({{0, 0}, {40, 0}, {40, 12}, {15, 12}, {15, 30}, {0, 30}}, CAR_DIAMETER, BLADE_DIAMETER);
+		report(partitioner, 40, 30, 15, 12, mowers);
+	}
+
+	LawnPartitioner partitioner(40, 30, CAR_DIAMETER, BLADE_DIAMETER);
+
+	for (int i = 0; i <= MAX_MOWERS; i++) {
+		partitioner.addMower(i, Pose{0, 0, 0});
+	}
+
+	std::cout << "Adding mower " << MAX_MOWERS + 1 << ": error " << partitioner.getErrorNum() << std::endl;
+
+	return 0;
+}
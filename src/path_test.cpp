@@ -4,5 +4,22 @@
 int main (void) {
 	Path path1(4.5, 4.5, 2.0, 1.0);
 
+	// the strips of this lawn would be -0.5 m long, so it gets no plan instead of negative moves
+	if (path1.generate() != -1 || !path1.getInstructions().empty()) {
+		std::cout << "FAIL: a 4.5 x 4.5 lawn with a 2 m mower got a plan" << std::endl;
+		return 1;
+	}
+
+	Path path2(3.0, 3.0, 0.87, 0.435, false);
+
+	for (const Instruction& instruction : path2.getInstructions()) {
+		if (instruction.value < 0) {
+			std::cout << "FAIL: " << instruction.action << instruction.value << " in the 3 x 3 plan" << std::endl;
+			return 1;
+		}
+	}
+
+	std::cout << "PASS" << std::endl;
+
 	return 0;
 }
@@ -0,0 +1,85 @@
+/**
+ * This file tests the PlanSearch class and ThreadPool without any hardware.
+ * It prints the best plan found for a lawn, checks that the deadline is respected,
+ * and reports how well the search scales from 1 to N threads.
+ *
+ */
+
+#include "PlanSearch.h"
+#include "ThreadPool.h"
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <cmath>
+
+const char* PATTERN_NAMES[] = {"boustrophedon", "inward spiral", "perimeter first"};
+
+/**
+ * main function, runs the search report and scaling benchmark
+ *
+ * @return 0: working properly
+ * @return -1: search failed
+ */
+int main (void) {
+	const double LENGTH = 12.0;
+	const double WIDTH = 8.0;
+	const double CAR_DIAMETER = 0.87;
+	const double BLADE_DIAMETER = 0.435;
+	const int ROUNDS = 5;
+	int maxThreads = std::max(1, (int) std::thread::hardware_concurrency());
+
+	{
+		ThreadPool pool(0);
+		PlanSearch search(LENGTH, WIDTH, CAR_DIAMETER, BLADE_DIAMETER, pool);
+
+		search.setStartPose(Pose{LENGTH, 0, M_PI}); // mower is parked in the bottom right corner
+
+		if (search.search(10000) != 0) {
+			std::cout << "Search failed" << std::endl;
+			return -1;
+		}
+
+		PlanCandidate best = search.getBestCandidate();
+		PlanScore score = search.getBestScore();
+
+		std::cout << "best of " << search.getScoredCount() << " candidates: " << PATTERN_NAMES[best.pattern];
+		std::cout << ", strips along " << (best.stripAxis == 0 ? "x" : "y") << ", corner " << best.startCorner << ", overlap " << best.overlap << std::endl;
+		std::cout << "  " << score.seconds << " s, coverage " << score.coveragePercent << "%, overlap " << score.overlapPercent << "%" << std::endl;
+
+		// a 1 ms deadline cannot score everything
+		search.search(1);
+		std::cout << "candidates scored with a 1 ms deadline: " << search.getScoredCount() << std::endl;
+	}
+
+	std::cout << "\nthreads  time (ms)  speedup  efficiency  steals" << std::endl;
+
+	double baseline = 0;
+
+	for (int threads = 1; threads <= maxThreads; threads *= 2) {
+		ThreadPool pool(threads);
+		PlanSearch search(LENGTH, WIDTH, CAR_DIAMETER, BLADE_DIAMETER, pool);
+
+		search.search(60000); // warm up the per-worker grids
+
+		auto start = std::chrono::steady_clock::now();
+
+		for (int i = 0; i < ROUNDS; i++) {
+			search.search(60000);
+		}
+
+		auto end = std::chrono::steady_clock::now();
+		double ms = std::chrono::duration<double, std::milli>(end - start).count() / ROUNDS;
+
+		if (threads == 1) {
+			baseline = ms;
+		}
+
+		std::cout << threads << "        " << ms << "      " << baseline / ms << "      " << baseline / ms / threads * 100 << "%      " << pool.getStealCount() << std::endl;
+
+		if (threads < maxThreads && threads * 2 > maxThreads) {
+			threads = maxThreads / 2; // make sure the last row is all cores
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,321 @@
+/**
+ * This file tests the PlanTextWriter and PlanTextReader without any hardware.
+ * A generated plan (with some blade-off legs and values that need every digit) is exported and imported and must come
+ * back bit for bit, hand written text with comments, spaces and "\r\n" must read as expected, and malformed lines must be
+ * refused with their line number and the plan left as it was. Then the benchmark: a plan of millions of instructions is
+ * exported and imported into a PlanArena, and the MB/s of both are printed next to a std::getline/std::stod import.
+ * The import into a warm arena must not touch the heap (operator new is replaced by one that counts every call).
+ *
+ * Usage: ./test [instructions]
+ *
+ */
+
+#include "Instruction.h"
+#include "Path.h"
+#include "PlanArena.h"
+#include "PlanTextReader.h"
+#include "PlanTextWriter.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <unistd.h>
+
+const char PLAN_PATH[] = "/tmp/nomo_plan_text_test.txt";
+const double CAR_DIAMETER = 0.87;
+const double BLADE_DIAMETER = 0.435;
+
+std::atomic<long> allocationCount(0);
+
+void* operator new(size_t bytes) {
+	allocationCount++;
+	void* pointer = std::malloc(bytes > 0 ? bytes : 1);
+
+	if (pointer == nullptr) {
+		throw std::bad_alloc();
+	}
+
+	return pointer;
+}
+
+// the default memory resource of a Plan allocates with the aligned form
+void* operator new(size_t bytes, std::align_val_t alignment) {
+	allocationCount++;
+	void* pointer = std::aligned_alloc(static_cast<size_t>(alignment), (bytes + static_cast<size_t>(alignment) - 1) / static_cast<size_t>(alignment) * static_cast<size_t>(alignment));
+
+	if (pointer == nullptr) {
+		throw std::bad_alloc();
+	}
+
+	return pointer;
+}
+
+void operator delete(void* pointer) noexcept {
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept {
+	std::free(pointer);
+}
+
+/**
+ * Function which compares two plans, values bit for bit
+ * @return the index of the first instruction that differs, -1 if the plans are the same
+ */
+long comparePlans(const Plan& expected, const Plan& actual) {
+	for (size_t i = 0; i < expected.size() && i < actual.size(); i++) {
+		if (expected[i].action != actual[i].action || memcmp(&expected[i].value, &actual[i].value, sizeof(double)) != 0
+			|| expected[i].cutting != actual[i].cutting || expected[i].durationMs != actual[i].durationMs) {
+			return i;
+		}
+	}
+
+	return expected.size() == actual.size() ? -1 : std::min(expected.size(), actual.size());
+}
+
+/**
+ * Function which builds a plan out of generated paths for lawns of different sizes, with every fifth leg blade off
+ */
+void buildPlan(size_t instructions, Plan& plan) {
+	for (int lawn = 0; plan.size() < instructions; lawn++) {
+		Path path(8 + lawn % 37 * 1.37, 6 + lawn % 23 * 0.91, CAR_DIAMETER, BLADE_DIAMETER, false);
+
+		for (const Instruction& instruction : path.getInstructions()) {
+			if (plan.size() == instructions) {
+				break;
+			}
+
+			plan.push_back(instruction);
+			plan.back().cutting = plan.size() % 5 != 0;
+		}
+	}
+}
+
+/**
+ * Function which exports and imports a plan with values that need every digit
+ * @return the number of failed checks
+ */
+int checkRoundTrip() {
+	Plan plan;
+	Plan imported;
+	PlanTextWriter writer;
+	PlanTextReader reader;
+	const double values[] = {0, 90, 2.13, 0.1 + 0.2, 1.0 / 3, 1e-300, 4.9406564584124654e-324, 123456789.123456789, 1.7976931348623157e308};
+
+	buildPlan(500, plan);
+
+	for (double value : values) {
+		Instruction instruction;
+		instruction.action = ActionCode("MF");
+		instruction.value = value;
+		plan.push_back(instruction);
+	}
+
+	plan.back().action = ActionCode("CH");
+
+	if (writer.open(PLAN_PATH) != 0 || writer.writeComment("round trip") != 0 || writer.writePlan(plan) != 0 || writer.close() != 0) {
+		std::cout << "FAIL: could not write " << PLAN_PATH << std::endl;
+		return 1;
+	}
+
+	int result = reader.read(PLAN_PATH, imported);
+	long differs = comparePlans(plan, imported);
+
+	std::cout << "Round trip: " << plan.size() << " instructions in " << writer.getByteCount() << " bytes, ";
+	std::cout << (result == 0 && differs < 0 ? "read back unchanged" : "NOT read back unchanged") << std::endl;
+
+	if (result != 0 || differs >= 0) {
+		std::cout << "FAIL: read returned " << result << " (line " << reader.getErrorLine() << "), first difference at " << differs << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * Function which reads hand written text and malformed lines
+ * @return the number of failed checks
+ */
+int checkFormat() {
+	struct Malformed {
+		const char* text;
+		long line;
+	};
+
+	const char text[] = "# plan for the front lawn\n\nMF2.13\r\n  TR90  \n\tMB0.435 off\r\n# back to the start\nTL90 1450ms\nCH1.5e1";
+	const Malformed malformed[] = {
+		{"MF1\nMX2\n", 2}, {"MF\n", 1}, {"MF 2\n", 1}, {"MF-2\n", 1}, {"MF-0\n", 1}, {"MFnan\n", 1}, {"MFinf\n", 1},
+		{"MF2x\n", 1}, {"MF2 of\n", 1}, {"MF2 offf\n", 1}, {"# ok\nTR90\nmf2\n", 3}, {"MF2\nMF3\r\rMF4\n", 2},
+		{"TL90 1450\n", 1}, {"TL90 1450s\n", 1}, {"TL90 off 1450ms\n", 1}
+	};
+	Plan plan;
+	PlanTextReader reader;
+	int failures = 0;
+
+	if (reader.parse(text, strlen(text), plan) != 0 || plan.size() != 5 || plan[0].action != "MF" || plan[0].value != 2.13
+		|| !plan[0].cutting || plan[1].action != "TR" || plan[1].value != 90 || plan[2].action != "MB" || plan[2].value != 0.435
+		|| plan[2].cutting || plan[3].action != "TL" || plan[3].durationMs != 1450 || plan[1].durationMs != 0 || plan[4].action != "CH" || plan[4].value != 15 || reader.getLineCount() != 8) {
+		std::cout << "FAIL: hand written plan read as " << plan.size() << " instructions" << std::endl;
+		failures++;
+	}
+
+	for (const Malformed& line : malformed) {
+		if (reader.parse(line.text, strlen(line.text), plan) != -2 || reader.getErrorLine() != line.line || plan.size() != 5) {
+			std::cout << "FAIL: \"" << line.text << "\" stopped at line " << reader.getErrorLine() << ", plan of " << plan.size() << std::endl;
+			failures++;
+		}
+	}
+
+	if (reader.read("/tmp/nomo_no_such_plan.txt", plan) != -1) {
+		failures++;
+	}
+
+	std::cout << "Format: comments, blank lines, spaces, \"\\r\\n\" and blade-off legs read, " << sizeof(malformed) / sizeof(malformed[0]);
+	std::cout << " malformed texts " << (failures == 0 ? "refused at the right line" : "NOT refused as expected") << std::endl;
+
+	return failures;
+}
+
+/**
+ * Function which imports a plan file the simple way, for comparison: a std::string per line and std::stod
+ * Return value is the number of instructions read
+ */
+long readWithStreams(Plan& plan) {
+	std::ifstream file(PLAN_PATH);
+	std::string line;
+
+	while (std::getline(file, line)) {
+		if (line.empty() || line[0] == '#') {
+			continue;
+		}
+
+		Instruction instruction;
+		size_t length;
+		instruction.action = ActionCode(line.c_str());
+		instruction.value = std::stod(line.substr(2), &length);
+		instruction.cutting = line.find(" off", 2 + length) == std::string::npos;
+
+		if (line.find("ms", 2 + length) != std::string::npos) {
+			instruction.durationMs = std::stoi(line.substr(2 + length));
+		}
+
+		plan.push_back(instruction);
+	}
+
+	return plan.size();
+}
+
+/**
+ * Function which times the export and import of a large plan
+ * @return the number of failed checks
+ */
+int benchmark(size_t instructions) {
+	Plan plan;
+	PlanTextWriter writer;
+	PlanTextReader reader;
+	PlanArena arena(4 * 1024 * 1024);
+	std::string path(PLAN_PATH);
+	int failures = 0;
+
+	buildPlan(instructions, plan);
+
+	auto start = std::chrono::steady_clock::now();
+
+	if (writer.open(PLAN_PATH) != 0 || writer.writePlan(plan) != 0 || writer.close() != 0) {
+		std::cout << "FAIL: could not write " << PLAN_PATH << std::endl;
+		return 1;
+	}
+
+	double writeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	double megabytes = writer.getByteCount() / 1e6;
+	double readSeconds = 0;
+	long allocations = 0;
+	long differs = 0;
+
+	// the first round grows the arena, the second one must not allocate
+	for (int round = 0; round < 2; round++) {
+		arena.reset();
+
+		Plan imported(arena.getResource());
+		long before = allocationCount.load();
+
+		start = std::chrono::steady_clock::now();
+
+		if (reader.read(path, imported) != 0) {
+			std::cout << "FAIL: could not read " << PLAN_PATH << " (line " << reader.getErrorLine() << ")" << std::endl;
+			return 1;
+		}
+
+		readSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		allocations = allocationCount.load() - before;
+		differs = comparePlans(plan, imported);
+	}
+
+	Plan streamed;
+	start = std::chrono::steady_clock::now();
+	readWithStreams(streamed);
+	double streamSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << "Benchmark: " << plan.size() << " instructions, " << megabytes << " MB" << std::endl;
+	std::cout << "  export: " << megabytes / writeSeconds << " MB/s, " << plan.size() / writeSeconds / 1e6 << " M instructions/s" << std::endl;
+	std::cout << "  import: " << megabytes / readSeconds << " MB/s, " << plan.size() / readSeconds / 1e6 << " M instructions/s, ";
+	std::cout << allocations << " allocations into a warm arena" << std::endl;
+	std::cout << "  getline/stod import: " << megabytes / streamSeconds << " MB/s (" << streamSeconds / readSeconds << "x slower)" << std::endl;
+
+	if (differs >= 0 || comparePlans(plan, streamed) >= 0) {
+		std::cout << "FAIL: the plan read back differs at instruction " << differs << std::endl;
+		failures++;
+	}
+
+	if (allocations != 0) {
+		std::cout << "FAIL: the import allocated" << std::endl;
+		failures++;
+	}
+
+	if (megabytes / readSeconds < 100) {
+		std::cout << "FAIL: import slower than 100 MB/s" << std::endl;
+		failures++;
+	}
+
+	return failures;
+}
+
+/**
+ * main function, runs the checks and the benchmark
+ *
+ * @return 0: working properly
+ * @return 1: a plan did not read back as written, or the import was too slow or allocated
+ */
+int main (int argc, char* argv[]) {
+	size_t instructions = argc > 1 ? atol(argv[1]) : 4000000;
+	int failures = 0;
+
+	failures += checkRoundTrip();
+	failures += checkFormat();
+	failures += benchmark(instructions);
+
+	unlink(PLAN_PATH);
+
+	if (failures > 0) {
+		std::cout << "FAIL" << std::endl;
+		return 1;
+	}
+
+	std::cout << "PASS" << std::endl;
+
+	return 0;
+}
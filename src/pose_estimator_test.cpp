@@ -0,0 +1,63 @@
+/**
+ * This file tests the PoseEstimator class without any hardware.
+ * It checks that dead reckoning a square lands back near the start, and measures the cost of one filter step
+ * (predict + encoder + gyro update), which has to fit comfortably in the 1 ms budget of the 1 kHz loop.
+ *
+ */
+
+#include "PoseEstimator.h"
+#include <iostream>
+#include <chrono>
+#include <cmath>
+
+/**
+ * main function, runs the check and benchmark
+ *
+ * @return 0: working properly
+ * @return -1: estimate drifted too far
+ */
+int main (void) {
+	const double WHEEL_BASE = 0.87;
+	PoseEstimator estimator(WHEEL_BASE);
+	DriveModel& model = estimator.getDriveModel();
+
+	// drive a 2 m square with left pivots (900 ms per 90 degrees, as in the default calibration)
+	Pose expected = Pose{0, 0, 0};
+
+	for (int side = 0; side < 4; side++) {
+		estimator.integrate(DRIVE_SPEED, DRIVE_SPEED, (int) (2 * DRIVE_MS_PER_METRE));
+		estimator.integrate(0, model.getTurnWheelSpeed(90, 900), 900);
+
+		expected = model.applyInstruction(expected, Instruction{"MF", 2});
+		expected = model.applyInstruction(expected, Instruction{"TL", 90});
+	}
+
+	Pose pose = estimator.getPose();
+	double error = std::hypot(pose.x - expected.x, pose.y - expected.y);
+
+	std::cout << "square: estimate (" << pose.x << ", " << pose.y << ", " << pose.theta * 180 / M_PI << " deg)";
+	std::cout << " model (" << expected.x << ", " << expected.y << ", " << expected.theta * 180 / M_PI << " deg)";
+	std::cout << " error " << error << " m, variance " << estimator.getPositionVariance() << std::endl;
+
+	if (error > 0.05) {
+		std::cout << "Estimate drifted too far from the drive model" << std::endl;
+		return -1;
+	}
+
+	// cost per 1 kHz step: predict from the wheel command, correct with encoders and gyro
+	const int STEPS = 1000000;
+	auto start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < STEPS; i++) {
+		estimator.predict(DRIVE_SPEED, DRIVE_SPEED * 0.9, 0.001);
+		estimator.updateEncoders(DRIVE_SPEED, DRIVE_SPEED * 0.9);
+		estimator.updateGyro(-0.1 * DRIVE_SPEED / WHEEL_BASE);
+	}
+
+	auto end = std::chrono::steady_clock::now();
+	double ns = std::chrono::duration<double, std::nano>(end - start).count() / STEPS;
+
+	std::cout << "step cost: " << ns << " ns/step (" << ns / 10000.0 << "% of one core at 1 kHz)" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,214 @@
+/**
+ * This file tests the preset plans of PresetPlan.h without any hardware.
+ * For lawns of different sizes and shapes (both ends of the serpentine, the short side given as length or width)
+ * the plan the compiler built must be the plan Path generates at runtime, bit for bit, cutting flags and measured turn times included.
+ * The compile time checks are tested with static_assert: lawns the mower cannot mow must be refused.
+ * Then the start up cost: Path::generate() against Path::usePreset() for the default lawn of thread_test.
+ *
+ * Usage: ./test [repeats]
+ *
+ */
+
+#include "Instruction.h"
+#include "Path.h"
+#include "PresetPlan.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+constexpr double CAR_DIAMETER = 0.87;
+constexpr double BLADE_DIAMETER = 0.435;
+
+// the lawn of thread_test
+struct DefaultLawn {
+	static constexpr double length = 3.0;
+	static constexpr double width = 3.0;
+	static constexpr double carDiameter = CAR_DIAMETER;
+	static constexpr double bladeDiameter = BLADE_DIAMETER;
+};
+
+struct LongLawn {
+	static constexpr double length = 4.0;
+	static constexpr double width = 3.0;
+	static constexpr double carDiameter = CAR_DIAMETER;
+	static constexpr double bladeDiameter = BLADE_DIAMETER;
+};
+
+struct WideLawn {
+	static constexpr double length = 3.3;
+	static constexpr double width = 5.2;
+	static constexpr double carDiameter = CAR_DIAMETER;
+	static constexpr double bladeDiameter = BLADE_DIAMETER;
+};
+
+struct EvenLawn {
+	static constexpr double length = 10.0;
+	static constexpr double width = 7.5;
+	static constexpr double carDiameter = CAR_DIAMETER;
+	static constexpr double bladeDiameter = BLADE_DIAMETER;
+};
+
+struct FrontLawn {
+	static constexpr double length = 20.0;
+	static constexpr double width = 15.0;
+	static constexpr double carDiameter = CAR_DIAMETER;
+	static constexpr double bladeDiameter = BLADE_DIAMETER;
+};
+
+// too narrow for the mower
+struct NarrowLawn {
+	static constexpr double length = 5.0;
+	static constexpr double width = 0.8;
+	static constexpr double carDiameter = CAR_DIAMETER;
+	static constexpr double bladeDiameter = BLADE_DIAMETER;
+};
+
+// the blade is as wide as the mower, so there is no reverse between strips
+struct WideBladeLawn {
+	static constexpr double length = 5.0;
+	static constexpr double width = 4.0;
+	static constexpr double carDiameter = CAR_DIAMETER;
+	static constexpr double bladeDiameter = CAR_DIAMETER;
+};
+
+// the serpentine's strips are shorter than the blade is wide
+struct ShortLawn {
+	static constexpr double length = 2.0;
+	static constexpr double width = 2.0;
+	static constexpr double carDiameter = CAR_DIAMETER;
+	static constexpr double bladeDiameter = BLADE_DIAMETER;
+};
+
+static_assert(checkPresetPlan<DefaultLawn>() == PRESET_PLAN_OK, "the default lawn is a valid preset");
+static_assert(checkPresetPlan<FrontLawn>() == PRESET_PLAN_OK, "a large lawn is a valid preset");
+static_assert(checkPresetPlan<NarrowLawn>() == PRESET_LAWN_TOO_SMALL, "a lawn narrower than the mower is refused");
+static_assert(checkPresetPlan<WideBladeLawn>() == PRESET_BAD_INSTRUCTION, "a zero length reverse is refused");
+static_assert(checkPresetPlan<ShortLawn>() == PRESET_BAD_INSTRUCTION, "a negative strip is refused");
+static_assert(PresetPlanTable<DefaultLawn>::instructions.size() == 25, "the default lawn has five strips");
+static_assert(PresetPlanTable<DefaultLawn>::instructions[0].value == DefaultLawn::width - CAR_DIAMETER, "the plan starts up the short side");
+
+/**
+ * Function which compares the preset plan of a lawn with the plan Path generates for it
+ * @return the number of failed checks
+ */
+template <class Lawn>
+int checkPreset(const char* name) {
+	Path generated(Lawn::length, Lawn::width, CAR_DIAMETER, Lawn::bladeDiameter, false);
+	Path preset(1, 1, CAR_DIAMETER, Lawn::bladeDiameter, false, false);
+	const Plan& expected = generated.getInstructions();
+	int loaded = preset.usePreset<Lawn>();
+	const Plan& actual = preset.getInstructions();
+	long differs = -1;
+	int blades = 0;
+
+	for (size_t i = 0; i < expected.size() && i < actual.size(); i++) {
+		if (differs < 0 && (expected[i].action != actual[i].action || memcmp(&expected[i].value, &actual[i].value, sizeof(double)) != 0
+			|| expected[i].cutting != actual[i].cutting || expected[i].durationMs != actual[i].durationMs)) {
+			differs = i;
+		}
+
+		blades += actual[i].cutting ? 0 : 1;
+	}
+
+	Pose start = preset.getStartPose();
+	Pose generatedStart = generated.getStartPose();
+	bool same = loaded == 0 && differs < 0 && expected.size() == actual.size() && preset.getLength() == Lawn::length && preset.getWidth() == Lawn::width
+		&& memcmp(&start, &generatedStart, sizeof(Pose)) == 0;
+
+	std::cout << name << " " << Lawn::length << " x " << Lawn::width << ": " << actual.size() << " instructions (" << blades << " blade off), ";
+	std::cout << sizeof(PresetPlanTable<Lawn>::instructions) << " bytes, " << (same ? "same as generated" : "NOT same as generated") << std::endl;
+
+	if (!same) {
+		if (differs >= 0) {
+			std::cout << "FAIL: instruction " << differs << " is " << actual[differs].action << actual[differs].value << (actual[differs].cutting ? "" : " off");
+			std::cout << ", generated " << expected[differs].action << expected[differs].value << (expected[differs].cutting ? "" : " off") << std::endl;
+		} else {
+			std::cout << "FAIL: " << actual.size() << " instructions, generated " << expected.size() << std::endl;
+		}
+
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * Function which checks that a preset is refused by a path for a different mower, and left as it was
+ * @return the number of failed checks
+ */
+int checkMismatch() {
+	Path path(DefaultLawn::length, DefaultLawn::width, 0.9, BLADE_DIAMETER, false);
+	size_t size = path.getInstructions().size();
+	int result = path.usePreset<DefaultLawn>();
+
+	std::cout << "Preset for a different mower: " << (result == -1 && path.getInstructions().size() == size ? "refused" : "NOT refused") << std::endl;
+
+	if (result != -1 || path.getInstructions().size() != size) {
+		std::cout << "FAIL: the preset of a 0.87 m mower was loaded into the path of a 0.9 m mower" << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * Function which times generating the default plan at start up against loading its preset
+ * @return the number of failed checks
+ */
+int benchmark(int repeats) {
+	Path path(DefaultLawn::length, DefaultLawn::width, CAR_DIAMETER, BLADE_DIAMETER, false, false);
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < repeats; i++) {
+		path.generate();
+	}
+
+	double generateUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / repeats;
+
+	start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < repeats; i++) {
+		path.usePreset<DefaultLawn>();
+	}
+
+	double presetUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / repeats;
+
+	std::cout << "Default plan at start up: generated in " << generateUs << " us, preset loaded in " << presetUs << " us (";
+	std::cout << generateUs / presetUs << "x)" << std::endl;
+
+	if (presetUs >= generateUs) {
+		std::cout << "FAIL: loading the preset is no faster than generating the plan" << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * Function main, checks the preset plans against generated ones and times them
+ * @return 0: every check passed
+ * @return 1: a preset differs from the generated plan, was loaded for the wrong mower or is not faster
+ */
+int main (int argc, char* argv[]) {
+	int repeats = argc > 1 ? atoi(argv[1]) : 2000;
+	int failures = 0;
+
+	failures += checkPreset<DefaultLawn>("Default lawn");
+	failures += checkPreset<LongLawn>("Long lawn");
+	failures += checkPreset<WideLawn>("Wide lawn");
+	failures += checkPreset<EvenLawn>("Even lawn");
+	failures += checkPreset<FrontLawn>("Front lawn");
+	failures += checkMismatch();
+	failures += benchmark(repeats > 0 ? repeats : 1);
+
+	if (failures > 0) {
+		std::cout << "FAIL" << std::endl;
+		return 1;
+	}
+
+	std::cout << "PASS" << std::endl;
+
+	return 0;
+}
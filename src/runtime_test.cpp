@@ -0,0 +1,219 @@
+/**
+ * This file compares the two runtimes without any hardware: the button and execution threads (as in thread_test.cpp)
+ * and the single threaded ReactorRuntime. Both run the same mower on a SimBoard in real time mode while a script
+ * presses start, pause, resume and then shutdown while the mower is in the middle of an instruction. It prints the CPU used,
+ * the time from each press to the state change, and the time from the shutdown press to every motor pin being LOW
+ * and to the runtime returning.
+ *
+ * Usage: ./test [seconds mowing before the first pause]
+ *
+ */
+
+#include "State.h"
+#include "Path.h"
+#include "Motor.h"
+#include "WheelController.h"
+#include "BladeController.h"
+#include "ButtonController.h"
+#include "ExecutionController.h"
+#include "ReactorRuntime.h"
+#include "SimBoard.h"
+#include "CancellationToken.h"
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <sys/resource.h>
+
+const int START_PIN = 29;
+const int INPUT_PIN = 1;
+const int UP_PIN = 4;
+const int DOWN_PIN = 28;
+const double CAR_DIAMETER = 0.87;
+const double BLADE_DIAMETER = 0.435;
+const int MOTOR_PINS[] = {24, 23, 21, 22, 2, 3};
+
+struct RuntimeResult {
+	double wallSeconds;
+	double cpuSeconds; // used by the runtime's threads, not the script
+	double meanPressMs; // press to state change
+	double maxPressMs;
+	double motorsStoppedMs; // shutdown press to every motor pin LOW
+	double shutdownMs; // shutdown press to the runtime returning
+	bool wasMoving; // a motor was on when shutdown was pressed
+};
+
+/**
+ * Function which returns the CPU time (user + system) in seconds of the process or of the calling thread
+ */
+double getCpuSeconds(int who) {
+	rusage usage;
+
+	getrusage(who, &usage);
+
+	return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+/**
+ * Function which presses and releases a button and returns how long (ms) it took the runtime to leave the old state
+ */
+double press(SimBoard& board, int pin, State& currentState) {
+	State before = currentState;
+	auto start = std::chrono::steady_clock::now();
+
+	board.setInput(pin, 0); // buttons pull the pin LOW
+
+	while (currentState == before && std::chrono::steady_clock::now() - start < std::chrono::seconds(2)) {
+		std::this_thread::sleep_for(std::chrono::microseconds(50));
+	}
+
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	board.setInput(pin, 1);
+
+	return ms;
+}
+
+/**
+ * Function which returns whether any motor pin is HIGH
+ */
+bool motorsOn(SimBoard& board) {
+	for (int pin : MOTOR_PINS) {
+		if (board.digitalRead(pin) == 1) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Function which runs one runtime through the script
+ *
+ * @param reactor: true for ReactorRuntime, false for the two threads
+ * @param mowSeconds: how long to mow before pausing
+ */
+RuntimeResult runScript(bool reactor, double mowSeconds) {
+	SimBoard board;
+	State currentState = IDLE;
+	Path path(3.0, 3.0, CAR_DIAMETER, BLADE_DIAMETER, false);
+
+	board.setRealTime(true);
+
+	for (int pin : {START_PIN, INPUT_PIN, UP_PIN, DOWN_PIN}) {
+		board.setInput(pin, 1); // released
+	}
+
+	Motor leftWheelMotor(24, 23, board);
+	Motor rightWheelMotor(21, 22, board);
+	Motor bladeMotor(2, 3, board);
+	CancellationToken shutdown;
+	WheelController wheelControl(leftWheelMotor, rightWheelMotor);
+	wheelControl.setCancellationToken(shutdown);
+	BladeController bladeControl(bladeMotor);
+	ExecutionController exec(currentState, path, wheelControl, bladeControl, board);
+	exec.setVerbose(false);
+	exec.setCancellationToken(shutdown);
+
+	ButtonController btn(START_PIN, INPUT_PIN, UP_PIN, DOWN_PIN, currentState, path, exec, board);
+	btn.setCancellationToken(shutdown);
+	RuntimeResult result = RuntimeResult{0, 0, 0, 0, 0, 0, false};
+	std::vector<double> pressMs;
+	std::chrono::steady_clock::time_point shutdownPress;
+	double scriptCpu = 0;
+
+	// the script runs on its own thread, the runtime on this one (the reactor) or two more (the threads)
+	std::thread script([&]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(500));
+		pressMs.push_back(press(board, START_PIN, currentState)); // IDLE -> MOWING
+		std::this_thread::sleep_for(std::chrono::milliseconds((int) (mowSeconds * 1000)));
+		pressMs.push_back(press(board, INPUT_PIN, currentState)); // MOWING -> PAUSED
+		std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+		pressMs.push_back(press(board, INPUT_PIN, currentState)); // PAUSED -> MOWING
+		std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+
+		// shutdown while mowing, wait for a move so the motors have to be stopped part way through it
+		while (!motorsOn(board)) {
+			std::this_thread::sleep_for(std::chrono::microseconds(50));
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		result.wasMoving = motorsOn(board);
+		shutdownPress = std::chrono::steady_clock::now();
+		board.setInput(DOWN_PIN, 0);
+
+		while (motorsOn(board) && std::chrono::steady_clock::now() - shutdownPress < std::chrono::seconds(5)) {
+			std::this_thread::yield();
+		}
+
+		result.motorsStoppedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - shutdownPress).count();
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		board.setInput(DOWN_PIN, 1);
+		scriptCpu = getCpuSeconds(RUSAGE_THREAD);
+	});
+
+	double cpuStart = getCpuSeconds(RUSAGE_SELF);
+	auto wallStart = std::chrono::steady_clock::now();
+
+	if (reactor) {
+		ReactorRuntime runtime(btn, exec, board);
+		runtime.run();
+
+		LatencyStats latency = runtime.getLatency();
+		std::cout << "  reactor event latency: mean " << latency.meanUs << " us, max " << latency.maxUs << " us over " << latency.count << " events" << std::endl;
+	} else {
+		btn.setupInputs();
+
+		std::thread buttonThread(&ButtonController::startInputListener, &btn);
+		std::thread execThread(&ExecutionController::startExecutionListener, &exec);
+
+		execThread.join();
+		buttonThread.join();
+	}
+
+	auto wallFinish = std::chrono::steady_clock::now();
+	script.join();
+
+	result.wallSeconds = std::chrono::duration<double>(wallFinish - wallStart).count();
+	result.cpuSeconds = getCpuSeconds(RUSAGE_SELF) - cpuStart - scriptCpu;
+	result.shutdownMs = std::chrono::duration<double, std::milli>(wallFinish - shutdownPress).count();
+
+	for (double ms : pressMs) {
+		result.meanPressMs += ms / pressMs.size();
+		result.maxPressMs = std::max(result.maxPressMs, ms);
+	}
+
+	return result;
+}
+
+/**
+ * Function which prints the result of one runtime
+ */
+void printResult(const char* name, const RuntimeResult& result) {
+	std::cout << name << ": " << result.wallSeconds << " s, CPU " << result.cpuSeconds << " s (";
+	std::cout << 100 * result.cpuSeconds / result.wallSeconds << "% of one core), press to state change mean ";
+	std::cout << result.meanPressMs << " ms, max " << result.maxPressMs << " ms" << std::endl;
+	std::cout << "  shutdown" << (result.wasMoving ? " while moving" : "") << ": motors stopped after " << result.motorsStoppedMs;
+	std::cout << " ms, runtime returned after " << result.shutdownMs << " ms" << std::endl;
+}
+
+/**
+ * main function, runs both runtimes
+ *
+ * @return 0: working properly
+ */
+int main (int argc, char* argv[]) {
+	double mowSeconds = argc > 1 ? std::atof(argv[1]) : 3;
+
+	std::cout << "Threads:" << std::endl;
+	RuntimeResult threads = runScript(false, mowSeconds);
+	printResult("Threads", threads);
+
+	std::cout << "Reactor:" << std::endl;
+	RuntimeResult reactor = runScript(true, mowSeconds);
+	printResult("Reactor", reactor);
+
+	return 0;
+}
@@ -0,0 +1,340 @@
+/**
+ * This file tests the SpanTracer without any hardware.
+ * It benchmarks a span with tracing stopped and running (against an empty block), then runs the button and execution
+ * threads on a SimBoard in real time with tracing on while a script presses start, pause, resume and shutdown, writes the
+ * spans as Chrome trace JSON and reads the file back: every thread must have its spans, properly nested. Last, one thread
+ * fills its ring several times over while another writes the trace, and only whole spans may come out.
+ *
+ * Open the written file in chrome://tracing or ui.perfetto.dev to see the threads side by side.
+ *
+ * Usage: ./test [trace file]
+ *
+ */
+
+#include "State.h"
+#include "Path.h"
+#include "Motor.h"
+#include "WheelController.h"
+#include "BladeController.h"
+#include "ButtonController.h"
+#include "ExecutionController.h"
+#include "SimBoard.h"
+#include "CancellationToken.h"
+#include "SpanTracer.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+const int BENCHMARK_SPANS = 1000000;
+const unsigned int RING_PASSES = 50; // times the ring test fills a ring
+const int START_PIN = 29;
+const int INPUT_PIN = 1;
+const int UP_PIN = 4;
+const int DOWN_PIN = 28;
+const double CAR_DIAMETER = 0.87;
+const double BLADE_DIAMETER = 0.435;
+
+struct ParsedSpan {
+	std::string name;
+	std::string category;
+	int tid;
+	double startUs;
+	double durationUs;
+};
+
+std::atomic<long> g_sink(0); // keeps the benchmark loops from being optimised away
+
+/**
+ * Function which returns the ns per iteration of a loop with one (or no) span in it
+ */
+double timeSpans(bool withSpan) {
+	auto start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < BENCHMARK_SPANS; i++) {
+		if (withSpan) {
+			TRACE_SPAN("bench", "span");
+			g_sink.fetch_add(1, std::memory_order_relaxed);
+		} else {
+			g_sink.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / BENCHMARK_SPANS;
+}
+
+/**
+ * Function which presses and releases a button, like a finger
+ */
+void press(SimBoard& board, int pin) {
+	board.setInput(pin, 0);
+	std::this_thread::sleep_for(std::chrono::milliseconds(120));
+	board.setInput(pin, 1);
+}
+
+/**
+ * Function which reads the spans and thread names back from a file written by writeChromeTrace()
+ * Return value is 0 for success, -1 if the file could not be read or is not a whole trace
+ */
+int readTrace(const std::string& path, std::vector<ParsedSpan>& spans, std::map<int, std::string>& threadNames) {
+	std::ifstream file(path);
+	std::string line;
+	bool ended = false;
+
+	if (!file) {
+		return -1;
+	}
+
+	while (std::getline(file, line)) {
+		char name[64];
+		char category[64];
+		ParsedSpan span;
+
+		if (sscanf(line.c_str(), "{\"name\":\"%63[^\"]\",\"cat\":\"%63[^\"]\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%lf,\"dur\":%lf},",
+			name, category, &span.tid, &span.startUs, &span.durationUs) == 5) {
+			span.name = name;
+			span.category = category;
+			spans.push_back(span);
+		} else if (sscanf(line.c_str(), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%63[^\"]\"}},", &span.tid, name) == 2) {
+			threadNames[span.tid] = name;
+		} else if (line == "]}") {
+			ended = true;
+		}
+	}
+
+	return ended ? 0 : -1;
+}
+
+/**
+ * Function which counts the spans that overlap a span they are not inside of, on the same thread
+ */
+int countBadNesting(std::vector<ParsedSpan> spans) {
+	int bad = 0;
+
+	std::stable_sort(spans.begin(), spans.end(), [](const ParsedSpan& a, const ParsedSpan& b) {
+		return a.tid != b.tid ? a.tid < b.tid : a.startUs != b.startUs ? a.startUs < b.startUs : a.durationUs > b.durationUs;
+	});
+
+	std::vector<const ParsedSpan*> open;
+
+	for (const ParsedSpan& span : spans) {
+		while (!open.empty() && (open.back()->tid != span.tid || open.back()->startUs + open.back()->durationUs <= span.startUs)) {
+			open.pop_back();
+		}
+
+		// the clock is read at the end of the inner span first, so an inner span can never end after the outer one
+		if (!open.empty() && span.startUs + span.durationUs > open.back()->startUs + open.back()->durationUs + 0.001) {
+			bad++;
+		}
+
+		open.push_back(&span);
+	}
+
+	return bad;
+}
+
+/**
+ * Function which counts the spans of a ring test trace that are not whole: a span the writer overwrote while it was
+ * copied would be out of order with the spans around it
+ * @return the number of spans out of order or not from the ring test, 1 if the file could not be read
+ */
+int countTorn(const std::string& path) {
+	std::vector<ParsedSpan> spans;
+	std::map<int, std::string> threadNames;
+	int torn = 0;
+
+	if (readTrace(path, spans, threadNames) != 0) {
+		return 1;
+	}
+
+	for (size_t i = 0; i < spans.size(); i++) {
+		torn += spans[i].name != "wrap" || spans[i].category != "ring" || spans[i].durationUs < 0 || (i > 0 && spans[i].startUs < spans[i - 1].startUs);
+	}
+
+	return torn;
+}
+
+/**
+ * Function which runs the two threads through the script with tracing on and writes the trace
+ * @return the number of spans written, -1 if the file could not be written
+ */
+int traceMower(const std::string& tracePath) {
+	SimBoard board;
+	State currentState = IDLE;
+	Path path(3.0, 3.0, CAR_DIAMETER, BLADE_DIAMETER, false);
+
+	board.setRealTime(true);
+
+	for (int pin : {START_PIN, INPUT_PIN, UP_PIN, DOWN_PIN}) {
+		board.setInput(pin, 1); // released
+	}
+
+	Motor leftWheelMotor(24, 23, board);
+	Motor rightWheelMotor(21, 22, board);
+	Motor bladeMotor(2, 3, board);
+	CancellationToken shutdown;
+	WheelController wheelControl(leftWheelMotor, rightWheelMotor);
+	wheelControl.setCancellationToken(shutdown);
+	BladeController bladeControl(bladeMotor);
+	ExecutionController exec(currentState, path, wheelControl, bladeControl, board);
+	exec.setVerbose(false);
+	exec.setCancellationToken(shutdown);
+
+	ButtonController btn(START_PIN, INPUT_PIN, UP_PIN, DOWN_PIN, currentState, path, exec, board);
+	btn.setCancellationToken(shutdown);
+
+	SpanTracer& tracer = SpanTracer::getInstance();
+	tracer.stop();
+	tracer.clear();
+	tracer.setThreadName("script");
+	tracer.start();
+	btn.initDisplay();
+	btn.setupInputs();
+
+	std::thread buttonThread(&ButtonController::startInputListener, &btn);
+	std::thread execThread(&ExecutionController::startExecutionListener, &exec);
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(300));
+	press(board, START_PIN);
+	std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+	press(board, INPUT_PIN); // pause
+	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+	press(board, INPUT_PIN); // resume
+	std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+	press(board, DOWN_PIN); // shutdown
+
+	execThread.join();
+	buttonThread.join();
+	tracer.stop();
+
+	return tracer.writeChromeTrace(tracePath);
+}
+
+/**
+ * main function, runs the benchmark, the mower trace and the ring test
+ *
+ * @return 0: working properly
+ * @return 1: spans went missing, were not nested, or came out torn
+ */
+int main (int argc, char* argv[]) {
+	std::string path = argc > 1 ? argv[1] : "/tmp/mower_spans.json";
+	SpanTracer& tracer = SpanTracer::getInstance();
+	int failures = 0;
+
+	// per span cost on the calling thread
+	double emptyNs = timeSpans(false);
+	double stoppedNs = timeSpans(true);
+	tracer.start();
+	double runningNs = timeSpans(true);
+	tracer.stop();
+
+	std::cout << "Per span: stopped " << std::max(0.0, stoppedNs - emptyNs) << " ns, running " << std::max(0.0, runningNs - emptyNs);
+	std::cout << " ns (empty loop " << emptyNs << " ns per iteration)" << std::endl;
+
+	// the mower's threads
+	int written = traceMower(path);
+	std::vector<ParsedSpan> spans;
+	std::map<int, std::string> threadNames;
+	std::map<std::string, int> perCategory;
+
+	if (written < 0 || readTrace(path, spans, threadNames) != 0 || (int) spans.size() != written) {
+		std::cout << "FAIL: the trace could not be written or read back from " << path << std::endl;
+		return 1;
+	}
+
+	for (const ParsedSpan& span : spans) {
+		perCategory[span.category]++;
+	}
+
+	int badNesting = countBadNesting(spans);
+
+	std::cout << "Mower: " << written << " spans written to " << path << " (";
+
+	for (const auto& category : perCategory) {
+		std::cout << " " << category.first << " " << category.second;
+	}
+
+	std::cout << " ), " << badNesting << " not nested" << std::endl;
+
+	for (const char* category : {"exec", "wheels", "buttons", "display", "board"}) {
+		if (perCategory[category] == 0) {
+			std::cout << "FAIL: no " << category << " spans" << std::endl;
+			failures++;
+		}
+	}
+
+	std::vector<std::string> names;
+
+	for (const auto& thread : threadNames) {
+		names.push_back(thread.second);
+	}
+
+	for (const char* name : {"exec", "buttons"}) {
+		if (std::find(names.begin(), names.end(), name) == names.end()) {
+			std::cout << "FAIL: no thread named " << name << std::endl;
+			failures++;
+		}
+	}
+
+	if (badNesting > 0) {
+		failures++;
+	}
+
+	// a ring written over several times while the trace is being written
+	tracer.clear();
+	tracer.start();
+
+	std::atomic<bool> done(false);
+	long before = tracer.getSpanCount();
+	std::thread writer([&]() {
+		for (unsigned int i = 0; i < RING_PASSES * SPAN_RING_SIZE; i++) {
+			TRACE_SPAN("ring", "wrap");
+		}
+
+		done.store(true);
+	});
+
+	int concurrent = 0;
+	int exports = 0;
+	int torn = 0;
+
+	while (!done.load()) {
+		concurrent = std::max(concurrent, tracer.writeChromeTrace(path + ".ring"));
+		torn += countTorn(path + ".ring");
+		exports++;
+	}
+
+	writer.join();
+	tracer.stop();
+
+	long recorded = tracer.getSpanCount() - before;
+	long overwritten = tracer.getOverwrittenCount();
+	int kept = tracer.writeChromeTrace(path + ".ring");
+	torn += countTorn(path + ".ring");
+
+	std::remove((path + ".ring").c_str());
+
+	std::cout << "Ring: " << recorded << " spans recorded, " << overwritten << " overwritten, " << kept << " kept (";
+	std::cout << concurrent << " at most in " << exports << " traces written while recording), " << torn << " torn" << std::endl;
+
+	if (recorded != RING_PASSES * SPAN_RING_SIZE || overwritten != (RING_PASSES - 1) * SPAN_RING_SIZE || kept != (int) SPAN_RING_SIZE - 1 || concurrent >= (int) SPAN_RING_SIZE || torn != 0) {
+		std::cout << "FAIL: the ring did not keep the last " << SPAN_RING_SIZE - 1 << " whole spans" << std::endl;
+		failures++;
+	}
+
+	if (failures > 0) {
+		std::cout << "FAIL" << std::endl;
+		return 1;
+	}
+
+	std::cout << "PASS" << std::endl;
+
+	return 0;
+}
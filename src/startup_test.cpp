@@ -0,0 +1,93 @@
+/**
+ * This file tests the start up without any hardware: the StartupOrchestrator sets the (simulated) GPIO up once,
+ * generates the default plan for a large lawn and initializes the display in parallel, and marks the mower ready
+ * as soon as the buttons are live. Start is pressed straight away, before the plan is done, and must wait for it.
+ * It prints the start up report and fails if the mower was not ready within READY_TARGET_MS.
+ *
+ * Usage: ./test [lawn length] [lawn width]
+ *
+ */
+
+#include "State.h"
+#include "Path.h"
+#include "Motor.h"
+#include "WheelController.h"
+#include "BladeController.h"
+#include "ButtonController.h"
+#include "ExecutionController.h"
+#include "StartupOrchestrator.h"
+#include "SimBoard.h"
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+
+const int START_PIN = 29;
+const int INPUT_PIN = 1;
+const int UP_PIN = 4;
+const int DOWN_PIN = 28;
+const double CAR_DIAMETER = 0.87;
+const double BLADE_DIAMETER = 0.435;
+const double READY_TARGET_MS = 1000;
+
+/**
+ * main function, starts the mower up and presses start
+ *
+ * @return 0: ready in time and the first press started the mission
+ * @return 1: too slow, or the press did not start the mission
+ */
+int main (int argc, char* argv[]) {
+	double length = argc > 1 ? std::atof(argv[1]) : 60;
+	double width = argc > 2 ? std::atof(argv[2]) : 40;
+	SimBoard board;
+
+	board.setRealTime(true);
+
+	for (int pin : {START_PIN, INPUT_PIN, UP_PIN, DOWN_PIN}) {
+		board.setInput(pin, 1); // released
+	}
+
+	StartupOrchestrator startup(board);
+	startup.setupGpio();
+
+	State currentState = IDLE;
+	Path path(length, width, CAR_DIAMETER, BLADE_DIAMETER, false, false);
+	Motor leftWheelMotor(24, 23, board);
+	Motor rightWheelMotor(21, 22, board);
+	Motor bladeMotor(2, 3, board);
+	WheelController wheelControl(leftWheelMotor, rightWheelMotor);
+	BladeController bladeControl(bladeMotor);
+	ExecutionController exec(currentState, path, wheelControl, bladeControl, board);
+	exec.setVerbose(false);
+	ButtonController btn(START_PIN, INPUT_PIN, UP_PIN, DOWN_PIN, currentState, path, exec, board);
+
+	btn.setPlanReady(startup.startStep("default plan", [&path]() { return path.generate(); }));
+	startup.startStep("display", [&btn]() { return btn.initDisplay(); });
+	startup.runStep("button inputs", [&btn]() { return btn.setupInputs(); });
+	startup.markReady();
+
+	// start pressed the moment the buttons are live: the press has to wait for the plan
+	auto pressed = std::chrono::steady_clock::now();
+	board.setInput(START_PIN, 0);
+	btn.pollButtons();
+	double pressMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - pressed).count();
+
+	startup.waitAll();
+	startup.printReport(std::cout);
+
+	std::cout << length << " x " << width << " m lawn, " << path.getInstructions().size() << " instructions" << std::endl;
+	std::cout << "Start pressed when ready: handled after " << pressMs << " ms, " << exec.getRemainingCount() << " instructions assigned" << std::endl;
+
+	if (startup.getReadyMs() + std::max(0.0, startup.getProcessAgeMs()) > READY_TARGET_MS) {
+		std::cout << "FAIL: not ready within " << READY_TARGET_MS << " ms" << std::endl;
+		return 1;
+	}
+
+	if (currentState != MOWING || exec.getRemainingCount() == 0) {
+		std::cout << "FAIL: the start press did not start the mission" << std::endl;
+		return 1;
+	}
+
+	std::cout << "PASS" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,409 @@
+/**
+ * This file tests the TelemetryWriter and TelemetryReader without any hardware.
+ * First a writer publishes frames as fast as it can while readers in this process and in a forked process sample the
+ * segment as fast as they can: every field of a frame is made from the same counter, so a frame mixed from two writes
+ * would show up. It prints how many frames each side got through and what a publish costs. Then a mission runs on a
+ * SimBoard with the executor publishing, and the segment is checked after every step while another thread samples it:
+ * the instruction index and remaining count must always add up to the plan, and the motor pins must match the instruction.
+ * Last the first leg of a mission runs in real time, the pose in the segment must move while the mower drives it.
+ *
+ * Usage: ./test [seconds]
+ *
+ */
+
+#include "State.h"
+#include "Path.h"
+#include "Motor.h"
+#include "WheelController.h"
+#include "BladeController.h"
+#include "ExecutionController.h"
+#include "PoseEstimator.h"
+#include "SimBoard.h"
+#include "TelemetryWriter.h"
+#include "TelemetryReader.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <sys/wait.h>
+#include <unistd.h>
+
+const char STRESS_NAME[] = "/nomo_telemetry_test";
+const char MISSION_NAME[] = "/nomo_telemetry_mission";
+const int READER_THREADS = 3;
+const int BENCHMARK_PUBLISHES = 1000000;
+const double CAR_DIAMETER = 0.87;
+const double BLADE_DIAMETER = 0.435;
+
+struct ReaderResult {
+	unsigned long reads;
+	unsigned long torn; // frames not made from a single counter
+	unsigned long backwards; // frames older than one read before
+	unsigned long retries;
+};
+
+/**
+ * Function which makes the stress frame for a counter, every field depends on all of its bits
+ */
+TelemetryFrame makeFrame(unsigned int counter) {
+	TelemetryFrame frame;
+
+	memset(&frame, 0, sizeof(frame));
+	frame.x = counter;
+	frame.y = -2.0 * counter;
+	frame.theta = counter * 0.5;
+	frame.value = counter + 0.25;
+	frame.state = counter % 7;
+	frame.phase = counter % 4;
+	frame.instructionIndex = counter;
+	frame.remainingCount = ~counter;
+	frame.motorLevels = counter * 2654435761u;
+	frame.action[0] = 'A' + counter % 26;
+	frame.action[1] = 'A' + counter / 26 % 26;
+	frame.poseValid = counter ^ 0x5A5A5A5A;
+	frame.bladeSpinning = counter + 1;
+
+	return frame;
+}
+
+/**
+ * Function which samples the stress segment until the deadline
+ */
+ReaderResult readUntil(std::chrono::steady_clock::time_point deadline) {
+	TelemetryReader reader;
+	ReaderResult result = {0, 0, 0, 0};
+	unsigned int lastCounter = 0;
+
+	if (reader.open(STRESS_NAME) != 0) {
+		result.torn = 1;
+		return result;
+	}
+
+	while (std::chrono::steady_clock::now() < deadline) {
+		for (int i = 0; i < 1000; i++) {
+			TelemetryFrame frame;
+
+			if (reader.read(frame) != 0) {
+				continue;
+			}
+
+			TelemetryFrame expected = makeFrame(frame.instructionIndex);
+
+			result.torn += memcmp(&frame, &expected, sizeof(frame)) != 0;
+			result.backwards += frame.instructionIndex < lastCounter;
+			lastCounter = frame.instructionIndex;
+			result.reads++;
+		}
+	}
+
+	result.retries = reader.getRetryCount();
+
+	return result;
+}
+
+/**
+ * Function which prints a reader's result
+ */
+void printResult(const char* name, const ReaderResult& result, double seconds) {
+	std::cout << "  " << name << ": " << result.reads / seconds / 1e6 << " M reads/s, " << result.retries << " retries, ";
+	std::cout << result.torn << " torn, " << result.backwards << " out of order" << std::endl;
+}
+
+/**
+ * Function which publishes as fast as possible while readers in this process and in a child process sample
+ * @return the number of failed checks
+ */
+int stressTest(double seconds) {
+	TelemetryWriter writer;
+	int failures = 0;
+
+	if (writer.open(STRESS_NAME) != 0) {
+		std::cout << "FAIL: could not create " << STRESS_NAME << std::endl;
+		return 1;
+	}
+
+	writer.publish(makeFrame(1));
+
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+
+	// forked before any thread is started, the child reads through its own mapping
+	pid_t child = fork();
+
+	if (child == 0) {
+		ReaderResult result = readUntil(deadline);
+		printResult("other process", result, seconds);
+		std::cout.flush();
+		_exit(result.torn == 0 && result.backwards == 0 && result.reads > 0 ? 0 : 1);
+	}
+
+	std::vector<std::thread> readers;
+	std::vector<ReaderResult> results(READER_THREADS);
+
+	for (int i = 0; i < READER_THREADS; i++) {
+		readers.emplace_back([&results, i, deadline]() { results[i] = readUntil(deadline); });
+	}
+
+	unsigned int counter = 1;
+
+	while (std::chrono::steady_clock::now() < deadline) {
+		for (int i = 0; i < 1000; i++) {
+			writer.publish(makeFrame(++counter));
+		}
+	}
+
+	for (std::thread& reader : readers) {
+		reader.join();
+	}
+
+	int status = 0;
+	waitpid(child, &status, 0);
+
+	std::cout << "Stress: " << writer.getPublishCount() / seconds / 1e6 << " M frames/s published for " << seconds << " s" << std::endl;
+
+	for (int i = 0; i < READER_THREADS; i++) {
+		printResult("thread", results[i], seconds);
+
+		if (results[i].torn != 0 || results[i].backwards != 0 || results[i].reads == 0) {
+			failures++;
+		}
+	}
+
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+		std::cout << "FAIL: the reader in the other process saw torn or out of order frames" << std::endl;
+		failures++;
+	}
+
+	if (failures > 0) {
+		std::cout << "FAIL: a reader saw torn or out of order frames" << std::endl;
+	}
+
+	// cost on the executor's thread, with and without a change to publish
+	auto start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < BENCHMARK_PUBLISHES; i++) {
+		writer.publish(makeFrame(++counter));
+	}
+
+	double changedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / BENCHMARK_PUBLISHES;
+	TelemetryFrame same = makeFrame(counter);
+	start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < BENCHMARK_PUBLISHES; i++) {
+		writer.publish(same);
+	}
+
+	double unchangedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / BENCHMARK_PUBLISHES;
+
+	std::cout << "Per publish: " << changedNs << " ns changed (frame made included), " << unchangedNs << " ns unchanged" << std::endl;
+
+	writer.unlink();
+
+	return failures;
+}
+
+/**
+ * Function which checks a mission frame against the plan
+ * @return 1 if the instruction index and remaining count do not add up to the plan or the state is not a mowing one
+ */
+int checkMissionFrame(const TelemetryFrame& frame, unsigned int planned) {
+	return frame.instructionIndex + frame.remainingCount != planned || (frame.state != IDLE && frame.state != MOWING && frame.state != PAUSED);
+}
+
+/**
+ * Function which runs a mission with the executor publishing, checking the segment after every step
+ * @return the number of failed checks
+ */
+int missionTest() {
+	SimBoard board;
+	State currentState = IDLE;
+	Path lawn(6.0, 4.0, CAR_DIAMETER, BLADE_DIAMETER, false);
+	PoseEstimator poseEstimator(CAR_DIAMETER, lawn.getStartPose());
+	TelemetryWriter writer;
+	TelemetryReader reader;
+	int failures = 0;
+
+	Motor leftWheelMotor(24, 23, board);
+	Motor rightWheelMotor(21, 22, board);
+	Motor bladeMotor(2, 3, board);
+	WheelController wheelControl(leftWheelMotor, rightWheelMotor);
+	BladeController bladeControl(bladeMotor);
+	ExecutionController exec(currentState, lawn, wheelControl, bladeControl, board);
+
+	if (writer.open(MISSION_NAME) != 0) {
+		std::cout << "FAIL: could not create " << MISSION_NAME << std::endl;
+		return 1;
+	}
+
+	exec.setVerbose(false);
+	exec.setPoseEstimator(poseEstimator);
+	exec.setTelemetry(writer);
+
+	if (reader.open(MISSION_NAME) != 0) {
+		std::cout << "FAIL: could not open " << MISSION_NAME << std::endl;
+		return 1;
+	}
+
+	unsigned int planned = lawn.getInstructions().size();
+	std::atomic<bool> done(false);
+	unsigned long sampled = 0;
+	unsigned long badSamples = 0;
+
+	// a dashboard sampling while the mission runs
+	std::thread dashboard([&]() {
+		TelemetryReader sampler;
+		TelemetryFrame frame;
+
+		sampler.open(MISSION_NAME);
+
+		while (!done.load()) {
+			if (sampler.read(frame) == 0) {
+				badSamples += frame.state == MOWING && checkMissionFrame(frame, planned);
+				sampled++;
+			}
+		}
+	});
+
+	exec.assignInstructions();
+	currentState = MOWING;
+
+	unsigned int waitMs;
+	unsigned int started = 0;
+	unsigned int movingFrames = 0;
+	TelemetryFrame frame;
+
+	while (exec.startNext(waitMs) == 1) {
+		started++;
+		reader.read(frame);
+
+		bool moving = strcmp(frame.action, "MF") == 0 || strcmp(frame.action, "MB") == 0;
+		unsigned int wheels = frame.motorLevels & (TELEMETRY_LEFT_CW | TELEMETRY_LEFT_CCW | TELEMETRY_RIGHT_CW | TELEMETRY_RIGHT_CCW);
+
+		movingFrames += moving;
+
+		if (checkMissionFrame(frame, planned) || frame.instructionIndex != started || frame.state != MOWING || frame.phase == NO_INSTRUCTION
+			|| (moving && wheels == 0) || (frame.bladeSpinning != 0) != ((frame.motorLevels & (TELEMETRY_BLADE_CW | TELEMETRY_BLADE_CCW)) != 0)) {
+			std::cout << "FAIL: frame of instruction " << started << " (" << frame.action << ") does not match the executor" << std::endl;
+			failures++;
+		}
+
+		do {
+			board.delay(waitMs);
+		} while (exec.continueCurrent(waitMs) == 1);
+
+		reader.read(frame);
+
+		if (checkMissionFrame(frame, planned) || frame.phase != NO_INSTRUCTION || frame.action[0] != 0
+			|| (frame.motorLevels & ~(TELEMETRY_BLADE_CW | TELEMETRY_BLADE_CCW)) != 0) {
+			std::cout << "FAIL: frame after instruction " << started << " still shows it running" << std::endl;
+			failures++;
+		}
+	}
+
+	done.store(true);
+	dashboard.join();
+
+	Pose pose = poseEstimator.getPose();
+	reader.read(frame);
+
+	std::cout << "Mission of " << planned << " instructions: " << writer.getPublishCount() << " frames published, ";
+	std::cout << sampled << " sampled by another thread (" << badSamples << " not adding up), last frame at (";
+	std::cout << frame.x << ", " << frame.y << ")" << std::endl;
+
+	if (started != planned || movingFrames == 0 || frame.state != IDLE || frame.instructionIndex != planned || frame.remainingCount != 0
+		|| frame.motorLevels != 0 || frame.poseValid != 1 || frame.x != pose.x || frame.y != pose.y || badSamples != 0) {
+		std::cout << "FAIL: the segment does not match the mission" << std::endl;
+		failures++;
+	}
+
+	writer.unlink();
+
+	return failures;
+}
+
+/**
+ * Function which drives the first leg of a mission in real time and samples the segment half way along it
+ * @return the number of failed checks
+ */
+int livePoseTest() {
+	SimBoard board;
+	State currentState = IDLE;
+	Path lawn(3.0, 3.0, CAR_DIAMETER, BLADE_DIAMETER, false);
+	Pose start = lawn.getStartPose();
+	PoseEstimator poseEstimator(CAR_DIAMETER, start);
+	TelemetryWriter writer;
+	TelemetryReader reader;
+
+	Motor leftWheelMotor(24, 23, board);
+	Motor rightWheelMotor(21, 22, board);
+	Motor bladeMotor(2, 3, board);
+	WheelController wheelControl(leftWheelMotor, rightWheelMotor);
+	BladeController bladeControl(bladeMotor);
+	ExecutionController exec(currentState, lawn, wheelControl, bladeControl, board);
+
+	if (writer.open(MISSION_NAME) != 0 || reader.open(MISSION_NAME) != 0) {
+		std::cout << "FAIL: could not open " << MISSION_NAME << std::endl;
+		return 1;
+	}
+
+	board.setRealTime(true);
+	exec.setVerbose(false);
+	exec.setPoseEstimator(poseEstimator);
+	exec.setTelemetry(writer);
+	exec.assignInstructions();
+	currentState = MOWING;
+
+	double legMetres = lawn.getInstructions()[0].value;
+	std::thread executor([&]() {
+		exec.executeNext();
+	});
+
+	std::this_thread::sleep_for(std::chrono::milliseconds((int) (legMetres * DRIVE_MS_PER_METRE / 2)));
+
+	TelemetryFrame frame;
+	reader.read(frame);
+
+	executor.join();
+	writer.unlink();
+
+	double halfway = std::hypot(frame.x - start.x, frame.y - start.y);
+	Pose end = poseEstimator.getPose();
+	double driven = std::hypot(end.x - start.x, end.y - start.y);
+
+	std::cout << "Leg of " << legMetres << " m in real time: " << halfway << " m in the segment half way, " << driven << " m at the end" << std::endl;
+
+	if (strcmp(frame.action, "MF") != 0 || halfway < legMetres / 4 || halfway > legMetres * 3 / 4 || std::fabs(driven - legMetres) > 0.05) {
+		std::cout << "FAIL: the pose in the segment does not follow the mower while it drives" << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * main function, runs the stress test and the mission
+ *
+ * @return 0: working properly
+ * @return 1: a reader saw a torn frame, or the segment did not follow the executor
+ */
+int main (int argc, char* argv[]) {
+	double seconds = argc > 1 ? atof(argv[1]) : 2;
+	int failures = 0;
+
+	failures += stressTest(seconds);
+	failures += missionTest();
+	failures += livePoseTest();
+
+	if (failures > 0) {
+		std::cout << "FAIL" << std::endl;
+		return 1;
+	}
+
+	std::cout << "PASS" << std::endl;
+
+	return 0;
+}
@@ -8,19 +8,41 @@
 #include "BladeController.h"
 #include "ButtonController.h"
 #include "ExecutionController.h"
+#include "PoseEstimator.h"
+#include "ReactorRuntime.h"
+#include "WiringPiBoard.h"
+#include "CancellationToken.h"
+#include "EmergencyStop.h"
+#include "StartupOrchestrator.h"
+#include <cmath>
+#include <cstring>
 
-int main (void) {
+// the lawn this mower always mows, its plan is built by the compiler (see PresetPlan.h)
+struct DefaultLawn {
+    static constexpr double length = 3.0;
+    static constexpr double width = 3.0;
+    static constexpr double carDiameter = 0.87;
+    static constexpr double bladeDiameter = 0.435;
+};
+
+// usage: sudo ./test [reactor] (two threads by default, or everything on one epoll loop)
+int main (int argc, char* argv[]) {
     const int START_PIN = 29;
     const int INPUT_PIN = 1;
     const int UP_PIN = 4;
     const int DOWN_PIN = 28;
-    const double LENGTH = 3.0;
-    const double WIDTH = 3.0;
-    const double CAR_DIAMETER = 0.87;
-    const double BLADE_DIAMETER = 0.435;
+    const int ESTOP_PIN = 25;
+    const double LENGTH = DefaultLawn::length;
+    const double WIDTH = DefaultLawn::width;
+    const double CAR_DIAMETER = DefaultLawn::carDiameter;
+    const double BLADE_DIAMETER = DefaultLawn::bladeDiameter;
+
+    // GPIO is set up once here, the display is started in parallel below
+    StartupOrchestrator startup(WiringPiBoard::getInstance());
+    startup.setupGpio();
 
     State currentState = IDLE;
-    Path path(LENGTH, WIDTH, CAR_DIAMETER, BLADE_DIAMETER);
+    Path path(LENGTH, WIDTH, CAR_DIAMETER, BLADE_DIAMETER, true, false);
 
     // wheel motors, based on circuit diagram
     Motor motor1(24, 23);
@@ -28,15 +50,61 @@ int main (void) {
 
     // blade motor, based on circuit diagram
     Motor motor3(2, 3);
+
+    // cancelled by the down button: stops every motor straight away and wakes both threads
+    CancellationToken shutdown;
 	
 	WheelController wheelControl(motor1, motor2);
+    wheelControl.setCancellationToken(shutdown);
     BladeController bladeControl(motor3);
 
     ExecutionController* exec = new ExecutionController(currentState, path, wheelControl, bladeControl);
 
+    // mower starts in the bottom left corner, facing up the short side
+    PoseEstimator poseEstimator(CAR_DIAMETER, Pose{CAR_DIAMETER / 2, CAR_DIAMETER / 2, M_PI / 2});
+    exec->setPoseEstimator(poseEstimator);
+    exec->setCancellationToken(shutdown);
+
     ButtonController btn(START_PIN, INPUT_PIN, UP_PIN, DOWN_PIN, currentState, path, *exec);
+    btn.setCancellationToken(shutdown);
+
+    // e-stop switches every motor pin off from its own interrupt, start acknowledges it
+    EmergencyStop emergencyStop(ESTOP_PIN, {24, 23, 21, 22, 2, 3}, WiringPiBoard::getInstance());
+
+    if (startup.runStep("e-stop", [&emergencyStop]() { return emergencyStop.arm(); }) == 0) {
+        exec->setEmergencyStop(emergencyStop);
+        btn.setEmergencyStop(emergencyStop);
+    } else {
+        std::cout << "e-stop could not be armed" << std::endl;
+    }
+
+    // the default plan is a preset, so there is nothing to wait for; the screens are drawn once the display is up
+    startup.runStep("default plan", [&path]() { return path.usePreset<DefaultLawn>(); });
+    startup.startStep("display", [&btn]() { return btn.initDisplay(); });
+    startup.runStep("button inputs", [&btn]() { return btn.setupInputs(); });
+    startup.markReady();
+
+    std::thread report_thread([&startup]() {
+        startup.waitAll();
+        startup.printReport(std::cout);
+    });
+
+    if (argc > 1 && strcmp(argv[1], "reactor") == 0) {
+        ReactorRuntime runtime(btn, *exec, WiringPiBoard::getInstance());
+
+        std::cout << "reactor now running" << std::endl;
+
+        runtime.run();
+
+        LatencyStats latency = runtime.getLatency();
+        std::cout << "Event latency: mean " << latency.meanUs << " us, max " << latency.maxUs << " us over " << latency.count << " events" << std::endl;
+
+        report_thread.join();
+
+        return 0;
+    }
 
-    std::thread button_thread(&ButtonController::startInputListener, btn);
+    std::thread button_thread(&ButtonController::startInputListener, &btn);
 
     std::cout << "button thread now running" << std::endl;
 
@@ -46,6 +114,7 @@ int main (void) {
 
     exec_thread.join();
     button_thread.join();
+    report_thread.join();
 
     std::cout << "All threads completed" << std::endl;
 
@@ -0,0 +1,347 @@
+/**
+ * This file is the regression test for recorded board traces, without any hardware.
+ * Every trace in the corpus directory (*.trace, recorded with a RecordingBoard) is replayed with a TraceReplayer on a
+ * SimBoard's virtual clock, twice, and the motor pin timeline of the replay is compared bit for bit with the timeline
+ * kept next to the trace (*.timeline) and with the replay before it. A change to the button or execution logic that
+ * moves a motor edge shows up as the first event that differs.
+ *
+ * With --record the corpus is recorded again first: scripted button presses (and an e-stop) on a SimBoard in real time,
+ * with ReactorRuntime running the mower like on the lawn, and the timelines are written from their replays. The replay
+ * of a fresh recording must match what the motors did while it was recorded, within TRACE_TOLERANCE_MS.
+ *
+ * A trace's header line says how the mower was set up: "lawn <length> <width>", then "estop <pin>" if one was fitted.
+ *
+ * Usage: ./test [corpus directory] [--record]
+ *
+ */
+
+#include "State.h"
+#include "Path.h"
+#include "Motor.h"
+#include "WheelController.h"
+#include "BladeController.h"
+#include "ButtonController.h"
+#include "ExecutionController.h"
+#include "EmergencyStop.h"
+#include "ReactorRuntime.h"
+#include "SimBoard.h"
+#include "RecordingBoard.h"
+#include "TraceReplayer.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <dirent.h>
+
+const int START_PIN = 29;
+const int INPUT_PIN = 1;
+const int UP_PIN = 4;
+const int DOWN_PIN = 28;
+const int ESTOP_PIN = 25;
+const double CAR_DIAMETER = 0.87;
+const double BLADE_DIAMETER = 0.435;
+const int MOTOR_PINS[] = {24, 23, 21, 22, 2, 3};
+const unsigned int TRACE_TOLERANCE_MS = 20; // a recording in real time against its replay on the virtual clock
+
+/**
+ * The mower as the runtime sees it, built on any board from a trace's header
+ */
+struct Mower {
+	State currentState;
+	Path path;
+	Motor leftWheelMotor;
+	Motor rightWheelMotor;
+	Motor bladeMotor;
+	WheelController wheelControl;
+	BladeController bladeControl;
+	ExecutionController exec;
+	ButtonController btn;
+	EmergencyStop emergencyStop;
+
+	Mower(double length, double width, int estopPin, Board& board)
+		: currentState(IDLE), path(length, width, CAR_DIAMETER, BLADE_DIAMETER, false),
+		leftWheelMotor(24, 23, board), rightWheelMotor(21, 22, board), bladeMotor(2, 3, board),
+		wheelControl(leftWheelMotor, rightWheelMotor), bladeControl(bladeMotor),
+		exec(currentState, path, wheelControl, bladeControl, board),
+		btn(START_PIN, INPUT_PIN, UP_PIN, DOWN_PIN, currentState, path, exec, board),
+		emergencyStop(estopPin, std::vector<int>(std::begin(MOTOR_PINS), std::end(MOTOR_PINS)), board) {
+		exec.setVerbose(false);
+
+		if (estopPin >= 0 && emergencyStop.arm() == 0) {
+			exec.setEmergencyStop(emergencyStop);
+			btn.setEmergencyStop(emergencyStop);
+		}
+	}
+};
+
+struct Scenario {
+	const char* name;
+	const char* header;
+	std::function<void(SimBoard&, State&)> script;
+};
+
+/**
+ * Function which presses and releases a button, like a finger
+ */
+void press(SimBoard& board, int pin) {
+	board.setInput(pin, 0);
+	std::this_thread::sleep_for(std::chrono::milliseconds(120));
+	board.setInput(pin, 1);
+}
+
+/**
+ * Function which waits until the mower is in the given state (at most 20 s)
+ */
+void waitFor(State& currentState, State state) {
+	for (int i = 0; i < 20000 && currentState != state; i++) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+/**
+ * Function which sleeps for some milliseconds of the script
+ */
+void pause(int milliseconds) {
+	std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
+
+/**
+ * Function which returns the scenarios the corpus is recorded from
+ */
+std::vector<Scenario> getScenarios() {
+	return {
+		{"pause_resume", "lawn 2.2 2.2", [](SimBoard& board, State& currentState) {
+			pause(300);
+			press(board, START_PIN);
+			pause(1700);
+			press(board, INPUT_PIN); // pause
+			pause(800);
+			press(board, INPUT_PIN); // resume
+			waitFor(currentState, MOWING);
+			waitFor(currentState, IDLE); // mission done
+			pause(300);
+			press(board, DOWN_PIN); // shutdown
+		}},
+		{"stop_early", "lawn 3 3", [](SimBoard& board, State&) {
+			pause(300);
+			press(board, START_PIN);
+			pause(2300);
+			press(board, START_PIN); // end the mission
+			pause(400);
+			press(board, DOWN_PIN);
+		}},
+		{"estop", "lawn 3 3 estop 25", [](SimBoard& board, State&) {
+			pause(300);
+			press(board, START_PIN);
+			pause(1900);
+			board.setInput(ESTOP_PIN, 0);
+			pause(400);
+			board.setInput(ESTOP_PIN, 1); // released
+			pause(300);
+			press(board, START_PIN); // acknowledge
+			pause(300);
+			press(board, DOWN_PIN);
+		}},
+		{"shutdown_moving", "lawn 3 3", [](SimBoard& board, State&) {
+			pause(300);
+			press(board, START_PIN);
+			pause(2650);
+			board.setInput(DOWN_PIN, 0); // shutdown part way through a move
+			pause(120);
+			board.setInput(DOWN_PIN, 1);
+		}}
+	};
+}
+
+/**
+ * Function which builds the mower a trace was recorded on and replays the trace on a virtual clock
+ * @param timeline: set to the motor pin timeline of the replay
+ * @param replayMs: set to how long the replay took
+ * Return value is 0 for success, -1 if the header could not be read
+ */
+int replay(const BoardTrace& trace, BoardTrace& timeline, double& replayMs) {
+	double length;
+	double width;
+	int estopPin = -1;
+
+	if (sscanf(trace.getHeader().c_str(), "lawn %lf %lf estop %d", &length, &width, &estopPin) < 2) {
+		return -1;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	SimBoard board;
+
+	for (int pin : {START_PIN, INPUT_PIN, UP_PIN, DOWN_PIN, ESTOP_PIN}) {
+		board.setInput(pin, 1); // released when the mower starts, as in record()
+	}
+
+	RecordingBoard recorder(board);
+	Mower mower(length, width, estopPin, recorder);
+	TraceReplayer replayer(mower.btn, mower.exec, board);
+
+	replayer.run(trace);
+	timeline = recorder.getTrace().getTimeline();
+	replayMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	return 0;
+}
+
+/**
+ * Function which records a scenario with ReactorRuntime on a SimBoard in real time and saves the trace
+ * Return value is 0 for success, -1 if the trace could not be saved
+ */
+int record(const Scenario& scenario, const std::string& path) {
+	double length;
+	double width;
+	int estopPin = -1;
+	SimBoard board;
+
+	sscanf(scenario.header, "lawn %lf %lf estop %d", &length, &width, &estopPin);
+	board.setRealTime(true);
+
+	for (int pin : {START_PIN, INPUT_PIN, UP_PIN, DOWN_PIN, ESTOP_PIN}) {
+		board.setInput(pin, 1); // released
+	}
+
+	RecordingBoard recorder(board);
+	Mower mower(length, width, estopPin, recorder);
+	ReactorRuntime runtime(mower.btn, mower.exec, recorder);
+	std::thread script([&]() {
+		scenario.script(board, mower.currentState);
+		pause(200);
+		runtime.requestShutdown(); // in case the script did not shut down
+	});
+
+	runtime.run();
+	script.join();
+
+	return recorder.save(path, scenario.header);
+}
+
+/**
+ * Function which returns the traces in the corpus directory, sorted by name
+ */
+std::vector<std::string> listTraces(const std::string& directory) {
+	std::vector<std::string> names;
+	DIR* dir = opendir(directory.c_str());
+
+	if (dir == nullptr) {
+		return names;
+	}
+
+	for (dirent* entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+		std::string name = entry->d_name;
+
+		if (name.size() > 6 && name.compare(name.size() - 6, 6, ".trace") == 0) {
+			names.push_back(name.substr(0, name.size() - 6));
+		}
+	}
+
+	closedir(dir);
+	std::sort(names.begin(), names.end());
+
+	return names;
+}
+
+/**
+ * main function, replays the corpus (recording it first with --record)
+ *
+ * @return 0: every replay matched its timeline
+ * @return 1: a trace could not be replayed or its timeline changed
+ */
+int main (int argc, char* argv[]) {
+	std::string directory = "../traces";
+	bool recordCorpus = false;
+	int failures = 0;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--record") == 0) {
+			recordCorpus = true;
+		} else {
+			directory = argv[i];
+		}
+	}
+
+	if (recordCorpus) {
+		for (const Scenario& scenario : getScenarios()) {
+			std::string path = directory + "/" + scenario.name;
+			BoardTrace trace;
+			BoardTrace timeline;
+			double replayMs;
+			unsigned int deviationMs;
+			std::string difference;
+
+			if (record(scenario, path + ".trace") != 0 || trace.load(path + ".trace") != 0 || replay(trace, timeline, replayMs) != 0) {
+				std::cout << scenario.name << ": FAIL, could not record to " << path << ".trace" << std::endl;
+				failures++;
+				continue;
+			}
+
+			// the replay has to do what the motors did in real time before it can be the reference
+			if (trace.getTimeline().compare(timeline, TRACE_TOLERANCE_MS, deviationMs, difference) != 0) {
+				std::cout << scenario.name << ": FAIL, replay does not match the recording: " << difference << std::endl;
+				failures++;
+				continue;
+			}
+
+			timeline.save(path + ".timeline");
+			std::cout << scenario.name << ": recorded " << trace.getEvents().size() << " events, replay within " << deviationMs;
+			std::cout << " ms of the recording" << std::endl;
+		}
+	}
+
+	std::vector<std::string> names = listTraces(directory);
+
+	if (names.empty()) {
+		std::cout << "FAIL: no traces in " << directory << std::endl;
+		return 1;
+	}
+
+	for (const std::string& name : names) {
+		std::string path = directory + "/" + name;
+		BoardTrace trace;
+		BoardTrace expected;
+		BoardTrace first;
+		BoardTrace second;
+		double firstMs;
+		double secondMs;
+		unsigned int deviationMs;
+		std::string difference;
+
+		if (trace.load(path + ".trace") != 0 || expected.load(path + ".timeline") != 0
+			|| replay(trace, first, firstMs) != 0 || replay(trace, second, secondMs) != 0) {
+			std::cout << name << ": FAIL, could not read " << path << ".trace or its timeline" << std::endl;
+			failures++;
+			continue;
+		}
+
+		if (expected.compare(first, 0, deviationMs, difference) != 0) {
+			std::cout << name << ": FAIL, motor timeline changed: " << difference << std::endl;
+			failures++;
+			continue;
+		}
+
+		if (first.compare(second, 0, deviationMs, difference) != 0) {
+			std::cout << name << ": FAIL, two replays differ: " << difference << std::endl;
+			failures++;
+			continue;
+		}
+
+		std::cout << name << ": " << first.getEvents().size() << " motor edges match, " << trace.getEndMs() / 1000.0 << " s replayed in ";
+		std::cout << firstMs << " ms (" << trace.getEndMs() / firstMs << "x real time)" << std::endl;
+	}
+
+	if (failures > 0) {
+		std::cout << "FAIL: " << failures << " of " << names.size() << " traces" << std::endl;
+		return 1;
+	}
+
+	std::cout << "PASS" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,212 @@
+/**
+ * This file tests the TurnCalibration class without any hardware.
+ * It measures the cost of a duration lookup, and reports how accurate interpolated turns are
+ * against a simulated mower whose turn rate depends on the angle (motor spin-up) and the battery voltage.
+ * Then the serpentine is mowed on a SimBoard's virtual clock, and every turn must run the wheel motor as long as the
+ * same turn of the original plan did (lawns with an odd and an even number of strips, so both final strips are checked).
+ *
+ */
+
+#include "TurnCalibration.h"
+#include "State.h"
+#include "Path.h"
+#include "Motor.h"
+#include "WheelController.h"
+#include "BladeController.h"
+#include "ExecutionController.h"
+#include "SimBoard.h"
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+const double CAR_DIAMETER = 0.87;
+const double BLADE_DIAMETER = 0.435;
+const uint64_t LEFT_WHEEL_PINS = 1 << 24 | 1 << 23;
+const uint64_t RIGHT_WHEEL_PINS = 1 << 21 | 1 << 22;
+
+// simulated mower: ~100 ms of spin-up, then turns at a rate proportional to the battery voltage
+double simulatedAngle(double duration, double voltage) {
+	double rate = 0.1 * voltage / 12.0; // degrees per ms at the given voltage
+
+	if (duration <= 100) {
+		return rate * duration * duration / 200.0;
+	}
+
+	return rate * 50.0 + rate * (duration - 100);
+}
+
+// inverse of simulatedAngle, used to "measure" calibration points
+double simulatedDuration(double angle, double voltage) {
+	double rate = 0.1 * voltage / 12.0;
+
+	if (angle <= rate * 50.0) {
+		return std::sqrt(angle * 200.0 / rate);
+	}
+
+	return 100 + (angle - rate * 50.0) / rate;
+}
+
+/**
+ * Function which returns how long the wheel motor ran for each turn of the original serpentine (before turns could be
+ * any angle): TR90/TL90, TR100 and TL110 ran for their TurnDuration, TL120 and TL180 fell through to two standard turns
+ */
+std::vector<int> getBaselineTurnMs(double length, double width) {
+	int loopCount = std::ceil((std::min(length, width) - CAR_DIAMETER) / BLADE_DIAMETER);
+	std::vector<int> turns = {TurnDuration::positionOne}; // TR90 at the end of the first leg
+
+	for (int i = 0; i < loopCount - 1; i++) {
+		turns.push_back(TurnDuration::positionOne); // TR90 or TL90
+		turns.push_back(i % 2 == 0 ? TurnDuration::positionTwo : 2 * TurnDuration::positionOne); // TR100 or TL120
+	}
+
+	if (loopCount % 2 == 0) { // TR90, TR100, TL180, TR90
+		turns.insert(turns.end(), {TurnDuration::positionOne, TurnDuration::positionTwo, 2 * TurnDuration::positionOne, TurnDuration::positionOne});
+	} else { // TL110, TL120, TR100
+		turns.insert(turns.end(), {TurnDuration::positionFour, 2 * TurnDuration::positionOne, TurnDuration::positionTwo});
+	}
+
+	return turns;
+}
+
+/**
+ * Function which mows the serpentine of a lawn on the virtual clock and returns how long the wheel motor ran for each turn
+ * (a turn is a stretch of intervals with only one wheel powered)
+ */
+std::vector<int> measureTurnMs(double length, double width) {
+	SimBoard board;
+	State currentState = MOWING;
+	Path path(length, width, CAR_DIAMETER, BLADE_DIAMETER, false);
+	std::vector<int> turns;
+	uint64_t previousWheels = 0;
+
+	Motor leftWheelMotor(24, 23, board);
+	Motor rightWheelMotor(21, 22, board);
+	Motor bladeMotor(2, 3, board);
+	WheelController wheelControl(leftWheelMotor, rightWheelMotor);
+	BladeController bladeControl(bladeMotor);
+	ExecutionController exec(currentState, path, wheelControl, bladeControl, board);
+
+	exec.setVerbose(false);
+	exec.assignInstructions();
+
+	while (exec.executeNext() > 0) {
+
+	}
+
+	for (const PinInterval& interval : board.getIntervals()) {
+		uint64_t wheels = interval.levels & (LEFT_WHEEL_PINS | RIGHT_WHEEL_PINS);
+		bool turning = ((wheels & LEFT_WHEEL_PINS) != 0) != ((wheels & RIGHT_WHEEL_PINS) != 0);
+
+		if (turning && wheels != previousWheels) {
+			turns.push_back(0);
+		}
+
+		if (turning) {
+			turns.back() += interval.durationMs;
+		}
+
+		previousWheels = wheels;
+	}
+
+	return turns;
+}
+
+/**
+ * Function which checks that every turn of a lawn's serpentine runs as long as in the original plan
+ * @return 0: same turn times, 1: a turn changed
+ */
+int checkTurnTimes(double length, double width) {
+	std::vector<int> baseline = getBaselineTurnMs(length, width);
+	std::vector<int> measured = measureTurnMs(length, width);
+	bool same = baseline == measured;
+	size_t finalTurns = (int) std::ceil((std::min(length, width) - CAR_DIAMETER) / BLADE_DIAMETER) % 2 == 0 ? 4 : 3;
+
+	std::cout << length << " x " << width << ": " << measured.size() << " turns, final strip";
+
+	for (size_t i = measured.size() >= finalTurns ? measured.size() - finalTurns : 0; i < measured.size(); i++) {
+		std::cout << " " << measured[i];
+	}
+
+	std::cout << " ms, " << (same ? "same as the original plan" : "NOT the original plan's turn times") << std::endl;
+
+	if (!same) {
+		for (size_t i = 0; i < baseline.size() || i < measured.size(); i++) {
+			int expected = i < baseline.size() ? baseline[i] : 0;
+			int actual = i < measured.size() ? measured[i] : 0;
+
+			if (expected != actual) {
+				std::cout << "FAIL: turn " << i << " ran " << actual << " ms, the original plan " << expected << " ms" << std::endl;
+			}
+		}
+	}
+
+	return same ? 0 : 1;
+}
+
+/**
+ * main function, runs the benchmark and accuracy report, then checks the serpentine's turn times
+ *
+ * @return 0: working properly
+ * @return -1: lookups are wrong, or a turn of the serpentine no longer runs as long as in the original plan
+ */
+int main (void) {
+	const double VOLTAGES[] = {11.0, 12.0, 12.6};
+	TurnCalibration calibration;
+
+	// "measure" the mower every 30 degrees at each voltage
+	for (double voltage : VOLTAGES) {
+		std::vector<CalibrationPoint> points;
+
+		for (double angle = 30; angle <= 360; angle += 30) {
+			points.push_back(CalibrationPoint{angle, simulatedDuration(angle, voltage)});
+		}
+
+		calibration.addTable(voltage, points);
+	}
+
+	// measured points must come back exactly
+	if (calibration.getDuration(90, 12.0) != (int) std::lround(simulatedDuration(90, 12.0))) {
+		std::cout << "Lookup of a calibration point failed" << std::endl;
+		return -1;
+	}
+
+	// lookup cost
+	const int LOOKUPS = 10000000;
+	long long checksum = 0;
+	auto start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < LOOKUPS; i++) {
+		checksum += calibration.getDuration(i % 360, 11.0 + (i % 17) * 0.1);
+	}
+
+	auto end = std::chrono::steady_clock::now();
+	double ns = std::chrono::duration<double, std::nano>(end - start).count() / LOOKUPS;
+
+	std::cout << "lookup cost: " << ns << " ns/lookup (checksum " << checksum << ")" << std::endl;
+
+	// accuracy report: commanded angle vs angle the simulated mower actually turns
+	std::cout << "\nvoltage  max error (deg)  mean error (deg)" << std::endl;
+
+	for (double voltage = 11.0; voltage <= 12.61; voltage += 0.4) {
+		double maxError = 0;
+		double sumError = 0;
+		int count = 0;
+
+		for (double angle = 1; angle <= 360; angle += 1) {
+			double error = std::fabs(simulatedAngle(calibration.getDuration(angle, voltage), voltage) - angle);
+			maxError = std::max(maxError, error);
+			sumError += error;
+			count++;
+		}
+
+		std::cout << voltage << "     " << maxError << "          " << sumError / count << std::endl;
+	}
+
+	// turn times of the serpentine: odd (3 x 3, 4.5 x 4.5) and even (2.5 x 4, 6 x 3.2) numbers of strips
+	std::cout << "\nserpentine turn times on the virtual clock" << std::endl;
+
+	int failures = checkTurnTimes(3.0, 3.0) + checkTurnTimes(4.5, 4.5) + checkTurnTimes(2.5, 4.0) + checkTurnTimes(6.0, 3.2);
+
+	return failures == 0 ? 0 : -1;
+}